@@ -60,6 +60,15 @@ static rax *commandId = NULL; /* Command name to id mapping */
 
 static unsigned long nextid = 0; /* Next command id that has not been assigned */
 
+/* Bumped whenever any user's rules may have changed (ACL SETUSER/DELUSER,
+ * ACL LOAD, config rewrites). Lets callers that validated a command earlier
+ * detect that no re-validation is needed, see execCommand(). */
+static unsigned long long acl_generation = 1;
+
+unsigned long long ACLGetGeneration(void) {
+    return acl_generation;
+}
+
 #define ACL_MAX_CATEGORIES 64 /* Maximum number of command categories  */
 
 struct ACLCategoryItem {
@@ -292,18 +301,47 @@ static void *ACLListDupSds(void *item) {
     return sdsdup(item);
 }
 
+/* How a key pattern is matched against keys. Since ACL rules change rarely
+ * but are checked on every command, the match strategy is compiled once when
+ * the pattern is created, so that the hot permission check only falls back to
+ * full glob matching when the pattern actually uses glob syntax. */
+#define ACL_PATTERN_MATCH_GLOB 0    /* Generic glob-style matching. */
+#define ACL_PATTERN_MATCH_ALL 1     /* "*": matches every key. */
+#define ACL_PATTERN_MATCH_LITERAL 2 /* No wildcards: exact comparison. */
+#define ACL_PATTERN_MATCH_PREFIX 3  /* "foo*": literal prefix comparison. */
+
 /* Structure used for handling key patterns with different key
  * based permissions. */
 typedef struct {
-    int flags;   /* The ACL key permission types for this key pattern */
-    sds pattern; /* The pattern to match keys against */
+    int flags;      /* The ACL key permission types for this key pattern */
+    sds pattern;    /* The pattern to match keys against */
+    int match_type; /* One of ACL_PATTERN_MATCH_*, precomputed from the pattern */
 } keyPattern;
 
+/* Classify a key pattern into one of the ACL_PATTERN_MATCH_* strategies. */
+static int ACLKeyPatternMatchType(sds pattern) {
+    size_t plen = sdslen(pattern);
+    if (plen == 1 && pattern[0] == '*') return ACL_PATTERN_MATCH_ALL;
+    for (size_t i = 0; i < plen; i++) {
+        switch (pattern[i]) {
+        case '*':
+            /* A single trailing star is a plain prefix match, a star
+             * anywhere else requires the full glob machinery. */
+            return (i == plen - 1) ? ACL_PATTERN_MATCH_PREFIX : ACL_PATTERN_MATCH_GLOB;
+        case '?':
+        case '[':
+        case '\\': return ACL_PATTERN_MATCH_GLOB;
+        }
+    }
+    return ACL_PATTERN_MATCH_LITERAL;
+}
+
 /* Create a new key pattern. */
 static keyPattern *ACLKeyPatternCreate(sds pattern, int flags) {
     keyPattern *new = (keyPattern *)zmalloc(sizeof(keyPattern));
     new->pattern = pattern;
     new->flags = flags;
+    new->match_type = ACLKeyPatternMatchType(pattern);
     return new;
 }
 
@@ -429,6 +467,11 @@ static user *ACLCreateUser(const char *name, size_t namelen) {
     u->flags |= USER_FLAG_SANITIZE_PAYLOAD;
     u->passwords = listCreate();
     u->acl_string = NULL;
+    u->stat_commands = 0;
+    u->stat_exec_usec = 0;
+    u->stat_net_input_bytes = 0;
+    u->stat_net_output_bytes = 0;
+    u->stat_alloc_bytes = 0;
     listSetMatchMethod(u->passwords, ACLListMatchSds);
     listSetFreeMethod(u->passwords, sdsfreeVoid);
     listSetDupMethod(u->passwords, ACLListDupSds);
@@ -485,6 +528,7 @@ static void ACLFreeUserVoid(void *u) {
 void ACLFreeUserAndKillClients(user *u) {
     listIter li;
     listNode *ln;
+    acl_generation++;
     listRewind(server.clients, &li);
     while ((ln = listNext(&li)) != NULL) {
         client *c = listNodeValue(ln);
@@ -1249,6 +1293,7 @@ int ACLSetUser(user *u, const char *op, ssize_t oplen) {
 
     if (oplen == -1) oplen = strlen(op);
     if (oplen == 0) return C_OK; /* Empty string is a no-operation. */
+    acl_generation++;
     if (!strcasecmp(op, "on")) {
         u->flags |= USER_FLAG_ENABLED;
         u->flags &= ~USER_FLAG_DISABLED;
@@ -1546,12 +1591,24 @@ static int ACLSelectorCheckKey(aclSelector *selector, const char *key, int keyle
     if (keyspec_flags & CMD_KEY_DELETE) key_flags |= ACL_WRITE_PERMISSION;
     if (keyspec_flags & CMD_KEY_UPDATE) key_flags |= ACL_WRITE_PERMISSION;
 
-    /* Test this key against every pattern. */
+    /* Test this key against every pattern, using the match strategy
+     * precomputed when the pattern was added to the selector. */
     while ((ln = listNext(&li))) {
         keyPattern *pattern = listNodeValue(ln);
         if ((pattern->flags & key_flags) != key_flags) continue;
         size_t plen = sdslen(pattern->pattern);
-        if (stringmatchlen(pattern->pattern, plen, key, keylen, 0)) return ACL_OK;
+        switch (pattern->match_type) {
+        case ACL_PATTERN_MATCH_ALL: return ACL_OK;
+        case ACL_PATTERN_MATCH_LITERAL:
+            if ((size_t)keylen == plen && !memcmp(pattern->pattern, key, plen)) return ACL_OK;
+            break;
+        case ACL_PATTERN_MATCH_PREFIX:
+            if ((size_t)keylen >= plen - 1 && !memcmp(pattern->pattern, key, plen - 1)) return ACL_OK;
+            break;
+        default:
+            if (stringmatchlen(pattern->pattern, plen, key, keylen, 0)) return ACL_OK;
+            break;
+        }
     }
     return ACL_DENIED_KEY;
 }
@@ -1579,7 +1636,7 @@ static int ACLSelectorHasUnrestrictedKeyAccess(aclSelector *selector, int flags)
     while ((ln = listNext(&li))) {
         keyPattern *pattern = listNodeValue(ln);
         if ((pattern->flags & access_flags) != access_flags) continue;
-        if (!strcmp(pattern->pattern, "*")) {
+        if (pattern->match_type == ACL_PATTERN_MATCH_ALL) {
             return 1;
         }
     }
@@ -2703,6 +2760,28 @@ sds getAclErrorMessage(int acl_res, user *user, struct serverCommand *cmd, sds e
     serverPanic("Reached deadcode on getAclErrorMessage");
 }
 
+/* Append the INFO userstats section body: one line per ACL user that executed
+ * at least one command, with the cumulative resources consumed by the clients
+ * authenticated as that user. The counters live in the user object, so they
+ * survive client disconnections but are discarded when the user is deleted or
+ * the ACL file is reloaded. */
+sds genValkeyInfoStringUserStats(sds info) {
+    raxIterator ri;
+    raxStart(&ri, Users);
+    raxSeek(&ri, "^", NULL, 0);
+    while (raxNext(&ri)) {
+        user *u = ri.data;
+        if (u->stat_commands == 0) continue;
+        char *tmpsafe;
+        info = sdscatprintf(info, "user_%s:cmds=%llu,exec_usec=%llu,net_in_bytes=%llu,net_out_bytes=%llu,alloc_bytes=%lld\r\n",
+                            getSafeInfoString(u->name, sdslen(u->name), &tmpsafe), u->stat_commands,
+                            u->stat_exec_usec, u->stat_net_input_bytes, u->stat_net_output_bytes, u->stat_alloc_bytes);
+        if (tmpsafe != NULL) zfree(tmpsafe);
+    }
+    raxStop(&ri);
+    return info;
+}
+
 /* =============================================================================
  * ACL related commands
  * ==========================================================================*/
@@ -46,12 +46,16 @@
 
 #include "zmalloc.h"
 #include "config.h"
+#include "usdt.h"
 
 /* Include the best multiplexing layer supported by this system.
  * The following should be ordered by performances, descending. */
 #ifdef HAVE_EVPORT
 #include "ae_evport.c"
 #else
+#ifdef HAVE_IOURING
+#include "ae_iouring.c"
+#else
 #ifdef HAVE_EPOLL
 #include "ae_epoll.c"
 #else
@@ -62,6 +66,7 @@
 #endif
 #endif
 #endif
+#endif
 
 #define AE_LOCK(eventLoop)                                         \
     if ((eventLoop)->flags & AE_PROTECT_POLL) {                    \
@@ -92,6 +97,7 @@ aeEventLoop *aeCreateEventLoop(int setsize) {
     eventLoop->aftersleep = NULL;
     eventLoop->custompoll = NULL;
     eventLoop->flags = 0;
+    eventLoop->busy_poll_us = 0;
     /* Initialize the eventloop mutex with PTHREAD_MUTEX_ERRORCHECK type */
     pthread_mutexattr_t attr;
     pthread_mutexattr_init(&attr);
@@ -130,6 +136,13 @@ void aeSetDontWait(aeEventLoop *eventLoop, int noWait) {
         eventLoop->flags &= ~AE_DONT_WAIT;
 }
 
+/* Make aeProcessEvents() spin with zero-timeout polls for up to 'usec'
+ * microseconds before issuing a blocking poll, trading a busy CPU for the
+ * multiplexing API's sleep/wake latency. 0 disables the spinning. */
+void aeSetBusyPoll(aeEventLoop *eventLoop, long long usec) {
+    eventLoop->busy_poll_us = usec;
+}
+
 /* Resize the maximum set size of the event loop.
  * If the requested set size is smaller than the current set size, but
  * there is already a file descriptor in use that is >= the requested
@@ -414,6 +427,8 @@ int aeProcessEvents(aeEventLoop *eventLoop, int flags) {
     /* Nothing to do? return ASAP */
     if (!(flags & AE_TIME_EVENTS) && !(flags & AE_FILE_EVENTS)) return 0;
 
+    VALKEY_USDT_EVENTLOOP_START(flags);
+
     /* Note that we want to call aeApiPoll() even if there are no
      * file events to process as long as we want to process time
      * events, in order to sleep until the next time event is ready
@@ -444,9 +459,30 @@ int aeProcessEvents(aeEventLoop *eventLoop, int flags) {
                     tvp = &tv;
                 }
             }
-            /* Call the multiplexing API, will return only on timeout or when
-             * some event fires. */
-            numevents = aeApiPoll(eventLoop, tvp);
+            /* When busy polling is enabled and we are about to block, spin
+             * with a zero timeout first: events that arrive while spinning
+             * skip the whole sleep/wake cycle. Time events can only be
+             * delayed by the (short) spin budget, and the timer deadline is
+             * refreshed before blocking to account for the time spent. */
+            if (eventLoop->busy_poll_us > 0 && (tvp == NULL || tvp->tv_sec || tvp->tv_usec)) {
+                monotime spin_start = getMonotonicUs();
+                struct timeval zero = {0, 0};
+                while ((numevents = aeApiPoll(eventLoop, &zero)) == 0 &&
+                       getMonotonicUs() - spin_start < (monotime)eventLoop->busy_poll_us);
+                if (numevents == 0) {
+                    if (tvp != NULL && (flags & AE_TIME_EVENTS)) {
+                        usUntilTimer = usUntilEarliestTimer(eventLoop);
+                        if (usUntilTimer < 0) usUntilTimer = 0;
+                        tv.tv_sec = usUntilTimer / 1000000;
+                        tv.tv_usec = usUntilTimer % 1000000;
+                    }
+                    numevents = aeApiPoll(eventLoop, tvp);
+                }
+            } else {
+                /* Call the multiplexing API, will return only on timeout or when
+                 * some event fires. */
+                numevents = aeApiPoll(eventLoop, tvp);
+            }
         }
 
         /* Don't process file events if not requested. */
@@ -512,6 +548,7 @@ int aeProcessEvents(aeEventLoop *eventLoop, int flags) {
     /* Check time events */
     if (flags & AE_TIME_EVENTS) processed += processTimeEvents(eventLoop);
 
+    VALKEY_USDT_EVENTLOOP_END(processed);
     return processed; /* return the number of processed file/time events */
 }
 
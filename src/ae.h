@@ -115,6 +115,7 @@ typedef struct aeEventLoop {
     aeCustomPollProc *custompoll;
     pthread_mutex_t poll_mutex;
     int flags;
+    long long busy_poll_us; /* Spin this long before a blocking poll (0 = off) */
 } aeEventLoop;
 
 /* Prototypes */
@@ -143,5 +144,6 @@ int aePoll(aeEventLoop *eventLoop, struct timeval *tvp);
 int aeGetSetSize(aeEventLoop *eventLoop);
 int aeResizeSetSize(aeEventLoop *eventLoop, int setsize);
 void aeSetDontWait(aeEventLoop *eventLoop, int noWait);
+void aeSetBusyPoll(aeEventLoop *eventLoop, long long usec);
 
 #endif
@@ -0,0 +1,285 @@
+/* Linux io_uring based ae.c module
+ *
+ * Copyright Valkey Contributors.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD 3-Clause
+ *
+ * Readiness is obtained with multishot IORING_OP_POLL_ADD requests, one per
+ * monitored fd. Registrations, modifications and removals only append SQEs
+ * to the submission ring; everything pending is flushed by the single
+ * io_uring_enter(2) performed in aeApiPoll(), so an event loop iteration
+ * that rearms hundreds of sockets still costs one syscall. */
+
+#include <linux/io_uring.h>
+#include <linux/time_types.h>
+#include <sys/mman.h>
+#include <sys/syscall.h>
+#include <stdatomic.h>
+
+/* Older kernel headers may miss the multishot/EXT_ARG additions
+ * (Linux 5.13 and 5.11 respectively). Define what we rely on so the
+ * backend still compiles; the runtime feature checks in aeApiCreate()
+ * make us fail gracefully on kernels that lack the support. */
+#ifndef IORING_POLL_ADD_MULTI
+#define IORING_POLL_ADD_MULTI (1U << 0)
+#endif
+#ifndef IORING_CQE_F_MORE
+#define IORING_CQE_F_MORE (1U << 1)
+#endif
+#ifndef IORING_ENTER_EXT_ARG
+#define IORING_ENTER_EXT_ARG (1U << 3)
+#endif
+#ifndef IORING_FEAT_EXT_ARG
+#define IORING_FEAT_EXT_ARG (1U << 8)
+#endif
+
+/* user_data tag for IORING_OP_POLL_REMOVE completions, which must be
+ * ignored while draining readiness CQEs. Valid tags are fd numbers. */
+#define AE_IOURING_REMOVE_TAG (~0ULL)
+
+typedef struct aeApiState {
+    int ringfd;
+    unsigned sqe_entries;
+    unsigned cqe_entries;
+    /* Submission queue rings (mapped). */
+    unsigned *sq_head;
+    unsigned *sq_tail;
+    unsigned *sq_mask;
+    unsigned *sq_array;
+    struct io_uring_sqe *sqes;
+    void *sq_ring;
+    size_t sq_ring_sz;
+    /* Completion queue rings (mapped). */
+    unsigned *cq_head;
+    unsigned *cq_tail;
+    unsigned *cq_mask;
+    struct io_uring_cqe *cqes;
+    /* Number of SQEs appended and not yet submitted to the kernel. */
+    unsigned pending;
+} aeApiState;
+
+static int aeIOUringSetup(unsigned entries, struct io_uring_params *p) {
+    return syscall(__NR_io_uring_setup, entries, p);
+}
+
+static int aeIOUringEnter(int fd, unsigned to_submit, unsigned min_complete, unsigned flags, const void *arg, size_t argsz) {
+    return syscall(__NR_io_uring_enter, fd, to_submit, min_complete, flags, arg, argsz);
+}
+
+/* Grab the next free SQE, flushing the ring to the kernel first if it is
+ * full. Returns NULL only if the flush itself fails. */
+static struct io_uring_sqe *aeApiGetSqe(aeApiState *state) {
+    unsigned head = atomic_load_explicit((_Atomic unsigned *)state->sq_head, memory_order_acquire);
+    unsigned tail = *state->sq_tail;
+
+    if (tail - head == state->sqe_entries) {
+        /* Ring full: push what we have without waiting for completions. */
+        if (aeIOUringEnter(state->ringfd, state->pending, 0, 0, NULL, 0) == -1) return NULL;
+        state->pending = 0;
+        head = atomic_load_explicit((_Atomic unsigned *)state->sq_head, memory_order_acquire);
+        if (tail - head == state->sqe_entries) return NULL;
+    }
+
+    struct io_uring_sqe *sqe = &state->sqes[tail & *state->sq_mask];
+    memset(sqe, 0, sizeof(*sqe));
+    state->sq_array[tail & *state->sq_mask] = tail & *state->sq_mask;
+    atomic_store_explicit((_Atomic unsigned *)state->sq_tail, tail + 1, memory_order_release);
+    state->pending++;
+    return sqe;
+}
+
+static unsigned aeApiPollMask(int mask) {
+    unsigned pollmask = 0;
+    if (mask & AE_READABLE) pollmask |= POLLIN;
+    if (mask & AE_WRITABLE) pollmask |= POLLOUT;
+    return pollmask;
+}
+
+/* Queue a multishot poll request for 'fd'. The fd doubles as user_data so
+ * completions map back to the event table without any lookup structure. */
+static int aeApiQueuePollAdd(aeApiState *state, int fd, int mask) {
+    struct io_uring_sqe *sqe = aeApiGetSqe(state);
+    if (!sqe) return -1;
+    sqe->opcode = IORING_OP_POLL_ADD;
+    sqe->fd = fd;
+    sqe->poll32_events = aeApiPollMask(mask);
+    sqe->len = IORING_POLL_ADD_MULTI;
+    sqe->user_data = (uint64_t)fd;
+    return 0;
+}
+
+static int aeApiQueuePollRemove(aeApiState *state, int fd) {
+    struct io_uring_sqe *sqe = aeApiGetSqe(state);
+    if (!sqe) return -1;
+    sqe->opcode = IORING_OP_POLL_REMOVE;
+    sqe->fd = -1;
+    sqe->addr = (uint64_t)fd; /* user_data of the poll to cancel */
+    sqe->user_data = AE_IOURING_REMOVE_TAG;
+    return 0;
+}
+
+static int aeApiCreate(aeEventLoop *eventLoop) {
+    aeApiState *state = zmalloc(sizeof(aeApiState));
+    struct io_uring_params params;
+
+    if (!state) return -1;
+    memset(state, 0, sizeof(*state));
+    memset(&params, 0, sizeof(params));
+
+    /* One in-flight poll per fd is enough; cap the SQ so huge setsize
+     * values don't pin megabytes of ring memory. */
+    unsigned entries = 8;
+    while (entries < (unsigned)eventLoop->setsize && entries < 4096) entries <<= 1;
+
+    state->ringfd = aeIOUringSetup(entries, &params);
+    if (state->ringfd == -1) {
+        zfree(state);
+        return -1;
+    }
+    /* Single mmap (5.4+) and EXT_ARG timed waits (5.11+) keep the code
+     * simple; multishot poll needs 5.13+ anyway. */
+    if (!(params.features & IORING_FEAT_SINGLE_MMAP) || !(params.features & IORING_FEAT_EXT_ARG)) {
+        close(state->ringfd);
+        zfree(state);
+        return -1;
+    }
+    anetCloexec(state->ringfd);
+
+    state->sqe_entries = params.sq_entries;
+    state->cqe_entries = params.cq_entries;
+    size_t sq_sz = params.sq_off.array + params.sq_entries * sizeof(unsigned);
+    size_t cq_sz = params.cq_off.cqes + params.cq_entries * sizeof(struct io_uring_cqe);
+    state->sq_ring_sz = sq_sz > cq_sz ? sq_sz : cq_sz;
+
+    state->sq_ring = mmap(0, state->sq_ring_sz, PROT_READ | PROT_WRITE, MAP_SHARED | MAP_POPULATE, state->ringfd,
+                          IORING_OFF_SQ_RING);
+    if (state->sq_ring == MAP_FAILED) {
+        close(state->ringfd);
+        zfree(state);
+        return -1;
+    }
+    state->sqes = mmap(0, params.sq_entries * sizeof(struct io_uring_sqe), PROT_READ | PROT_WRITE,
+                       MAP_SHARED | MAP_POPULATE, state->ringfd, IORING_OFF_SQES);
+    if (state->sqes == MAP_FAILED) {
+        munmap(state->sq_ring, state->sq_ring_sz);
+        close(state->ringfd);
+        zfree(state);
+        return -1;
+    }
+
+    char *sq = state->sq_ring;
+    state->sq_head = (unsigned *)(sq + params.sq_off.head);
+    state->sq_tail = (unsigned *)(sq + params.sq_off.tail);
+    state->sq_mask = (unsigned *)(sq + params.sq_off.ring_mask);
+    state->sq_array = (unsigned *)(sq + params.sq_off.array);
+    state->cq_head = (unsigned *)(sq + params.cq_off.head);
+    state->cq_tail = (unsigned *)(sq + params.cq_off.tail);
+    state->cq_mask = (unsigned *)(sq + params.cq_off.ring_mask);
+    state->cqes = (struct io_uring_cqe *)(sq + params.cq_off.cqes);
+
+    eventLoop->apidata = state;
+    return 0;
+}
+
+static int aeApiResize(aeEventLoop *eventLoop, int setsize) {
+    /* Poll requests are keyed by fd, not by slot, so nothing to do. */
+    AE_NOTUSED(eventLoop);
+    AE_NOTUSED(setsize);
+    return 0;
+}
+
+static void aeApiFree(aeEventLoop *eventLoop) {
+    aeApiState *state = eventLoop->apidata;
+
+    munmap(state->sqes, state->sqe_entries * sizeof(struct io_uring_sqe));
+    munmap(state->sq_ring, state->sq_ring_sz);
+    close(state->ringfd);
+    zfree(state);
+}
+
+static int aeApiAddEvent(aeEventLoop *eventLoop, int fd, int mask) {
+    aeApiState *state = eventLoop->apidata;
+    int merged = eventLoop->events[fd].mask | mask;
+
+    /* The kernel has no poll "modify": drop the armed request (no-op if
+     * none is in flight) and rearm with the merged mask. Both SQEs ride
+     * the next io_uring_enter(). */
+    if (eventLoop->events[fd].mask != AE_NONE && aeApiQueuePollRemove(state, fd) == -1) return -1;
+    return aeApiQueuePollAdd(state, fd, merged);
+}
+
+static void aeApiDelEvent(aeEventLoop *eventLoop, int fd, int mask) {
+    aeApiState *state = eventLoop->apidata;
+    AE_NOTUSED(mask);
+
+    /* We rely on the fact that our caller has already updated the mask in the eventLoop. */
+    if (aeApiQueuePollRemove(state, fd) == -1) return;
+    if (eventLoop->events[fd].mask != AE_NONE) aeApiQueuePollAdd(state, fd, eventLoop->events[fd].mask);
+}
+
+static int aeApiPoll(aeEventLoop *eventLoop, struct timeval *tvp) {
+    aeApiState *state = eventLoop->apidata;
+    int numevents = 0;
+    struct io_uring_getevents_arg arg;
+    struct __kernel_timespec ts;
+    unsigned enter_flags = IORING_ENTER_GETEVENTS;
+    const void *argp = NULL;
+    size_t argsz = 0;
+    int retval;
+
+    if (tvp) {
+        ts.tv_sec = tvp->tv_sec;
+        ts.tv_nsec = tvp->tv_usec * 1000;
+        memset(&arg, 0, sizeof(arg));
+        arg.ts = (uint64_t)(uintptr_t)&ts;
+        argp = &arg;
+        argsz = sizeof(arg);
+        enter_flags |= IORING_ENTER_EXT_ARG;
+    }
+
+    /* Flush every queued registration and wait for readiness in a single
+     * syscall. */
+    retval = aeIOUringEnter(state->ringfd, state->pending, 1, enter_flags, argp, argsz);
+    if (retval == -1 && errno != EINTR && errno != ETIME) panic("aeApiPoll: io_uring_enter, %s", strerror(errno));
+    if (retval >= 0) state->pending = 0;
+
+    unsigned head = *state->cq_head;
+    unsigned tail = atomic_load_explicit((_Atomic unsigned *)state->cq_tail, memory_order_acquire);
+    while (head != tail && numevents < eventLoop->setsize) {
+        struct io_uring_cqe *cqe = &state->cqes[head & *state->cq_mask];
+        head++;
+        if (cqe->user_data == AE_IOURING_REMOVE_TAG) continue;
+
+        int fd = (int)cqe->user_data;
+        int mask = 0;
+        if (cqe->res < 0) {
+            /* Poll failure (e.g. fd closed under us): report it like
+             * EPOLLERR so the handlers get a chance to clean up. */
+            mask = AE_READABLE | AE_WRITABLE;
+        } else {
+            if (cqe->res & POLLIN) mask |= AE_READABLE;
+            if (cqe->res & POLLOUT) mask |= AE_WRITABLE;
+            if (cqe->res & (POLLERR | POLLHUP)) mask |= AE_READABLE | AE_WRITABLE;
+        }
+        /* The request may have completed after the fd was removed from
+         * the event table; aeProcessEvents() filters on the registered
+         * mask, so just report what we got. */
+        eventLoop->fired[numevents].fd = fd;
+        eventLoop->fired[numevents].mask = mask;
+        numevents++;
+
+        /* Multishot polls stay armed while IORING_CQE_F_MORE is set;
+         * otherwise the request is consumed and must be rearmed. */
+        if (!(cqe->flags & IORING_CQE_F_MORE) && cqe->res >= 0 && fd < eventLoop->setsize &&
+            eventLoop->events[fd].mask != AE_NONE) {
+            aeApiQueuePollAdd(state, fd, eventLoop->events[fd].mask);
+        }
+    }
+    atomic_store_explicit((_Atomic unsigned *)state->cq_head, head, memory_order_release);
+
+    return numevents;
+}
+
+static char *aeApiName(void) {
+    return "io_uring";
+}
@@ -336,6 +336,34 @@ unsigned long allocatorDefragGetFragSmallbins(void) {
     return frag;
 }
 
+/* Export a snapshot of the per-bin statistics for observability (MEMORY
+ * ALLOCATOR-STATS). The same counters drive the defrag decisions, so this is
+ * just a copy-out after an epoch refresh and does not add new mallctl queries
+ * beyond what allocatorDefragGetFragSmallbins already performs.
+ *
+ * On success '*stats' points to a zmalloc'ed array owned by the caller and the
+ * number of bins is returned. Returns 0 (with '*stats' set to NULL) when the
+ * allocator does not expose bin statistics. */
+unsigned allocatorGetBinStats(allocatorBinStats **stats) {
+    *stats = NULL;
+    if (!defrag_supported || je_cb.nbins == 0) return 0;
+    /* Refreshes the epoch and updates je_usage_info for all bins. */
+    allocatorDefragGetFragSmallbins();
+    allocatorBinStats *snapshot = zmalloc(sizeof(allocatorBinStats) * je_cb.nbins);
+    for (unsigned j = 0; j < je_cb.nbins; j++) {
+        jeBinInfo *bin_info = &je_cb.bin_info[j];
+        jemallocBinUsageData *bin_usage = &je_usage_info[j];
+        snapshot[j].reg_size = bin_info->reg_size;
+        snapshot[j].nregs = bin_info->nregs;
+        snapshot[j].curr_slabs = bin_usage->curr_slabs;
+        snapshot[j].curr_nonfull_slabs = bin_usage->curr_nonfull_slabs;
+        snapshot[j].curr_regs = bin_usage->curr_regs;
+        snapshot[j].frag_bytes = ((bin_info->nregs * bin_usage->curr_slabs) - bin_usage->curr_regs) * bin_info->reg_size;
+    }
+    *stats = snapshot;
+    return je_cb.nbins;
+}
+
 /* Determines whether defragmentation should be performed on a pointer based on jemalloc information.
  *
  * bin_info Pointer to the bin information structure.
@@ -439,6 +467,11 @@ unsigned long allocatorDefragGetFragSmallbins(void) {
     return 0;
 }
 
+unsigned allocatorGetBinStats(allocatorBinStats **stats) {
+    *stats = NULL;
+    return 0;
+}
+
 int allocatorShouldDefrag(void *ptr) {
     UNUSED(ptr);
     return 1;
@@ -465,6 +498,11 @@ unsigned long allocatorDefragGetFragSmallbins(void) {
     return 0;
 }
 
+unsigned allocatorGetBinStats(allocatorBinStats **stats) {
+    *stats = NULL;
+    return 0;
+}
+
 int allocatorShouldDefrag(void *ptr) {
     UNUSED(ptr);
     return 0;
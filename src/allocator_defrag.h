@@ -1,6 +1,9 @@
 #ifndef __ALLOCATOR_DEFRAG_H
 #define __ALLOCATOR_DEFRAG_H
 
+#include <stddef.h>
+#include <stdint.h>
+
 #if defined(USE_JEMALLOC)
 #include <jemalloc/jemalloc.h>
 /* We can enable the server defrag capabilities only if we are using Jemalloc
@@ -14,10 +17,22 @@
 #endif
 #endif
 
+/* Per size-class snapshot exported for MEMORY ALLOCATOR-STATS. The fields
+ * mirror the jemalloc bin statistics already sampled for defrag decisions. */
+typedef struct allocatorBinStats {
+    size_t reg_size;           /* Size of each region in the bin. */
+    uint32_t nregs;            /* Number of regions per slab. */
+    size_t curr_slabs;         /* Current number of slabs in the bin. */
+    size_t curr_nonfull_slabs; /* Current number of non-full slabs in the bin. */
+    size_t curr_regs;          /* Current number of allocated regions in the bin. */
+    size_t frag_bytes;         /* Bytes wasted in unused regions of existing slabs. */
+} allocatorBinStats;
+
 int allocatorDefragInit(void);
 void allocatorDefragFree(void *ptr, size_t size);
 __attribute__((malloc)) void *allocatorDefragAlloc(size_t size);
 unsigned long allocatorDefragGetFragSmallbins(void);
+unsigned allocatorGetBinStats(allocatorBinStats **stats);
 int allocatorShouldDefrag(void *ptr);
 float getAllocatorFragmentation(size_t *out_frag_bytes);
 
@@ -149,6 +149,24 @@ int anetCloexec(int fd) {
     return r;
 }
 
+/* Enable kernel busy polling on the socket (SO_BUSY_POLL): the network stack
+ * busy waits up to 'usec' microseconds for new packets before sleeping in a
+ * blocking receive or poll. No-op on platforms without SO_BUSY_POLL. */
+int anetEnableBusyPoll(char *err, int fd, int usec) {
+#ifdef SO_BUSY_POLL
+    if (setsockopt(fd, SOL_SOCKET, SO_BUSY_POLL, &usec, sizeof(usec)) == -1) {
+        anetSetError(err, "setsockopt SO_BUSY_POLL: %s", strerror(errno));
+        return ANET_ERR;
+    }
+    return ANET_OK;
+#else
+    UNUSED(err);
+    UNUSED(fd);
+    UNUSED(usec);
+    return ANET_OK;
+#endif
+}
+
 /* Enable TCP keep-alive mechanism to detect dead peers,
  * TCP_KEEPIDLE, TCP_KEEPINTVL and TCP_KEEPCNT will be set accordingly. */
 int anetKeepAlive(char *err, int fd, int interval) {
@@ -698,6 +716,34 @@ int anetUnixAccept(char *err, int s) {
     return fd;
 }
 
+/* Get the effective UID of the peer process connected on a Unix socket. */
+int anetUnixGetPeerUid(char *err, int fd, uid_t *uid) {
+#if defined(__linux__)
+    struct ucred cred;
+    socklen_t len = sizeof(cred);
+
+    if (getsockopt(fd, SOL_SOCKET, SO_PEERCRED, &cred, &len) == -1) {
+        anetSetError(err, "getsockopt(SO_PEERCRED): %s", strerror(errno));
+        return ANET_ERR;
+    }
+    *uid = cred.uid;
+    return ANET_OK;
+#elif defined(__FreeBSD__) || defined(__OpenBSD__) || defined(__NetBSD__) || defined(__APPLE__)
+    gid_t gid;
+
+    if (getpeereid(fd, uid, &gid) == -1) {
+        anetSetError(err, "getpeereid: %s", strerror(errno));
+        return ANET_ERR;
+    }
+    return ANET_OK;
+#else
+    UNUSED(fd);
+    UNUSED(uid);
+    anetSetError(err, "peer credentials not supported on this platform");
+    return ANET_ERR;
+#endif
+}
+
 int anetFdToString(int fd, char *ip, size_t ip_len, int *port, int remote) {
     struct sockaddr_storage sa;
     socklen_t salen = sizeof(sa);
@@ -59,6 +59,7 @@ int anetTcp6Server(char *err, int port, char *bindaddr, int backlog);
 int anetUnixServer(char *err, char *path, mode_t perm, int backlog, char *group);
 int anetTcpAccept(char *err, int serversock, char *ip, size_t ip_len, int *port);
 int anetUnixAccept(char *err, int serversock);
+int anetUnixGetPeerUid(char *err, int fd, uid_t *uid);
 int anetNonBlock(char *err, int fd);
 int anetBlock(char *err, int fd);
 int anetIsBlock(char *err, int fd);
@@ -69,6 +70,7 @@ int anetSendTimeout(char *err, int fd, long long ms);
 int anetRecvTimeout(char *err, int fd, long long ms);
 int anetFdToString(int fd, char *ip, size_t ip_len, int *port, int remote);
 int anetKeepAlive(char *err, int fd, int interval);
+int anetEnableBusyPoll(char *err, int fd, int usec);
 int anetFormatAddr(char *fmt, size_t fmt_len, char *ip, int port);
 int anetPipe(int fds[2], int read_flags, int write_flags);
 int anetSetSockMarkId(char *err, int fd, uint32_t id);
@@ -0,0 +1,294 @@
+/* Microbenchmarks for the core data structures, built as valkey-bench-structs
+ * and run via `make bench`.
+ *
+ * Every benchmark is run in two variants: cache-hot, with a working set sized
+ * to stay in L1/L2, and cache-cold, with a working set well beyond the last
+ * level cache probed in random order. Results are reported as nanoseconds and
+ * cycles per operation. Absolute numbers depend on the machine; the intended
+ * use is comparing a change against a baseline build on the same host.
+ *
+ * Copyright Valkey Contributors.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD 3-Clause
+ */
+
+#include <stdio.h>
+#include <stdint.h>
+#include <inttypes.h>
+#include <stdlib.h>
+#include <string.h>
+#include <time.h>
+
+#include "../server.h"
+#include "../hashtable.h"
+#include "../listpack.h"
+#include "../rax.h"
+#include "../intset.h"
+#include "../mt19937-64.h"
+
+#define HOT_KEYS 1024
+#define COLD_KEYS (1 << 20)
+#define PROBES (1 << 20)
+
+/* Sink for results so the compiler cannot elide the measured work. */
+static volatile uint64_t sink;
+
+static inline uint64_t benchCycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int lo, hi;
+    __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t)hi << 32) | lo;
+#elif defined(__aarch64__)
+    uint64_t val;
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(val));
+    return val;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+static inline uint64_t benchNanos(void) {
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+}
+
+static void benchReport(const char *op, int hot, uint64_t ops, uint64_t ns, uint64_t cy) {
+    printf("%-24s %-4s %10" PRIu64 " ops %10.1f ns/op %10.1f cycles/op\n", op, hot ? "hot" : "cold", ops,
+           (double)ns / ops, (double)cy / ops);
+}
+
+/* Pre-generated "key:<number>" strings and a random probe order, shared by the
+ * keyed benchmarks so that key generation stays out of the timed sections. */
+static sds *genKeys(size_t count) {
+    sds *keys = zmalloc(count * sizeof(sds));
+    for (size_t i = 0; i < count; i++) keys[i] = sdscatprintf(sdsempty(), "key:%012zu", i);
+    return keys;
+}
+
+static void freeKeys(sds *keys, size_t count) {
+    for (size_t i = 0; i < count; i++) sdsfree(keys[i]);
+    zfree(keys);
+}
+
+static uint32_t *genProbeOrder(size_t probes, size_t keyspace) {
+    uint32_t *order = zmalloc(probes * sizeof(uint32_t));
+    for (size_t i = 0; i < probes; i++) order[i] = genrand64_int64() % keyspace;
+    return order;
+}
+
+/* --------------------------------- hashtable ------------------------------ */
+
+static const void *benchHtGetKey(const void *entry) {
+    return entry;
+}
+
+static uint64_t benchHtHash(const void *key) {
+    return hashtableGenHashFunction(key, sdslen((sds)key));
+}
+
+static int benchHtCompare(const void *key1, const void *key2) {
+    return sdscmp((sds)key1, (sds)key2);
+}
+
+static hashtableType bench_ht_type = {
+    .entryGetKey = benchHtGetKey,
+    .hashFunction = benchHtHash,
+    .keyCompare = benchHtCompare,
+};
+
+static void benchHashtable(int hot) {
+    size_t nkeys = hot ? HOT_KEYS : COLD_KEYS;
+    sds *keys = genKeys(nkeys);
+    uint32_t *order = genProbeOrder(PROBES, nkeys);
+    hashtable *ht = hashtableCreate(&bench_ht_type);
+
+    uint64_t ns = benchNanos(), cy = benchCycles();
+    for (size_t i = 0; i < nkeys; i++) hashtableAdd(ht, keys[i]);
+    benchReport("hashtableAdd", hot, nkeys, benchNanos() - ns, benchCycles() - cy);
+
+    ns = benchNanos(), cy = benchCycles();
+    for (size_t i = 0; i < PROBES; i++) {
+        void *found;
+        if (hashtableFind(ht, keys[order[i]], &found)) sink += (uintptr_t)found;
+    }
+    benchReport("hashtableFind", hot, PROBES, benchNanos() - ns, benchCycles() - cy);
+
+    hashtableRelease(ht);
+    freeKeys(keys, nkeys);
+    zfree(order);
+}
+
+/* --------------------------------- listpack ------------------------------- */
+
+#define LP_ENTRIES 128
+
+static void benchListpack(int hot) {
+    /* One listpack of LP_ENTRIES small strings is about a kilobyte; the cold
+     * variant keeps thousands of them alive and walks them in random order. */
+    size_t nlps = hot ? 8 : 65536;
+    size_t appends = hot ? PROBES : nlps * LP_ENTRIES;
+    unsigned char **lps = zmalloc(nlps * sizeof(unsigned char *));
+    unsigned char ele[16];
+    memset(ele, 'x', sizeof(ele));
+    for (size_t i = 0; i < nlps; i++) lps[i] = lpNew(0);
+
+    uint64_t ns = benchNanos(), cy = benchCycles();
+    for (size_t i = 0; i < appends; i++) {
+        size_t j = i / LP_ENTRIES % nlps;
+        lps[j] = lpAppend(lps[j], ele, sizeof(ele));
+        if (hot && i % (LP_ENTRIES * nlps) == LP_ENTRIES * nlps - 1) {
+            for (size_t k = 0; k < nlps; k++) {
+                lpFree(lps[k]);
+                lps[k] = lpNew(0);
+            }
+        }
+    }
+    benchReport("lpAppend", hot, appends, benchNanos() - ns, benchCycles() - cy);
+
+    /* Refill for the iteration pass (hot listpacks were just reset). */
+    for (size_t i = 0; i < nlps; i++) {
+        while (lpLength(lps[i]) < LP_ENTRIES) lps[i] = lpAppend(lps[i], ele, sizeof(ele));
+    }
+    uint32_t *order = genProbeOrder(hot ? PROBES / LP_ENTRIES : nlps, nlps);
+    size_t iters = hot ? PROBES / LP_ENTRIES : nlps;
+    uint64_t steps = 0;
+    ns = benchNanos(), cy = benchCycles();
+    for (size_t i = 0; i < iters; i++) {
+        unsigned char *lp = lps[order[i]];
+        for (unsigned char *p = lpFirst(lp); p != NULL; p = lpNext(lp, p)) steps++;
+    }
+    benchReport("lpNext", hot, steps, benchNanos() - ns, benchCycles() - cy);
+    sink += steps;
+
+    for (size_t i = 0; i < nlps; i++) lpFree(lps[i]);
+    zfree(lps);
+    zfree(order);
+}
+
+/* --------------------------------- skiplist ------------------------------- */
+
+static void benchZslInsert(int hot) {
+    /* The hot variant repeatedly fills small skiplists; the cold one builds a
+     * single large one, paying the deeper level walks and the misses. */
+    size_t nkeys = hot ? HOT_KEYS : COLD_KEYS;
+    size_t rounds = hot ? COLD_KEYS / HOT_KEYS : 1;
+    sds *keys = genKeys(nkeys);
+    uint64_t ns = 0, cy = 0;
+
+    for (size_t r = 0; r < rounds; r++) {
+        zskiplist *zsl = zslCreate();
+        uint64_t ns0 = benchNanos(), cy0 = benchCycles();
+        for (size_t i = 0; i < nkeys; i++) {
+            zslInsert(zsl, (double)(genrand64_int64() % COLD_KEYS), sdsdup(keys[i]));
+        }
+        ns += benchNanos() - ns0;
+        cy += benchCycles() - cy0;
+        zslFree(zsl);
+    }
+    benchReport("zslInsert", hot, rounds * nkeys, ns, cy);
+    freeKeys(keys, nkeys);
+}
+
+/* ----------------------------------- sds ---------------------------------- */
+
+static void benchSdscatlen(int hot) {
+    /* Appends 16 bytes at a time. The hot variant grows one string to 4k and
+     * resets it; the cold one round-robins over many strings so that both the
+     * headers and the heap working set fall out of cache. */
+    size_t nstrings = hot ? 1 : 65536;
+    sds *strings = zmalloc(nstrings * sizeof(sds));
+    for (size_t i = 0; i < nstrings; i++) strings[i] = sdsempty();
+    uint32_t *order = genProbeOrder(PROBES, nstrings);
+    char buf[16] = "0123456789abcdef";
+
+    uint64_t ns = benchNanos(), cy = benchCycles();
+    for (size_t i = 0; i < PROBES; i++) {
+        size_t j = order[i];
+        strings[j] = sdscatlen(strings[j], buf, sizeof(buf));
+        if (sdslen(strings[j]) >= 4096) sdssetlen(strings[j], 0);
+    }
+    benchReport("sdscatlen", hot, PROBES, benchNanos() - ns, benchCycles() - cy);
+
+    for (size_t i = 0; i < nstrings; i++) sdsfree(strings[i]);
+    zfree(strings);
+    zfree(order);
+}
+
+/* ----------------------------------- rax ----------------------------------- */
+
+static void benchRaxSeek(int hot) {
+    size_t nkeys = hot ? HOT_KEYS : COLD_KEYS;
+    sds *keys = genKeys(nkeys);
+    uint32_t *order = genProbeOrder(PROBES, nkeys);
+    rax *rt = raxNew();
+    for (size_t i = 0; i < nkeys; i++) raxInsert(rt, (unsigned char *)keys[i], sdslen(keys[i]), NULL, NULL);
+
+    raxIterator it;
+    raxStart(&it, rt);
+    uint64_t ns = benchNanos(), cy = benchCycles();
+    for (size_t i = 0; i < PROBES; i++) {
+        sds key = keys[order[i]];
+        sink += raxSeek(&it, "==", (unsigned char *)key, sdslen(key));
+    }
+    benchReport("raxSeek", hot, PROBES, benchNanos() - ns, benchCycles() - cy);
+    raxStop(&it);
+
+    raxFree(rt);
+    freeKeys(keys, nkeys);
+    zfree(order);
+}
+
+/* ---------------------------------- intset --------------------------------- */
+
+static void benchIntsetFind(int hot) {
+    /* Inserts shift the tail of the array, so the cold variant stays at a
+     * moderate cardinality; the lookup binary search is the interesting part
+     * and 64k entries already exceed L1/L2. */
+    size_t nvalues = hot ? 512 : 65536;
+    intset *is = intsetNew();
+    int64_t *values = zmalloc(nvalues * sizeof(int64_t));
+    uint32_t *order = genProbeOrder(PROBES, nvalues);
+    for (size_t i = 0; i < nvalues; i++) {
+        uint8_t success;
+        values[i] = genrand64_int64();
+        is = intsetAdd(is, values[i], &success);
+    }
+
+    uint64_t ns = benchNanos(), cy = benchCycles();
+    for (size_t i = 0; i < PROBES; i++) sink += intsetFind(is, values[order[i]]);
+    benchReport("intsetFind", hot, PROBES, benchNanos() - ns, benchCycles() - cy);
+
+    zfree(is);
+    zfree(values);
+    zfree(order);
+}
+
+/* ---------------------------------- driver --------------------------------- */
+
+static struct {
+    const char *name;
+    void (*fn)(int hot);
+} benchmarks[] = {
+    {"hashtable", benchHashtable}, {"listpack", benchListpack},   {"zsl", benchZslInsert},
+    {"sds", benchSdscatlen},       {"rax", benchRaxSeek},         {"intset", benchIntsetFind},
+};
+
+int main(int argc, char **argv) {
+    /* Seed like the unit tests do, so hash tables behave as in the server. */
+    unsigned long long seed;
+    getRandomBytes((void *)&seed, sizeof(seed));
+    init_genrand64(seed);
+    uint8_t hashseed[16];
+    getRandomBytes(hashseed, sizeof(hashseed));
+    hashtableSetHashFunctionSeed(hashseed);
+
+    for (size_t i = 0; i < sizeof(benchmarks) / sizeof(benchmarks[0]); i++) {
+        if (argc > 1 && strcasecmp(argv[1], benchmarks[i].name)) continue;
+        benchmarks[i].fn(1);
+        benchmarks[i].fn(0);
+    }
+    return 0;
+}
@@ -101,6 +101,9 @@ typedef union bio_job {
                                           * the file is closed. */
         unsigned need_reclaim_cache : 1; /* A flag to indicate that reclaim cache is required before
                                           * the file is closed. */
+        unsigned notify_fsync_waiters : 1; /* A flag to indicate that clients are blocked waiting
+                                            * for this fsync, so the event loop should be woken
+                                            * up when it completes. */
     } fd_args;
 
     struct {
@@ -194,11 +197,12 @@ void bioCreateCloseAofJob(int fd, long long offset, int need_reclaim_cache) {
     bioSubmitJob(BIO_CLOSE_AOF, job);
 }
 
-void bioCreateFsyncJob(int fd, long long offset, int need_reclaim_cache) {
+void bioCreateFsyncJob(int fd, long long offset, int need_reclaim_cache, int notify_waiters) {
     bio_job *job = zmalloc(sizeof(*job));
     job->fd_args.fd = fd;
     job->fd_args.offset = offset;
     job->fd_args.need_reclaim_cache = need_reclaim_cache;
+    job->fd_args.notify_fsync_waiters = notify_waiters;
 
     bioSubmitJob(BIO_AOF_FSYNC, job);
 }
@@ -242,6 +246,7 @@ void *bioProcessBackgroundJobs(void *arg) {
 
         /* Process the job accordingly to its type. */
         int job_type = job->header.type;
+        VALKEY_USDT_BIO_JOB_START(worker, job_type);
 
         if (job_type == BIO_CLOSE_FILE) {
             if (job->fd_args.need_fsync && valkey_fsync(job->fd_args.fd) == -1 && errno != EBADF && errno != EINVAL) {
@@ -268,6 +273,17 @@ void *bioProcessBackgroundJobs(void *arg) {
             } else {
                 atomic_store_explicit(&server.aof_bio_fsync_status, C_OK, memory_order_relaxed);
                 atomic_store_explicit(&server.fsynced_reploff_pending, job->fd_args.offset, memory_order_relaxed);
+
+                /* Clients blocked in WAITAOF are waiting for this offset to
+                 * become durable: wake the event loop instead of letting them
+                 * sit out the remainder of the cron period. The module pipe
+                 * is a generic best-effort wakeup, its read handler just
+                 * drains the bytes. */
+                if (job->fd_args.notify_fsync_waiters) {
+                    if (write(server.module_pipe[1], "A", 1) != 1) {
+                        /* Ignore the error, this is best-effort. */
+                    }
+                }
             }
 
             if (job->fd_args.need_reclaim_cache) {
@@ -282,6 +298,7 @@ void *bioProcessBackgroundJobs(void *arg) {
             serverPanic("Wrong job type in bioProcessBackgroundJobs().");
         }
         zfree(job);
+        VALKEY_USDT_BIO_JOB_END(worker, job_type);
 
         /* Lock again before reiterating the loop, if there are no longer
          * jobs to process we'll block again in pthread_cond_wait(). */
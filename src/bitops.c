@@ -30,10 +30,51 @@
 
 #include "server.h"
 
+#ifdef HAVE_AVX2
+/* Define __MM_MALLOC_H to prevent importing the memory aligned
+ * allocation functions, which we don't use. */
+#define __MM_MALLOC_H
+#include <immintrin.h>
+#define BITOPS_USE_AVX2 (__builtin_cpu_supports("avx2"))
+#else
+#define BITOPS_USE_AVX2 0
+#endif
+
 /* -----------------------------------------------------------------------------
  * Helpers and low level bit functions.
  * -------------------------------------------------------------------------- */
 
+#ifdef HAVE_AVX2
+/* Count the set bits in 'blocks' full 32 byte blocks starting at 'p',
+ * using the vectorized nibble lookup algorithm by Wojciech Mula. Each
+ * byte is split in two nibbles whose popcounts come from an in-register
+ * table, and the per-byte counts are horizontally summed into 64 bit
+ * lanes, so no intermediate counter can overflow. */
+ATTRIBUTE_TARGET_AVX2
+static long long serverPopcountAVX2(const unsigned char *p, long blocks) {
+    const __m256i lookup = _mm256_setr_epi8( //
+        0, 1, 1, 2, 1, 2, 2, 3,              //
+        1, 2, 2, 3, 2, 3, 3, 4,              //
+        0, 1, 1, 2, 1, 2, 2, 3,              //
+        1, 2, 2, 3, 2, 3, 3, 4               //
+    );
+    const __m256i low_mask = _mm256_set1_epi8(0x0f);
+    __m256i acc = _mm256_setzero_si256();
+
+    while (blocks--) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)p);
+        __m256i lo = _mm256_and_si256(x, low_mask);
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(x, 4), low_mask);
+        __m256i cnt = _mm256_add_epi8(_mm256_shuffle_epi8(lookup, lo), _mm256_shuffle_epi8(lookup, hi));
+        acc = _mm256_add_epi64(acc, _mm256_sad_epu8(cnt, _mm256_setzero_si256()));
+        p += 32;
+    }
+
+    return _mm256_extract_epi64(acc, 0) + _mm256_extract_epi64(acc, 1) + _mm256_extract_epi64(acc, 2) +
+           _mm256_extract_epi64(acc, 3);
+}
+#endif
+
 /* Count number of bits set in the binary array pointed by 's' and long
  * 'count' bytes. The implementation of this function is required to
  * work with an input string length up to 512 MB or more (server.proto_max_bulk_len) */
@@ -50,6 +91,17 @@ long long serverPopcount(void *s, long count) {
         5, 5, 6, 5, 6, 6, 7, 2, 3, 3, 4, 3, 4, 4, 5, 3, 4, 4, 5, 4, 5, 5, 6, 3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6,
         6, 7, 3, 4, 4, 5, 4, 5, 5, 6, 4, 5, 5, 6, 5, 6, 6, 7, 4, 5, 5, 6, 5, 6, 6, 7, 5, 6, 6, 7, 6, 7, 7, 8};
 
+#ifdef HAVE_AVX2
+    /* Count full 32 byte blocks with the vectorized kernel, the scalar
+     * code below handles whatever tail is left. */
+    if (count >= 32 && BITOPS_USE_AVX2) {
+        long blocks = count / 32;
+        bits += serverPopcountAVX2(p, blocks);
+        p += blocks * 32;
+        count -= blocks * 32;
+    }
+#endif
+
     /* Count initial bytes not aligned to 32 bit. */
     while ((unsigned long)p & 3 && count) {
         bits += bitsinbyte[*p++];
@@ -97,6 +149,26 @@ long long serverPopcount(void *s, long count) {
     return bits;
 }
 
+#ifdef HAVE_AVX2
+/* Return the number of leading bytes of 'p' (a multiple of 32, at most
+ * 'count') that hold no zero bit (if 'bit' is 0) or no set bit (if 'bit'
+ * is 1), comparing 32 bytes at a time. Used by serverBitpos() to skip
+ * large uniform prefixes before the scalar scan. */
+ATTRIBUTE_TARGET_AVX2
+static unsigned long serverBitposSkipAVX2(const unsigned char *p, unsigned long count, int bit) {
+    const __m256i skipval = bit ? _mm256_setzero_si256() : _mm256_set1_epi8(-1);
+    unsigned long skipped = 0;
+
+    while (count - skipped >= 32) {
+        __m256i x = _mm256_loadu_si256((const __m256i *)(p + skipped));
+        __m256i eq = _mm256_cmpeq_epi8(x, skipval);
+        if ((uint32_t)_mm256_movemask_epi8(eq) != UINT32_MAX) break;
+        skipped += 32;
+    }
+    return skipped;
+}
+#endif
+
 /* Return the position of the first bit set to one (if 'bit' is 1) or
  * zero (if 'bit' is 0) in the bitmap starting at 's' and long 'count' bytes.
  *
@@ -121,6 +193,16 @@ long long serverBitpos(void *s, unsigned long count, int bit) {
      * to sizeof(unsigned long) we consume it byte by byte until it is
      * aligned. */
 
+#ifdef HAVE_AVX2
+    /* Skip uniform 32 byte blocks with the vectorized kernel first. */
+    if (count >= 32 && BITOPS_USE_AVX2) {
+        unsigned long skipped = serverBitposSkipAVX2(s, count, bit);
+        s = (unsigned char *)s + skipped;
+        count -= skipped;
+        pos += skipped * 8;
+    }
+#endif
+
     /* Skip initial bits not aligned to sizeof(unsigned long) byte by byte. */
     skipval = bit ? 0 : UCHAR_MAX;
     c = (unsigned char *)s;
@@ -596,6 +678,52 @@ void getbitCommand(client *c) {
     addReply(c, bitval ? shared.cone : shared.czero);
 }
 
+#ifdef HAVE_AVX2
+/* Vectorized fast path for bitopCommand(): applies 'op' over the first
+ * 'minlen' bytes (the prefix covered by every input string) 32 bytes at
+ * a time, writing the result to 'res'. Returns the number of bytes
+ * processed; the caller finishes the remainder byte by byte. */
+ATTRIBUTE_TARGET_AVX2
+static unsigned long
+bitopProcessAVX2(unsigned long op, unsigned char **src, unsigned long numkeys, unsigned char *res, unsigned long minlen) {
+    unsigned long i, j = 0;
+
+    memcpy(res, src[0], minlen);
+
+    /* Different branches per different operations for speed (sorry). */
+    if (op == BITOP_AND) {
+        while (minlen - j >= 32) {
+            __m256i x = _mm256_loadu_si256((__m256i *)(res + j));
+            for (i = 1; i < numkeys; i++) x = _mm256_and_si256(x, _mm256_loadu_si256((__m256i *)(src[i] + j)));
+            _mm256_storeu_si256((__m256i *)(res + j), x);
+            j += 32;
+        }
+    } else if (op == BITOP_OR) {
+        while (minlen - j >= 32) {
+            __m256i x = _mm256_loadu_si256((__m256i *)(res + j));
+            for (i = 1; i < numkeys; i++) x = _mm256_or_si256(x, _mm256_loadu_si256((__m256i *)(src[i] + j)));
+            _mm256_storeu_si256((__m256i *)(res + j), x);
+            j += 32;
+        }
+    } else if (op == BITOP_XOR) {
+        while (minlen - j >= 32) {
+            __m256i x = _mm256_loadu_si256((__m256i *)(res + j));
+            for (i = 1; i < numkeys; i++) x = _mm256_xor_si256(x, _mm256_loadu_si256((__m256i *)(src[i] + j)));
+            _mm256_storeu_si256((__m256i *)(res + j), x);
+            j += 32;
+        }
+    } else if (op == BITOP_NOT) {
+        const __m256i ones = _mm256_set1_epi8(-1);
+        while (minlen - j >= 32) {
+            __m256i x = _mm256_loadu_si256((__m256i *)(res + j));
+            _mm256_storeu_si256((__m256i *)(res + j), _mm256_xor_si256(x, ones));
+            j += 32;
+        }
+    }
+    return j;
+}
+#endif
+
 /* BITOP op_name target_key src_key1 src_key2 src_key3 ... src_keyN */
 VALKEY_NO_SANITIZE("alignment")
 void bitopCommand(client *c) {
@@ -674,8 +802,13 @@ void bitopCommand(client *c) {
          * result in GCC compiling the code using multiple-words load/store
          * operations that are not supported even in ARM >= v6. */
         j = 0;
+#ifdef HAVE_AVX2
+        if (minlen >= 32 && numkeys <= 16 && BITOPS_USE_AVX2) {
+            j = bitopProcessAVX2(op, src, numkeys, res, minlen);
+        }
+#endif
 #ifndef USE_ALIGNED_ACCESS
-        if (minlen >= sizeof(unsigned long) * 4 && numkeys <= 16) {
+        if (j == 0 && minlen >= sizeof(unsigned long) * 4 && numkeys <= 16) {
             unsigned long *lp[16];
             unsigned long *lres = (unsigned long *)res;
 
@@ -85,6 +85,9 @@ void initClientBlockingState(client *c) {
     c->bstate->numlocal = 0;
     c->bstate->reploffset = 0;
     c->bstate->generic_blocked_list_node = NULL;
+    c->bstate->scan_cursor = 0;
+    c->bstate->scan_keys = NULL;
+    c->bstate->scan_slot = -1;
     c->bstate->module_blocked_handle = NULL;
     c->bstate->async_rm_call_handle = NULL;
 }
@@ -139,7 +142,7 @@ void updateStatsOnUnblock(client *c, long blocked_us, long reply_us, int failed_
             debugServerAssertWithInfo(c, NULL, 0);
     }
     if (server.latency_tracking_enabled)
-        updateCommandLatencyHistogram(&(c->lastcmd->latency_histogram), c->duration * 1000);
+        updateCommandLatencyHistogram(c->lastcmd, c->duration * 1000);
     /* Log the command into the commandlog if needed. */
     commandlogPushCurrentCommand(c, c->lastcmd);
     c->duration = 0;
@@ -217,6 +220,12 @@ void unblockClient(client *c, int queue_for_reprocessing) {
     } else if (c->bstate->btype == BLOCKED_MODULE) {
         if (moduleClientIsBlockedOnKeys(c)) unblockClientWaitingData(c);
         unblockClientFromModule(c);
+    } else if (c->bstate->btype == BLOCKED_SCAN) {
+        serverAssert(c->bstate->generic_blocked_list_node);
+        listDelNode(server.scan_slice_clients, c->bstate->generic_blocked_list_node);
+        c->bstate->generic_blocked_list_node = NULL;
+        listRelease(c->bstate->scan_keys);
+        c->bstate->scan_keys = NULL;
     } else if (c->bstate->btype == BLOCKED_POSTPONE) {
         serverAssert(c->bstate->postponed_list_node);
         listDelNode(server.postponed_clients, c->bstate->postponed_list_node);
@@ -269,6 +278,11 @@ void replyToBlockedClientTimedOut(client *c) {
         } else {
             serverPanic("Unknown wait command %s in replyToBlockedClientTimedOut().", c->cmd->declared_name);
         }
+    } else if (c->bstate->btype == BLOCKED_SCAN) {
+        /* Forced unblock (CLIENT UNBLOCK TIMEOUT): reply with the keys the
+         * interrupted scan has matched so far. */
+        replyToScanBlockedClient(c);
+        updateStatsOnUnblock(c, 0, 0, 0);
     } else if (c->bstate->btype == BLOCKED_MODULE) {
         moduleBlockedClientTimedOut(c, 0);
     } else {
@@ -596,9 +610,13 @@ static void handleClientsBlockedOnKey(readyList *rl) {
         /* Avoid processing more than the initial count so that we're not stuck
          * in an endless loop in case the reprocessing of the command blocks again. */
         long count = listLength(clients);
+        /* The key is looked up once and then only again after a client was
+         * actually served, since only serving a client can change the key
+         * state: with many waiters and few pushed elements this avoids one
+         * keyspace lookup per waiter that can no longer be served. */
+        robj *o = lookupKeyReadWithFlags(rl->db, rl->key, LOOKUP_NOEFFECTS);
         while ((ln = listNext(&li)) && count--) {
             client *receiver = listNodeValue(ln);
-            robj *o = lookupKeyReadWithFlags(rl->db, rl->key, LOOKUP_NOEFFECTS);
             /* 1. In case new key was added/touched we need to verify it satisfy the
              *    blocked type, since we might process the wrong key type.
              * 2. We want to serve clients blocked on module keys
@@ -612,6 +630,7 @@ static void handleClientsBlockedOnKey(readyList *rl) {
                     unblockClientOnKey(receiver, rl->key);
                 else
                     moduleUnblockClientOnKey(receiver, rl->key);
+                o = lookupKeyReadWithFlags(rl->db, rl->key, LOOKUP_NOEFFECTS);
             }
         }
     }
@@ -624,6 +643,7 @@ void blockClientForReplicaAck(client *c, mstime_t timeout, long long offset, lon
     c->bstate->reploffset = offset;
     c->bstate->numreplicas = numreplicas;
     c->bstate->numlocal = numlocal;
+    if (numlocal) server.waitaof_blocked_clients++;
     listAddNodeHead(server.clients_waiting_acks, c);
     /* Note that we remember the linked list node where the client is stored,
      * this way removing the client in unblockClientWaitingReplicas() will not
@@ -633,6 +653,22 @@ void blockClientForReplicaAck(client *c, mstime_t timeout, long long offset, lon
     blockClient(c, BLOCKED_WAIT);
 }
 
+/* Block a client whose full keyspace scan (KEYS) is executed incrementally in
+ * cursor slices from beforeSleep(), see incrementalScanSliceCycle(). 'slot'
+ * restricts the scan to a single slot, -1 scans the whole keyspace. */
+void blockClientForIncrementalScan(client *c, int slot) {
+    initClientBlockingState(c);
+    c->bstate->timeout = 0;
+    c->bstate->scan_cursor = 0;
+    c->bstate->scan_keys = listCreate();
+    listSetFreeMethod(c->bstate->scan_keys, sdsfreeVoid);
+    c->bstate->scan_slot = slot;
+    listAddNodeTail(server.scan_slice_clients, c);
+    serverAssert(c->bstate->generic_blocked_list_node == NULL);
+    c->bstate->generic_blocked_list_node = listLast(server.scan_slice_clients);
+    blockClient(c, BLOCKED_SCAN);
+}
+
 /* Postpone client from executing a command. For example the server might be busy
  * requesting to avoid processing clients commands which will be processed later
  * when the it is ready to accept them. */
@@ -759,6 +795,9 @@ void blockedBeforeSleep(void) {
      * This may unblock clients, so must be done before processUnblockedClients */
     handleClientsBlockedOnKeys();
 
+    /* Advance clients executing KEYS in cursor slices. */
+    if (listLength(server.scan_slice_clients)) incrementalScanSliceCycle();
+
     /* Check if there are clients unblocked by modules that implement
      * blocking commands. */
     if (moduleCount()) moduleHandleBlockedClients();
@@ -39,6 +39,7 @@
 #include "module.h"
 
 #include <ctype.h>
+#include <fcntl.h>
 
 /* -----------------------------------------------------------------------------
  * Key space handling
@@ -109,6 +110,109 @@ ConnectionType *connTypeOfCluster(void) {
     return connectionTypeTcp();
 }
 
+/* -----------------------------------------------------------------------------
+ * DUMP payload cache
+ *
+ * Cross-cluster replicators tend to DUMP or MIGRATE the same hot keys over
+ * and over; re-running rdbSaveObject() on an unmodified value produces the
+ * same bytes every time. When dump-payload-cache-size is non zero we keep
+ * the serialized payload of recently dumped keys and serve repeats from the
+ * cache. Entries are dropped from signalModifiedKey() the moment the key is
+ * written, and the whole cache is dropped on FLUSHALL/FLUSHDB and SWAPDB,
+ * so a cached payload is only ever served while the value is untouched.
+ * -------------------------------------------------------------------------- */
+
+typedef struct dumpCacheEntry {
+    int dbid;    /* Database the payload was serialized from. */
+    sds payload; /* Complete DUMP payload, footer included. */
+} dumpCacheEntry;
+
+static dict *dump_payload_cache = NULL; /* sds key name -> dumpCacheEntry. */
+static size_t dump_payload_cache_bytes = 0;
+
+static void dictDumpCacheEntryDestructor(void *val) {
+    dumpCacheEntry *entry = val;
+    sdsfree(entry->payload);
+    zfree(entry);
+}
+
+static dictType dumpCacheDictType = {
+    dictSdsHash,                  /* hash function */
+    NULL,                         /* key dup */
+    dictSdsKeyCompare,            /* key compare */
+    dictSdsDestructor,            /* key destructor */
+    dictDumpCacheEntryDestructor, /* val destructor */
+    NULL                          /* allow to expand */
+};
+
+/* Memory charged to the budget for one entry: key, payload and overhead. */
+static size_t dumpCacheEntrySize(sds keyname, dumpCacheEntry *entry) {
+    return sdslen(keyname) + sdslen(entry->payload) + sizeof(*entry);
+}
+
+/* Remove one entry by key name, updating the byte accounting. */
+static void dumpPayloadCacheDelete(sds keyname) {
+    dictEntry *de = dictUnlink(dump_payload_cache, keyname);
+    if (de) {
+        dump_payload_cache_bytes -= dumpCacheEntrySize(dictGetKey(de), dictGetVal(de));
+        dictFreeUnlinkedEntry(dump_payload_cache, de);
+    }
+}
+
+/* Drop the cached payload of 'key', if any. Called on every key
+ * modification, so the empty-cache case must stay a cheap early return. */
+void dumpPayloadCacheInvalidate(robj *key) {
+    if (dump_payload_cache == NULL || dictSize(dump_payload_cache) == 0) return;
+    dumpPayloadCacheDelete(key->ptr);
+}
+
+/* Drop every cached payload. Used when whole databases change identity
+ * (flush, swap) and when the cache is disabled at runtime. */
+void dumpPayloadCacheFlush(void) {
+    if (dump_payload_cache == NULL || dictSize(dump_payload_cache) == 0) return;
+    dictEmpty(dump_payload_cache, NULL);
+    dump_payload_cache_bytes = 0;
+}
+
+/* Return the cached payload of 'keyname' in 'dbid', or NULL. The caller
+ * must have already verified that the key exists. */
+static sds dumpPayloadCacheGet(int dbid, sds keyname) {
+    if (dump_payload_cache == NULL || dictSize(dump_payload_cache) == 0) return NULL;
+    dumpCacheEntry *entry = dictFetchValue(dump_payload_cache, keyname);
+    if (entry == NULL || entry->dbid != dbid) return NULL;
+    return entry->payload;
+}
+
+/* Store a copy of 'payload' as the cached serialization of 'keyname'.
+ * Over-budget entries are simply not cached; otherwise random entries are
+ * evicted until the new one fits, the same way the maxmemory sampling
+ * accepts approximate recency in exchange for O(1) bookkeeping. */
+static void dumpPayloadCachePut(int dbid, sds keyname, sds payload) {
+    if (server.dump_payload_cache_size == 0) {
+        dumpPayloadCacheFlush();
+        return;
+    }
+    if (dump_payload_cache == NULL) dump_payload_cache = dictCreate(&dumpCacheDictType);
+
+    dumpCacheEntry *entry = zmalloc(sizeof(*entry));
+    entry->dbid = dbid;
+    entry->payload = sdsdup(payload);
+    size_t bytes = dumpCacheEntrySize(keyname, entry);
+    if (bytes > server.dump_payload_cache_size) {
+        dictDumpCacheEntryDestructor(entry);
+        return;
+    }
+    /* A stale same-name entry from another db may still be present. */
+    dumpPayloadCacheDelete(keyname);
+    while (dump_payload_cache_bytes + bytes > server.dump_payload_cache_size &&
+           dictSize(dump_payload_cache) > 0) {
+        dictEntry *de = dictGetRandomKey(dump_payload_cache);
+        dumpPayloadCacheDelete(dictGetKey(de));
+    }
+    serverAssert(dictAdd(dump_payload_cache, sdsdup(keyname), entry) == DICT_OK);
+    dump_payload_cache_bytes += bytes;
+}
+
 /* -----------------------------------------------------------------------------
  * DUMP, RESTORE and MIGRATE commands
  * -------------------------------------------------------------------------- */
@@ -175,6 +279,189 @@ int verifyDumpPayload(unsigned char *p, size_t len, uint16_t *rdbver_ptr) {
     return (memcmp(&crc, footer + 2, 8) == 0) ? C_OK : C_ERR;
 }
 
+/* A chunked DUMP or RESTORE transfer in progress on a client. The payload is
+ * spooled into an unlinked temporary file so that arbitrarily large objects
+ * can be moved in bounded memory: DUMP serializes the object into the file
+ * once and serves it back chunk by chunk, while RESTORE accumulates the
+ * received chunks and loads the object from the file once the transfer is
+ * finalized. A client can have at most one transfer in progress. */
+#define CHUNKED_OP_DUMP 0
+#define CHUNKED_OP_RESTORE 1
+
+typedef struct chunkedDumpState {
+    int type;     /* CHUNKED_OP_DUMP or CHUNKED_OP_RESTORE. */
+    sds key;      /* The key the transfer refers to. */
+    FILE *fp;     /* Unlinked temporary file spooling the payload. */
+    off_t size;   /* Total payload size (CHUNKED_OP_DUMP only). */
+    off_t offset; /* Next offset to serve, or bytes received so far. */
+} chunkedDumpState;
+
+/* Release the chunked transfer state of the client, if any. */
+void freeClientChunkedDumpState(client *c) {
+    chunkedDumpState *cs = c->chunk_state;
+    if (cs == NULL) return;
+    fclose(cs->fp);
+    sdsfree(cs->key);
+    zfree(cs);
+    c->chunk_state = NULL;
+}
+
+/* Create the spool file for a chunked transfer in the working directory.
+ * The file is unlinked right away so it cannot leak whatever happens to
+ * the process. Returns NULL on error. */
+static FILE *chunkedDumpCreateSpoolFile(client *c) {
+    char tmpfile[256];
+    snprintf(tmpfile, sizeof(tmpfile), "temp-dump-%d-%llu.bin", (int)getpid(), (unsigned long long)c->id);
+    int fd = open(tmpfile, O_CREAT | O_EXCL | O_RDWR, 0644);
+    if (fd == -1) return NULL;
+    unlink(tmpfile);
+    FILE *fp = fdopen(fd, "w+b");
+    if (fp == NULL) close(fd);
+    return fp;
+}
+
+/* Allocate and attach a chunked transfer state to the client, replacing
+ * a previous unfinished transfer if there was one. Returns NULL if the
+ * spool file can not be created, in which case an error was replied. */
+static chunkedDumpState *chunkedDumpStateCreate(client *c, int type) {
+    freeClientChunkedDumpState(c);
+    FILE *fp = chunkedDumpCreateSpoolFile(c);
+    if (fp == NULL) {
+        addReplyError(c, "Unable to create the dump spool file");
+        return NULL;
+    }
+    chunkedDumpState *cs = zmalloc(sizeof(*cs));
+    cs->type = type;
+    cs->key = sdsdup(c->argv[1]->ptr);
+    cs->fp = fp;
+    cs->size = 0;
+    cs->offset = 0;
+    c->chunk_state = cs;
+    return cs;
+}
+
+/* Return 1 if the chunked transfer state of the client matches the given
+ * transfer type, key and cursor, 0 otherwise. */
+static int chunkedDumpStateMatches(client *c, int type, unsigned long long cursor) {
+    chunkedDumpState *cs = c->chunk_state;
+    return cs != NULL && cs->type == type && sdscmp(cs->key, c->argv[1]->ptr) == 0 && cursor == (unsigned long long)cs->offset;
+}
+
+/* DUMP key CHUNKED cursor count
+ *
+ * Serves the DUMP payload of 'key' in chunks of at most 'count' bytes, so
+ * that objects larger than proto-max-bulk-len (or simply too large to be
+ * buffered at once) can be dumped. A cursor of 0 starts the transfer: the
+ * object is serialized into a spool file at this point, so later chunks
+ * are consistent even if the key is modified meanwhile. Each call replies
+ * with an array of two elements, the cursor to pass to the next call (0
+ * when the transfer is complete) and the chunk itself. */
+static void dumpChunkedCommand(client *c) {
+    unsigned long long cursor;
+    long long count;
+
+    if (string2ull(c->argv[3]->ptr, &cursor) == 0) {
+        addReplyError(c, "Invalid cursor");
+        return;
+    }
+    if (getLongLongFromObjectOrReply(c, c->argv[4], &count, NULL) != C_OK) return;
+    if (count < 1 || count > server.proto_max_bulk_len) {
+        addReplyError(c, "Invalid count, must be between 1 and proto-max-bulk-len");
+        return;
+    }
+
+    if (cursor == 0) {
+        robj *o;
+        if ((o = lookupKeyRead(c->db, c->argv[1])) == NULL) {
+            addReplyNull(c);
+            return;
+        }
+        chunkedDumpState *cs = chunkedDumpStateCreate(c, CHUNKED_OP_DUMP);
+        if (cs == NULL) return;
+
+        /* Serialize the object into the spool file with the same framing
+         * used by createDumpPayload(): the concatenation of all the chunks
+         * is a payload that plain RESTORE would accept. */
+        rio payload;
+        unsigned char buf[2];
+        uint64_t crc;
+        rioInitWithFile(&payload, cs->fp);
+        payload.update_cksum = rioGenericUpdateChecksum;
+        serverAssert(rdbSaveObjectType(&payload, o));
+        serverAssert(rdbSaveObject(&payload, o, c->argv[1], c->db->id));
+        buf[0] = RDB_VERSION & 0xff;
+        buf[1] = (RDB_VERSION >> 8) & 0xff;
+        serverAssert(rioWrite(&payload, buf, 2));
+        crc = payload.cksum;
+        memrev64ifbe(&crc);
+        serverAssert(rioWrite(&payload, &crc, 8));
+        fflush(cs->fp);
+        cs->size = ftello(cs->fp);
+    } else if (!chunkedDumpStateMatches(c, CHUNKED_OP_DUMP, cursor)) {
+        addReplyError(c, "Invalid dump cursor");
+        return;
+    }
+
+    chunkedDumpState *cs = c->chunk_state;
+    off_t remaining = cs->size - cs->offset;
+    if (count > remaining) count = remaining;
+    sds chunk = sdsnewlen(SDS_NOINIT, count);
+    if (fseeko(cs->fp, cs->offset, SEEK_SET) == -1 || fread(chunk, 1, count, cs->fp) != (size_t)count) {
+        sdsfree(chunk);
+        freeClientChunkedDumpState(c);
+        addReplyError(c, "Unable to read the dump spool file");
+        return;
+    }
+    cs->offset += count;
+
+    addReplyArrayLen(c, 2);
+    if (cs->offset == cs->size) {
+        addReplyLongLong(c, 0);
+        freeClientChunkedDumpState(c);
+    } else {
+        addReplyLongLong(c, cs->offset);
+    }
+    addReplyBulkSds(c, chunk);
+}
+
+/* Verify the RDB version and the checksum of a DUMP payload spooled into a
+ * file, the same way verifyDumpPayload() does for an in-memory payload, but
+ * reading the file in fixed size blocks so the memory usage stays bounded. */
+static int verifyDumpPayloadFile(FILE *fp, off_t len, uint16_t *rdbver_ptr) {
+    unsigned char footer[10];
+    uint16_t rdbver;
+    uint64_t crc = 0;
+
+    /* At least 2 bytes of RDB version and 8 of CRC64 should be present. */
+    if (len < 10) return C_ERR;
+    if (fseeko(fp, len - 10, SEEK_SET) == -1 || fread(footer, 1, 10, fp) != 10) return C_ERR;
+
+    /* Set and verify RDB version. */
+    rdbver = (footer[1] << 8) | footer[0];
+    if (rdbver_ptr) {
+        *rdbver_ptr = rdbver;
+    }
+    if ((rdbver >= RDB_FOREIGN_VERSION_MIN && rdbver <= RDB_FOREIGN_VERSION_MAX) ||
+        (rdbver > RDB_VERSION && server.rdb_version_check == RDB_VERSION_CHECK_STRICT)) {
+        return C_ERR;
+    }
+
+    if (server.skip_checksum_validation) return C_OK;
+
+    /* Verify CRC64, computed over everything but the trailing checksum. */
+    if (fseeko(fp, 0, SEEK_SET) == -1) return C_ERR;
+    off_t toread = len - 8;
+    unsigned char block[8192];
+    while (toread > 0) {
+        size_t n = toread > (off_t)sizeof(block) ? sizeof(block) : (size_t)toread;
+        if (fread(block, 1, n, fp) != n) return C_ERR;
+        crc = crc64(crc, block, n);
+        toread -= n;
+    }
+    memrev64ifbe(&crc);
+    return (memcmp(&crc, footer + 2, 8) == 0) ? C_OK : C_ERR;
+}
+
 /* DUMP keyname
  * DUMP is actually not used by Cluster but it is the obvious
  * complement of RESTORE and can be useful for different applications. */
@@ -182,25 +469,42 @@ void dumpCommand(client *c) {
     robj *o;
     rio payload;
 
+    if (c->argc == 5 && !strcasecmp(c->argv[2]->ptr, "chunked")) {
+        dumpChunkedCommand(c);
+        return;
+    } else if (c->argc != 2) {
+        addReplyErrorObject(c, shared.syntaxerr);
+        return;
+    }
+
     /* Check if the key is here. */
     if ((o = lookupKeyRead(c->db, c->argv[1])) == NULL) {
         addReplyNull(c);
         return;
     }
 
+    /* Serve repeated dumps of an unmodified key from the payload cache. */
+    sds cached = dumpPayloadCacheGet(c->db->id, c->argv[1]->ptr);
+    if (cached != NULL) {
+        addReplyBulkCBuffer(c, cached, sdslen(cached));
+        return;
+    }
+
     /* Create the DUMP encoded representation. */
     createDumpPayload(&payload, o, c->argv[1], c->db->id);
+    dumpPayloadCachePut(c->db->id, c->argv[1]->ptr, payload.io.buffer.ptr);
 
     /* Transfer to the client */
     addReplyBulkSds(c, payload.io.buffer.ptr);
     return;
 }
 
-/* RESTORE key ttl serialized-value [REPLACE] [ABSTTL] [IDLETIME seconds] [FREQ frequency] */
+/* RESTORE key ttl serialized-value [REPLACE] [ABSTTL] [IDLETIME seconds] [FREQ frequency] [CHUNKED cursor] */
 void restoreCommand(client *c) {
     long long ttl, lfu_freq = -1, lru_idle = -1, lru_clock = -1;
+    unsigned long long cursor = 0;
     rio payload;
-    int j, type, replace = 0, absttl = 0;
+    int j, type, replace = 0, absttl = 0, chunked = 0;
     robj *obj;
 
     /* Parse additional options */
@@ -210,6 +514,13 @@ void restoreCommand(client *c) {
             replace = 1;
         } else if (!strcasecmp(c->argv[j]->ptr, "absttl")) {
             absttl = 1;
+        } else if (!strcasecmp(c->argv[j]->ptr, "chunked") && additional >= 1) {
+            if (string2ull(c->argv[j + 1]->ptr, &cursor) == 0) {
+                addReplyError(c, "Invalid cursor");
+                return;
+            }
+            chunked = 1;
+            j++; /* Consume additional arg. */
         } else if (!strcasecmp(c->argv[j]->ptr, "idletime") && additional >= 1 && lfu_freq == -1) {
             if (getLongLongFromObjectOrReply(c, c->argv[j + 1], &lru_idle, NULL) != C_OK) return;
             if (lru_idle < 0) {
@@ -231,6 +542,29 @@ void restoreCommand(client *c) {
         }
     }
 
+    /* With CHUNKED, a non empty chunk is just accumulated into the spool
+     * file: options like REPLACE and the key existence only matter for the
+     * finalizing call, that carries an empty chunk. */
+    if (chunked && sdslen(c->argv[3]->ptr) != 0) {
+        size_t chunklen = sdslen(c->argv[3]->ptr);
+        chunkedDumpState *cs;
+        if (cursor == 0) {
+            if ((cs = chunkedDumpStateCreate(c, CHUNKED_OP_RESTORE)) == NULL) return;
+        } else if (!chunkedDumpStateMatches(c, CHUNKED_OP_RESTORE, cursor)) {
+            addReplyError(c, "Invalid restore cursor");
+            return;
+        }
+        cs = c->chunk_state;
+        if (fwrite(c->argv[3]->ptr, 1, chunklen, cs->fp) != chunklen) {
+            freeClientChunkedDumpState(c);
+            addReplyError(c, "Unable to write the dump spool file");
+            return;
+        }
+        cs->offset += chunklen;
+        addReplyLongLong(c, cs->offset);
+        return;
+    }
+
     /* Make sure this key does not already exist here... */
     robj *key = c->argv[1];
     if (!replace && lookupKeyWrite(c->db, key) != NULL) {
@@ -246,8 +580,56 @@ void restoreCommand(client *c) {
         return;
     }
 
-    /* Verify RDB version and data checksum. */
-    if (verifyDumpPayload(c->argv[3]->ptr, sdslen(c->argv[3]->ptr), NULL) == C_ERR) {
+    if (chunked) {
+        /* Empty chunk: finalize the transfer. */
+        if (cursor == 0 || !chunkedDumpStateMatches(c, CHUNKED_OP_RESTORE, cursor)) {
+            addReplyError(c, "Invalid restore cursor");
+            return;
+        }
+        chunkedDumpState *cs = c->chunk_state;
+        fflush(cs->fp);
+
+        /* Verify the payload before materializing it, so a corrupted
+         * transfer is rejected without allocating its full size. */
+        if (verifyDumpPayloadFile(cs->fp, cs->offset, NULL) == C_ERR) {
+            freeClientChunkedDumpState(c);
+            addReplyError(c, "DUMP payload version or checksum are wrong");
+            return;
+        }
+
+        /* Rebuild the command as a plain RESTORE carrying the whole payload,
+         * so replicas and the AOF receive a single self-contained command:
+         * the chunked calls themselves are never propagated. The replication
+         * link and the AOF loader are not subject to proto-max-bulk-len, so
+         * the jumbo argument is safe on the other side. */
+        sds full = sdsnewlen(SDS_NOINIT, cs->offset);
+        if (fseeko(cs->fp, 0, SEEK_SET) == -1 || fread(full, 1, cs->offset, cs->fp) != (size_t)cs->offset) {
+            sdsfree(full);
+            freeClientChunkedDumpState(c);
+            addReplyError(c, "Unable to read the dump spool file");
+            return;
+        }
+        freeClientChunkedDumpState(c);
+
+        robj **newargv = zmalloc(sizeof(robj *) * c->argc);
+        int newargc = 0;
+        for (j = 0; j < 3; j++) {
+            newargv[newargc++] = c->argv[j];
+            incrRefCount(c->argv[j]);
+        }
+        newargv[newargc++] = createObject(OBJ_STRING, full);
+        for (j = 4; j < c->argc; j++) {
+            if (!strcasecmp(c->argv[j]->ptr, "chunked")) {
+                j++; /* Skip the cursor as well. */
+                continue;
+            }
+            newargv[newargc++] = c->argv[j];
+            incrRefCount(c->argv[j]);
+        }
+        replaceClientCommandVector(c, newargc, newargv);
+        key = c->argv[1];
+    } else if (verifyDumpPayload(c->argv[3]->ptr, sdslen(c->argv[3]->ptr), NULL) == C_ERR) {
+        /* Verify RDB version and data checksum. */
         addReplyError(c, "DUMP payload version or checksum are wrong");
         return;
     }
@@ -568,10 +950,17 @@ try_again:
         serverAssertWithInfo(c, NULL, rioWriteBulkLongLong(&cmd, ttl));
 
         /* Emit the payload argument, that is the serialized object using
-         * the DUMP format. */
-        createDumpPayload(&payload, ov[j], kv[j], dbid);
-        serverAssertWithInfo(c, NULL, rioWriteBulkString(&cmd, payload.io.buffer.ptr, sdslen(payload.io.buffer.ptr)));
-        sdsfree(payload.io.buffer.ptr);
+         * the DUMP format. Unmodified keys that were dumped or migrated
+         * before come straight from the payload cache. */
+        sds cached = dumpPayloadCacheGet(dbid, kv[j]->ptr);
+        if (cached != NULL) {
+            serverAssertWithInfo(c, NULL, rioWriteBulkString(&cmd, cached, sdslen(cached)));
+        } else {
+            createDumpPayload(&payload, ov[j], kv[j], dbid);
+            dumpPayloadCachePut(dbid, kv[j]->ptr, payload.io.buffer.ptr);
+            serverAssertWithInfo(c, NULL, rioWriteBulkString(&cmd, payload.io.buffer.ptr, sdslen(payload.io.buffer.ptr)));
+            sdsfree(payload.io.buffer.ptr);
+        }
 
         /* Add the REPLACE option to the RESTORE command if it was specified
          * as a MIGRATE option. */
@@ -1383,6 +1772,15 @@ void clearCachedClusterSlotsResponse(void) {
     }
 }
 
+void clearCachedClusterShardsResponse(void) {
+    for (int conn_type = 0; conn_type < CACHE_CONN_TYPE_MAX; conn_type++) {
+        if (server.cached_cluster_shards_info[conn_type]) {
+            sdsfree(server.cached_cluster_shards_info[conn_type]);
+            server.cached_cluster_shards_info[conn_type] = NULL;
+        }
+    }
+}
+
 sds generateClusterSlotResponse(int resp) {
     client *recording_client = createCachedResponseClient(resp);
     clusterNode *n = NULL;
@@ -1440,7 +1838,12 @@ void clusterCommandSlots(client *c) {
     if (isClientConnIpV6(c)) conn_type |= CACHE_CONN_TYPE_IPv6;
     if (c->resp == 3) conn_type |= CACHE_CONN_TYPE_RESP3;
 
-    if (detectAndUpdateCachedNodeHealth()) clearCachedClusterSlotsResponse();
+    if (detectAndUpdateCachedNodeHealth()) {
+        /* A health transition invalidates both topology caches; the detection
+         * consumes the transition so clear them together. */
+        clearCachedClusterSlotsResponse();
+        clearCachedClusterShardsResponse();
+    }
 
     sds cached_reply = server.cached_cluster_slot_info[conn_type];
     if (!cached_reply) {
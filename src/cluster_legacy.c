@@ -1214,6 +1214,7 @@ void clusterInit(void) {
     server.cluster->mf_replica = NULL;
     for (int conn_type = 0; conn_type < CACHE_CONN_TYPE_MAX; conn_type++) {
         server.cached_cluster_slot_info[conn_type] = NULL;
+        server.cached_cluster_shards_info[conn_type] = NULL;
     }
     resetManualFailover();
     clusterUpdateMyselfFlags();
@@ -2787,6 +2788,9 @@ void clusterUpdateSlotsConfigWith(clusterNode *sender, uint64_t senderConfigEpoc
                       myself->name, myself->human_nodename, myself->shard_id);
             delKeysInSlot(dirty_slots[j]);
         }
+        /* When the values were freed synchronously, hand the unused pages
+         * back to the OS right away, like emptyDbStructure() does. */
+        if (!server.lazyfree_lazy_server_del) jemalloc_purge();
     }
 }
 
@@ -3767,42 +3771,64 @@ void handleLinkIOError(clusterLink *link) {
     freeClusterLink(link);
 }
 
-/* Send the messages queued for the link. */
+/* Send the messages queued for the link. Multiple queued messages are
+ * coalesced into a single writev() call: bus traffic is dominated by small
+ * PING/PONG messages and issuing one syscall per message is pure overhead
+ * on busy links. */
 void clusterWriteHandler(connection *conn) {
     clusterLink *link = connGetPrivateData(conn);
     ssize_t nwritten;
     size_t totwritten = 0;
+    int iovmax = min(IOV_MAX, conn->iovcnt);
 
     while (totwritten < NET_MAX_WRITES_PER_EVENT && listLength(link->send_msg_queue) > 0) {
-        listNode *head = listFirst(link->send_msg_queue);
-        clusterMsgSendBlock *msgblock = (clusterMsgSendBlock *)head->value;
-        clusterMsg *msg = getMessageFromSendBlock(msgblock);
-        size_t msg_offset = link->head_msg_send_offset;
-        size_t msg_len = ntohl(msg->totlen);
+        struct iovec iov[iovmax];
+        int iovcnt = 0;
+        listIter li;
+        listNode *ln;
 
-        nwritten = connWrite(conn, (char *)msg + msg_offset, msg_len - msg_offset);
+        /* Gather as many queued messages as the iovec allows. Only the
+         * head message may have been partially sent by a previous call. */
+        listRewind(link->send_msg_queue, &li);
+        while (iovcnt < iovmax && (ln = listNext(&li)) != NULL) {
+            clusterMsg *msg = getMessageFromSendBlock((clusterMsgSendBlock *)ln->value);
+            size_t msg_offset = (iovcnt == 0) ? link->head_msg_send_offset : 0;
+            iov[iovcnt].iov_base = (char *)msg + msg_offset;
+            iov[iovcnt].iov_len = ntohl(msg->totlen) - msg_offset;
+            iovcnt++;
+        }
+
+        nwritten = connWritev(conn, iov, iovcnt);
         if (nwritten <= 0) {
             serverLog(LL_DEBUG, "I/O error writing to node link: %s",
                       (nwritten == -1) ? connGetLastError(conn) : "short write");
             handleLinkIOError(link);
             return;
         }
-        if (msg_offset + nwritten < msg_len) {
-            /* If full message wasn't written, record the offset
-             * and continue sending from this point next time */
-            link->head_msg_send_offset += nwritten;
-            return;
-        }
-        serverAssert((msg_offset + nwritten) == msg_len);
-        link->head_msg_send_offset = 0;
+        totwritten += nwritten;
 
-        /* Delete the node and update our memory tracking */
-        uint32_t blocklen = msgblock->totlen;
-        listDelNode(link->send_msg_queue, head);
-        server.stat_cluster_links_memory -= sizeof(listNode);
-        link->send_msg_queue_mem -= sizeof(listNode) + blocklen;
+        /* Dequeue the messages that were fully written. */
+        while (nwritten > 0) {
+            listNode *head = listFirst(link->send_msg_queue);
+            clusterMsgSendBlock *msgblock = (clusterMsgSendBlock *)head->value;
+            clusterMsg *msg = getMessageFromSendBlock(msgblock);
+            size_t remaining = ntohl(msg->totlen) - link->head_msg_send_offset;
+
+            if ((size_t)nwritten < remaining) {
+                /* If the full message wasn't written, record the offset
+                 * and continue sending from this point next time */
+                link->head_msg_send_offset += nwritten;
+                return;
+            }
+            nwritten -= remaining;
+            link->head_msg_send_offset = 0;
 
-        totwritten += nwritten;
+            /* Delete the node and update our memory tracking */
+            uint32_t blocklen = msgblock->totlen;
+            listDelNode(link->send_msg_queue, head);
+            server.stat_cluster_links_memory -= sizeof(listNode);
+            link->send_msg_queue_mem -= sizeof(listNode) + blocklen;
+        }
     }
 
     if (listLength(link->send_msg_queue) == 0) connSetWriteHandler(link->conn, NULL);
@@ -4462,10 +4488,11 @@ int clusterSendModuleMessageToTarget(const char *target,
  * Publish this message across the slot (primary/replica).
  * -------------------------------------------------------------------------- */
 void clusterPropagatePublish(robj *channel, robj *message, int sharded) {
-    clusterMsgSendBlock *msgblock, *msgblock_light;
-    msgblock_light = clusterCreatePublishMsgBlock(channel, message, 1, sharded);
-    /* We will only create msgblock with normal hdr if there are any nodes that do not support light hdr */
-    msgblock = NULL;
+    /* Both message blocks are created lazily, on the first node that needs
+     * the respective header format. When there is no peer to forward to
+     * (e.g. SPUBLISH on a shard with no replicas) the publish path skips
+     * bus serialization entirely, which matters at high publish rates. */
+    clusterMsgSendBlock *msgblock = NULL, *msgblock_light = NULL;
     ClusterNodeIterator iter;
     if (sharded) {
         clusterNodeIterInitMyShard(&iter);
@@ -4477,6 +4504,9 @@ void clusterPropagatePublish(robj *channel, robj *message, int sharded) {
     while ((node = clusterNodeIterNext(&iter)) != NULL) {
         if (node->flags & (CLUSTER_NODE_MYSELF | CLUSTER_NODE_HANDSHAKE)) continue;
         if (nodeSupportsLightMsgHdrForPubSub(node)) {
+            if (msgblock_light == NULL) {
+                msgblock_light = clusterCreatePublishMsgBlock(channel, message, 1, sharded);
+            }
             clusterSendMessage(node->link, msgblock_light);
         } else {
             if (msgblock == NULL) {
@@ -4487,7 +4517,7 @@ void clusterPropagatePublish(robj *channel, robj *message, int sharded) {
     }
     clusterNodeIterReset(&iter);
     if (msgblock != NULL) clusterMsgSendBlockDecrRefCount(msgblock);
-    clusterMsgSendBlockDecrRefCount(msgblock_light);
+    if (msgblock_light != NULL) clusterMsgSendBlockDecrRefCount(msgblock_light);
 }
 
 /* -----------------------------------------------------------------------------
@@ -5308,6 +5338,12 @@ void clusterCron(void) {
     }
     dictReleaseIterator(di);
 
+    /* The SHARDS reply embeds replication offsets, which keep advancing
+     * without any topology change. Drop the cached reply about once per
+     * second so the offsets clients observe stay about as fresh as the
+     * gossip-propagated offsets of the other nodes in the same reply. */
+    if (!(iteration % 10)) clearCachedClusterShardsResponse();
+
     /* Ping some random node 1 time every 10 iterations, so that we usually ping
      * one random node every second. */
     if (!server.debug_cluster_disable_random_ping && !(iteration % 10)) {
@@ -5498,7 +5534,10 @@ void clusterBeforeSleep(void) {
 
 void clusterDoBeforeSleep(int flags) {
     /* Clear the cache if there are config changes here. */
-    if (flags & CLUSTER_TODO_SAVE_CONFIG) clearCachedClusterSlotsResponse();
+    if (flags & CLUSTER_TODO_SAVE_CONFIG) {
+        clearCachedClusterSlotsResponse();
+        clearCachedClusterShardsResponse();
+    }
 
     server.cluster->todo_before_sleep |= flags;
 }
@@ -6319,8 +6358,12 @@ void addNodeDetailsToShardReply(client *c, clusterNode *node) {
 /* Add to the output buffer of the given client, an array of slot (start, end)
  * pair owned by the shard, also the primary and set of replica(s) along with
  * information about each node. */
-void clusterCommandShards(client *c) {
-    addReplyArrayLen(c, dictSize(server.cluster->shards));
+static void addReplyClusterShards(client *c) {
+    /* A deferred length is used so that, when recording the reply for the
+     * cache, everything lands in the reply list (aggregateClientOutputBuffer
+     * does not read the static buffer). */
+    void *shard_replylen = addReplyDeferredLen(c);
+    setDeferredArrayLen(c, shard_replylen, dictSize(server.cluster->shards));
     /* This call will add slot_info_pairs to all nodes */
     clusterGenNodesSlotsInfo(0);
     dictIterator *di = dictGetSafeIterator(server.cluster->shards);
@@ -6364,6 +6407,39 @@ void clusterCommandShards(client *c) {
     dictReleaseIterator(di);
 }
 
+/* Generate the CLUSTER SHARDS reply through a recording client, so the
+ * serialized form can be cached and replayed to further callers. */
+static sds generateClusterShardsResponse(int resp) {
+    client *recording_client = createCachedResponseClient(resp);
+    addReplyClusterShards(recording_client);
+    sds shards_response = aggregateClientOutputBuffer(recording_client);
+    deleteCachedResponseClient(recording_client);
+    return shards_response;
+}
+
+void clusterCommandShards(client *c) {
+    /* TLS does not influence this reply (both ports are always included),
+     * but the ip/endpoint fields depend on the caller's address family and
+     * the encoding on its RESP version, so cache per connection type like
+     * CLUSTER SLOTS does. After a failover every client refreshes its
+     * topology at once; serving a cached blob keeps that herd cheap. */
+    int conn_type = 0;
+    if (isClientConnIpV6(c)) conn_type |= CACHE_CONN_TYPE_IPv6;
+    if (c->resp == 3) conn_type |= CACHE_CONN_TYPE_RESP3;
+
+    if (detectAndUpdateCachedNodeHealth()) {
+        clearCachedClusterSlotsResponse();
+        clearCachedClusterShardsResponse();
+    }
+
+    sds cached_reply = server.cached_cluster_shards_info[conn_type];
+    if (!cached_reply) {
+        cached_reply = generateClusterShardsResponse(c->resp);
+        server.cached_cluster_shards_info[conn_type] = cached_reply;
+    }
+    addReplyProto(c, cached_reply, sdslen(cached_reply));
+}
+
 sds genClusterInfoString(void) {
     sds info = sdsempty();
     char *statestr[] = {"ok", "fail"};
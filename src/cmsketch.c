@@ -0,0 +1,454 @@
+/* cmsketch.c - Probabilistic frequency sketches (count-min and top-K).
+ *
+ * Copyright (c) 2024-current, Valkey contributors
+ * All rights reserved.
+ *
+ * Licensed under your choice of (a) the Redis Source Available License 2.0
+ * (RSALv2); or (b) the Server Side Public License v1 (SSPLv1); or (c) the
+ * GNU Affero General Public License version 3 (AGPLv3).
+ */
+
+#include "server.h"
+#include "crc64.h"
+
+/* Like HyperLogLog, the sketches implemented here are stored inside plain
+ * string values: a small header followed by a flat array of counters. This
+ * means RDB persistence, replication, DUMP/RESTORE, expires and memory
+ * accounting all work without touching any other subsystem, and the value
+ * can be retrieved and inspected with GET.
+ *
+ * Two sketches are provided:
+ *
+ * 1. A count-min sketch (CMSINCRBY / CMSQUERY / CMSMERGE / CMSINFO). The
+ *    counter matrix is CMS_DEPTH rows of CMS_WIDTH 32 bit counters. Each
+ *    row is indexed by an independent hash of the item, an increment bumps
+ *    one counter per row, and a query returns the minimum across rows: the
+ *    estimate can only over-count (by colliding items), never under-count.
+ *    With the default 2048x5 geometry a sketch is 40KB regardless of how
+ *    many distinct items it has seen, and the expected over-count is about
+ *    2e/width of the total increments with high probability.
+ *
+ * 2. A SpaceSaving top-K summary (TOPKADD / TOPKLIST). A fixed set of K
+ *    slots track candidate heavy hitters; when a new item arrives and all
+ *    slots are taken, the minimum-count slot is evicted and the newcomer
+ *    inherits its count (recorded as the slot's error bound). Heavy items
+ *    survive churn because their counts outgrow the eviction floor.
+ *
+ * All multi-byte fields are stored in little endian byte order with
+ * explicit byte shuffling, both because sds payloads have no alignment
+ * guarantee and so that RDB files move between architectures, mirroring
+ * what hyperloglog.c does for its cached cardinality. */
+
+#define CMS_MAGIC "CMSK"
+#define CMS_VERSION 1
+#define CMS_WIDTH 2048 /* Counters per row, must be a power of two. */
+#define CMS_DEPTH 5    /* Independent rows. */
+
+/* Header: magic(4) version(1) depth(1) reserved(2) width(le32) total(le64). */
+#define CMS_HDR_SIZE 20
+#define CMS_SIZE (CMS_HDR_SIZE + CMS_WIDTH * CMS_DEPTH * 4)
+
+#define TOPK_MAGIC "TOPK"
+#define TOPK_VERSION 1
+#define TOPK_K 10        /* Tracked candidates. */
+#define TOPK_ITEM_MAX 255 /* Max item length storable in a slot. */
+
+/* Header: magic(4) version(1) reserved(3) k(le32).
+ * Slot: count(le32) error(le32) itemlen(1) item(TOPK_ITEM_MAX). */
+#define TOPK_HDR_SIZE 12
+#define TOPK_SLOT_SIZE (4 + 4 + 1 + TOPK_ITEM_MAX)
+#define TOPK_SIZE (TOPK_HDR_SIZE + TOPK_K * TOPK_SLOT_SIZE)
+
+static const char *invalid_cms_err = "INVALIDOBJ Corrupted CMS object detected";
+static const char *invalid_topk_err = "INVALIDOBJ Corrupted TOPK object detected";
+
+/* Unaligned little endian accessors. The compiler turns these into plain
+ * loads and stores on little endian machines. */
+static inline uint32_t sketchGetU32(const uint8_t *p) {
+    return (uint32_t)p[0] | ((uint32_t)p[1] << 8) | ((uint32_t)p[2] << 16) | ((uint32_t)p[3] << 24);
+}
+
+static inline void sketchSetU32(uint8_t *p, uint32_t v) {
+    p[0] = v & 0xff;
+    p[1] = (v >> 8) & 0xff;
+    p[2] = (v >> 16) & 0xff;
+    p[3] = (v >> 24) & 0xff;
+}
+
+static inline uint64_t sketchGetU64(const uint8_t *p) {
+    return (uint64_t)sketchGetU32(p) | ((uint64_t)sketchGetU32(p + 4) << 32);
+}
+
+static inline void sketchSetU64(uint8_t *p, uint64_t v) {
+    sketchSetU32(p, v & 0xffffffff);
+    sketchSetU32(p + 4, v >> 32);
+}
+
+/* ========================= Count-min sketch ============================== */
+
+/* Derive the CMS_DEPTH row indexes for 'ele'. We hash once and expand with
+ * the Kirsch-Mitzenmacher construction (index_i = h1 + i*h2): two derived
+ * hashes are as good as depth independent ones for count-min bounds. The
+ * hash must be seedless since the indexes are persisted inside the value
+ * and have to survive restarts and cross-host migration, so we use crc64
+ * rather than the randomly seeded siphash the dict uses. */
+static void cmsRowIndexes(const unsigned char *ele, size_t elesize, uint32_t *idx) {
+    uint64_t h = crc64(0, ele, elesize);
+    uint32_t h1 = h & 0xffffffff;
+    uint32_t h2 = (h >> 32) | 1; /* Odd, so it is invertible mod the width. */
+    for (int i = 0; i < CMS_DEPTH; i++) idx[i] = (h1 + i * h2) & (CMS_WIDTH - 1);
+}
+
+/* Create an empty count-min sketch object. sdsnewlen() with NULL returns
+ * zeroed bytes, which is exactly an all-zero counter matrix. */
+static robj *createCmsObject(void) {
+    sds s = sdsnewlen(NULL, CMS_SIZE);
+    uint8_t *hdr = (uint8_t *)s;
+
+    memcpy(hdr, CMS_MAGIC, 4);
+    hdr[4] = CMS_VERSION;
+    hdr[5] = CMS_DEPTH;
+    sketchSetU32(hdr + 8, CMS_WIDTH);
+    return createObject(OBJ_STRING, s);
+}
+
+/* Check that the object is a string holding a valid count-min sketch.
+ * Return C_OK if so, otherwise reply with an error and return C_ERR. */
+static int isCmsObjectOrReply(client *c, robj *o) {
+    uint8_t *hdr;
+
+    if (checkType(c, o, OBJ_STRING)) return C_ERR; /* Error already sent. */
+    if (!sdsEncodedObject(o)) goto invalid;
+    if (stringObjectLen(o) != CMS_SIZE) goto invalid;
+    hdr = o->ptr;
+    if (memcmp(hdr, CMS_MAGIC, 4) != 0) goto invalid;
+    if (hdr[4] != CMS_VERSION || hdr[5] != CMS_DEPTH) goto invalid;
+    if (sketchGetU32(hdr + 8) != CMS_WIDTH) goto invalid;
+    return C_OK;
+
+invalid:
+    addReplyError(c, invalid_cms_err);
+    return C_ERR;
+}
+
+/* Add 'incr' to the counters of 'ele' and return the updated estimate.
+ * Counters saturate at UINT32_MAX instead of wrapping. */
+static uint64_t cmsIncrBy(robj *o, const unsigned char *ele, size_t elesize, uint64_t incr) {
+    uint8_t *counters = (uint8_t *)o->ptr + CMS_HDR_SIZE;
+    uint32_t idx[CMS_DEPTH];
+    uint64_t min = UINT32_MAX;
+
+    cmsRowIndexes(ele, elesize, idx);
+    for (int i = 0; i < CMS_DEPTH; i++) {
+        uint8_t *p = counters + ((size_t)i * CMS_WIDTH + idx[i]) * 4;
+        uint64_t v = sketchGetU32(p) + incr;
+        if (v > UINT32_MAX) v = UINT32_MAX;
+        sketchSetU32(p, v);
+        if (v < min) min = v;
+    }
+    uint8_t *hdr = o->ptr;
+    sketchSetU64(hdr + 12, sketchGetU64(hdr + 12) + incr);
+    return min;
+}
+
+/* Return the estimated count of 'ele' (minimum across rows). */
+static uint64_t cmsQuery(robj *o, const unsigned char *ele, size_t elesize) {
+    uint8_t *counters = (uint8_t *)o->ptr + CMS_HDR_SIZE;
+    uint32_t idx[CMS_DEPTH];
+    uint64_t min = UINT32_MAX;
+
+    cmsRowIndexes(ele, elesize, idx);
+    for (int i = 0; i < CMS_DEPTH; i++) {
+        uint64_t v = sketchGetU32(counters + ((size_t)i * CMS_WIDTH + idx[i]) * 4);
+        if (v < min) min = v;
+    }
+    return min;
+}
+
+/* CMSINCRBY key item increment [item increment ...]
+ * Reply: array with the updated estimate of every item. */
+void cmsIncrByCommand(client *c) {
+    robj *o;
+    int pairs = (c->argc - 2) / 2;
+
+    if (c->argc % 2 != 0) {
+        addReplyErrorArity(c);
+        return;
+    }
+
+    /* Validate all the increments before touching the sketch so the
+     * command is all-or-nothing. */
+    long long incrs_static[16], *incrs = incrs_static;
+    if (pairs > 16) incrs = zmalloc(sizeof(long long) * pairs);
+    for (int j = 0; j < pairs; j++) {
+        if (getLongLongFromObjectOrReply(c, c->argv[3 + j * 2], &incrs[j], NULL) != C_OK) {
+            if (incrs != incrs_static) zfree(incrs);
+            return;
+        }
+        if (incrs[j] < 0) {
+            addReplyError(c, "increment must be a non negative integer");
+            if (incrs != incrs_static) zfree(incrs);
+            return;
+        }
+    }
+
+    o = lookupKeyWrite(c->db, c->argv[1]);
+    if (o == NULL) {
+        o = createCmsObject();
+        dbAdd(c->db, c->argv[1], &o);
+    } else {
+        if (isCmsObjectOrReply(c, o) != C_OK) {
+            if (incrs != incrs_static) zfree(incrs);
+            return;
+        }
+        o = dbUnshareStringValue(c->db, c->argv[1], o);
+    }
+
+    addReplyArrayLen(c, pairs);
+    for (int j = 0; j < pairs; j++) {
+        sds ele = c->argv[2 + j * 2]->ptr;
+        addReplyLongLong(c, cmsIncrBy(o, (unsigned char *)ele, sdslen(ele), incrs[j]));
+    }
+    if (incrs != incrs_static) zfree(incrs);
+
+    signalModifiedKey(c, c->db, c->argv[1]);
+    notifyKeyspaceEvent(NOTIFY_STRING, "cmsincrby", c->argv[1], c->db->id);
+    server.dirty++;
+}
+
+/* CMSQUERY key item [item ...]
+ * Reply: array with the estimated count of every item. A missing key is
+ * an empty sketch, so every estimate is zero. */
+void cmsQueryCommand(client *c) {
+    robj *o = lookupKeyRead(c->db, c->argv[1]);
+
+    if (o != NULL && isCmsObjectOrReply(c, o) != C_OK) return;
+    addReplyArrayLen(c, c->argc - 2);
+    for (int j = 2; j < c->argc; j++) {
+        if (o == NULL) {
+            addReply(c, shared.czero);
+        } else {
+            sds ele = c->argv[j]->ptr;
+            addReplyLongLong(c, cmsQuery(o, (unsigned char *)ele, sdslen(ele)));
+        }
+    }
+}
+
+/* CMSMERGE destkey sourcekey [sourcekey ...]
+ * Merge source sketches into the destination by summing counters cell by
+ * cell (saturating). All sketches share the fixed geometry so merging is
+ * a straight vector addition. Missing sources are treated as empty. */
+void cmsMergeCommand(client *c) {
+    robj *dest = lookupKeyWrite(c->db, c->argv[1]);
+
+    if (dest != NULL && isCmsObjectOrReply(c, dest) != C_OK) return;
+
+    /* Validate every source before creating or mutating the destination,
+     * so a type error leaves the keyspace untouched. */
+    for (int j = 2; j < c->argc; j++) {
+        robj *src = lookupKeyRead(c->db, c->argv[j]);
+        if (src != NULL && isCmsObjectOrReply(c, src) != C_OK) return;
+    }
+
+    if (dest == NULL) {
+        dest = createCmsObject();
+        dbAdd(c->db, c->argv[1], &dest);
+    } else {
+        dest = dbUnshareStringValue(c->db, c->argv[1], dest);
+    }
+
+    uint8_t *dhdr = dest->ptr;
+    uint8_t *dcnt = dhdr + CMS_HDR_SIZE;
+    for (int j = 2; j < c->argc; j++) {
+        robj *src = lookupKeyRead(c->db, c->argv[j]);
+        if (src == NULL) continue;
+        uint8_t *shdr = src->ptr;
+        uint8_t *scnt = shdr + CMS_HDR_SIZE;
+        for (size_t i = 0; i < (size_t)CMS_WIDTH * CMS_DEPTH; i++) {
+            uint64_t v = (uint64_t)sketchGetU32(dcnt + i * 4) + sketchGetU32(scnt + i * 4);
+            if (v > UINT32_MAX) v = UINT32_MAX;
+            sketchSetU32(dcnt + i * 4, v);
+        }
+        sketchSetU64(dhdr + 12, sketchGetU64(dhdr + 12) + sketchGetU64(shdr + 12));
+    }
+
+    signalModifiedKey(c, c->db, c->argv[1]);
+    notifyKeyspaceEvent(NOTIFY_STRING, "cmsmerge", c->argv[1], c->db->id);
+    server.dirty++;
+    addReply(c, shared.ok);
+}
+
+/* CMSINFO key
+ * Reply: map with the sketch geometry and the total of all increments. */
+void cmsInfoCommand(client *c) {
+    robj *o = lookupKeyRead(c->db, c->argv[1]);
+
+    if (o == NULL) {
+        addReplyError(c, "no such key");
+        return;
+    }
+    if (isCmsObjectOrReply(c, o) != C_OK) return;
+    uint8_t *hdr = o->ptr;
+    addReplyMapLen(c, 4);
+    addReplyBulkCString(c, "width");
+    addReplyLongLong(c, CMS_WIDTH);
+    addReplyBulkCString(c, "depth");
+    addReplyLongLong(c, CMS_DEPTH);
+    addReplyBulkCString(c, "count");
+    addReplyLongLong(c, sketchGetU64(hdr + 12));
+    addReplyBulkCString(c, "size");
+    addReplyLongLong(c, CMS_SIZE);
+}
+
+/* ========================= SpaceSaving top-K ============================= */
+
+static inline uint8_t *topkSlot(robj *o, int i) {
+    return (uint8_t *)o->ptr + TOPK_HDR_SIZE + (size_t)i * TOPK_SLOT_SIZE;
+}
+
+static robj *createTopkObject(void) {
+    sds s = sdsnewlen(NULL, TOPK_SIZE);
+    uint8_t *hdr = (uint8_t *)s;
+
+    memcpy(hdr, TOPK_MAGIC, 4);
+    hdr[4] = TOPK_VERSION;
+    sketchSetU32(hdr + 8, TOPK_K);
+    return createObject(OBJ_STRING, s);
+}
+
+static int isTopkObjectOrReply(client *c, robj *o) {
+    uint8_t *hdr;
+
+    if (checkType(c, o, OBJ_STRING)) return C_ERR; /* Error already sent. */
+    if (!sdsEncodedObject(o)) goto invalid;
+    if (stringObjectLen(o) != TOPK_SIZE) goto invalid;
+    hdr = o->ptr;
+    if (memcmp(hdr, TOPK_MAGIC, 4) != 0) goto invalid;
+    if (hdr[4] != TOPK_VERSION) goto invalid;
+    if (sketchGetU32(hdr + 8) != TOPK_K) goto invalid;
+    return C_OK;
+
+invalid:
+    addReplyError(c, invalid_topk_err);
+    return C_ERR;
+}
+
+/* Record one occurrence of 'ele' in the summary. If a candidate had to be
+ * evicted to make room, its item is copied into 'evicted' (at least
+ * TOPK_ITEM_MAX bytes), its length stored in *evictedlen, and 1 is
+ * returned; otherwise 0. SpaceSaving guarantees every item whose true
+ * count exceeds total/K is present in the slots. */
+static int topkAdd(robj *o, const unsigned char *ele, size_t elesize, uint8_t *evicted, size_t *evictedlen) {
+    int minslot = 0, freeslot = -1;
+    uint32_t mincount = UINT32_MAX;
+
+    for (int i = 0; i < TOPK_K; i++) {
+        uint8_t *slot = topkSlot(o, i);
+        uint32_t count = sketchGetU32(slot);
+        if (count == 0) {
+            if (freeslot == -1) freeslot = i;
+            continue;
+        }
+        if (slot[8] == elesize && memcmp(slot + 9, ele, elesize) == 0) {
+            if (count < UINT32_MAX) sketchSetU32(slot, count + 1);
+            return 0;
+        }
+        if (count < mincount) {
+            mincount = count;
+            minslot = i;
+        }
+    }
+    if (freeslot != -1) {
+        uint8_t *slot = topkSlot(o, freeslot);
+        sketchSetU32(slot, 1);
+        sketchSetU32(slot + 4, 0);
+        slot[8] = elesize;
+        memcpy(slot + 9, ele, elesize);
+        return 0;
+    }
+    /* All slots taken: evict the minimum and let the newcomer inherit its
+     * count. The inherited amount is kept as the slot's error bound. */
+    uint8_t *slot = topkSlot(o, minslot);
+    *evictedlen = slot[8];
+    memcpy(evicted, slot + 9, slot[8]);
+    sketchSetU32(slot, mincount + 1);
+    sketchSetU32(slot + 4, mincount);
+    slot[8] = elesize;
+    memcpy(slot + 9, ele, elesize);
+    return 1;
+}
+
+/* TOPKADD key item [item ...]
+ * Reply: array with, for every added item, the candidate it evicted from
+ * the summary or nil if nothing was displaced. */
+void topkAddCommand(client *c) {
+    robj *o;
+
+    for (int j = 2; j < c->argc; j++) {
+        if (sdslen(c->argv[j]->ptr) > TOPK_ITEM_MAX) {
+            addReplyError(c, "item is too long for a top-K summary (max 255 bytes)");
+            return;
+        }
+    }
+
+    o = lookupKeyWrite(c->db, c->argv[1]);
+    if (o == NULL) {
+        o = createTopkObject();
+        dbAdd(c->db, c->argv[1], &o);
+    } else {
+        if (isTopkObjectOrReply(c, o) != C_OK) return;
+        o = dbUnshareStringValue(c->db, c->argv[1], o);
+    }
+
+    addReplyArrayLen(c, c->argc - 2);
+    for (int j = 2; j < c->argc; j++) {
+        sds ele = c->argv[j]->ptr;
+        uint8_t evicted[TOPK_ITEM_MAX];
+        size_t evictedlen;
+        if (topkAdd(o, (unsigned char *)ele, sdslen(ele), evicted, &evictedlen)) {
+            addReplyBulkCBuffer(c, evicted, evictedlen);
+        } else {
+            addReplyNull(c);
+        }
+    }
+
+    signalModifiedKey(c, c->db, c->argv[1]);
+    notifyKeyspaceEvent(NOTIFY_STRING, "topkadd", c->argv[1], c->db->id);
+    server.dirty++;
+}
+
+/* TOPKLIST key
+ * Reply: flat array of item, count, error triplets sorted by descending
+ * count. A missing key is an empty summary. */
+void topkListCommand(client *c) {
+    robj *o = lookupKeyRead(c->db, c->argv[1]);
+
+    if (o == NULL) {
+        addReplyArrayLen(c, 0);
+        return;
+    }
+    if (isTopkObjectOrReply(c, o) != C_OK) return;
+
+    /* K is small and fixed, selection sort over an index array is fine. */
+    int order[TOPK_K], used = 0;
+    for (int i = 0; i < TOPK_K; i++) {
+        if (sketchGetU32(topkSlot(o, i)) > 0) order[used++] = i;
+    }
+    for (int i = 0; i < used; i++) {
+        int best = i;
+        for (int j = i + 1; j < used; j++) {
+            if (sketchGetU32(topkSlot(o, order[j])) > sketchGetU32(topkSlot(o, order[best]))) best = j;
+        }
+        int tmp = order[i];
+        order[i] = order[best];
+        order[best] = tmp;
+    }
+
+    addReplyArrayLen(c, used * 3);
+    for (int i = 0; i < used; i++) {
+        uint8_t *slot = topkSlot(o, order[i]);
+        addReplyBulkCBuffer(c, slot + 9, slot[8]);
+        addReplyLongLong(c, sketchGetU32(slot));
+        addReplyLongLong(c, sketchGetU32(slot + 4));
+    }
+}
@@ -98,15 +98,31 @@ void commandlogInit(void) {
 /* Push a new entry into the command log.
  * This function will make sure to trim the command log accordingly to the
  * configured max length. */
-static void commandlogPushEntryIfNeeded(client *c, robj **argv, int argc, long long value, int type) {
-    if (server.commandlog[type].threshold < 0 || server.commandlog[type].max_len == 0) return; /* The corresponding commandlog disabled */
-    if (value >= server.commandlog[type].threshold)
-        listAddNodeHead(server.commandlog[type].entries, commandlogCreateEntry(c, argv, argc, value, type));
+static void commandlogPushEntry(client *c, robj **argv, int argc, long long value, int type) {
+    listAddNodeHead(server.commandlog[type].entries, commandlogCreateEntry(c, argv, argc, value, type));
 
     /* Remove old entries if needed. */
     while (listLength(server.commandlog[type].entries) > server.commandlog[type].max_len) listDelNode(server.commandlog[type].entries, listLast(server.commandlog[type].entries));
 }
 
+static void commandlogPushEntryIfNeeded(client *c, robj **argv, int argc, long long value, int type) {
+    if (server.commandlog[type].threshold < 0 || server.commandlog[type].max_len == 0) return; /* The corresponding commandlog disabled */
+    if (value >= server.commandlog[type].threshold) commandlogPushEntry(c, argv, argc, value, type);
+}
+
+/* Push one command out of every commandlog[TRACE].threshold executed ones into
+ * the trace log, recording the microsecond execution timestamp as the entry
+ * value. Unlike the threshold-triggered logs, the trace log is an unbiased
+ * sample of the traffic mix, cheap enough to leave running in production and
+ * usable to reconstruct a workload for benchmarking. */
+static void commandlogPushTraceIfNeeded(client *c, robj **argv, int argc) {
+    static long long traced_commands = 0;
+    long long rate = server.commandlog[COMMANDLOG_TYPE_TRACE].threshold;
+    if (rate < 1 || server.commandlog[COMMANDLOG_TYPE_TRACE].max_len == 0) return; /* Tracing disabled */
+    if (++traced_commands % rate != 0) return;
+    commandlogPushEntry(c, argv, argc, ustime(), COMMANDLOG_TYPE_TRACE);
+}
+
 /* Remove all the entries from the current command log of the specified type. */
 static void commandlogReset(int type) {
     while (listLength(server.commandlog[type].entries) > 0) listDelNode(server.commandlog[type].entries, listLast(server.commandlog[type].entries));
@@ -159,6 +175,7 @@ void commandlogPushCurrentCommand(client *c, struct serverCommand *cmd) {
     commandlogPushEntryIfNeeded(c, argv, argc, c->duration, COMMANDLOG_TYPE_SLOW);
     commandlogPushEntryIfNeeded(c, argv, argc, c->net_input_bytes_curr_cmd, COMMANDLOG_TYPE_LARGE_REQUEST);
     commandlogPushEntryIfNeeded(c, argv, argc, c->net_output_bytes_curr_cmd, COMMANDLOG_TYPE_LARGE_REPLY);
+    commandlogPushTraceIfNeeded(c, argv, argc);
 }
 
 /* The SLOWLOG command. Implements all the subcommands needed to handle the
@@ -209,7 +226,8 @@ static int commandlogGetTypeOrReply(client *c, robj *o) {
     if (!strcasecmp(o->ptr, "slow")) return COMMANDLOG_TYPE_SLOW;
     if (!strcasecmp(o->ptr, "large-request")) return COMMANDLOG_TYPE_LARGE_REQUEST;
     if (!strcasecmp(o->ptr, "large-reply")) return COMMANDLOG_TYPE_LARGE_REPLY;
-    addReplyError(c, "type should be one of the following: slow, large-request, large-reply");
+    if (!strcasecmp(o->ptr, "trace")) return COMMANDLOG_TYPE_TRACE;
+    addReplyError(c, "type should be one of the following: slow, large-request, large-reply, trace");
     return -1;
 }
 
@@ -225,7 +243,8 @@ void commandlogCommand(client *c) {
             "    id, timestamp,",
             "        time in microseconds for type of slow,",
             "        or size in bytes for type of large-request,",
-            "        or size in bytes for type of large-reply",
+            "        or size in bytes for type of large-reply,",
+            "        or microsecond execution timestamp for type of trace",
             "    arguments array, client IP and port,",
             "    client name",
             "LEN <type>",
@@ -97,6 +97,17 @@
 #define HAVE_EPOLL 1
 #endif
 
+/* io_uring based polling is opt-in (make USE_IOURING=yes) since it
+ * requires Linux 5.13+ (multishot poll) at runtime. */
+#if defined(__linux__) && defined(USE_IOURING)
+#define HAVE_IOURING 1
+#endif
+
+/* Test for MSG_ZEROCOPY send support */
+#ifdef __linux__
+#define HAVE_MSG_ZEROCOPY 1
+#endif
+
 /* Test for accept4() */
 #if defined(__linux__) || defined(__FreeBSD__) || defined(OpenBSD5_7) || \
     (defined(__DragonFly__) && __DragonFly_version >= 400305) ||         \
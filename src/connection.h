@@ -57,6 +57,7 @@ typedef enum {
 #define CONN_FLAG_CLOSE_SCHEDULED (1 << 0)      /* Closed scheduled by a handler */
 #define CONN_FLAG_WRITE_BARRIER (1 << 1)        /* Write barrier requested */
 #define CONN_FLAG_ALLOW_ACCEPT_OFFLOAD (1 << 2) /* Connection accept can be offloaded to IO threads. */
+#define CONN_FLAG_TX_ZEROCOPY (1 << 3)          /* SO_ZEROCOPY was enabled on the socket */
 
 #define CONN_TYPE_SOCKET "tcp"
 #define CONN_TYPE_UNIX "unix"
@@ -101,6 +102,10 @@ typedef struct ConnectionType {
     /* IO */
     int (*write)(struct connection *conn, const void *data, size_t data_len);
     int (*writev)(struct connection *conn, const struct iovec *iov, int iovcnt);
+    /* Optional zero-copy write support (NULL when the type can't provide it).
+     * See connWritevZeroCopy() / connReapZeroCopyCompletions() below. */
+    int (*writev_zerocopy)(struct connection *conn, const struct iovec *iov, int iovcnt);
+    void (*reap_zerocopy)(struct connection *conn);
     int (*read)(struct connection *conn, void *buf, size_t buf_len);
     int (*set_write_handler)(struct connection *conn, ConnectionCallbackFunc handler, int barrier);
     int (*set_read_handler)(struct connection *conn, ConnectionCallbackFunc handler);
@@ -134,6 +139,12 @@ struct connection {
     short int flags;
     short int refs;
     unsigned short int iovcnt;
+    /* Zero-copy write bookkeeping: the kernel numbers MSG_ZEROCOPY sends per
+     * socket starting from zero, so 'zcopy_next_seq' counts the sends we
+     * issued and 'zcopy_completed' the number of sends whose buffers were
+     * released by the kernel (completions are reported in order on TCP). */
+    unsigned int zcopy_next_seq;
+    unsigned int zcopy_completed;
     void *private_data;
     ConnectionCallbackFunc conn_handler;
     ConnectionCallbackFunc write_handler;
@@ -225,6 +236,31 @@ static inline int connWritev(connection *conn, const struct iovec *iov, int iovc
     return conn->type->writev(conn, iov, iovcnt);
 }
 
+/* Returns 1 if the connection type may write without copying the caller's
+ * buffers into the kernel. A zero-copy send pins the buffers until the kernel
+ * reports the completion: a caller observing 'zcopy_next_seq' advance MUST
+ * keep the iov memory untouched until connReapZeroCopyCompletions() shows
+ * 'zcopy_completed' caught up with that sequence number. */
+static inline int connMayZeroCopy(connection *conn) {
+    return conn->type->writev_zerocopy != NULL;
+}
+
+/* Like connWritev() but, when supported, asks the kernel to transmit the iov
+ * buffers without copying them. The implementation is free to fall back to a
+ * copying write (e.g. setsockopt failure or memory accounting pressure); the
+ * caller detects that no pinning is needed because 'zcopy_next_seq' did not
+ * move. */
+static inline int connWritevZeroCopy(connection *conn, const struct iovec *iov, int iovcnt) {
+    if (!connMayZeroCopy(conn)) return connWritev(conn, iov, iovcnt);
+    return conn->type->writev_zerocopy(conn, iov, iovcnt);
+}
+
+/* Drain the socket error queue and update conn->zcopy_completed with the
+ * zero-copy sends the kernel has released so far. */
+static inline void connReapZeroCopyCompletions(connection *conn) {
+    if (conn->type->reap_zerocopy) conn->type->reap_zerocopy(conn);
+}
+
 /* Read from the connection, behaves the same as read(2).
  *
  * Like read(2), a short read is possible.  A return value of 0 will indicate the
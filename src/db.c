@@ -45,6 +45,7 @@
 /* Flags for expireIfNeeded */
 #define EXPIRE_FORCE_DELETE_EXPIRED 1
 #define EXPIRE_AVOID_DELETE_EXPIRED 2
+#define EXPIRE_DEFER_DELETE_EXPIRED 4
 
 /* Return values for expireIfNeeded */
 typedef enum {
@@ -114,6 +115,12 @@ robj *lookupKey(serverDb *db, robj *key, int flags) {
         int expire_flags = 0;
         if (flags & LOOKUP_WRITE && !is_ro_replica) expire_flags |= EXPIRE_FORCE_DELETE_EXPIRED;
         if (flags & LOOKUP_NOEXPIRE) expire_flags |= EXPIRE_AVOID_DELETE_EXPIRED;
+        /* Read lookups don't need the deletion to happen inline: treating
+         * the key as a miss after the timestamp check is enough, and the
+         * actual reclaim can be done in batch before the next event loop
+         * sleep. This bounds the per-lookup cost when a large number of
+         * keys reach their TTL at the same moment. */
+        if (!(flags & LOOKUP_WRITE)) expire_flags |= EXPIRE_DEFER_DELETE_EXPIRED;
         if (expireIfNeededWithDictIndex(db, key, val, expire_flags, dict_index) != KEY_VALID) {
             /* The key is no longer valid. */
             val = NULL;
@@ -498,6 +505,7 @@ int dbGenericDeleteWithDictIndex(serverDb *db, robj *key, int async, int flags,
             decrRefCount(val);
         }
 
+        server.stat_deleted_keys++;
         return 1;
     } else {
         return 0;
@@ -661,7 +669,7 @@ serverDb *initTempDb(void) {
     serverDb *tempDb = zcalloc(sizeof(serverDb) * server.dbnum);
     for (int i = 0; i < server.dbnum; i++) {
         tempDb[i].id = i;
-        tempDb[i].keys = kvstoreCreate(&kvstoreKeysHashtableType, slot_count_bits, flags);
+        tempDb[i].keys = kvstoreCreate(&kvstoreKeysHashtableType, slot_count_bits, flags | KVSTORE_TRACK_WRITE_ACTIVITY);
         tempDb[i].expires = kvstoreCreate(&kvstoreExpiresHashtableType, slot_count_bits, flags);
     }
 
@@ -704,11 +712,124 @@ long long dbTotalServerKeyCount(void) {
  * Every time a DB is flushed the function signalFlushDb() is called.
  *----------------------------------------------------------------------------*/
 
+/* -----------------------------------------------------------------------------
+ * Dirty-key changelog ring
+ *
+ * Incremental export pipelines (warehouse mirroring, cache invalidation
+ * fan-out) used to poll SCAN over the whole keyspace to discover what
+ * changed. When changelog-ring-size is non zero every key modification
+ * appends a compact (version, slot, key hash) record to a ring that the
+ * CHANGELOG command drains with cursor semantics: a consumer remembers the
+ * last version it saw and asks for everything after it. Slow consumers that
+ * fall behind by more than the ring capacity are told records were lost so
+ * they can fall back to a full rescan.
+ *----------------------------------------------------------------------------*/
+
+typedef struct changelogRecord {
+    uint64_t version; /* Monotonic modification counter, never reused. */
+    uint64_t keyhash; /* Keyspace hash of the key name. */
+    uint32_t slot;    /* Cluster slot of the key, 0 in standalone mode. */
+} changelogRecord;
+
+static changelogRecord *changelog_ring = NULL;
+static uint64_t changelog_ring_entries = 0; /* Allocated slots, power of two. */
+static uint64_t changelog_next = 0;         /* Version of the next record. */
+static uint64_t changelog_floor = 0;        /* Versions at or below this were dropped by a resize. */
+
+/* (Re)allocate the ring to match changelog-ring-size. Versions keep
+ * counting across resizes so existing cursors stay valid, but the old
+ * records are dropped: consumers see that as falling behind. */
+void changelogResizeRing(void) {
+    uint64_t entries = 0;
+    if (server.changelog_ring_size > 0) {
+        entries = 1;
+        while (entries < server.changelog_ring_size) entries <<= 1;
+    }
+    if (entries == changelog_ring_entries) return;
+    zfree(changelog_ring);
+    changelog_ring = entries ? zcalloc(sizeof(changelogRecord) * entries) : NULL;
+    changelog_ring_entries = entries;
+    changelog_floor = changelog_next;
+}
+
+static void changelogRecordKey(robj *key) {
+    uint64_t version = ++changelog_next;
+    changelogRecord *rec = &changelog_ring[(version - 1) & (changelog_ring_entries - 1)];
+    rec->version = version;
+    rec->keyhash = dictSdsHash(key->ptr);
+    rec->slot = server.cluster_enabled ? (uint32_t)getKeySlot(key->ptr) : 0;
+}
+
+/* CHANGELOG cursor [COUNT count]
+ *
+ * Return the modification records with a version greater than 'cursor', at
+ * most 'count' of them (default 100). The reply is a three element array:
+ * the cursor to pass on the next call, a flag telling whether records were
+ * lost between the cursor and the first returned record, and the records
+ * themselves as (version, slot, key hash) triplets. */
+void changelogCommand(client *c) {
+    long long cursor;
+    long count = 100;
+
+    if (getLongLongFromObjectOrReply(c, c->argv[1], &cursor, NULL) != C_OK) return;
+    if (cursor < 0) {
+        addReplyError(c, "cursor is out of range");
+        return;
+    }
+    if (c->argc == 4 && !strcasecmp(c->argv[2]->ptr, "count")) {
+        if (getRangeLongFromObjectOrReply(c, c->argv[3], 1, LONG_MAX, &count, NULL) != C_OK) return;
+    } else if (c->argc != 2) {
+        addReplyErrorObject(c, shared.syntaxerr);
+        return;
+    }
+    if (changelog_ring_entries == 0) {
+        addReplyError(c, "The changelog is disabled, set changelog-ring-size to enable it");
+        return;
+    }
+
+    uint64_t head = changelog_next;
+    if ((uint64_t)cursor > head) {
+        /* A cursor past the head would make 'avail' underflow and replay
+         * uninitialized ring slots. */
+        addReplyError(c, "cursor is out of range");
+        return;
+    }
+    uint64_t oldest = head > changelog_ring_entries ? head - changelog_ring_entries : 0;
+    if (oldest < changelog_floor) oldest = changelog_floor;
+    int lost = 0;
+    if ((uint64_t)cursor < oldest) {
+        /* The consumer fell behind by more than the ring capacity: jump
+         * ahead and let it know it has to rescan. */
+        cursor = oldest;
+        lost = 1;
+    }
+    uint64_t avail = head - cursor;
+    if ((uint64_t)count > avail) count = (long)avail;
+
+    addReplyArrayLen(c, 3);
+    addReplyLongLong(c, cursor + count);
+    addReplyLongLong(c, lost);
+    addReplyArrayLen(c, count);
+    for (long i = 0; i < count; i++) {
+        changelogRecord *rec = &changelog_ring[((uint64_t)cursor + i) & (changelog_ring_entries - 1)];
+        addReplyArrayLen(c, 3);
+        addReplyLongLong(c, rec->version);
+        addReplyLongLong(c, rec->slot);
+        addReplyLongLong(c, rec->keyhash);
+    }
+}
+
 /* Note that the 'c' argument may be NULL if the key was modified out of
  * a context of a client. */
 void signalModifiedKey(client *c, serverDb *db, robj *key) {
+    /* Feed the per-slot write counters that order the snapshot child's
+     * keyspace walk; getKeySlot() is cheap here since the executing command
+     * has usually cached the slot on the client already. */
+    if (server.cluster_enabled) kvstoreHashtableMarkDirty(db->keys, getKeySlot(key->ptr));
     touchWatchedKey(db, key);
     trackingInvalidateKey(c, key, 1);
+    dumpPayloadCacheInvalidate(key);
+    if (changelog_ring_entries) changelogRecordKey(key);
 }
 
 void signalFlushedDb(int dbid, int async) {
@@ -726,6 +847,7 @@ void signalFlushedDb(int dbid, int async) {
     }
 
     trackingInvalidateKeysOnFlush(async);
+    dumpPayloadCacheFlush();
 
     /* Changes in this method may take place in swapMainDbWithTempDb as well,
      * where we execute similar calls, but with subtle differences as it's
@@ -822,6 +944,13 @@ void flushallCommand(client *c) {
 void delGenericCommand(client *c, int lazy) {
     int numdel = 0, j;
 
+    /* With multiple keys, hand the unlinked values to the lazyfree thread as
+     * a single batched job instead of one job per key. The command itself is
+     * already propagated as one record; signalModifiedKey() and the "del"
+     * notification stay per key since WATCH and keyspace events are per-key
+     * by design. */
+    int batch = lazy && c->argc > 2;
+    if (batch) lazyfreeBatchBegin();
     for (j = 1; j < c->argc; j++) {
         if (expireIfNeeded(c->db, c->argv[j], NULL, 0) == KEY_DELETED) continue;
         int deleted = lazy ? dbAsyncDelete(c->db, c->argv[j]) : dbSyncDelete(c->db, c->argv[j]);
@@ -832,6 +961,7 @@ void delGenericCommand(client *c, int lazy) {
             numdel++;
         }
     }
+    if (batch) lazyfreeBatchEnd();
     addReplyLongLong(c, numdel);
 }
 
@@ -887,11 +1017,22 @@ void keysCommand(client *c) {
     sds pattern = c->argv[1]->ptr;
     int plen = sdslen(pattern), allkeys, pslot = -1;
     unsigned long numkeys = 0;
-    void *replylen = addReplyDeferredLen(c);
     allkeys = (pattern[0] == '*' && plen == 1);
     if (server.cluster_enabled && !allkeys) {
         pslot = patternHashSlot(pattern, plen);
     }
+
+    /* When incremental execution is enabled, block the client and scan the
+     * keyspace in cursor slices from beforeSleep() instead of holding the
+     * event loop for the whole table. The guarantees become those of SCAN:
+     * keys present for the whole scan are returned, keys added or removed
+     * meanwhile may or may not be. */
+    if (server.keys_incremental_scan && !c->flag.deny_blocking) {
+        blockClientForIncrementalScan(c, pslot);
+        return;
+    }
+
+    void *replylen = addReplyDeferredLen(c);
     kvstoreHashtableIterator *kvs_di = NULL;
     kvstoreIterator *kvs_it = NULL;
     if (pslot != -1) {
@@ -916,6 +1057,68 @@ void keysCommand(client *c) {
     setDeferredArrayLen(c, replylen, numkeys);
 }
 
+/* Time budget per event loop iteration for clients executing KEYS in cursor
+ * slices, in microseconds. */
+#define INCREMENTAL_SCAN_SLICE_DURATION 1000
+
+/* Scan callback for incremental KEYS: collects a copy of every matching,
+ * non-expired key in the client's blocking state. */
+static void incrementalKeysScanCallback(void *privdata, void *entry) {
+    client *c = privdata;
+    robj *val = entry;
+    sds key = objectGetKey(val);
+    sds pattern = c->argv[1]->ptr;
+    int plen = sdslen(pattern);
+    int allkeys = (pattern[0] == '*' && plen == 1);
+    if ((allkeys || stringmatchlen(pattern, plen, key, sdslen(key), 0)) && !objectIsExpired(val)) {
+        /* The key may be deleted before the scan completes, so keep a copy. */
+        listAddNodeTail(c->bstate->scan_keys, sdsdup(key));
+    }
+}
+
+/* Emit the keys collected so far by a client blocked in BLOCKED_SCAN. */
+void replyToScanBlockedClient(client *c) {
+    list *keys = c->bstate->scan_keys;
+    listIter li;
+    listNode *ln;
+    addReplyArrayLen(c, listLength(keys));
+    listRewind(keys, &li);
+    while ((ln = listNext(&li))) {
+        sds key = listNodeValue(ln);
+        addReplyBulkCBuffer(c, key, sdslen(key));
+    }
+}
+
+/* Called from beforeSleep() to advance the clients executing KEYS in cursor
+ * slices (see keysCommand). Each call scans under a fixed time budget; when a
+ * client's cursor wraps around, the collected keys are emitted and the client
+ * is unblocked. */
+void incrementalScanSliceCycle(void) {
+    long long start = ustime();
+    listNode *ln;
+    while ((ln = listFirst(server.scan_slice_clients)) != NULL) {
+        client *c = listNodeValue(ln);
+        int iterations = 0;
+        int done = 0;
+        while (1) {
+            c->bstate->scan_cursor = kvstoreScan(c->db->keys, c->bstate->scan_cursor, c->bstate->scan_slot,
+                                                 incrementalKeysScanCallback, NULL, c);
+            if (c->bstate->scan_cursor == 0) {
+                done = 1;
+                break;
+            }
+            /* Checking the clock is costly compared to scanning one bucket,
+             * do it every few iterations. */
+            if ((++iterations & 63) == 0 && ustime() - start >= INCREMENTAL_SCAN_SLICE_DURATION) break;
+        }
+        if (!done) return; /* Budget exhausted, resume in the next cycle. */
+        replyToScanBlockedClient(c);
+        updateStatsOnUnblock(c, 0, 0, 0);
+        if (c->flag.pending_command) c->flag.pending_command = 0;
+        unblockClient(c, 1);
+    }
+}
+
 /* Data used by the dict scan callback. */
 typedef struct {
     list *keys;     /* elements that collect from dict */
@@ -1649,6 +1852,9 @@ int dbSwapDatabases(int id1, int id2) {
     touchAllWatchedKeysInDb(db1, db2);
     touchAllWatchedKeysInDb(db2, db1);
 
+    /* Cached DUMP payloads are bound to a db id, drop them all. */
+    dumpPayloadCacheFlush();
+
     /* Try to unblock any XREADGROUP clients if the key no longer exists. */
     scanDatabaseForDeletedKeys(db1, db2);
     scanDatabaseForDeletedKeys(db2, db1);
@@ -1684,6 +1890,8 @@ int dbSwapDatabases(int id1, int id2) {
  * database (temp) as the main (active) database, the actual freeing of old database
  * (which will now be placed in the temp one) is done later. */
 void swapMainDbWithTempDb(serverDb *tempDb) {
+    /* Every database changes identity, no cached DUMP payload survives. */
+    dumpPayloadCacheFlush();
     for (int i = 0; i < server.dbnum; i++) {
         serverDb aux = server.db[i];
         serverDb *activedb = &server.db[i], *newdb = &tempDb[i];
@@ -1873,11 +2081,36 @@ void deleteExpiredKeyFromOverwriteAndPropagate(client *c, robj *keyobj) {
  *    postExecutionUnitOperations, preferably just after a
  *    single deletion batch, so that DEL/UNLINK will NOT be wrapped
  *    in MULTI/EXEC */
+/* Maximum number of keys folded into a single propagated DEL/UNLINK. The cap
+ * keeps a mass expiry from producing arbitrarily large command frames in the
+ * replication stream and the AOF. */
+#define DELETION_PROPAGATION_MAX_KEYS 64
+
 void propagateDeletion(serverDb *db, robj *key, int lazy) {
     robj *argv[2];
 
     argv[0] = lazy ? shared.unlink : shared.del;
     argv[1] = key;
+
+    /* Mass deletions (e.g. a TTL cliff hitting the active expire cycle)
+     * stage one DEL/UNLINK per key before the execution unit flushes them.
+     * Fold consecutive deletions for the same database into a single
+     * multi-key command: replicas and the AOF then see one command frame
+     * instead of hundreds. Ordering with respect to any interleaved
+     * propagation (e.g. writes performed by a module reacting to the
+     * keyspace event) is preserved because we only ever extend the most
+     * recently staged operation. */
+    if (server.also_propagate.numops > 0) {
+        serverOp *prev = &server.also_propagate.ops[server.also_propagate.numops - 1];
+        if (prev->argv[0] == argv[0] && prev->dbid == db->id && prev->target == (PROPAGATE_AOF | PROPAGATE_REPL) &&
+            prev->argc < DELETION_PROPAGATION_MAX_KEYS) {
+            prev->argv = zrealloc(prev->argv, sizeof(robj *) * (prev->argc + 1));
+            prev->argv[prev->argc++] = key;
+            incrRefCount(key);
+            return;
+        }
+    }
+
     incrRefCount(argv[0]);
     incrRefCount(argv[1]);
 
@@ -1992,6 +2225,14 @@ static keyStatus expireIfNeededWithDictIndex(serverDb *db, robj *key, robj *val,
      * will have failed over and the new primary will send us the expire. */
     if (isPausedActionsWithUpdate(PAUSE_ACTION_EXPIRE)) return KEY_EXPIRED;
 
+    /* The caller may not need the deletion to be performed right now, in
+     * which case we just queue the key and reclaim it in batch from
+     * beforeSleep(). The key is reported as expired either way. */
+    if (flags & EXPIRE_DEFER_DELETE_EXPIRED) {
+        deferExpiredKeyDeletion(db, key);
+        return KEY_EXPIRED;
+    }
+
     /* The key needs to be converted from static to heap before deleted */
     int static_key = key->refcount == OBJ_STATIC_REFCOUNT;
     if (static_key) {
@@ -433,6 +433,12 @@ void debugCommand(client *c) {
             "    Show low level info about `key` and associated value.",
             "    Some fields of the default behavior may be time consuming to fetch,",
             "    and `fast` can be passed to avoid fetching them.",
+            "OBJECT-CENSUS [<samples>]",
+            "    Sample <samples> random keys (default 1000) from the current DB and",
+            "    return estimated memory usage bucketed by type and encoding.",
+            "OBJECT-SAMPLES [<count>]",
+            "    Return <count> (key, freq, idle, size) tuples (default 100) sampled",
+            "    from the current DB the way the eviction pool samples keys.",
             "DROP-CLUSTER-PACKET-FILTER <packet-type>",
             "    Drop all packets that match the filtered type. Set to -1 allow all packets or -2 to drop all packets.",
             "CLOSE-CLUSTER-LINK-ON-PACKET-DROP <0|1>",
@@ -671,6 +677,117 @@ void debugCommand(client *c) {
         s = sdscatprintf(s, "%s", extra);
         addReplyStatusLength(c, s, sdslen(s));
         sdsfree(s);
+    } else if (!strcasecmp(c->argv[1]->ptr, "object-census") && (c->argc == 2 || c->argc == 3)) {
+        /* Sampled heap census: draw fair-random keys from the current DB and
+         * bucket their estimated sizes by type and encoding. Sampling keeps
+         * the cost bounded regardless of keyspace size, unlike issuing
+         * MEMORY USAGE for every key. */
+#define CENSUS_MAX_ENCODINGS 16
+        struct {
+            long long count;
+            long long volatile_count;
+            long long bytes;
+        } buckets[OBJ_TYPE_MAX][CENSUS_MAX_ENCODINGS];
+        memset(buckets, 0, sizeof(buckets));
+
+        long long samples = 1000;
+        if (c->argc == 3) {
+            if (getLongLongFromObjectOrReply(c, c->argv[2], &samples, NULL) != C_OK) return;
+            if (samples <= 0 || samples > 1000000) {
+                addReplyError(c, "samples must be between 1 and 1000000");
+                return;
+            }
+        }
+
+        long long sampled = 0;
+        if (kvstoreSize(c->db->keys) != 0) {
+            for (long long i = 0; i < samples; i++) {
+                void *entry;
+                int didx = kvstoreGetFairRandomHashtableIndex(c->db->keys);
+                if (!kvstoreHashtableFairRandomEntry(c->db->keys, didx, &entry)) continue;
+                robj *val = entry;
+                if (val->type >= OBJ_TYPE_MAX || val->encoding >= CENSUS_MAX_ENCODINGS) continue;
+                sds key = objectGetKey(val);
+                robj *keyobj = createStringObject(key, sdslen(key));
+                buckets[val->type][val->encoding].count++;
+                if (objectGetExpire(val) != -1) buckets[val->type][val->encoding].volatile_count++;
+                buckets[val->type][val->encoding].bytes +=
+                    objectComputeSize(keyobj, val, OBJ_COMPUTE_SIZE_DEF_SAMPLES, c->db->id);
+                decrRefCount(keyobj);
+                sampled++;
+            }
+        }
+
+        int nonempty = 0;
+        for (int t = 0; t < OBJ_TYPE_MAX; t++)
+            for (int e = 0; e < CENSUS_MAX_ENCODINGS; e++)
+                if (buckets[t][e].count) nonempty++;
+
+        addReplyMapLen(c, nonempty + 2);
+        addReplyBulkCString(c, "keys");
+        addReplyLongLong(c, kvstoreSize(c->db->keys));
+        addReplyBulkCString(c, "sampled");
+        addReplyLongLong(c, sampled);
+        for (int t = 0; t < OBJ_TYPE_MAX; t++) {
+            for (int e = 0; e < CENSUS_MAX_ENCODINGS; e++) {
+                if (!buckets[t][e].count) continue;
+                robj fake = {.type = t, .encoding = e};
+                /* getObjectTypeName() dereferences the module type for
+                 * OBJ_MODULE, which the fake object doesn't carry. */
+                char *tname = (t == OBJ_MODULE) ? "module" : getObjectTypeName(&fake);
+                sds name = sdscatprintf(sdsempty(), "%s:%s", tname, strEncoding(e));
+                addReplyBulkSds(c, name);
+                addReplyMapLen(c, 3);
+                addReplyBulkCString(c, "count");
+                addReplyLongLong(c, buckets[t][e].count);
+                addReplyBulkCString(c, "volatile");
+                addReplyLongLong(c, buckets[t][e].volatile_count);
+                addReplyBulkCString(c, "bytes");
+                addReplyLongLong(c, buckets[t][e].bytes);
+            }
+        }
+    } else if (!strcasecmp(c->argv[1]->ptr, "object-samples") && (c->argc == 2 || c->argc == 3)) {
+        /* Bulk export of per-key eviction metadata: returns up to <count>
+         * (key, freq, idle, size) tuples drawn with the same sampling the
+         * eviction pool uses, so cache-tuning jobs don't need one OBJECT
+         * FREQ round trip per key. */
+        long long wanted = 100;
+        if (c->argc == 3) {
+            if (getLongLongFromObjectOrReply(c, c->argv[2], &wanted, NULL) != C_OK) return;
+            if (wanted <= 0 || wanted > 1000000) {
+                addReplyError(c, "count must be between 1 and 1000000");
+                return;
+            }
+        }
+
+        int use_lfu = server.maxmemory_policy & MAXMEMORY_FLAG_LFU;
+        long long collected = 0;
+        int empty_draws = 0;
+        void *replylen = addReplyDeferredLen(c);
+        while (collected < wanted && kvstoreSize(c->db->keys) != 0) {
+            void *samples[64];
+            unsigned int batch = wanted - collected < 64 ? (unsigned int)(wanted - collected) : 64;
+            int slot = kvstoreGetFairRandomHashtableIndex(c->db->keys);
+            unsigned int n = kvstoreHashtableSampleEntries(c->db->keys, slot, &samples[0], batch);
+            if (n == 0) {
+                if (++empty_draws == 10) break;
+                continue;
+            }
+            empty_draws = 0;
+            for (unsigned int j = 0; j < n; j++) {
+                robj *val = samples[j];
+                sds key = objectGetKey(val);
+                robj *keyobj = createStringObject(key, sdslen(key));
+                addReplyArrayLen(c, 4);
+                addReplyBulkCBuffer(c, key, sdslen(key));
+                addReplyLongLong(c, use_lfu ? (long long)LFUDecrAndReturn(val) : -1);
+                addReplyLongLong(c, use_lfu ? -1 : (long long)(estimateObjectIdleTime(val) / 1000));
+                addReplyLongLong(c, objectComputeSize(keyobj, val, OBJ_COMPUTE_SIZE_DEF_SAMPLES, c->db->id));
+                decrRefCount(keyobj);
+                collected++;
+            }
+        }
+        setDeferredArrayLen(c, replylen, collected);
     } else if (!strcasecmp(c->argv[1]->ptr, "sdslen") && c->argc == 3) {
         robj *val;
         sds key;
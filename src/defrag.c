@@ -261,62 +261,16 @@ static dict *dictDefragTables(dict *d) {
     return ret;
 }
 
-/* Internal function used by zslDefrag */
-static void zslUpdateNode(zskiplist *zsl, zskiplistNode *oldnode, zskiplistNode *newnode, zskiplistNode **update) {
-    int i;
-    for (i = 0; i < zsl->level; i++) {
-        if (update[i]->level[i].forward == oldnode) update[i]->level[i].forward = newnode;
-    }
-    serverAssert(zsl->header != oldnode);
-    if (newnode->level[0].forward) {
-        serverAssert(newnode->level[0].forward->backward == oldnode);
-        newnode->level[0].forward->backward = newnode;
-    } else {
-        serverAssert(zsl->tail == oldnode);
-        zsl->tail = newnode;
-    }
-}
-
-/* Hashtable scan callback for sorted set. It defragments a single skiplist
- * node, updates skiplist pointers, and updates the hashtable pointer to the
- * node. */
+/* Hashtable scan callback for sorted set. Skiplist nodes live in the
+ * skiplist's arena and cannot be moved individually, so only the element
+ * string is defragmented; the node pointer stored in the hashtable and the
+ * skiplist links stay valid. */
 static void activeDefragZsetNode(void *privdata, void *entry_ref) {
-    zskiplist *zsl = privdata;
-    zskiplistNode **node_ref = (zskiplistNode **)entry_ref;
-    zskiplistNode *node = *node_ref;
+    UNUSED(privdata);
+    zskiplistNode *node = *(zskiplistNode **)entry_ref;
 
-    /* defragment node internals */
     sds newsds = activeDefragSds(node->ele);
     if (newsds) node->ele = newsds;
-
-    const double score = node->score;
-    const sds ele = node->ele;
-
-    /* find skiplist pointers that need to be updated if we end up moving the
-     * skiplist node. */
-    zskiplistNode *update[ZSKIPLIST_MAXLEVEL];
-    zskiplistNode *x = zsl->header;
-    for (int i = zsl->level - 1; i >= 0; i--) {
-        /* stop when we've reached the end of this level or the next node comes
-         * after our target in sorted order */
-        zskiplistNode *next = x->level[i].forward;
-        while (next &&
-               (next->score < score ||
-                (next->score == score && sdscmp(next->ele, ele) < 0))) {
-            x = next;
-            next = x->level[i].forward;
-        }
-        update[i] = x;
-    }
-    /* should have arrived at intended node */
-    serverAssert(x->level[0].forward == node);
-
-    /* try to defrag the skiplist record itself */
-    zskiplistNode *newnode = activeDefragAlloc(node);
-    if (newnode) {
-        zslUpdateNode(zsl, node, newnode, update);
-        *node_ref = newnode; /* update hashtable pointer */
-    }
 }
 
 #define DEFRAG_SDS_DICT_NO_VAL 0
@@ -367,6 +321,8 @@ static void activeDefragQuickListNode(quicklist *ql, quicklistNode **node_ref) {
         else
             ql->tail = newnode;
         *node_ref = node = newnode;
+        /* The seek index samples node pointers, drop it. */
+        quicklistSkipIndexInvalidate(ql);
     }
     if ((newzl = activeDefragAlloc(node->entry))) node->entry = newzl;
 }
@@ -491,10 +447,9 @@ static void defragZsetSkiplist(robj *ob) {
 
     zset *newzs;
     zskiplist *newzsl;
-    struct zskiplistNode *newheader;
     if ((newzs = activeDefragAlloc(zs))) ob->ptr = zs = newzs;
     if ((newzsl = activeDefragAlloc(zs->zsl))) zs->zsl = newzsl;
-    if ((newheader = activeDefragAlloc(zs->zsl->header))) zs->zsl->header = newheader;
+    /* The header node lives in the skiplist's arena and cannot be moved. */
 
     hashtable *newtable;
     if ((newtable = hashtableDefragTables(zs->ht, activeDefragAlloc))) zs->ht = newtable;
@@ -563,6 +518,8 @@ static int scanLaterStreamListpacks(robj *ob, unsigned long *cursor, monotime en
     }
 
     stream *s = ob->ptr;
+    /* Listpack nodes may be relocated below, drop the tail cache. */
+    s->tail_lp = NULL;
     raxStart(&ri, s->rax);
     if (*cursor == 0) {
         /* if cursor is 0, we start new iteration */
@@ -679,6 +636,10 @@ static void defragStream(robj *ob) {
     /* handle the main struct */
     if ((news = activeDefragAlloc(s))) ob->ptr = s = news;
 
+    /* Defragging the radix tree relocates its listpacks, drop the tail
+     * cache used by streamAppendItem(). */
+    s->tail_lp = NULL;
+
     if (raxSize(s->rax) > server.active_defrag_max_scan_fields) {
         rax *newrax = activeDefragAlloc(s->rax);
         if (newrax) s->rax = newrax;
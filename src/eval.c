@@ -45,6 +45,7 @@
 #include "resp_parser.h"
 #include "script.h"
 #include "lua/debug_lua.h"
+#include "lua/script_lua.h"
 #include "scripting_engine.h"
 #include "sds.h"
 
@@ -570,6 +571,15 @@ void scriptCommand(client *c) {
             "    Kill the currently executing Lua script.",
             "LOAD <script>",
             "    Load a script into the scripts cache without executing it.",
+            "PROFILE START [<sample-interval>]",
+            "    Start the sampling profiler, taking one sample every",
+            "    <sample-interval> Lua VM instructions (default: 1000).",
+            "PROFILE STOP",
+            "    Stop the sampling profiler, keeping the collected samples.",
+            "PROFILE DUMP",
+            "    Return the collected samples as [source:line, count] pairs.",
+            "PROFILE RESET",
+            "    Discard the collected samples.",
             "SHOW <sha1>",
             "    Show a script from the scripts cache.",
             NULL,
@@ -628,6 +638,34 @@ void scriptCommand(client *c) {
             addReplyError(c, "Use SCRIPT DEBUG YES/SYNC/NO");
             return;
         }
+    } else if (c->argc >= 3 && !strcasecmp(c->argv[1]->ptr, "profile")) {
+        if (!strcasecmp(c->argv[2]->ptr, "start") && (c->argc == 3 || c->argc == 4)) {
+            long long interval = 0;
+            if (c->argc == 4) {
+                if (getLongLongFromObjectOrReply(c, c->argv[3], &interval, NULL) != C_OK) return;
+                /* The interval is passed to lua_sethook() as an int; a larger
+                 * value would truncate, possibly to a hook that never fires,
+                 * which would also disable the script kill check it carries. */
+                if (interval < 1 || interval > INT_MAX) {
+                    addReplyError(c, "sample-interval must be a positive number of VM instructions "
+                                     "not greater than 2147483647");
+                    return;
+                }
+            }
+            luaProfilerStart(interval);
+            addReply(c, shared.ok);
+        } else if (c->argc == 3 && !strcasecmp(c->argv[2]->ptr, "stop")) {
+            luaProfilerStop();
+            addReply(c, shared.ok);
+        } else if (c->argc == 3 && !strcasecmp(c->argv[2]->ptr, "reset")) {
+            luaProfilerReset();
+            addReply(c, shared.ok);
+        } else if (c->argc == 3 && !strcasecmp(c->argv[2]->ptr, "dump")) {
+            luaProfilerDumpReply(c);
+        } else {
+            addReplyError(c, "Use SCRIPT PROFILE START [<sample-interval>]|STOP|DUMP|RESET");
+            return;
+        }
     } else if (c->argc == 3 && !strcasecmp(c->argv[1]->ptr, "show")) {
         dictEntry *de;
         evalScript *es;
@@ -564,6 +564,24 @@ int performEvictions(void) {
             while (bestkey == NULL) {
                 unsigned long total_keys = 0;
 
+                /* Under volatile-ttl the pool scores are absolute expire
+                 * times: unlike LRU idle times or LFU counters they do not
+                 * drift between iterations, so the remaining pool entries
+                 * stay the best candidates seen so far. Drain the pool
+                 * across iterations and only sample again once it runs
+                 * empty, instead of paying a full resampling round for
+                 * every single victim. */
+                if (server.maxmemory_policy == MAXMEMORY_VOLATILE_TTL) {
+                    int populated = 0;
+                    for (k = 0; k < EVPOOL_SIZE; k++) {
+                        if (pool[k].key != NULL) {
+                            populated = 1;
+                            break;
+                        }
+                    }
+                    if (populated) goto pick_best;
+                }
+
                 /* We don't want to make local-db choices when expiring keys,
                  * so to start populate the eviction pool sampling keys from
                  * every DB. */
@@ -594,6 +612,8 @@ int performEvictions(void) {
                 }
                 if (!total_keys) break; /* No keys to evict. */
 
+            pick_best:;
+
                 /* Go backward from best to worst element to evict. */
                 for (k = EVPOOL_SIZE - 1; k >= 0; k--) {
                     if (pool[k].key == NULL) continue;
@@ -620,7 +640,12 @@ int performEvictions(void) {
                         bestkey = objectGetKey(valkey);
                         break;
                     } else {
-                        /* Ghost... Iterate again. */
+                        /* Ghost: the sampled key is gone. A high ghost rate
+                         * relative to evicted_keys means the pool content goes
+                         * stale faster than it is consumed, a sign that
+                         * maxmemory-samples is set higher than the workload
+                         * needs. Iterate again. */
+                        server.stat_evictedpoolghosts++;
                     }
                 }
             }
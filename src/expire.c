@@ -133,8 +133,10 @@ void expireScanCallback(void *privdata, void *entry) {
     long long ttl = objectGetExpire(val) - data->now;
     if (activeExpireCycleTryExpire(data->db, val, data->now)) {
         data->expired++;
-        /* Propagate the DEL command */
-        postExecutionUnitOperations();
+        /* The DEL/UNLINK is staged in server.also_propagate here and
+         * flushed by the caller once the current scan burst is over, so
+         * that deletions of keys expiring together coalesce into a few
+         * multi-key commands instead of one command per key. */
     }
     if (ttl > 0) {
         /* We want the average TTL of keys yet not expired. */
@@ -195,6 +197,8 @@ void activeExpireCycle(int type) {
         last_fast_cycle = start;
     }
 
+    VALKEY_USDT_EXPIRE_CYCLE_START(type);
+
     /* We usually should test CRON_DBS_PER_CALL per iteration, with
      * two exceptions:
      *
@@ -293,6 +297,12 @@ void activeExpireCycle(int type) {
                 }
                 checked_buckets++;
             }
+
+            /* Flush the deletions staged by this scan burst. Doing it here
+             * rather than per key lets propagateDeletion() coalesce them
+             * into multi-key DEL/UNLINK commands. */
+            if (data.expired) postExecutionUnitOperations();
+
             total_expired += data.expired;
             total_sampled += data.sampled;
 
@@ -355,6 +365,7 @@ void activeExpireCycle(int type) {
     elapsed = ustime() - start;
     server.stat_expire_cycle_time_used += elapsed;
     latencyAddSampleIfNeeded("expire-cycle", elapsed / 1000);
+    VALKEY_USDT_EXPIRE_CYCLE_END(type, total_sampled, total_expired, elapsed);
 
     /* Update our estimate of keys existing but yet to be expired.
      * Running average with this sample accounting for 5%. */
@@ -366,6 +377,65 @@ void activeExpireCycle(int type) {
     server.stat_expired_stale_perc = (current_perc * 0.05) + (server.stat_expired_stale_perc * 0.95);
 }
 
+/*-----------------------------------------------------------------------------
+ * Deferred reclaim of expired keys met by lookups
+ *
+ * When a read lookup finds a logically expired key, deleting it inline means
+ * paying for the notification and the DEL propagation in the middle of the
+ * command. That is fine for the occasional expire, but when a large batch of
+ * keys shares the same TTL deadline, reads issued right after the deadline
+ * each absorb a deletion, and latency spikes exactly when traffic hits.
+ *
+ * So read lookups just queue the key here and keep treating it as a miss
+ * (the same thing replicas have always done for logically expired keys),
+ * while the queue is drained in batch from beforeSleep(), outside of any
+ * command execution.
+ *----------------------------------------------------------------------------*/
+
+typedef struct deferredExpiredKey {
+    serverDb *db;
+    robj *key;
+} deferredExpiredKey;
+
+/* Queue a logically expired key for deletion in beforeSleep(). Called by
+ * expireIfNeeded() when the caller does not need the deletion inline. */
+void deferExpiredKeyDeletion(serverDb *db, robj *key) {
+    deferredExpiredKey *dek = zmalloc(sizeof(*dek));
+    dek->db = db;
+    if (key->refcount == OBJ_STATIC_REFCOUNT) {
+        dek->key = createStringObject(key->ptr, sdslen(key->ptr));
+    } else {
+        incrRefCount(key);
+        dek->key = key;
+    }
+    listAddNodeTail(server.pending_expired_keys, dek);
+}
+
+/* Delete and propagate the expired keys queued by read lookups since the
+ * previous event loop iteration. */
+void reclaimDeferredExpiredKeys(void) {
+    if (!listLength(server.pending_expired_keys)) return;
+
+    listNode *ln;
+    while ((ln = listFirst(server.pending_expired_keys)) != NULL) {
+        deferredExpiredKey *dek = listNodeValue(ln);
+        /* Since the key was queued it may have been deleted, overwritten
+         * or given a new TTL, and the server itself may have turned into a
+         * replica or entered import mode: reclaim the key only if we are
+         * still in charge of its expiry and it is still expired. */
+        if (iAmPrimary() && !server.import_mode && !isPausedActions(PAUSE_ACTION_EXPIRE) &&
+            keyIsExpired(dek->db, dek->key)) {
+            enterExecutionUnit(1, 0);
+            deleteExpiredKeyAndPropagate(dek->db, dek->key);
+            exitExecutionUnit();
+            postExecutionUnitOperations();
+        }
+        decrRefCount(dek->key);
+        zfree(dek);
+        listDelNode(server.pending_expired_keys, ln);
+    }
+}
+
 /*-----------------------------------------------------------------------------
  * Expires of keys created in writable replicas
  *
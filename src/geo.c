@@ -50,6 +50,10 @@ int zslValueLteMax(double value, zrangespec *spec);
  * geoArray implementation
  * ==================================================================== */
 
+#define SORT_NONE 0
+#define SORT_ASC 1
+#define SORT_DESC 2
+
 /* Create a new array of geoPoints. */
 geoArray *geoArrayCreate(void) {
     geoArray *ga = zmalloc(sizeof(*ga));
@@ -57,22 +61,80 @@ geoArray *geoArrayCreate(void) {
     ga->array = NULL;
     ga->buckets = 0;
     ga->used = 0;
+    ga->cap = 0;
+    ga->dir = SORT_ASC;
     return ga;
 }
 
-/* Add and populate with data a new entry to the geoArray. */
+/* Returns non-zero if, for the configured direction, distance 'a' ranks
+ * worse than 'b' (farther for ASC queries, closer for DESC ones). In
+ * bounded mode the worst of the kept points sits at the heap root. */
+static inline int geoPointWorse(const geoArray *ga, double a, double b) {
+    return ga->dir == SORT_DESC ? a < b : a > b;
+}
+
+/* Restore the heap property after the root was replaced. */
+static void geoArrayHeapSiftDown(geoArray *ga, size_t i) {
+    size_t n = ga->used;
+    while (1) {
+        size_t worst = i, l = 2 * i + 1, r = 2 * i + 2;
+        if (l < n && geoPointWorse(ga, ga->array[l].dist, ga->array[worst].dist)) worst = l;
+        if (r < n && geoPointWorse(ga, ga->array[r].dist, ga->array[worst].dist)) worst = r;
+        if (worst == i) break;
+        geoPoint tmp = ga->array[i];
+        ga->array[i] = ga->array[worst];
+        ga->array[worst] = tmp;
+        i = worst;
+    }
+}
+
+/* Restore the heap property after an append at the tail. */
+static void geoArrayHeapSiftUp(geoArray *ga, size_t i) {
+    while (i) {
+        size_t parent = (i - 1) / 2;
+        if (!geoPointWorse(ga, ga->array[i].dist, ga->array[parent].dist)) break;
+        geoPoint tmp = ga->array[i];
+        ga->array[i] = ga->array[parent];
+        ga->array[parent] = tmp;
+        i = parent;
+    }
+}
+
+/* In bounded mode, tells whether a candidate at 'dist' would actually be
+ * kept by geoArrayAppend(). Callers use it to skip the member name
+ * allocation for candidates that cannot make the result. */
+static inline int geoArrayAccepts(const geoArray *ga, double dist) {
+    if (ga->cap == 0 || ga->used < ga->cap) return 1;
+    return geoPointWorse(ga, ga->array[0].dist, dist);
+}
+
+/* Add and populate with data a new entry to the geoArray. Takes ownership
+ * of 'member'. In bounded mode a full array replaces its current worst
+ * entry instead of growing, so at most 'cap' points are ever kept. */
 geoPoint *geoArrayAppend(geoArray *ga, double *xy, double dist, double score, char *member) {
-    if (ga->used == ga->buckets) {
-        ga->buckets = (ga->buckets == 0) ? 8 : ga->buckets * 2;
-        ga->array = zrealloc(ga->array, sizeof(geoPoint) * ga->buckets);
+    geoPoint *gp;
+    if (ga->cap && ga->used == ga->cap) {
+        gp = ga->array; /* The heap root is the worst kept point. */
+        sdsfree(gp->member);
+    } else {
+        if (ga->used == ga->buckets) {
+            ga->buckets = (ga->buckets == 0) ? 8 : ga->buckets * 2;
+            ga->array = zrealloc(ga->array, sizeof(geoPoint) * ga->buckets);
+        }
+        gp = ga->array + ga->used;
+        ga->used++;
     }
-    geoPoint *gp = ga->array + ga->used;
     gp->longitude = xy[0];
     gp->latitude = xy[1];
     gp->dist = dist;
     gp->member = member;
     gp->score = score;
-    ga->used++;
+    if (ga->cap) {
+        if (gp == ga->array)
+            geoArrayHeapSiftDown(ga, 0);
+        else
+            geoArrayHeapSiftUp(ga, ga->used - 1);
+    }
     return gp;
 }
 
@@ -84,6 +146,41 @@ void geoArrayFree(geoArray *ga) {
     zfree(ga);
 }
 
+/* The search commands run one at a time on the main thread, so a single
+ * cached array can serve every query and spare the allocate/free churn of
+ * high rate proximity workloads; per client arenas would only pin memory
+ * on idle connections. The cached buffer is dropped once it grows past a
+ * sanity bound so one huge result does not stay resident forever. */
+static geoArray *cached_ga = NULL;
+#define GEO_ARRAY_CACHED_MAX_BUCKETS 4096
+
+/* Get an empty geoArray, reusing the cached one when available. */
+static geoArray *geoArrayObtain(void) {
+    geoArray *ga = cached_ga;
+    if (ga) {
+        cached_ga = NULL;
+        return ga;
+    }
+    return geoArrayCreate();
+}
+
+/* Return a geoArray obtained with geoArrayObtain(). Members that were not
+ * handed off to the reply or store path are released; the backing buffer
+ * is kept for the next query when reasonably sized. */
+static void geoArrayRelease(geoArray *ga) {
+    size_t i;
+    for (i = 0; i < ga->used; i++) sdsfree(ga->array[i].member);
+    ga->used = 0;
+    ga->cap = 0;
+    ga->dir = SORT_ASC;
+    if (cached_ga == NULL && ga->buckets <= GEO_ARRAY_CACHED_MAX_BUCKETS) {
+        cached_ga = ga;
+        return;
+    }
+    zfree(ga->array);
+    zfree(ga);
+}
+
 /* ====================================================================
  * Helpers
  * ==================================================================== */
@@ -225,6 +322,17 @@ int geoWithinShape(GeoShape *shape, double score, double *xy, double *distance)
     /* Note that geohashGetDistanceIfInRadiusWGS84() takes arguments in
      * reverse order: longitude first, latitude later. */
     if (shape->type == CIRCULAR_TYPE) {
+        /* Reject against the search area's bounding box (computed once per
+         * search) before paying for the haversine formula: many candidates
+         * coming from the covering geohash boxes fall outside the circle.
+         * The longitude check only applies when the box neither wraps
+         * around the +-180 meridian nor crosses a pole, since in both cases
+         * in-range members can sit at faraway longitudes. */
+        if (xy[1] < shape->bounds[1] || xy[1] > shape->bounds[3]) return C_ERR;
+        if (shape->bounds[0] >= GEO_LONG_MIN && shape->bounds[2] <= GEO_LONG_MAX &&
+            shape->bounds[1] > GEO_LAT_MIN && shape->bounds[3] < GEO_LAT_MAX &&
+            (xy[0] < shape->bounds[0] || xy[0] > shape->bounds[2]))
+            return C_ERR;
         if (!geohashGetDistanceIfInRadiusWGS84(shape->xy[0], shape->xy[1], xy[0], xy[1],
                                                shape->t.radius * shape->conversion, distance))
             return C_ERR;
@@ -277,7 +385,7 @@ int geoGetPointsInRange(robj *zobj, double min, double max, GeoShape *shape, geo
             if (!zslValueLteMax(score, &range)) break;
 
             vstr = lpGetValue(eptr, &vlen, &vlong);
-            if (geoWithinShape(shape, score, xy, &distance) == C_OK) {
+            if (geoWithinShape(shape, score, xy, &distance) == C_OK && geoArrayAccepts(ga, distance)) {
                 /* Append the new element. */
                 char *member = (vstr == NULL) ? sdsfromlonglong(vlong) : sdsnewlen(vstr, vlen);
                 geoArrayAppend(ga, xy, distance, score, member);
@@ -300,7 +408,7 @@ int geoGetPointsInRange(robj *zobj, double min, double max, GeoShape *shape, geo
             double distance = 0;
             /* Abort when the node is no longer in range. */
             if (!zslValueLteMax(ln->score, &range)) break;
-            if (geoWithinShape(shape, ln->score, xy, &distance) == C_OK) {
+            if (geoWithinShape(shape, ln->score, xy, &distance) == C_OK && geoArrayAccepts(ga, distance)) {
                 /* Append the new element. */
                 geoArrayAppend(ga, xy, distance, ln->score, sdsdup(ln->ele));
             }
@@ -340,21 +448,21 @@ void scoresOfGeoHashBox(GeoHashBits hash, GeoHashFix52Bits *min, GeoHashFix52Bit
     *max = geohashAlign52Bits(hash);
 }
 
-/* Obtain all members between the min/max of this geohash bounding box.
- * Populate a geoArray of GeoPoints by calling geoGetPointsInRange().
- * Return the number of points added to the array. */
-int membersOfGeoHashBox(robj *zobj, GeoHashBits hash, geoArray *ga, GeoShape *shape, unsigned long limit) {
-    GeoHashFix52Bits min, max;
-
-    scoresOfGeoHashBox(hash, &min, &max);
-    return geoGetPointsInRange(zobj, min, max, shape, ga, limit);
-}
-
-/* Search all eight neighbors + self geohash box */
+/* Search all eight neighbors + self geohash box.
+ *
+ * The boxes translate to at most nine score ranges on the sorted set, and
+ * these frequently touch or overlap: adjacent boxes map to contiguous
+ * score intervals, and with a huge radius (5000 km or more) neighbors can
+ * collapse into one another. The ranges are sorted and coalesced first, so
+ * each merged interval costs a single seek into the sorted set and
+ * overlapping boxes cannot contribute duplicated elements. */
 int membersOfAllNeighbors(robj *zobj, const GeoHashRadius *n, GeoShape *shape, geoArray *ga, unsigned long limit) {
     GeoHashBits neighbors[9];
-    unsigned int i, count = 0, last_processed = 0;
-    int debugmsg = 0;
+    struct {
+        GeoHashFix52Bits min, max;
+    } ranges[9];
+    unsigned int i, j, num_ranges = 0;
+    int count = 0;
 
     neighbors[0] = n->hash;
     neighbors[1] = n->neighbors.north;
@@ -366,42 +474,32 @@ int membersOfAllNeighbors(robj *zobj, const GeoHashRadius *n, GeoShape *shape, g
     neighbors[7] = n->neighbors.south_east;
     neighbors[8] = n->neighbors.south_west;
 
-    /* For each neighbor (*and* our own hashbox), get all the matching
-     * members and add them to the potential result list. */
     for (i = 0; i < sizeof(neighbors) / sizeof(*neighbors); i++) {
-        if (HASHISZERO(neighbors[i])) {
-            if (debugmsg) D("neighbors[%d] is zero", i);
-            continue;
-        }
+        if (HASHISZERO(neighbors[i])) continue;
+        scoresOfGeoHashBox(neighbors[i], &ranges[num_ranges].min, &ranges[num_ranges].max);
+        num_ranges++;
+    }
 
-        /* Debugging info. */
-        if (debugmsg) {
-            GeoHashRange long_range, lat_range;
-            geohashGetCoordRange(&long_range, &lat_range);
-            GeoHashArea myarea = {{0}};
-            geohashDecode(long_range, lat_range, neighbors[i], &myarea);
-
-            /* Dump center square. */
-            D("neighbors[%d]:\n", i);
-            D("area.longitude.min: %f\n", myarea.longitude.min);
-            D("area.longitude.max: %f\n", myarea.longitude.max);
-            D("area.latitude.min: %f\n", myarea.latitude.min);
-            D("area.latitude.max: %f\n", myarea.latitude.max);
-            D("\n");
+    /* Order by range start; insertion sort, we have at most nine. */
+    for (i = 1; i < num_ranges; i++) {
+        for (j = i; j > 0 && ranges[j].min < ranges[j - 1].min; j--) {
+            GeoHashFix52Bits tmpmin = ranges[j].min, tmpmax = ranges[j].max;
+            ranges[j].min = ranges[j - 1].min;
+            ranges[j].max = ranges[j - 1].max;
+            ranges[j - 1].min = tmpmin;
+            ranges[j - 1].max = tmpmax;
         }
+    }
 
-        /* When a huge Radius (in the 5000 km range or more) is used,
-         * adjacent neighbors can be the same, leading to duplicated
-         * elements. Skip every range which is the same as the one
-         * processed previously. */
-        if (last_processed && neighbors[i].bits == neighbors[last_processed].bits &&
-            neighbors[i].step == neighbors[last_processed].step) {
-            if (debugmsg) D("Skipping processing of %d, same as previous\n", i);
-            continue;
-        }
+    /* Scan each run of touching or overlapping ranges as one interval. */
+    i = 0;
+    while (i < num_ranges) {
+        GeoHashFix52Bits min = ranges[i].min, max = ranges[i].max;
+        for (j = i + 1; j < num_ranges && ranges[j].min <= max; j++)
+            if (ranges[j].max > max) max = ranges[j].max;
+        count += geoGetPointsInRange(zobj, min, max, shape, ga, limit);
         if (ga->used && limit && ga->used >= limit) break;
-        count += membersOfGeoHashBox(zobj, neighbors[i], ga, shape, limit);
-        last_processed = i;
+        i = j;
     }
     return count;
 }
@@ -491,10 +589,6 @@ void geoaddCommand(client *c) {
     zaddCommand(c);
 }
 
-#define SORT_NONE 0
-#define SORT_ASC 1
-#define SORT_DESC 2
-
 #define RADIUS_COORDS (1 << 0)  /* Search around coordinates. */
 #define RADIUS_MEMBER (1 << 1)  /* Search around member. */
 #define RADIUS_NOSTORE (1 << 2) /* Do not accept STORE/STOREDIST option. */
@@ -681,13 +775,20 @@ void georadiusGeneric(client *c, int srcKeyIndex, int flags) {
     GeoHashRadius georadius = geohashCalculateAreasByShapeWGS84(&shape);
 
     /* Search the zset for all matching points */
-    geoArray *ga = geoArrayCreate();
+    geoArray *ga = geoArrayObtain();
+    if (count != 0 && !any) {
+        /* With a COUNT we only ever return the best 'count' points, so keep
+         * a bounded heap of that size while scanning instead of collecting
+         * (and later sorting) every candidate in the area. */
+        ga->cap = count;
+        ga->dir = sort;
+    }
     membersOfAllNeighbors(zobj, &georadius, &shape, ga, any ? count : 0);
 
     /* If no matching results, the user gets an empty reply. */
     if (ga->used == 0 && storekey == NULL) {
         addReply(c, shared.emptyarray);
-        geoArrayFree(ga);
+        geoArrayRelease(ga);
         return;
     }
 
@@ -791,7 +892,7 @@ void georadiusGeneric(client *c, int srcKeyIndex, int flags) {
         }
         addReplyLongLong(c, returned_items);
     }
-    geoArrayFree(ga);
+    geoArrayRelease(ga);
 }
 
 /* GEORADIUS wrapper function. */
@@ -17,6 +17,8 @@ typedef struct geoArray {
     struct geoPoint *array;
     size_t buckets;
     size_t used;
+    size_t cap; /* When non-zero, keep only the best 'cap' points (bounded heap mode). */
+    int dir;    /* Bounded mode ranking: SORT_ASC keeps nearest, SORT_DESC farthest. */
 } geoArray;
 
 #endif
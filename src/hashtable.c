@@ -58,6 +58,12 @@
 #include <string.h>
 #include <unistd.h>
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
+
 /* The default hashing function uses the SipHash implementation in siphash.c. */
 
 uint64_t siphash(const uint8_t *in, const size_t inlen, const uint8_t *k);
@@ -418,6 +424,38 @@ static inline int bucketIsFull(bucket *b) {
 static inline int isPositionFilled(bucket *b, int position) {
     return b->presence & (1 << position);
 }
+
+/* Returns a bitmask with one bit per bucket position, set for the positions
+ * that are occupied and whose stored hash byte equals 'h2' (Swiss-table style
+ * group probing). The SIMD paths compare all hash bytes in one instruction;
+ * they load 16 bytes starting at b->hashes, which stays within the 64-byte
+ * bucket. A chained bucket's child-pointer slot never has its presence bit
+ * set, so masking with 'presence' also excludes it. */
+static inline uint32_t bucketFindCandidates(bucket *b, uint8_t h2) {
+#if defined(__SSE2__)
+    __m128i hashes = _mm_loadu_si128((const __m128i *)b->hashes);
+    __m128i match = _mm_cmpeq_epi8(hashes, _mm_set1_epi8((char)h2));
+    return (uint32_t)_mm_movemask_epi8(match) & b->presence;
+#elif defined(__ARM_NEON)
+    uint8x16_t hashes = vld1q_u8((const uint8_t *)b->hashes);
+    uint8x16_t match = vceqq_u8(hashes, vdupq_n_u8(h2));
+    /* Narrow each 16-bit lane to 4 bits, giving one nibble per position. */
+    uint64_t nibbles = vget_lane_u64(vreinterpret_u64_u8(vshrn_n_u16(vreinterpretq_u16_u8(match), 4)), 0);
+    nibbles &= 0x1111111111111111ULL;
+    uint32_t mask = 0;
+    while (nibbles) {
+        mask |= 1u << (__builtin_ctzll(nibbles) >> 2);
+        nibbles &= nibbles - 1;
+    }
+    return mask & b->presence;
+#else
+    uint32_t mask = 0;
+    for (int pos = 0; pos < ENTRIES_PER_BUCKET; pos++) {
+        mask |= (uint32_t)(b->hashes[pos] == h2) << pos;
+    }
+    return mask & b->presence;
+#endif
+}
 static void resetTable(hashtable *ht, int table_idx) {
     ht->tables[table_idx] = NULL;
     ht->used[table_idx] = 0;
@@ -516,6 +554,14 @@ static bucket *bucketDefrag(bucket *prev, bucket *b, void *(*defragfn)(void *))
 /* Rehashes one bucket. */
 static void rehashBucket(hashtable *ht, bucket *b) {
     int pos;
+    /* When expanding we must re-hash every key, which dereferences every
+     * entry. Issue the entry loads up front so the cache misses overlap
+     * instead of serializing, one per hashEntry() call. */
+    if (ht->bucket_exp[1] >= ht->bucket_exp[0]) {
+        for (pos = 0; pos < numBucketPositions(b); pos++) {
+            if (isPositionFilled(b, pos)) valkey_prefetch(b->entries[pos]);
+        }
+    }
     for (pos = 0; pos < numBucketPositions(b); pos++) {
         if (!isPositionFilled(b, pos)) continue; /* empty */
         void *entry = b->entries[pos];
@@ -545,6 +591,10 @@ static void rehashStep(hashtable *ht) {
     assert(hashtableIsRehashing(ht));
     size_t idx = ht->rehash_idx;
     bucket *b = &ht->tables[0][idx];
+    /* Overlap the next source bucket's cache miss with this bucket's work;
+     * this matters when many steps run back to back (serverCron's rehash
+     * time budget). */
+    if (idx + 1 < numBuckets(ht->bucket_exp[0])) valkey_prefetch(&ht->tables[0][idx + 1]);
     rehashBucket(ht, b);
     if (b->chained) {
         /* Rehash and free child buckets. */
@@ -666,6 +716,12 @@ static int expand(hashtable *ht, size_t size, int *malloc_failed) {
     if (size < hashtableSize(ht)) {
         return 0;
     }
+    /* Expanding must never shrink the table. This allows callers to pass a
+     * size hint for elements about to be inserted without checking how big
+     * the table already is. */
+    if (nextBucketExp(size) <= ht->bucket_exp[hashtableIsRehashing(ht) ? 1 : 0]) {
+        return 0;
+    }
     return resize(ht, size, malloc_failed);
 }
 
@@ -694,18 +750,18 @@ static bucket *findBucket(hashtable *ht, uint64_t hash, const void *key, int *po
         bucket *b = &ht->tables[table][bucket_idx];
         do {
             /* Find candidate entries with presence flag set and matching h2 hash. */
-            for (int pos = 0; pos < numBucketPositions(b); pos++) {
-                if (isPositionFilled(b, pos) && b->hashes[pos] == h2) {
-                    /* It's a candidate. */
-                    void *entry = b->entries[pos];
-                    const void *elem_key = entryGetKey(ht, entry);
-                    if (compareKeys(ht, key, elem_key) == 0) {
-                        /* It's a match. */
-                        assert(pos_in_bucket != NULL);
-                        *pos_in_bucket = pos;
-                        if (table_index) *table_index = table;
-                        return b;
-                    }
+            uint32_t candidates = bucketFindCandidates(b, h2);
+            while (candidates) {
+                int pos = __builtin_ctz(candidates);
+                candidates &= candidates - 1;
+                void *entry = b->entries[pos];
+                const void *elem_key = entryGetKey(ht, entry);
+                if (compareKeys(ht, key, elem_key) == 0) {
+                    /* It's a match. */
+                    assert(pos_in_bucket != NULL);
+                    *pos_in_bucket = pos;
+                    if (table_index) *table_index = table;
+                    return b;
                 }
             }
             b = getChildBucket(b);
@@ -848,11 +904,11 @@ static bucket *findBucketForInsert(hashtable *ht, uint64_t hash, int *pos_in_buc
         }
         b = getChildBucket(b);
     }
-    /* Find a free slot in the bucket. There must be at least one. */
-    int pos;
-    for (pos = 0; pos < ENTRIES_PER_BUCKET; pos++) {
-        if (!isPositionFilled(b, pos)) break;
-    }
+    /* Find a free slot in the bucket. There must be at least one. Since the
+     * bucket is not full, the lowest clear presence bit is a valid position
+     * (the child-pointer slot of a chained bucket can only be the lowest
+     * clear bit if all other positions are filled, i.e. the bucket is full). */
+    int pos = __builtin_ctz(~(uint32_t)b->presence);
     assert(pos < ENTRIES_PER_BUCKET);
     assert(pos_in_bucket != NULL);
     *pos_in_bucket = pos;
@@ -1719,7 +1775,12 @@ size_t hashtableScanDefrag(hashtable *ht, size_t cursor, hashtableScanFunction f
         size_t mask = expToMask(ht->bucket_exp[0]);
         bucket *b = &ht->tables[0][cursor & mask];
         do {
+            /* Prefetch the chained bucket and the entries about to be
+             * emitted, so the callback's dereferences overlap the fetches. */
+            bucket *next = getChildBucket(b);
+            if (next != NULL) valkey_prefetch(next);
             if (b->presence != 0) {
+                prefetchBucketEntries(b);
                 int pos;
                 for (pos = 0; pos < ENTRIES_PER_BUCKET; pos++) {
                     if (isPositionFilled(b, pos)) {
@@ -1728,7 +1789,6 @@ size_t hashtableScanDefrag(hashtable *ht, size_t cursor, hashtableScanFunction f
                     }
                 }
             }
-            bucket *next = getChildBucket(b);
             if (next != NULL && defragfn != NULL) {
                 next = bucketDefrag(b, next, defragfn);
             }
@@ -1757,7 +1817,10 @@ size_t hashtableScanDefrag(hashtable *ht, size_t cursor, hashtableScanFunction f
             size_t used_before = ht->used[table_small];
             bucket *b = &ht->tables[table_small][idx];
             do {
+                bucket *next = getChildBucket(b);
+                if (next != NULL) valkey_prefetch(next);
                 if (b->presence) {
+                    prefetchBucketEntries(b);
                     for (int pos = 0; pos < ENTRIES_PER_BUCKET; pos++) {
                         if (isPositionFilled(b, pos)) {
                             void *emit = emit_ref ? &b->entries[pos] : b->entries[pos];
@@ -1765,7 +1828,6 @@ size_t hashtableScanDefrag(hashtable *ht, size_t cursor, hashtableScanFunction f
                         }
                     }
                 }
-                bucket *next = getChildBucket(b);
                 if (next != NULL && defragfn != NULL) {
                     next = bucketDefrag(b, next, defragfn);
                 }
@@ -1787,7 +1849,10 @@ size_t hashtableScanDefrag(hashtable *ht, size_t cursor, hashtableScanFunction f
                 size_t used_before = ht->used[table_large];
                 bucket *b = &ht->tables[table_large][idx];
                 do {
+                    bucket *next = getChildBucket(b);
+                    if (next != NULL) valkey_prefetch(next);
                     if (b->presence) {
+                        prefetchBucketEntries(b);
                         for (int pos = 0; pos < ENTRIES_PER_BUCKET; pos++) {
                             if (isPositionFilled(b, pos)) {
                                 void *emit = emit_ref ? &b->entries[pos] : b->entries[pos];
@@ -1795,7 +1860,6 @@ size_t hashtableScanDefrag(hashtable *ht, size_t cursor, hashtableScanFunction f
                             }
                         }
                     }
-                    bucket *next = getChildBucket(b);
                     if (next != NULL && defragfn != NULL) {
                         next = bucketDefrag(b, next, defragfn);
                     }
@@ -2011,6 +2075,44 @@ int hashtableFairRandomEntry(hashtable *ht, void **found) {
     return 1;
 }
 
+/* Points the first elements of 'dst' to 'count' distinct random entries and
+ * returns the number of entries stored, which is 'count' except if 'count' is
+ * greater than the total number of entries in the hash table.
+ *
+ * The entries are selected uniformly from a window of entries scanned starting
+ * at a random location. The window grows with 'count', so each entry is picked
+ * with at least the same fairness as a hashtableFairRandomEntry() call, while
+ * the scanning cost is amortized across all the returned entries. The order of
+ * the returned entries is random. */
+unsigned hashtableFairRandomEntries(hashtable *ht, void **dst, unsigned count) {
+    if (count > hashtableSize(ht)) count = hashtableSize(ht);
+    if (count == 0) return 0;
+    size_t window = (size_t)count * 4;
+    if (window < FAIR_RANDOM_SAMPLE_SIZE) window = FAIR_RANDOM_SAMPLE_SIZE;
+    if (window > hashtableSize(ht)) window = hashtableSize(ht);
+    /* Reservoir-sample the window: each scanned entry ends up in 'dst' with
+     * probability count / seen. */
+    scan_samples samples;
+    samples.size = count;
+    samples.seen = 0;
+    samples.entries = dst;
+    size_t cursor = randomSizeT();
+    while (samples.seen < window) {
+        cursor = hashtableScan(ht, cursor, sampleEntriesScanFn, &samples);
+    }
+    rehashStepOnReadIfNeeded(ht);
+    unsigned stored = samples.seen < count ? (unsigned)samples.seen : count;
+    /* The reservoir keeps the selection uniform but not the order, so
+     * shuffle the result. */
+    for (unsigned i = stored - 1; i > 0; i--) {
+        unsigned j = random() % (i + 1);
+        void *tmp = dst[i];
+        dst[i] = dst[j];
+        dst[j] = tmp;
+    }
+    return stored;
+}
+
 /* This function samples a sequence of entries starting at a random location in
  * the hash table.
  *
@@ -161,6 +161,7 @@ int hashtableNext(hashtableIterator *iter, void **elemptr);
 /* Random entries */
 int hashtableRandomEntry(hashtable *ht, void **found);
 int hashtableFairRandomEntry(hashtable *ht, void **found);
+unsigned hashtableFairRandomEntries(hashtable *ht, void **dst, unsigned count);
 unsigned hashtableSampleEntries(hashtable *ht, void **dst, unsigned count);
 
 /* Debug & stats */
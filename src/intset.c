@@ -36,6 +36,10 @@
 #include "endianconv.h"
 #include "serverassert.h"
 
+#if defined(__SSE2__)
+#include <emmintrin.h>
+#endif
+
 /* Note that these encodings are ordered, so:
  * INTSET_ENC_INT16 < INTSET_ENC_INT32 < INTSET_ENC_INT64. */
 #define INTSET_ENC_INT16 (sizeof(int16_t))
@@ -110,23 +114,104 @@ static intset *intsetResize(intset *is, uint32_t len) {
     return is;
 }
 
+/* Once the binary search has narrowed the range down to this many elements,
+ * switch to a branchless scan of the remaining window. */
+#define INTSET_SEARCH_WINDOW 16
+
+/* The count-less-than helpers below return how many of the 'n' sorted
+ * elements starting at 'base' are smaller than 'value', which is the lower
+ * bound index within that window. They compare every element instead of
+ * branching per element, with SSE2 doing 8 (int16) or 4 (int32) compares per
+ * iteration. The raw loads are safe on big endian too, because the scalar
+ * fallbacks byte swap each element and SSE2 implies little endian. */
+static uint32_t intsetCountLessInt16(const int16_t *base, uint32_t n, int16_t value) {
+    uint32_t i = 0, count = 0;
+#if defined(__SSE2__)
+    __m128i vval = _mm_set1_epi16(value);
+    for (; i + 8 <= n; i += 8) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(base + i));
+        /* cmpgt sets 0xffff per lane where value > x, i.e. x < value. */
+        count += __builtin_popcount(_mm_movemask_epi8(_mm_cmpgt_epi16(vval, x))) >> 1;
+    }
+#endif
+    for (; i < n; i++) {
+        int16_t v = base[i];
+        memrev16ifbe(&v);
+        count += v < value;
+    }
+    return count;
+}
+
+static uint32_t intsetCountLessInt32(const int32_t *base, uint32_t n, int32_t value) {
+    uint32_t i = 0, count = 0;
+#if defined(__SSE2__)
+    __m128i vval = _mm_set1_epi32(value);
+    for (; i + 4 <= n; i += 4) {
+        __m128i x = _mm_loadu_si128((const __m128i *)(base + i));
+        count += __builtin_popcount(_mm_movemask_epi8(_mm_cmpgt_epi32(vval, x))) >> 2;
+    }
+#endif
+    for (; i < n; i++) {
+        int32_t v = base[i];
+        memrev32ifbe(&v);
+        count += v < value;
+    }
+    return count;
+}
+
+/* SSE2 has no 64 bit signed compare, so int64 stays scalar but branchless. */
+static uint32_t intsetCountLessInt64(const int64_t *base, uint32_t n, int64_t value) {
+    uint32_t count = 0;
+    for (uint32_t i = 0; i < n; i++) {
+        int64_t v = base[i];
+        memrev64ifbe(&v);
+        count += v < value;
+    }
+    return count;
+}
+
+/* Return the index of the first element that is >= value (the lower bound).
+ * The caller must ensure the set is not empty and that value is within
+ * [min, max], so that the result is a valid index and the truncating casts
+ * to the set's encoding below are lossless. */
+static uint32_t intsetLowerBound(intset *is, int64_t value) {
+    uint32_t lo = 0, n = intrev32ifbe(is->length);
+    const uint8_t enc = intrev32ifbe(is->encoding);
+
+    /* Branchless binary search: each step halves the range by adding either
+     * 'half' or 0 to the base, which compiles to a conditional move instead
+     * of a hard-to-predict branch. */
+    while (n > INTSET_SEARCH_WINDOW) {
+        uint32_t half = n >> 1;
+        lo += (_intsetGetEncoded(is, lo + half - 1, enc) < value) ? half : 0;
+        n -= half;
+    }
+
+    if (enc == INTSET_ENC_INT64) {
+        return lo + intsetCountLessInt64((const int64_t *)is->contents + lo, n, value);
+    } else if (enc == INTSET_ENC_INT32) {
+        return lo + intsetCountLessInt32((const int32_t *)is->contents + lo, n, (int32_t)value);
+    } else {
+        return lo + intsetCountLessInt16((const int16_t *)is->contents + lo, n, (int16_t)value);
+    }
+}
+
 /* Search for the position of "value". Return 1 when the value was found and
  * sets "pos" to the position of the value within the intset. Return 0 when
  * the value is not present in the intset and sets "pos" to the position
  * where "value" can be inserted. */
 static uint8_t intsetSearch(intset *is, int64_t value, uint32_t *pos) {
-    int min = 0, max = intrev32ifbe(is->length) - 1, mid = -1;
-    int64_t cur = -1;
+    uint32_t len = intrev32ifbe(is->length);
 
     /* The value can never be found when the set is empty */
-    if (intrev32ifbe(is->length) == 0) {
+    if (len == 0) {
         if (pos) *pos = 0;
         return 0;
     } else {
         /* Check for the case where we know we cannot find the value,
          * but do know the insert position. */
-        if (value > _intsetGet(is, max)) {
-            if (pos) *pos = intrev32ifbe(is->length);
+        if (value > _intsetGet(is, len - 1)) {
+            if (pos) *pos = len;
             return 0;
         } else if (value < _intsetGet(is, 0)) {
             if (pos) *pos = 0;
@@ -134,25 +219,10 @@ static uint8_t intsetSearch(intset *is, int64_t value, uint32_t *pos) {
         }
     }
 
-    while (max >= min) {
-        mid = ((unsigned int)min + (unsigned int)max) >> 1;
-        cur = _intsetGet(is, mid);
-        if (value > cur) {
-            min = mid + 1;
-        } else if (value < cur) {
-            max = mid - 1;
-        } else {
-            break;
-        }
-    }
-
-    if (value == cur) {
-        if (pos) *pos = mid;
-        return 1;
-    } else {
-        if (pos) *pos = min;
-        return 0;
-    }
+    /* value <= max, so the lower bound is a valid index. */
+    uint32_t lb = intsetLowerBound(is, value);
+    if (pos) *pos = lb;
+    return _intsetGet(is, lb) == value;
 }
 
 /* Upgrades the intset to a larger encoding and inserts the given integer. */
@@ -285,6 +355,43 @@ uint8_t intsetGet(intset *is, uint32_t pos, int64_t *value) {
     return 0;
 }
 
+/* Bulk export: decode up to 'count' consecutive elements starting at 'pos'
+ * into 'values'. The per-encoding loops hoist the encoding dispatch and
+ * bounds check out of the per-element path and vectorize well, unlike
+ * calling intsetGet() once per element. Returns the number of elements
+ * written, which is smaller than 'count' only at the end of the set. */
+uint32_t intsetGetMany(intset *is, uint32_t pos, uint32_t count, int64_t *values) {
+    uint32_t len = intrev32ifbe(is->length);
+    uint8_t enc = intrev32ifbe(is->encoding);
+
+    if (pos >= len) return 0;
+    if (count > len - pos) count = len - pos;
+
+    if (enc == INTSET_ENC_INT64) {
+        const int64_t *src = (const int64_t *)is->contents + pos;
+        for (uint32_t i = 0; i < count; i++) {
+            int64_t v64 = src[i];
+            memrev64ifbe(&v64);
+            values[i] = v64;
+        }
+    } else if (enc == INTSET_ENC_INT32) {
+        const int32_t *src = (const int32_t *)is->contents + pos;
+        for (uint32_t i = 0; i < count; i++) {
+            int32_t v32 = src[i];
+            memrev32ifbe(&v32);
+            values[i] = v32;
+        }
+    } else {
+        const int16_t *src = (const int16_t *)is->contents + pos;
+        for (uint32_t i = 0; i < count; i++) {
+            int16_t v16 = src[i];
+            memrev16ifbe(&v16);
+            values[i] = v16;
+        }
+    }
+    return count;
+}
+
 /* Return intset length */
 uint32_t intsetLen(const intset *is) {
     return intrev32ifbe(is->length);
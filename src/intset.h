@@ -46,6 +46,7 @@ int64_t intsetRandom(intset *is);
 int64_t intsetMax(intset *is);
 int64_t intsetMin(intset *is);
 uint8_t intsetGet(intset *is, uint32_t pos, int64_t *value);
+uint32_t intsetGetMany(intset *is, uint32_t pos, uint32_t count, int64_t *values);
 uint32_t intsetLen(const intset *is);
 size_t intsetBlobLen(intset *is);
 int intsetValidateIntegrity(const unsigned char *is, size_t size, int deep);
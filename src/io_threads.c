@@ -89,6 +89,22 @@ static size_t IOJobQueue_availableJobs(const IOJobQueue *jq) {
     }
 }
 
+/* Number of jobs currently sitting in the active IO thread queues, sampled by
+ * the main thread for INFO. The relaxed loads mean the value can lag behind by
+ * a few jobs, which is fine for an observability counter and avoids any
+ * synchronization with the workers. */
+size_t ioThreadsQueuedJobs(void) {
+    size_t jobs = 0;
+    for (int i = 1; i < server.active_io_threads_num; i++) {
+        IOJobQueue *jq = &io_jobs[i];
+        if (jq->size == 0) continue;
+        size_t head = atomic_load_explicit(&jq->head, memory_order_relaxed);
+        size_t tail = atomic_load_explicit(&jq->tail, memory_order_relaxed);
+        jobs += (head >= tail) ? head - tail : jq->size - (tail - head);
+    }
+    return jobs;
+}
+
 /* Checks if the job Queue is empty.
  * returns 1 if the buffer is currently empty, 0 otherwise.
  * Called by the main-thread only.
@@ -114,6 +130,151 @@ static void IOJobQueue_removeJob(IOJobQueue *jq) {
     atomic_store_explicit(&jq->tail, (current_tail + 1) % jq->size, memory_order_relaxed);
 }
 
+/* IO completion rings - Used to report finished jobs from the IO threads back
+ * to the main thread.
+ *
+ * A bounded lock-free multi-producer single-consumer ring (the classic
+ * sequence-number scheme): any IO thread - and the main thread itself, when
+ * it needs to re-deliver an event - can push, only the main thread pops.
+ * This lets processIOThreadsReadDone()/processIOThreadsWriteDone() visit
+ * exactly the clients that completed instead of scanning every client with
+ * an in-flight job and polling its completion flag.
+ *
+ * If a push ever finds the ring full it just raises the overflow flag and
+ * drops the event; the consumer then falls back to the full list scan for
+ * that cycle, so no completion can be lost. */
+#define IO_COMPLETION_RING_SIZE (1 << 13) /* Must be a power of 2. */
+
+typedef struct IOCompletionCell {
+    _Atomic size_t seq;
+    client *c;
+} IOCompletionCell;
+
+typedef struct IOCompletionRing {
+    IOCompletionCell *cells;
+    size_t mask;
+    _Atomic int overflow;
+    _Atomic size_t enqueue_pos __attribute__((aligned(CACHE_LINE_SIZE)));
+    size_t dequeue_pos __attribute__((aligned(CACHE_LINE_SIZE))); /* Main thread only. */
+} IOCompletionRing;
+
+static IOCompletionRing io_read_completions;
+static IOCompletionRing io_write_completions;
+
+static void IOCompletionRing_init(IOCompletionRing *r) {
+    r->cells = zmalloc(IO_COMPLETION_RING_SIZE * sizeof(IOCompletionCell));
+    r->mask = IO_COMPLETION_RING_SIZE - 1;
+    for (size_t i = 0; i < IO_COMPLETION_RING_SIZE; i++) {
+        atomic_init(&r->cells[i].seq, i);
+        r->cells[i].c = NULL;
+    }
+    atomic_init(&r->enqueue_pos, 0);
+    r->dequeue_pos = 0;
+    atomic_init(&r->overflow, 0);
+}
+
+static void IOCompletionRing_push(IOCompletionRing *r, client *c) {
+    size_t pos = atomic_load_explicit(&r->enqueue_pos, memory_order_relaxed);
+    while (1) {
+        IOCompletionCell *cell = &r->cells[pos & r->mask];
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        intptr_t dif = (intptr_t)seq - (intptr_t)pos;
+        if (dif == 0) {
+            if (atomic_compare_exchange_weak_explicit(&r->enqueue_pos, &pos, pos + 1, memory_order_relaxed,
+                                                      memory_order_relaxed)) {
+                cell->c = c;
+                atomic_store_explicit(&cell->seq, pos + 1, memory_order_release);
+                return;
+            }
+        } else if (dif < 0) {
+            /* Full: drop the event, the consumer will do a list scan. */
+            atomic_store_explicit(&r->overflow, 1, memory_order_release);
+            return;
+        } else {
+            pos = atomic_load_explicit(&r->enqueue_pos, memory_order_relaxed);
+        }
+    }
+}
+
+/* Pop the next completion, NULL when the ring is empty. Purged cells (see
+ * purgeClientIOCompletions) are consumed and skipped transparently. */
+static client *IOCompletionRing_pop(IOCompletionRing *r) {
+    while (1) {
+        IOCompletionCell *cell = &r->cells[r->dequeue_pos & r->mask];
+        size_t seq = atomic_load_explicit(&cell->seq, memory_order_acquire);
+        if ((intptr_t)seq - (intptr_t)(r->dequeue_pos + 1) < 0) return NULL;
+        client *c = cell->c;
+        atomic_store_explicit(&cell->seq, r->dequeue_pos + r->mask + 1, memory_order_release);
+        r->dequeue_pos++;
+        if (c) return c;
+    }
+}
+
+static size_t IOCompletionRing_pending(IOCompletionRing *r) {
+    return atomic_load_explicit(&r->enqueue_pos, memory_order_acquire) - r->dequeue_pos;
+}
+
+/* Blank out every published-but-unconsumed event for 'c'. Called by the main
+ * thread when a client is freed: the published region is exclusively owned
+ * by the consumer, and waitForClientIO() guarantees no IO thread can still
+ * be pushing this client. */
+static void IOCompletionRing_purge(IOCompletionRing *r, client *c) {
+    if (!r->cells) return;
+    size_t end = atomic_load_explicit(&r->enqueue_pos, memory_order_acquire);
+    for (size_t pos = r->dequeue_pos; pos != end; pos++) {
+        IOCompletionCell *cell = &r->cells[pos & r->mask];
+        if (atomic_load_explicit(&cell->seq, memory_order_acquire) != pos + 1) continue;
+        if (cell->c == c) cell->c = NULL;
+    }
+}
+
+void pushClientReadCompletion(client *c) {
+    IOCompletionRing_push(&io_read_completions, c);
+}
+
+void pushClientWriteCompletion(client *c) {
+    IOCompletionRing_push(&io_write_completions, c);
+}
+
+client *popClientReadCompletion(void) {
+    debugServerAssertWithInfo(NULL, NULL, inMainThread());
+    return IOCompletionRing_pop(&io_read_completions);
+}
+
+client *popClientWriteCompletion(void) {
+    debugServerAssertWithInfo(NULL, NULL, inMainThread());
+    return IOCompletionRing_pop(&io_write_completions);
+}
+
+size_t pendingClientReadCompletions(void) {
+    return IOCompletionRing_pending(&io_read_completions);
+}
+
+size_t pendingClientWriteCompletions(void) {
+    return IOCompletionRing_pending(&io_write_completions);
+}
+
+/* Returns 1 (and rearms the flag) if a completion was dropped since the last
+ * call, in which case the caller must fall back to scanning the whole
+ * pending list. */
+int consumeReadCompletionsOverflow(void) {
+    if (!atomic_load_explicit(&io_read_completions.overflow, memory_order_acquire)) return 0;
+    atomic_store_explicit(&io_read_completions.overflow, 0, memory_order_release);
+    return 1;
+}
+
+int consumeWriteCompletionsOverflow(void) {
+    if (!atomic_load_explicit(&io_write_completions.overflow, memory_order_acquire)) return 0;
+    atomic_store_explicit(&io_write_completions.overflow, 0, memory_order_release);
+    return 1;
+}
+
+void purgeClientIOCompletions(client *c) {
+    debugServerAssertWithInfo(NULL, NULL, inMainThread());
+    IOCompletionRing_purge(&io_read_completions, c);
+    IOCompletionRing_purge(&io_write_completions, c);
+}
+
 /* Retrieves the next job handler and data from the job queue without removal.
  * Called by the consumer (IO thread). Caller must ensure queue is not empty.*/
 static void IOJobQueue_peek(const IOJobQueue *jq, job_handler *handler, void **data) {
@@ -219,7 +380,10 @@ static void *IOThreadMain(void *myid) {
     serverAssert(id > 0 && id < server.io_threads_num);
     snprintf(thdname, sizeof(thdname), "io_thd_%ld", id);
     valkey_set_thread_title(thdname);
-    serverSetCpuAffinity(server.server_cpulist);
+    /* IO threads can be pinned separately from the main thread, e.g. to keep
+     * them on the same NUMA node as the NIC while the main thread runs
+     * elsewhere. Without the dedicated list they follow the server one. */
+    serverSetCpuAffinity(server.io_threads_cpulist ? server.io_threads_cpulist : server.server_cpulist);
     makeThreadKillable();
     initSharedQueryBuf();
 
@@ -309,6 +473,9 @@ void initIOThreads(void) {
 
     serverAssert(server.io_threads_num <= IO_THREADS_MAX_NUM);
 
+    IOCompletionRing_init(&io_read_completions);
+    IOCompletionRing_init(&io_write_completions);
+
     prefetchCommandsBatchInit();
 
     /* Spawn and initialize the I/O threads. */
@@ -574,6 +741,10 @@ void trySendPollJobToIOThreads(void) {
 static void ioThreadAccept(void *data) {
     client *c = (client *)data;
     connAccept(c->conn, NULL);
+    pushClientReadCompletion(c);
+    /* Memory barrier to make sure the accept results are visible to the main
+     * thread before it observes the completed state. */
+    atomic_thread_fence(memory_order_release);
     c->io_read_state = CLIENT_COMPLETED_IO;
 }
 
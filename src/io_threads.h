@@ -14,5 +14,15 @@ void adjustIOThreadsByEventLoad(int numevents, int increase_only);
 void drainIOThreadsQueue(void);
 void trySendPollJobToIOThreads(void);
 int trySendAcceptToIOThreads(connection *conn);
+void pushClientReadCompletion(client *c);
+void pushClientWriteCompletion(client *c);
+client *popClientReadCompletion(void);
+client *popClientWriteCompletion(void);
+size_t pendingClientReadCompletions(void);
+size_t pendingClientWriteCompletions(void);
+size_t ioThreadsQueuedJobs(void);
+int consumeReadCompletionsOverflow(void);
+int consumeWriteCompletionsOverflow(void);
+void purgeClientIOCompletions(client *c);
 
 #endif /* IO_THREADS_H */
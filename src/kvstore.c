@@ -65,6 +65,8 @@ struct _kvstore {
     unsigned long long bucket_count;          /* Total number of buckets in this kvstore across hash tables. */
     unsigned long long *hashtable_size_index; /* Binary indexed tree (BIT) that describes cumulative key frequencies up until
                                                * given hashtable-index. */
+    unsigned long long *dirty;                /* Per-hashtable write counters used to order snapshot serialization by
+                                               * write activity. NULL unless KVSTORE_TRACK_WRITE_ACTIVITY is set. */
     size_t overhead_hashtable_lut;            /* Overhead of all hashtables in bytes. */
     size_t overhead_hashtable_rehashing;      /* Overhead of hash tables rehashing in bytes. */
 };
@@ -284,6 +286,9 @@ kvstore *kvstoreCreate(hashtableType *type, int num_hashtables_bits, int flags)
     kvs->hashtables = zcalloc(sizeof(hashtable *) * kvs->num_hashtables);
     kvs->rehashing = listCreate();
     kvs->hashtable_size_index = kvs->num_hashtables > 1 ? zcalloc(sizeof(unsigned long long) * (kvs->num_hashtables + 1)) : NULL;
+    kvs->dirty = (flags & KVSTORE_TRACK_WRITE_ACTIVITY) && kvs->num_hashtables > 1
+                     ? zcalloc(sizeof(unsigned long long) * kvs->num_hashtables)
+                     : NULL;
     if (!(kvs->flags & KVSTORE_ALLOCATE_HASHTABLES_ON_DEMAND)) {
         for (int i = 0; i < kvs->num_hashtables; i++) createHashtableIfNeeded(kvs, i);
     }
@@ -308,6 +313,7 @@ void kvstoreEmpty(kvstore *kvs, void(callback)(hashtable *)) {
     kvs->resize_cursor = 0;
     kvs->bucket_count = 0;
     if (kvs->hashtable_size_index) memset(kvs->hashtable_size_index, 0, sizeof(unsigned long long) * (kvs->num_hashtables + 1));
+    if (kvs->dirty) memset(kvs->dirty, 0, sizeof(unsigned long long) * kvs->num_hashtables);
     kvs->overhead_hashtable_rehashing = 0;
 }
 
@@ -324,10 +330,31 @@ void kvstoreRelease(kvstore *kvs) {
 
     listRelease(kvs->rehashing);
     if (kvs->hashtable_size_index) zfree(kvs->hashtable_size_index);
+    if (kvs->dirty) zfree(kvs->dirty);
 
     zfree(kvs);
 }
 
+/* Record a write affecting the hash table at 'didx'. No-op unless the kvstore
+ * was created with KVSTORE_TRACK_WRITE_ACTIVITY. */
+void kvstoreHashtableMarkDirty(kvstore *kvs, int didx) {
+    if (!kvs->dirty) return;
+    kvs->dirty[didx]++;
+}
+
+/* Number of writes recorded against the hash table at 'didx', aged by
+ * kvstoreDecayDirtyCounters(). Zero when tracking is disabled. */
+unsigned long long kvstoreHashtableDirtyCount(kvstore *kvs, int didx) {
+    return kvs->dirty ? kvs->dirty[didx] : 0;
+}
+
+/* Halve all write counters. Called when a snapshot child is forked, so the
+ * counters keep reflecting recent activity instead of all-time totals. */
+void kvstoreDecayDirtyCounters(kvstore *kvs) {
+    if (!kvs->dirty) return;
+    for (int didx = 0; didx < kvs->num_hashtables; didx++) kvs->dirty[didx] >>= 1;
+}
+
 unsigned long long int kvstoreSize(kvstore *kvs) {
     if (kvs->num_hashtables != 1) {
         return kvs->key_count;
@@ -354,6 +381,7 @@ size_t kvstoreMemUsage(kvstore *kvs) {
     mem += listLength(kvs->rehashing) * sizeof(listNode);
 
     if (kvs->hashtable_size_index) mem += sizeof(unsigned long long) * (kvs->num_hashtables + 1);
+    if (kvs->dirty) mem += sizeof(unsigned long long) * kvs->num_hashtables;
 
     return mem;
 }
@@ -13,6 +13,7 @@ typedef int(kvstoreExpandShouldSkipHashtableIndex)(int didx);
 
 #define KVSTORE_ALLOCATE_HASHTABLES_ON_DEMAND (1 << 0)
 #define KVSTORE_FREE_EMPTY_HASHTABLES (1 << 1)
+#define KVSTORE_TRACK_WRITE_ACTIVITY (1 << 2)
 kvstore *kvstoreCreate(hashtableType *type, int num_hashtables_bits, int flags);
 void kvstoreEmpty(kvstore *kvs, void(callback)(hashtable *));
 void kvstoreRelease(kvstore *kvs);
@@ -37,6 +38,11 @@ int kvstoreNumAllocatedHashtables(kvstore *kvs);
 int kvstoreNumHashtables(kvstore *kvs);
 uint64_t kvstoreGetHash(kvstore *kvs, const void *key);
 
+/* Per-hashtable write activity tracking (KVSTORE_TRACK_WRITE_ACTIVITY) */
+void kvstoreHashtableMarkDirty(kvstore *kvs, int didx);
+unsigned long long kvstoreHashtableDirtyCount(kvstore *kvs, int didx);
+void kvstoreDecayDirtyCounters(kvstore *kvs);
+
 void kvstoreHashtableRehashingStarted(hashtable *d);
 void kvstoreHashtableRehashingCompleted(hashtable *d);
 void kvstoreHashtableTrackMemUsage(hashtable *s, ssize_t delta);
@@ -134,6 +134,36 @@ int latencyResetEvent(char *event_to_reset) {
     return resets;
 }
 
+/* Reset the windowed histogram that is about to start collecting, for every
+ * command (and subcommand) that allocated one. */
+static void latencyHistogramResetWindow(hashtable *commands) {
+    hashtableIterator iter;
+    void *next;
+    hashtableInitIterator(&iter, commands, HASHTABLE_ITER_SAFE);
+    while (hashtableNext(&iter, &next)) {
+        struct serverCommand *cmd = next;
+        if (cmd->latency_histogram_recent[server.latency_tracking_recent_idx])
+            hdr_reset(cmd->latency_histogram_recent[server.latency_tracking_recent_idx]);
+        if (cmd->subcommands_ht) latencyHistogramResetWindow(cmd->subcommands_ht);
+    }
+    hashtableResetIterator(&iter);
+}
+
+/* Rotate the rolling latency histogram windows, called from serverCron.
+ * Every latency-tracking-window seconds the histogram that was collecting
+ * becomes the "previous" window and the other one is cleared and starts
+ * collecting. LATENCY HISTOGRAM merges the two, so the recent distribution
+ * always covers between one and two windows and old samples age out instead
+ * of accumulating forever like in the lifetime histogram. */
+void latencyTrackingRotateWindows(void) {
+    static time_t next_rotation = 0;
+    if (server.latency_tracking_window <= 0) return;
+    if (server.unixtime < next_rotation) return;
+    next_rotation = server.unixtime + server.latency_tracking_window;
+    server.latency_tracking_recent_idx ^= 1;
+    latencyHistogramResetWindow(server.commands);
+}
+
 /* ------------------------ Latency reporting (doctor) ---------------------- */
 
 /* Analyze the samples available for a given event and return a structure
@@ -498,18 +528,14 @@ sds createLatencyReport(void) {
 
 /* ---------------------- Latency command implementation -------------------- */
 
-/* latencyCommand() helper to produce a map of time buckets,
+/* fillCommandCDF() helper to produce a map of time buckets,
  * each representing a latency range,
  * between 1 nanosecond and roughly 1 second.
  * Each bucket covers twice the previous bucket's range.
  * Empty buckets are not printed.
  * Everything above 1 sec is considered +Inf.
  * At max there will be log2(1000000000)=30 buckets */
-void fillCommandCDF(client *c, struct hdr_histogram *histogram) {
-    addReplyMapLen(c, 2);
-    addReplyBulkCString(c, "calls");
-    addReplyLongLong(c, (long long)histogram->total_count);
-    addReplyBulkCString(c, "histogram_usec");
+static void fillCDFBuckets(client *c, struct hdr_histogram *histogram) {
     void *replylen = addReplyDeferredLen(c);
     int samples = 0;
     struct hdr_iter iter;
@@ -528,6 +554,31 @@ void fillCommandCDF(client *c, struct hdr_histogram *histogram) {
     setDeferredMapLen(c, replylen, samples);
 }
 
+/* latencyCommand() helper to produce the per command latency distribution:
+ * the lifetime cumulative histogram and, when rolling windows are enabled,
+ * a "recent" histogram merging the collecting and the previous window, so
+ * it covers between one and two windows worth of samples. */
+void fillCommandCDF(client *c, struct serverCommand *cmd) {
+    int recent = server.latency_tracking_window > 0 &&
+                 (cmd->latency_histogram_recent[0] || cmd->latency_histogram_recent[1]);
+    addReplyMapLen(c, recent ? 4 : 2);
+    addReplyBulkCString(c, "calls");
+    addReplyLongLong(c, (long long)cmd->latency_histogram->total_count);
+    addReplyBulkCString(c, "histogram_usec");
+    fillCDFBuckets(c, cmd->latency_histogram);
+    if (recent) {
+        struct hdr_histogram *merged;
+        hdr_init(LATENCY_HISTOGRAM_MIN_VALUE, LATENCY_HISTOGRAM_MAX_VALUE, LATENCY_HISTOGRAM_PRECISION, &merged);
+        for (int i = 0; i < 2; i++)
+            if (cmd->latency_histogram_recent[i]) hdr_add(merged, cmd->latency_histogram_recent[i]);
+        addReplyBulkCString(c, "recent_calls");
+        addReplyLongLong(c, (long long)merged->total_count);
+        addReplyBulkCString(c, "histogram_usec_recent");
+        fillCDFBuckets(c, merged);
+        hdr_close(merged);
+    }
+}
+
 /* latencyCommand() helper to produce for all commands,
  * a per command cumulative distribution of latencies. */
 void latencyAllCommandsFillCDF(client *c, hashtable *commands, int *command_with_data) {
@@ -538,7 +589,7 @@ void latencyAllCommandsFillCDF(client *c, hashtable *commands, int *command_with
         struct serverCommand *cmd = next;
         if (cmd->latency_histogram) {
             addReplyBulkCBuffer(c, cmd->fullname, sdslen(cmd->fullname));
-            fillCommandCDF(c, cmd->latency_histogram);
+            fillCommandCDF(c, cmd);
             (*command_with_data)++;
         }
 
@@ -563,7 +614,7 @@ void latencySpecificCommandsFillCDF(client *c) {
 
         if (cmd->latency_histogram) {
             addReplyBulkCBuffer(c, cmd->fullname, sdslen(cmd->fullname));
-            fillCommandCDF(c, cmd->latency_histogram);
+            fillCommandCDF(c, cmd);
             command_with_data++;
         }
 
@@ -575,7 +626,7 @@ void latencySpecificCommandsFillCDF(client *c) {
                 struct serverCommand *sub = next;
                 if (sub->latency_histogram) {
                     addReplyBulkCBuffer(c, sub->fullname, sdslen(sub->fullname));
-                    fillCommandCDF(c, sub->latency_histogram);
+                    fillCommandCDF(c, sub);
                     command_with_data++;
                 }
             }
@@ -749,6 +800,7 @@ void latencyCommand(client *c) {
             "    (default: reset all data for all event classes)",
             "HISTOGRAM [COMMAND ...]",
             "    Return a cumulative distribution of latencies in the format of a histogram for the specified command names.",
+            "    If latency-tracking-window is non zero a rolling window distribution is returned as well.",
             "    If no commands are specified then all histograms are replied.",
             NULL,
         };
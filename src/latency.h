@@ -65,6 +65,7 @@ struct latencyStats {
 
 void latencyMonitorInit(void);
 void latencyAddSample(const char *event, mstime_t latency);
+void latencyTrackingRotateWindows(void);
 
 /* Latency monitoring macros. */
 
@@ -100,6 +101,7 @@ typedef enum {
     EL_DURATION_TYPE_EL = 0, // cumulative time duration metric of the whole eventloop
     EL_DURATION_TYPE_CMD,    // cumulative time duration metric of executing commands
     EL_DURATION_TYPE_AOF,    // cumulative time duration metric of flushing AOF in eventloop
+    EL_DURATION_TYPE_POLL,   // cumulative time duration metric of waiting in the multiplexing API (and the module GIL)
     EL_DURATION_TYPE_CRON,   // cumulative time duration metric of cron (serverCron and beforeSleep, but excluding IO and
                              // AOF)
     EL_DURATION_TYPE_NUM
@@ -18,6 +18,17 @@ void lazyfreeFreeObject(void *args[]) {
     atomic_fetch_add_explicit(&lazyfreed_objects, 1, memory_order_relaxed);
 }
 
+/* Release an array of objects from the lazyfree thread. The array itself was
+ * allocated by the main thread and is freed here together with the objects. */
+void lazyfreeFreeObjectsBatch(void *args[]) {
+    robj **objs = args[0];
+    size_t numobjs = (size_t)args[1];
+    for (size_t i = 0; i < numobjs; i++) decrRefCount(objs[i]);
+    zfree(objs);
+    atomic_fetch_sub_explicit(&lazyfree_objects, numobjs, memory_order_relaxed);
+    atomic_fetch_add_explicit(&lazyfreed_objects, numobjs, memory_order_relaxed);
+}
+
 /* Release a database from the lazyfree thread. The 'db' pointer is the
  * database which was substituted with a fresh one in the main thread
  * when the database was logically deleted. */
@@ -167,6 +178,36 @@ size_t lazyfreeGetFreeEffort(robj *key, robj *obj, int dbid) {
  * slower... So under a certain limit we just free the object synchronously. */
 #define LAZYFREE_THRESHOLD 64
 
+/* While a batch is open (see lazyfreeBatchBegin()) objects queued by
+ * freeObjAsync() are accumulated here and submitted to the lazyfree thread
+ * with a single background job, instead of one job per object. */
+#define LAZYFREE_BATCH_SIZE 128
+static robj *batch_objs[LAZYFREE_BATCH_SIZE];
+static int batch_len = 0;
+static int batch_depth = 0;
+
+static void lazyfreeBatchFlush(void) {
+    if (batch_len == 0) return;
+    robj **objs = zmalloc(sizeof(robj *) * batch_len);
+    memcpy(objs, batch_objs, sizeof(robj *) * batch_len);
+    bioCreateLazyFreeJob(lazyfreeFreeObjectsBatch, 2, objs, (void *)(size_t)batch_len);
+    batch_len = 0;
+}
+
+/* Start accumulating the objects passed to freeObjAsync() so that they are
+ * handed to the lazyfree thread as one job. Must be paired with
+ * lazyfreeBatchEnd(); calls may nest, the batch is submitted when the
+ * outermost batch is closed (or when the accumulation buffer fills up).
+ * Main thread only. */
+void lazyfreeBatchBegin(void) {
+    batch_depth++;
+}
+
+void lazyfreeBatchEnd(void) {
+    serverAssert(batch_depth > 0);
+    if (--batch_depth == 0) lazyfreeBatchFlush();
+}
+
 /* Free an object, if the object is huge enough, free it in async way. */
 void freeObjAsync(robj *key, robj *obj, int dbid) {
     size_t free_effort = lazyfreeGetFreeEffort(key, obj, dbid);
@@ -176,7 +217,12 @@ void freeObjAsync(robj *key, robj *obj, int dbid) {
      * objects, and then call dbDelete(). */
     if (free_effort > LAZYFREE_THRESHOLD && obj->refcount == 1) {
         atomic_fetch_add_explicit(&lazyfree_objects, 1, memory_order_relaxed);
-        bioCreateLazyFreeJob(lazyfreeFreeObject, 1, obj);
+        if (batch_depth > 0) {
+            batch_objs[batch_len++] = obj;
+            if (batch_len == LAZYFREE_BATCH_SIZE) lazyfreeBatchFlush();
+        } else {
+            bioCreateLazyFreeJob(lazyfreeFreeObject, 1, obj);
+        }
     } else {
         decrRefCount(obj);
     }
@@ -193,7 +239,7 @@ void emptyDbAsync(serverDb *db) {
         flags |= KVSTORE_FREE_EMPTY_HASHTABLES;
     }
     kvstore *oldkeys = db->keys, *oldexpires = db->expires;
-    db->keys = kvstoreCreate(&kvstoreKeysHashtableType, slot_count_bits, flags);
+    db->keys = kvstoreCreate(&kvstoreKeysHashtableType, slot_count_bits, flags | KVSTORE_TRACK_WRITE_ACTIVITY);
     db->expires = kvstoreCreate(&kvstoreExpiresHashtableType, slot_count_bits, flags);
     atomic_fetch_add_explicit(&lazyfree_objects, kvstoreSize(oldkeys), memory_order_relaxed);
     bioCreateLazyFreeJob(lazyfreeFreeDatabase, 2, oldkeys, oldexpires);
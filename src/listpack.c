@@ -676,6 +676,42 @@ unsigned char *lpGetValue(unsigned char *p, unsigned int *slen, long long *lval)
     return vstr;
 }
 
+/* Decode up to 'count' consecutive entries starting from 'p' into the
+ * 'entries' array in a single forward pass. For each entry 'sval'/'slen' are
+ * set when it is a string (pointing inside the listpack itself), otherwise
+ * 'sval' is NULL and 'lval' holds the integer value.
+ *
+ * Compared to a lpGetValue() + lpNext() loop, this decodes each entry header
+ * only once (the decoded length is reused to advance) and replaces the full
+ * per-entry validation of lpNext() with a bounds check, which matters for
+ * commands that walk a large part of the listpack.
+ *
+ * Returns the number of entries decoded, which is smaller than 'count' only
+ * when the end of the listpack is reached. If 'next' is not NULL, *next is
+ * set to the entry following the last decoded one, or NULL at the end of
+ * the listpack. */
+unsigned int lpGetRange(unsigned char *lp, unsigned char *p, listpackEntry *entries, unsigned int count, unsigned char **next) {
+    unsigned int decoded = 0;
+
+    assert(p);
+    while (decoded < count && p[0] != LP_EOF) {
+        listpackEntry *e = &entries[decoded++];
+        uint64_t entry_size = 0;
+        int64_t v;
+
+        e->sval = lpGetWithSize(p, &v, NULL, &entry_size);
+        assert(entry_size != 0); /* unknown encoding byte */
+        if (e->sval)
+            e->slen = v;
+        else
+            e->lval = v;
+        ASSERT_INTEGRITY_LEN(lp, p, entry_size);
+        p += entry_size;
+    }
+    if (next) *next = (p[0] == LP_EOF) ? NULL : p;
+    return decoded;
+}
+
 /* Find pointer to the entry equal to the specified entry. Skip 'skip' entries
  * between every comparison. Returns NULL when the field could not be found. */
 unsigned char *lpFind(unsigned char *lp, unsigned char *p, unsigned char *s, uint32_t slen, unsigned int skip) {
@@ -20,8 +20,10 @@ typedef struct luaFunction {
 } luaFunction;
 
 typedef struct luaEngineCtx {
-    lua_State *eval_lua;     /* The Lua interpreter for EVAL commands. We use just one for all EVAL calls */
-    lua_State *function_lua; /* The Lua interpreter for FCALL commands. We use just one for all FCALL calls */
+    lua_State *eval_lua;     /* The Lua interpreter for EVAL commands. We use just one for all EVAL calls.
+                              * NULL until the first EVAL related command is served. */
+    lua_State *function_lua; /* The Lua interpreter for FCALL commands. We use just one for all FCALL calls.
+                              * NULL until the first function is compiled. */
 } luaEngineCtx;
 
 /* Adds server.debug() function used by lua debugger
@@ -162,12 +164,19 @@ static void initializeLuaState(luaEngineCtx *lua_engine_ctx,
 }
 
 static struct luaEngineCtx *createEngineContext(void) {
-    luaEngineCtx *lua_engine_ctx = zmalloc(sizeof(*lua_engine_ctx));
-
-    initializeLuaState(lua_engine_ctx, VMSE_EVAL);
-    initializeLuaState(lua_engine_ctx, VMSE_FUNCTION);
+    /* The interpreters themselves are created lazily on first use: setting
+     * up a Lua state (registering the server API and recursively locking
+     * the global table) is one of the slower startup stages, and many
+     * instances never run a script at all. */
+    return zcalloc(sizeof(luaEngineCtx));
+}
 
-    return lua_engine_ctx;
+/* Return the interpreter serving 'type', creating it on first use. */
+static lua_State *luaEngineGetState(luaEngineCtx *lua_engine_ctx, subsystemType type) {
+    serverAssert(type == VMSE_EVAL || type == VMSE_FUNCTION);
+    lua_State **lua = type == VMSE_EVAL ? &lua_engine_ctx->eval_lua : &lua_engine_ctx->function_lua;
+    if (*lua == NULL) initializeLuaState(lua_engine_ctx, type);
+    return *lua;
 }
 
 static engineMemoryInfo luaEngineGetMemoryInfo(ValkeyModuleCtx *module_ctx,
@@ -179,10 +188,10 @@ static engineMemoryInfo luaEngineGetMemoryInfo(ValkeyModuleCtx *module_ctx,
     luaEngineCtx *lua_engine_ctx = engine_ctx;
     engineMemoryInfo mem_info = {0};
 
-    if (type == VMSE_EVAL || type == VMSE_ALL) {
+    if ((type == VMSE_EVAL || type == VMSE_ALL) && lua_engine_ctx->eval_lua) {
         mem_info.used_memory += luaMemory(lua_engine_ctx->eval_lua);
     }
-    if (type == VMSE_FUNCTION || type == VMSE_ALL) {
+    if ((type == VMSE_FUNCTION || type == VMSE_ALL) && lua_engine_ctx->function_lua) {
         mem_info.used_memory += luaMemory(lua_engine_ctx->function_lua);
     }
 
@@ -205,7 +214,7 @@ static compiledFunction **luaEngineCompileCode(ValkeyModuleCtx *module_ctx,
     compiledFunction **functions = NULL;
 
     if (type == VMSE_EVAL) {
-        lua_State *lua = lua_engine_ctx->eval_lua;
+        lua_State *lua = luaEngineGetState(lua_engine_ctx, VMSE_EVAL);
 
         if (luaL_loadbuffer(lua, code, strlen(code), "@user_script")) {
             sds error = sdscatfmt(sdsempty(), "Error compiling script (new function): %s", lua_tostring(lua, -1));
@@ -234,7 +243,7 @@ static compiledFunction **luaEngineCompileCode(ValkeyModuleCtx *module_ctx,
         functions = zcalloc(sizeof(compiledFunction *));
         *functions = func;
     } else {
-        functions = luaFunctionLibraryCreate(lua_engine_ctx->function_lua,
+        functions = luaFunctionLibraryCreate(luaEngineGetState(lua_engine_ctx, VMSE_FUNCTION),
                                              code,
                                              timeout,
                                              out_num_compiled_functions,
@@ -261,11 +270,11 @@ static void luaEngineFunctionCall(ValkeyModuleCtx *module_ctx,
     int lua_function_ref = -1;
 
     if (type == VMSE_EVAL) {
-        lua = lua_engine_ctx->eval_lua;
+        lua = luaEngineGetState(lua_engine_ctx, VMSE_EVAL);
         luaFunction *script = compiled_function->function;
         lua_function_ref = script->function_ref;
     } else {
-        lua = lua_engine_ctx->function_lua;
+        lua = luaEngineGetState(lua_engine_ctx, VMSE_FUNCTION);
         lua_function_ref = luaFunctionGetLuaFunctionRef(compiled_function);
     }
 
@@ -312,9 +321,12 @@ static callableLazyEvalReset *luaEngineResetEvalEnv(ValkeyModuleCtx *module_ctx,
     serverAssert(module_ctx == NULL);
 
     luaEngineCtx *lua_engine_ctx = (luaEngineCtx *)engine_ctx;
-    serverAssert(lua_engine_ctx->eval_lua);
     callableLazyEvalReset *callback = NULL;
 
+    /* If no EVAL related command was served yet there is no interpreter to
+     * reset. */
+    if (lua_engine_ctx->eval_lua == NULL) return NULL;
+
     if (async) {
         callback = zcalloc(sizeof(*callback));
         *callback = (callableLazyEvalReset){
@@ -325,7 +337,8 @@ static callableLazyEvalReset *luaEngineResetEvalEnv(ValkeyModuleCtx *module_ctx,
         resetEvalContext(lua_engine_ctx->eval_lua);
     }
 
-    initializeLuaState(lua_engine_ctx, VMSE_EVAL);
+    /* A fresh interpreter is created on the next use. */
+    lua_engine_ctx->eval_lua = NULL;
 
     return callback;
 }
@@ -1604,9 +1604,11 @@ static int server_math_randomseed(lua_State *L) {
     return 0;
 }
 
-/* This is the Lua script "count" hook that we use to detect scripts timeout. */
-static void luaMaskCountHook(lua_State *lua, lua_Debug *ar) {
-    UNUSED(ar);
+static void luaMaskCountHook(lua_State *lua, lua_Debug *ar);
+
+/* Check for SCRIPT KILL / FUNCTION KILL and abort the script when requested.
+ * Shared by the plain count hook and the profiler hook. */
+static void luaCheckScriptKill(lua_State *lua) {
     scriptRunCtx *rctx = luaGetFromRegistry(lua, REGISTRY_RUN_CTX_NAME);
     serverAssert(rctx); /* Only supported inside script invocation */
     if (scriptInterrupt(rctx) == SCRIPT_KILL) {
@@ -1630,6 +1632,115 @@ static void luaMaskCountHook(lua_State *lua, lua_Debug *ar) {
     }
 }
 
+/* This is the Lua script "count" hook that we use to detect scripts timeout. */
+static void luaMaskCountHook(lua_State *lua, lua_Debug *ar) {
+    UNUSED(ar);
+    luaCheckScriptKill(lua);
+}
+
+/* -----------------------------------------------------------------------------
+ * Lua sampling profiler (SCRIPT PROFILE)
+ *
+ * When enabled, a count hook fires every 'interval' VM instructions and
+ * attributes the currently executing source line with one sample, giving a
+ * line-level picture of where scripts spend their cycles. Samples accumulate
+ * across invocations until SCRIPT PROFILE RESET (or START, which resets too).
+ * -------------------------------------------------------------------------- */
+
+#define LUA_PROFILER_DEFAULT_INTERVAL 1000
+
+static struct {
+    int enabled;
+    long long interval;       /* VM instructions between samples. */
+    long long kill_check;     /* Instructions since the last kill check. */
+    unsigned long long total; /* Total samples taken. */
+    dict *samples;            /* "source:line" (sds) -> sample count. */
+} lua_profiler;
+
+static dictType luaProfilerDictType = {
+    dictSdsHash,       /* hash function */
+    NULL,              /* key dup */
+    dictSdsKeyCompare, /* key compare */
+    dictSdsDestructor, /* key destructor */
+    NULL,              /* val destructor */
+    NULL               /* allow to expand */
+};
+
+/* Profiler count hook: sample the line Lua is executing right now. */
+static void luaProfilerHook(lua_State *lua, lua_Debug *ar) {
+    if (lua_getstack(lua, 0, ar) && lua_getinfo(lua, "Sl", ar)) {
+        sds key = sdscatfmt(sdsempty(), "%s:%i", ar->short_src, ar->currentline);
+        dictEntry *existing, *de = dictAddRaw(lua_profiler.samples, key, &existing);
+        if (de) {
+            dictSetUnsignedIntegerVal(de, 1);
+        } else {
+            sdsfree(key);
+            dictIncrUnsignedIntegerVal(existing, 1);
+        }
+        lua_profiler.total++;
+    }
+
+    /* While profiling we replace the plain count hook, so keep honoring
+     * SCRIPT KILL at (roughly) the usual instruction cadence. */
+    if (server.busy_reply_threshold > 0) {
+        lua_profiler.kill_check += lua_profiler.interval;
+        if (lua_profiler.kill_check >= 100000) {
+            lua_profiler.kill_check = 0;
+            luaCheckScriptKill(lua);
+        }
+    }
+}
+
+void luaProfilerStart(long long interval) {
+    if (!lua_profiler.samples) lua_profiler.samples = dictCreate(&luaProfilerDictType);
+    luaProfilerReset();
+    lua_profiler.interval = interval > 0 ? interval : LUA_PROFILER_DEFAULT_INTERVAL;
+    lua_profiler.enabled = 1;
+}
+
+void luaProfilerStop(void) {
+    lua_profiler.enabled = 0;
+}
+
+int luaProfilerIsEnabled(void) {
+    return lua_profiler.enabled;
+}
+
+void luaProfilerReset(void) {
+    if (lua_profiler.samples) dictEmpty(lua_profiler.samples, NULL);
+    lua_profiler.total = 0;
+    lua_profiler.kill_check = 0;
+}
+
+static int luaProfilerSampleCompare(const void *a, const void *b) {
+    uint64_t sa = dictGetUnsignedIntegerVal(*(dictEntry **)a);
+    uint64_t sb = dictGetUnsignedIntegerVal(*(dictEntry **)b);
+    if (sa != sb) return sb > sa ? 1 : -1;
+    return 0;
+}
+
+/* Reply with the collected samples as [source:line, count] pairs, most
+ * sampled line first. */
+void luaProfilerDumpReply(client *c) {
+    unsigned long num = lua_profiler.samples ? dictSize(lua_profiler.samples) : 0, i = 0;
+
+    addReplyArrayLen(c, num);
+    if (num == 0) return;
+
+    dictEntry **entries = zmalloc(sizeof(dictEntry *) * num);
+    dictIterator *di = dictGetIterator(lua_profiler.samples);
+    dictEntry *de;
+    while ((de = dictNext(di))) entries[i++] = de;
+    dictReleaseIterator(di);
+    qsort(entries, num, sizeof(dictEntry *), luaProfilerSampleCompare);
+    for (i = 0; i < num; i++) {
+        addReplyArrayLen(c, 2);
+        addReplyBulkSds(c, sdsdup((sds)dictGetKey(entries[i])));
+        addReplyLongLong(c, dictGetUnsignedIntegerVal(entries[i]));
+    }
+    zfree(entries);
+}
+
 void luaErrorInformationDiscard(errorInfo *err_info) {
     if (err_info->msg) sdsfree(err_info->msg);
     if (err_info->source) sdsfree(err_info->source);
@@ -1735,12 +1846,17 @@ void luaCallFunction(scriptRunCtx *run_ctx,
      * each time the Lua hook is invoked. */
     luaSaveOnRegistry(lua, REGISTRY_RUN_CTX_NAME, run_ctx);
 
-    if (server.busy_reply_threshold > 0 && !debug_enabled) {
-        lua_sethook(lua, luaMaskCountHook, LUA_MASKCOUNT, 100000);
-        delhook = 1;
-    } else if (debug_enabled) {
+    if (debug_enabled) {
         lua_sethook(lua, luaLdbLineHook, LUA_MASKLINE | LUA_MASKCOUNT, 100000);
         delhook = 1;
+    } else if (lua_profiler.enabled) {
+        /* The profiler hook also performs the SCRIPT KILL check, so it
+         * replaces the plain count hook while profiling is on. */
+        lua_sethook(lua, luaProfilerHook, LUA_MASKCOUNT, (int)lua_profiler.interval);
+        delhook = 1;
+    } else if (server.busy_reply_threshold > 0) {
+        lua_sethook(lua, luaMaskCountHook, LUA_MASKCOUNT, 100000);
+        delhook = 1;
     }
 
     /* Populate the argv and keys table accordingly to the arguments that
@@ -88,6 +88,11 @@ void luaCallFunction(scriptRunCtx *r_ctx,
 void luaExtractErrorInformation(lua_State *lua, errorInfo *err_info);
 void luaErrorInformationDiscard(errorInfo *err_info);
 unsigned long luaMemory(lua_State *lua);
+void luaProfilerStart(long long interval);
+void luaProfilerStop(void);
+int luaProfilerIsEnabled(void);
+void luaProfilerReset(void);
+void luaProfilerDumpReply(client *c);
 
 
 #endif /* __SCRIPT_LUA_H_ */
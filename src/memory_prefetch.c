@@ -9,15 +9,18 @@
 
 #include "memory_prefetch.h"
 #include "server.h"
+#include "quicklist.h"
 
 typedef enum {
-    PREFETCH_ENTRY, /* Initial state, prefetch entries associated with the given key's hash */
-    PREFETCH_VALUE, /* prefetch the value object of the entry found in the previous step */
-    PREFETCH_DONE   /* Indicates that prefetching for this key is complete */
+    PREFETCH_ENTRY,   /* Initial state, prefetch entries associated with the given key's hash */
+    PREFETCH_VALUE,   /* prefetch the value object of the entry found in the previous step */
+    PREFETCH_PAYLOAD, /* prefetch the first payload node behind the value pointer (type specific) */
+    PREFETCH_DONE     /* Indicates that prefetching for this key is complete */
 } PrefetchState;
 
 typedef struct KeyPrefetchInfo {
     PrefetchState state; /* Current state of the prefetch operation */
+    robj *val;           /* Value object, set when entering PREFETCH_PAYLOAD */
     hashtableIncrementalFindState hashtab_state;
 } KeyPrefetchInfo;
 
@@ -129,14 +132,55 @@ static void prefetchValue(KeyPrefetchInfo *info) {
     void *entry;
     if (hashtableIncrementalFindGetResult(&info->hashtab_state, &entry)) {
         robj *val = entry;
-        if (val->encoding == OBJ_ENCODING_RAW && val->type == OBJ_STRING) {
+        switch (val->encoding) {
+        case OBJ_ENCODING_RAW:
+        case OBJ_ENCODING_LISTPACK:
+        case OBJ_ENCODING_INTSET:
+        case OBJ_ENCODING_HASHTABLE:
+            /* The payload is one contiguous allocation; its header is where
+             * the first access lands. */
             valkey_prefetch(val->ptr);
+            break;
+        case OBJ_ENCODING_QUICKLIST:
+        case OBJ_ENCODING_SKIPLIST:
+            /* The pointed-to struct holds pointers to the nodes the command
+             * will touch; prefetch it now and chase it one more level in
+             * PREFETCH_PAYLOAD once the load had time to complete. */
+            valkey_prefetch(val->ptr);
+            info->val = val;
+            info->state = PREFETCH_PAYLOAD;
+            moveToNextKey();
+            return;
+        default: break;
         }
     }
 
     markKeyAsdone(info);
 }
 
+/* Prefetch the first payload node(s) behind the value's top-level struct, so
+ * the command's first real data access doesn't miss either. */
+static void prefetchPayload(KeyPrefetchInfo *info) {
+    robj *val = info->val;
+    switch (val->encoding) {
+    case OBJ_ENCODING_QUICKLIST: {
+        /* LPUSH/LPOP/LRANGE start at the head, RPUSH/RPOP at the tail. */
+        quicklist *ql = val->ptr;
+        if (ql->head) valkey_prefetch(ql->head);
+        if (ql->tail && ql->tail != ql->head) valkey_prefetch(ql->tail);
+        break;
+    }
+    case OBJ_ENCODING_SKIPLIST: {
+        zset *zs = val->ptr;
+        valkey_prefetch(zs->ht);
+        valkey_prefetch(zs->zsl);
+        break;
+    }
+    default: break;
+    }
+    markKeyAsdone(info);
+}
+
 /* Prefetch hashtable data for an array of keys.
  *
  * This function takes an array of tables and keys, attempting to bring
@@ -154,6 +198,7 @@ static void hashtablePrefetch(hashtable **tables) {
         switch (info->state) {
         case PREFETCH_ENTRY: prefetchEntry(info); break;
         case PREFETCH_VALUE: prefetchValue(info); break;
+        case PREFETCH_PAYLOAD: prefetchPayload(info); break;
         default: serverPanic("Unknown prefetch state %d", info->state);
         }
     }
@@ -278,3 +323,78 @@ void removeClientFromPendingCommandsBatch(client *c) {
         }
     }
 }
+
+/* Interleave the bucket walks for a window of up to PREFETCH_INLINE_WINDOW
+ * keys so their cache and TLB misses overlap instead of being paid serially
+ * by the lookups that follow. The io-thread batch above prefetches across
+ * commands, so a single command carrying many keys (MGET, LMPOP, ZMPOP)
+ * still pays its misses one by one; this variant runs inline on the main
+ * thread over a command's own key array. The command's subsequent lookups
+ * then repeat the find against warm cache lines.
+ *
+ * Found values get their payload prefetched one level deep as well, like
+ * prefetchValue()/prefetchPayload() do for the io-thread batch. */
+void prefetchKeysInline(serverDb *db, robj **keys, int count) {
+    hashtableIncrementalFindState states[PREFETCH_INLINE_WINDOW];
+    hashtable *tables[PREFETCH_INLINE_WINDOW];
+    robj *vals[PREFETCH_INLINE_WINDOW];
+    int pending = 0;
+
+    if (count > PREFETCH_INLINE_WINDOW) count = PREFETCH_INLINE_WINDOW;
+    for (int i = 0; i < count; i++) {
+        sds key = keys[i]->ptr;
+        int didx = server.cluster_enabled ? getKeySlot(key) : 0;
+        hashtable *ht = kvstoreGetHashtable(db->keys, didx);
+        vals[i] = NULL;
+        if (!ht || hashtableSize(ht) == 0) {
+            tables[i] = NULL;
+            continue;
+        }
+        tables[i] = ht;
+        hashtableIncrementalFindInit(&states[i], ht, key);
+        pending++;
+    }
+
+    while (pending) {
+        for (int i = 0; i < count; i++) {
+            if (!tables[i]) continue;
+            if (hashtableIncrementalFindStep(&states[i]) == 1) continue; /* Not done yet. */
+            void *entry;
+            if (hashtableIncrementalFindGetResult(&states[i], &entry)) {
+                robj *val = entry;
+                switch (val->encoding) {
+                case OBJ_ENCODING_RAW:
+                case OBJ_ENCODING_LISTPACK:
+                case OBJ_ENCODING_INTSET:
+                case OBJ_ENCODING_HASHTABLE:
+                    /* One contiguous allocation behind ptr. */
+                    valkey_prefetch(val->ptr);
+                    break;
+                case OBJ_ENCODING_QUICKLIST:
+                case OBJ_ENCODING_SKIPLIST:
+                    /* Top-level struct now, nodes below once it arrived. */
+                    valkey_prefetch(val->ptr);
+                    vals[i] = val;
+                    break;
+                default: break;
+                }
+            }
+            tables[i] = NULL;
+            pending--;
+        }
+    }
+
+    /* Second level: by now the top-level structs had time to arrive. */
+    for (int i = 0; i < count; i++) {
+        if (!vals[i]) continue;
+        if (vals[i]->encoding == OBJ_ENCODING_QUICKLIST) {
+            quicklist *ql = vals[i]->ptr;
+            if (ql->head) valkey_prefetch(ql->head);
+            if (ql->tail && ql->tail != ql->head) valkey_prefetch(ql->tail);
+        } else {
+            zset *zs = vals[i]->ptr;
+            valkey_prefetch(zs->ht);
+            valkey_prefetch(zs->zsl);
+        }
+    }
+}
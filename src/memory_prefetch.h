@@ -2,10 +2,18 @@
 #define MEMORY_PREFETCH_H
 
 struct client;
+struct serverDb;
+struct serverObject;
+
+/* Keys walked concurrently by prefetchKeysInline(), and the key count at
+ * which a multi-key command should start using it. */
+#define PREFETCH_INLINE_WINDOW 16
+#define PREFETCH_INLINE_MIN_KEYS 16
 
 void prefetchCommandsBatchInit(void);
 void processClientsCommandsBatch(void);
 int addCommandToBatchAndProcessIfFull(struct client *c);
 void removeClientFromPendingCommandsBatch(struct client *c);
+void prefetchKeysInline(struct serverDb *db, struct serverObject **keys, int count);
 
 #endif /* MEMORY_PREFETCH_H */
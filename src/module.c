@@ -10939,6 +10939,172 @@ unsigned long long VM_CommandFilterGetClientId(ValkeyModuleCommandFilterCtx *fct
     return fctx->c->id;
 }
 
+/* --------------------------------------------------------------------------
+ * ## Command tracing ring
+ *
+ * An opt-in ring buffer of post-execution command events (command name, key
+ * hash, duration, reply size) that modules can poll from their own threads.
+ * Unlike a command filter, which runs synchronously on every dispatch, the
+ * ring adds a single flag check to the command path while disabled and a
+ * plain struct copy while enabled; all analysis happens on the module's
+ * thread.
+ *
+ * The main thread is the only writer. Each slot carries a sequence number
+ * that is cleared before the payload is rewritten and republished after, so
+ * a reader that raced with the writer detects the mismatch and skips the
+ * entry instead of returning torn data. Slow readers lose the oldest
+ * entries, they never block the writer.
+ * -------------------------------------------------------------------------- */
+
+typedef struct moduleCommandTraceSlot {
+    _Atomic uint64_t seq; /* trace id + 1 once the payload is stable, 0 while written. */
+    ValkeyModuleCommandTrace trace;
+} moduleCommandTraceSlot;
+
+static struct {
+    _Atomic int enabled;
+    _Atomic uint64_t next; /* Id of the next trace to be written. */
+    size_t size;           /* Number of slots, power of two. */
+    moduleCommandTraceSlot *slots;
+    struct ValkeyModule *owner;
+} moduleTraceRing;
+
+/* Cheap check used by call() before doing any tracing work. */
+int moduleCommandTraceEnabled(void) {
+    return atomic_load_explicit(&moduleTraceRing.enabled, memory_order_relaxed);
+}
+
+/* Record one executed command into the tracing ring. Main thread only. */
+void moduleCommandTraceRecord(client *c, struct serverCommand *cmd, long long duration, uint64_t reply_bytes) {
+    uint64_t id = atomic_load_explicit(&moduleTraceRing.next, memory_order_relaxed);
+    moduleCommandTraceSlot *slot = &moduleTraceRing.slots[id & (moduleTraceRing.size - 1)];
+
+    /* Take the slot down so concurrent readers discard what they copy from
+     * it while we rewrite the payload. */
+    atomic_store_explicit(&slot->seq, 0, memory_order_relaxed);
+    atomic_thread_fence(memory_order_release);
+
+    slot->trace.id = id;
+    size_t namelen = sdslen(cmd->fullname);
+    if (namelen >= sizeof(slot->trace.cmdname)) namelen = sizeof(slot->trace.cmdname) - 1;
+    memcpy(slot->trace.cmdname, cmd->fullname, namelen);
+    slot->trace.cmdname[namelen] = '\0';
+    slot->trace.duration_us = duration < 0 ? 0 : (uint64_t)duration;
+    slot->trace.reply_bytes = reply_bytes;
+
+    slot->trace.key_hash = VALKEYMODULE_CMDTRACE_NO_KEY;
+    getKeysResult result;
+    initGetKeysResult(&result);
+    int numkeys = getKeysFromCommand(cmd, c->argv, c->argc, &result);
+    if (numkeys > 0) {
+        robj *key = c->argv[result.keys[0].pos];
+        slot->trace.key_hash = keyHashSlot(key->ptr, sdslen(key->ptr));
+    }
+    getKeysFreeResult(&result);
+
+    atomic_store_explicit(&slot->seq, id + 1, memory_order_release);
+    atomic_store_explicit(&moduleTraceRing.next, id + 1, memory_order_release);
+}
+
+/* Called when a module is unloaded, to tear the ring down if it owns it. */
+void moduleCommandTraceStopIfOwner(struct ValkeyModule *module) {
+    if (moduleTraceRing.owner == module) {
+        atomic_store_explicit(&moduleTraceRing.enabled, 0, memory_order_release);
+        moduleTraceRing.owner = NULL;
+    }
+}
+
+/* Start recording executed commands into the command tracing ring.
+ *
+ * `ring_size` is the number of events the ring can hold before the oldest
+ * are overwritten; it is rounded up to a power of two and clamped to the
+ * [1024, 1048576] range, with 0 meaning the default of 16384.
+ *
+ * Each event describes one executed command: its name, the hash slot of its
+ * first key (`VALKEYMODULE_CMDTRACE_NO_KEY` for keyless commands), the main
+ * thread execution time in microseconds and the number of reply bytes it
+ * produced. Events are consumed with ValkeyModule_CommandTracePoll(), which
+ * may be called from the module's own threads without holding the GIL.
+ *
+ * The ring is a single server-wide resource: only one module can have it
+ * started at a time, and it is stopped automatically when that module is
+ * unloaded. Returns VALKEYMODULE_OK on success, or VALKEYMODULE_ERR if the
+ * ring is already in use by another module. */
+int VM_CommandTraceStart(ValkeyModuleCtx *ctx, size_t ring_size) {
+    if (moduleTraceRing.owner != NULL && moduleTraceRing.owner != ctx->module) return VALKEYMODULE_ERR;
+
+    if (ring_size == 0) ring_size = 16384;
+    if (ring_size < 1024) ring_size = 1024;
+    if (ring_size > 1024 * 1024) ring_size = 1024 * 1024;
+    size_t size = 1024;
+    while (size < ring_size) size *= 2;
+
+    /* The ring memory is retained until shutdown once allocated: readers on
+     * module threads may still be inside a poll when tracing is stopped, so
+     * the slots may never be freed under them. */
+    if (moduleTraceRing.slots == NULL || moduleTraceRing.size != size) {
+        serverAssert(!moduleCommandTraceEnabled());
+        zfree(moduleTraceRing.slots);
+        moduleTraceRing.slots = zcalloc(sizeof(moduleCommandTraceSlot) * size);
+        moduleTraceRing.size = size;
+        atomic_store_explicit(&moduleTraceRing.next, 0, memory_order_release);
+    }
+    moduleTraceRing.owner = ctx->module;
+    atomic_store_explicit(&moduleTraceRing.enabled, 1, memory_order_release);
+    return VALKEYMODULE_OK;
+}
+
+/* Stop recording commands into the tracing ring. Events already recorded
+ * remain available to ValkeyModule_CommandTracePoll(). Returns
+ * VALKEYMODULE_OK, or VALKEYMODULE_ERR if the ring is owned by another
+ * module. */
+int VM_CommandTraceStop(ValkeyModuleCtx *ctx) {
+    if (moduleTraceRing.owner != NULL && moduleTraceRing.owner != ctx->module) return VALKEYMODULE_ERR;
+    atomic_store_explicit(&moduleTraceRing.enabled, 0, memory_order_release);
+    moduleTraceRing.owner = NULL;
+    return VALKEYMODULE_OK;
+}
+
+/* Copy up to `count` command trace events into `entries`, starting from the
+ * reader position `*cursor`, and return the number of events copied. The
+ * cursor must be a module-owned variable initialized to 0 before the first
+ * call; the function advances it past the returned events. If the reader
+ * fell behind and the writer overwrote part of the range, the cursor skips
+ * to the oldest event still available, so slow consumers lose data instead
+ * of stalling the server.
+ *
+ * May be called from any thread without holding the GIL. A return value
+ * smaller than `count` means the ring is drained for now. */
+size_t VM_CommandTracePoll(uint64_t *cursor, ValkeyModuleCommandTrace *entries, size_t count) {
+    if (moduleTraceRing.slots == NULL) return 0;
+
+    size_t n = 0;
+    uint64_t head = atomic_load_explicit(&moduleTraceRing.next, memory_order_acquire);
+    while (n < count && *cursor < head) {
+        /* Drop the part of the range the writer has already lapped. */
+        if (head > moduleTraceRing.size && *cursor < head - moduleTraceRing.size)
+            *cursor = head - moduleTraceRing.size;
+
+        moduleCommandTraceSlot *slot = &moduleTraceRing.slots[*cursor & (moduleTraceRing.size - 1)];
+        uint64_t seq = atomic_load_explicit(&slot->seq, memory_order_acquire);
+        entries[n] = slot->trace;
+        atomic_thread_fence(memory_order_acquire);
+        if (seq == *cursor + 1 && atomic_load_explicit(&slot->seq, memory_order_relaxed) == seq) {
+            n++;
+            (*cursor)++;
+        } else {
+            /* The writer got here first: refresh the head and retry from
+             * the oldest surviving entry. */
+            head = atomic_load_explicit(&moduleTraceRing.next, memory_order_acquire);
+            if (head > moduleTraceRing.size)
+                *cursor = head - moduleTraceRing.size;
+            else if (seq == 0)
+                break; /* Slot is being written right now, try again later. */
+        }
+    }
+    return n;
+}
+
 /* For a given pointer allocated via ValkeyModule_Alloc() or
  * ValkeyModule_Realloc(), return the amount of memory allocated for it.
  * Note that this may be different (larger) than the memory we allocated
@@ -12191,6 +12357,12 @@ int moduleFreeCommand(struct ValkeyModule *module, struct serverCommand *cmd) {
         hdr_close(cmd->latency_histogram);
         cmd->latency_histogram = NULL;
     }
+    for (int i = 0; i < 2; i++) {
+        if (cmd->latency_histogram_recent[i]) {
+            hdr_close(cmd->latency_histogram_recent[i]);
+            cmd->latency_histogram_recent[i] = NULL;
+        }
+    }
     moduleFreeArgs(cmd->args, cmd->num_args);
     zfree(cp);
 
@@ -12286,6 +12458,7 @@ void moduleUnregisterCleanup(ValkeyModule *module) {
     moduleUnsubscribeAllServerEvents(module);
     moduleRemoveConfigs(module);
     moduleUnregisterAuthCBs(module);
+    moduleCommandTraceStopIfOwner(module);
 }
 
 /* Load a module and initialize it. On success C_OK is returned, otherwise
@@ -14031,6 +14204,9 @@ void moduleRegisterCoreAPI(void) {
     REGISTER_API(CommandFilterArgReplace);
     REGISTER_API(CommandFilterArgDelete);
     REGISTER_API(CommandFilterGetClientId);
+    REGISTER_API(CommandTraceStart);
+    REGISTER_API(CommandTraceStop);
+    REGISTER_API(CommandTracePoll);
     REGISTER_API(Fork);
     REGISTER_API(SendChildHeartbeat);
     REGISTER_API(ExitFromChild);
@@ -205,6 +205,9 @@ void moduleReleaseGIL(void);
 void moduleNotifyKeyspaceEvent(int type, const char *event, robj *key, int dbid);
 void firePostExecutionUnitJobs(void);
 void moduleCallCommandFilters(client *c);
+int moduleCommandTraceEnabled(void);
+void moduleCommandTraceRecord(client *c, struct serverCommand *cmd, long long duration, uint64_t reply_bytes);
+void moduleCommandTraceStopIfOwner(struct ValkeyModule *module);
 void modulePostExecutionUnitOperations(void);
 void ModuleForkDoneHandler(int exitcode, int bysignal);
 int TerminateModuleForkChild(int child_pid, int wait);
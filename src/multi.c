@@ -86,6 +86,11 @@ void queueMultiCommand(client *c, uint64_t cmd_flags) {
          * two commands. Hence, creating by default size of 2. */
         c->mstate->commands = zmalloc(sizeof(multiCmd) * 2);
         c->mstate->alloc_count = 2;
+        /* Remember who the queued commands are checked against; if neither
+         * the user nor the ACL rules change before EXEC, the per-command
+         * re-check at execution time can be skipped. */
+        c->mstate->acl_user = c->user;
+        c->mstate->acl_generation = ACLGetGeneration();
     }
     if (c->mstate->count == c->mstate->alloc_count) {
         c->mstate->alloc_count = c->mstate->alloc_count < INT_MAX / 2 ? c->mstate->alloc_count * 2 : INT_MAX;
@@ -207,6 +212,25 @@ void execCommand(client *c) {
     orig_argc = c->argc;
     orig_cmd = c->cmd;
     addReplyArrayLen(c, c->mstate->count);
+
+    /* Warm the keys the queued commands are about to touch, so their
+     * lookups run against cache lines that are already on the way. */
+    if (c->id != CLIENT_ID_AOF) {
+        robj *prefetch_keys[PREFETCH_INLINE_WINDOW];
+        int nkeys = 0;
+        for (j = 0; j < c->mstate->count && nkeys < PREFETCH_INLINE_WINDOW; j++) {
+            multiCmd *mc = c->mstate->commands + j;
+            getKeysResult result;
+            initGetKeysResult(&result);
+            int numkeys = getKeysFromCommand(mc->cmd, mc->argv, mc->argc, &result);
+            for (int k = 0; k < numkeys && nkeys < PREFETCH_INLINE_WINDOW; k++) {
+                prefetch_keys[nkeys++] = mc->argv[result.keys[k].pos];
+            }
+            getKeysFreeResult(&result);
+        }
+        if (nkeys > 1) prefetchKeysInline(c->db, prefetch_keys, nkeys);
+    }
+
     for (j = 0; j < c->mstate->count; j++) {
         c->argc = c->mstate->commands[j].argc;
         c->argv = c->mstate->commands[j].argv;
@@ -214,9 +238,15 @@ void execCommand(client *c) {
         c->cmd = c->realcmd = c->mstate->commands[j].cmd;
 
         /* ACL permissions are also checked at the time of execution in case
-         * they were changed after the commands were queued. */
-        int acl_errpos;
-        int acl_retval = ACLCheckAllPerm(c, &acl_errpos);
+         * they were changed after the commands were queued. Every queued
+         * command already passed the check in processCommand(), so when
+         * neither the rules nor the executing user changed since queueing
+         * started (AUTH or ACL commands can do both, also from inside the
+         * transaction itself) the re-check is skipped. */
+        int acl_errpos = -1;
+        int acl_retval = ACL_OK;
+        if (c->user != c->mstate->acl_user || ACLGetGeneration() != c->mstate->acl_generation)
+            acl_retval = ACLCheckAllPerm(c, &acl_errpos);
         if (acl_retval != ACL_OK) {
             char *reason;
             switch (acl_retval) {
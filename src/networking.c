@@ -77,12 +77,20 @@ static sds getAllFilteredClientsInfoString(clientFilter *client_filter, int hide
 int ProcessingEventsWhileBlocked = 0; /* See processEventsWhileBlocked(). */
 __thread sds thread_shared_qb = NULL;
 
+/* Spare query buffer kept per thread to refill thread_shared_qb without
+ * allocating. When a client retains the shared buffer because a command
+ * spans reads, the replacement comes from here; when that client later
+ * drains its buffer it is donated back instead of being kept (or freed). */
+static __thread sds thread_spare_qb = NULL;
+
 typedef enum {
     PARSE_OK = 0,
     PARSE_ERR = -1,
     PARSE_NEEDMORE = -2,
 } parseResult;
 
+int cmdHasPushAsReply(struct serverCommand *cmd);
+
 /* Return the amount of memory used by the sds string at object->ptr
  * for a string object. This includes internal fragmentation. */
 size_t getStringObjectSdsUsedMemory(robj *o) {
@@ -109,13 +117,132 @@ void *dupClientReplyValue(void *o) {
     clientReplyBlock *old = o;
     clientReplyBlock *buf = zmalloc(sizeof(clientReplyBlock) + old->size);
     memcpy(buf, o, sizeof(clientReplyBlock) + old->size);
+    buf->refcount = 1; /* The copy is private regardless of the original. */
     return buf;
 }
 
-void freeClientReplyValue(void *o) {
+/* Return a reply block able to hold at least 'len' bytes, with 'size' set to
+ * the usable payload size and 'used' reset to zero. Allocated to at least
+ * PROTO_REPLY_CHUNK_BYTES so small appends coalesce into one block. */
+static clientReplyBlock *allocReplyBlock(size_t len) {
+    size_t usable_size;
+    size_t size = len < PROTO_REPLY_CHUNK_BYTES ? PROTO_REPLY_CHUNK_BYTES : len;
+    clientReplyBlock *o = zmalloc_usable(size + sizeof(clientReplyBlock), &usable_size);
+    /* take over the allocation's internal fragmentation */
+    o->size = usable_size - sizeof(clientReplyBlock);
+    o->used = 0;
+    o->refcount = 1;
+    return o;
+}
+
+/* Drop one reference to a reply block, freeing it with the last one. */
+static void releaseReplyBlock(clientReplyBlock *o) {
+    if (o && atomic_fetch_sub_explicit(&o->refcount, 1, memory_order_acq_rel) != 1) return;
     zfree(o);
 }
 
+void freeClientReplyValue(void *o) {
+    releaseReplyBlock(o);
+}
+
+/* Create a refcounted reply block holding a ready-to-send serialized reply.
+ * Unlike allocReplyBlock() the allocation is exact: shared blocks are meant
+ * to be referenced from many reply lists (see addReplySharedBlock) and their
+ * size counts against every referencing client's output buffer. */
+clientReplyBlock *createSharedReplyBlock(const char *s, size_t len) {
+    size_t usable_size;
+    clientReplyBlock *o = zmalloc_usable(len + sizeof(clientReplyBlock), &usable_size);
+    o->size = usable_size - sizeof(clientReplyBlock);
+    o->used = len;
+    o->refcount = 1;
+    memcpy(o->buf, s, len);
+    return o;
+}
+
+/* Append a shared reply block to the client's reply list, taking a new
+ * reference on it. The payload is not copied: every subscriber's reply list
+ * points at the same block, and whoever drops the last reference (possibly
+ * an IO thread draining a reply list) frees it. */
+void addReplySharedBlock(client *c, clientReplyBlock *o) {
+    if (prepareClientToWrite(c) != C_OK) return;
+    if (c->flag.close_after_reply) return;
+
+    /* Same rogue-replica protection as _addReplyToBufferOrList. */
+    if (getClientType(c) == CLIENT_TYPE_REPLICA) {
+        sds cmdname = c->lastcmd ? c->lastcmd->fullname : NULL;
+        logInvalidUseAndFreeClientAsync(c, "Replica generated a reply to command '%s'",
+                                        cmdname ? cmdname : "<unknown>");
+        return;
+    }
+
+    c->net_output_bytes_curr_cmd += o->used;
+    reqresSaveClientReplyOffset(c);
+
+    /* Keep push ordering semantics of _addReplyToBufferOrList: a push into
+     * the client currently executing a command is postponed until after the
+     * command's own reply. */
+    list *reply_list = c->reply;
+    if (c->flag.pushing && c == server.current_client && server.executing_client &&
+        !cmdHasPushAsReply(server.executing_client->cmd))
+        reply_list = server.pending_push_messages;
+
+    atomic_fetch_add_explicit(&o->refcount, 1, memory_order_relaxed);
+    listAddNodeTail(reply_list, o);
+    c->reply_bytes += o->size;
+
+    closeClientOnOutputBufferLimitReached(c, 1);
+}
+
+/* Drop the caller's reference on a shared reply block. */
+void releaseSharedReplyBlock(clientReplyBlock *o) {
+    releaseReplyBlock(o);
+}
+
+/* A reply block that was handed to the kernel with MSG_ZEROCOPY and must not
+ * be reused or freed until the send with sequence number 'seq' completes. */
+typedef struct zcopyPinnedBlock {
+    unsigned int seq;
+    clientReplyBlock *block;
+} zcopyPinnedBlock;
+
+static void freeZeroCopyPinnedBlock(void *o) {
+    zcopyPinnedBlock *p = o;
+    releaseReplyBlock(p->block);
+    zfree(p);
+}
+
+/* Move a fully written reply block to the client's pinned list instead of
+ * freeing it: after a MSG_ZEROCOPY send the kernel transmits straight from
+ * the block's pages. The block keeps counting against c->reply_bytes until
+ * the completion is reaped. */
+static void pinZeroCopyReplyBlock(client *c, clientReplyBlock *o) {
+    zcopyPinnedBlock *p = zmalloc(sizeof(*p));
+    p->seq = c->conn->zcopy_next_seq;
+    p->block = o;
+    if (!c->zcopy_pinned) {
+        c->zcopy_pinned = listCreate();
+        listSetFreeMethod(c->zcopy_pinned, freeZeroCopyPinnedBlock);
+    }
+    listAddNodeTail(c->zcopy_pinned, p);
+}
+
+/* Release the reply blocks whose zero-copy sends the kernel has finished
+ * with. Pins are appended in send order, so we can stop at the first block
+ * whose sequence number was not completed yet. Called before every write
+ * and from clientsCron, so an idle client does not pin its blocks (and the
+ * kernel optmem they account for) indefinitely. */
+void processZeroCopyCompletions(client *c) {
+    if (!c->zcopy_pinned || listLength(c->zcopy_pinned) == 0) return;
+    connReapZeroCopyCompletions(c->conn);
+    listNode *ln;
+    while ((ln = listFirst(c->zcopy_pinned)) != NULL) {
+        zcopyPinnedBlock *p = listNodeValue(ln);
+        if (c->conn->zcopy_completed < p->seq) break;
+        c->reply_bytes -= p->block->size;
+        listDelNode(c->zcopy_pinned, ln);
+    }
+}
+
 /* This function links the client to the global linked list of clients.
  * unlinkClient() does the opposite, among other things. */
 void linkClient(client *c) {
@@ -138,9 +265,13 @@ static void clientSetDefaultAuth(client *c) {
 
 int authRequired(client *c) {
     /* Check if the user is authenticated. This check is skipped in case
-     * the default user is flagged as "nopass" and is active. */
-    int auth_required = (!(DefaultUser->flags & USER_FLAG_NOPASS) || (DefaultUser->flags & USER_FLAG_DISABLED)) &&
-                        !c->flag.authenticated;
+     * the default user is flagged as "nopass" and is active, or when a
+     * trusted-UID Unix socket peer connected: both skip only the password
+     * check, so a disabled default user still locks them out. */
+    int default_user_active = !(DefaultUser->flags & USER_FLAG_DISABLED);
+    int password_not_required =
+        ((DefaultUser->flags & USER_FLAG_NOPASS) || c->flag.peer_uid_trusted) && default_user_active;
+    int auth_required = !password_not_required && !c->flag.authenticated;
     return auth_required;
 }
 
@@ -205,6 +336,10 @@ client *createClient(connection *conn) {
     c->reply = listCreate();
     c->deferred_reply_errors = NULL;
     c->reply_bytes = 0;
+    c->zcopy_pinned = NULL;
+    c->io_pre_parsed = NULL;
+    c->io_pre_parsed_count = 0;
+    c->io_pre_parsed_idx = 0;
     c->obuf_soft_limit_reached_time = 0;
     listSetFreeMethod(c->reply, freeClientReplyValue);
     listSetDupMethod(c->reply, dupClientReplyValue);
@@ -213,6 +348,7 @@ client *createClient(connection *conn) {
     c->pubsub_data = NULL;
     c->module_data = NULL;
     c->mstate = NULL;
+    c->chunk_state = NULL;
     c->woff = 0;
     c->peerid = NULL;
     c->sockname = NULL;
@@ -232,6 +368,8 @@ client *createClient(connection *conn) {
     c->net_output_bytes = 0;
     c->net_output_bytes_curr_cmd = 0;
     c->commands_processed = 0;
+    c->exec_usec = 0;
+    c->alloc_bytes = 0;
     c->io_last_reply_block = NULL;
     c->io_last_bufpos = 0;
     return c;
@@ -409,8 +547,9 @@ void _addReplyProtoToList(client *c, list *reply_list, const char *s, size_t len
      * addReplyDeferredLen() is used, it sets a dummy node to NULL just
      * to fill it later, when the size of the bulk length is set. */
 
-    /* Append to tail string when possible. */
-    if (tail) {
+    /* Append to tail string when possible. Shared blocks (refcount > 1) are
+     * visible from other clients' reply lists and must not be mutated. */
+    if (tail && tail->refcount == 1) {
         /* Copy the part we can fit into the tail, and leave the rest for a
          * new node */
         size_t avail = tail->size - tail->used;
@@ -423,11 +562,7 @@ void _addReplyProtoToList(client *c, list *reply_list, const char *s, size_t len
     if (len) {
         /* Create a new node, make sure it is allocated to at
          * least PROTO_REPLY_CHUNK_BYTES */
-        size_t usable_size;
-        size_t size = len < PROTO_REPLY_CHUNK_BYTES ? PROTO_REPLY_CHUNK_BYTES : len;
-        tail = zmalloc_usable(size + sizeof(clientReplyBlock), &usable_size);
-        /* take over the allocation's internal fragmentation */
-        tail->size = usable_size - sizeof(clientReplyBlock);
+        tail = allocReplyBlock(len);
         tail->used = len;
         memcpy(tail->buf, s, len);
         listAddNodeTail(reply_list, tail);
@@ -774,7 +909,7 @@ void trimReplyUnusedTailSpace(client *c) {
      * Also, to avoid large memmove which happens as part of realloc, we only do
      * that if the used part is small.  */
     if (tail->size - tail->used > tail->size / 4 && tail->used < PROTO_REPLY_CHUNK_BYTES &&
-        c->io_write_state != CLIENT_PENDING_IO) {
+        tail->refcount == 1 && c->io_write_state != CLIENT_PENDING_IO) {
         size_t usable_size;
         size_t old_size = tail->size;
         tail = zrealloc_usable(tail, tail->used + sizeof(clientReplyBlock), &usable_size);
@@ -836,7 +971,7 @@ void setDeferredReply(client *c, void *node, const char *s, size_t length) {
      * - And not too large (avoid large memmove)
      * - And the client is not in a pending I/O state */
     if (ln->prev != NULL && (prev = listNodeValue(ln->prev)) && prev->size - prev->used > 0 &&
-        c->io_write_state != CLIENT_PENDING_IO) {
+        prev->refcount == 1 && c->io_write_state != CLIENT_PENDING_IO) {
         size_t len_to_copy = prev->size - prev->used;
         if (len_to_copy > length) len_to_copy = length;
         memcpy(prev->buf + prev->used, s, len_to_copy);
@@ -850,18 +985,21 @@ void setDeferredReply(client *c, void *node, const char *s, size_t length) {
     }
 
     if (ln->next != NULL && (next = listNodeValue(ln->next)) && next->size - next->used >= length &&
-        next->used < PROTO_REPLY_CHUNK_BYTES * 4 && c->io_write_state != CLIENT_PENDING_IO) {
+        next->used < PROTO_REPLY_CHUNK_BYTES * 4 && next->refcount == 1 && c->io_write_state != CLIENT_PENDING_IO) {
         memmove(next->buf + length, next->buf, next->used);
         memcpy(next->buf, s, length);
         next->used += length;
         listDelNode(c->reply, ln);
     } else {
-        /* Create a new node */
+        /* Create a new node. Allocated exactly: this node sits in the middle
+         * of the list so a standard-size chunk's spare space would never be
+         * filled, hence no allocReplyBlock() here. */
         size_t usable_size;
         clientReplyBlock *buf = zmalloc_usable(length + sizeof(clientReplyBlock), &usable_size);
         /* Take over the allocation's internal fragmentation */
         buf->size = usable_size - sizeof(clientReplyBlock);
         buf->used = length;
+        buf->refcount = 1;
         memcpy(buf->buf, s, length);
         listNodeValue(ln) = buf;
         c->reply_bytes += buf->size;
@@ -904,19 +1042,42 @@ void setDeferredAggregateLen(client *c, void *node, long length, char prefix) {
     setDeferredReply(c, node, lenstr, lenstr_len + 3);
 }
 
+/* Reply literals and prefixes that differ between RESP2 and RESP3, indexed
+ * by the client protocol version. Loading the bytes through this table keeps
+ * the per-element protocol branch out of the hot reply emitters, the same
+ * way shared.null[c->resp] already does for the null object. */
+typedef struct respEncoding {
+    const char *null_reply;
+    size_t null_reply_len;
+    const char *null_array;
+    size_t null_array_len;
+    const char *bool_true; /* Both protocols use 4 byte booleans. */
+    const char *bool_false;
+    char map_prefix;           /* RESP2 has no map type: flattened array. */
+    char set_prefix;           /* RESP2 has no set type: plain array. */
+    unsigned char map_len_mul; /* RESP2 flattening doubles the length. */
+} respEncoding;
+
+static const respEncoding respEncodings[4] = {
+    [2] = {"$-1\r\n", 5, "*-1\r\n", 5, ":1\r\n", ":0\r\n", '*', '*', 2},
+    [3] = {"_\r\n", 3, "_\r\n", 3, "#t\r\n", "#f\r\n", '%', '~', 1},
+};
+
+static inline const respEncoding *clientRespEncoding(client *c) {
+    return &respEncodings[c->resp];
+}
+
 void setDeferredArrayLen(client *c, void *node, long length) {
     setDeferredAggregateLen(c, node, length, '*');
 }
 
 void setDeferredMapLen(client *c, void *node, long length) {
-    int prefix = c->resp == 2 ? '*' : '%';
-    if (c->resp == 2) length *= 2;
-    setDeferredAggregateLen(c, node, length, prefix);
+    const respEncoding *enc = clientRespEncoding(c);
+    setDeferredAggregateLen(c, node, length * enc->map_len_mul, enc->map_prefix);
 }
 
 void setDeferredSetLen(client *c, void *node, long length) {
-    int prefix = c->resp == 2 ? '*' : '~';
-    setDeferredAggregateLen(c, node, length, prefix);
+    setDeferredAggregateLen(c, node, length, clientRespEncoding(c)->set_prefix);
 }
 
 void setDeferredAttributeLen(client *c, void *node, long length) {
@@ -989,13 +1150,13 @@ void addReplyBigNum(client *c, const char *num, size_t len) {
  * of the double instead of exposing the crude behavior of doubles to the
  * dear user. */
 void addReplyHumanLongDouble(client *c, long double d) {
+    char buf[MAX_LONG_DOUBLE_CHARS];
+    int len = ld2string(buf, sizeof(buf), d, LD_STR_HUMAN);
     if (c->resp == 2) {
-        robj *o = createStringObjectFromLongDouble(d, 1);
-        addReplyBulk(c, o);
-        decrRefCount(o);
+        /* Formatting on the stack spares a string object round trip for
+         * every emitted element. */
+        addReplyBulkCBuffer(c, buf, len);
     } else {
-        char buf[MAX_LONG_DOUBLE_CHARS];
-        int len = ld2string(buf, sizeof(buf), d, LD_STR_HUMAN);
         addReplyProto(c, ",", 1);
         addReplyProto(c, buf, len);
         addReplyProto(c, "\r\n", 2);
@@ -1062,21 +1223,18 @@ void addWritePreparedReplyArrayLen(writePreparedClient *wpc, long length) {
 }
 
 void addReplyMapLen(client *c, long length) {
-    int prefix = c->resp == 2 ? '*' : '%';
-    if (c->resp == 2) length *= 2;
-    addReplyAggregateLen(c, length, prefix);
+    const respEncoding *enc = clientRespEncoding(c);
+    addReplyAggregateLen(c, length * enc->map_len_mul, enc->map_prefix);
 }
 
 void addWritePreparedReplyMapLen(writePreparedClient *wpc, long length) {
     client *c = (client *)wpc;
-    int prefix = c->resp == 2 ? '*' : '%';
-    if (c->resp == 2) length *= 2;
-    _addReplyLongLongWithPrefix(c, length, prefix);
+    const respEncoding *enc = clientRespEncoding(c);
+    _addReplyLongLongWithPrefix(c, length * enc->map_len_mul, enc->map_prefix);
 }
 
 void addReplySetLen(client *c, long length) {
-    int prefix = c->resp == 2 ? '*' : '~';
-    addReplyAggregateLen(c, length, prefix);
+    addReplyAggregateLen(c, length, clientRespEncoding(c)->set_prefix);
 }
 
 void addReplyAttributeLen(client *c, long length) {
@@ -1091,19 +1249,13 @@ void addReplyPushLen(client *c, long length) {
 }
 
 void addReplyNull(client *c) {
-    if (c->resp == 2) {
-        addReplyProto(c, "$-1\r\n", 5);
-    } else {
-        addReplyProto(c, "_\r\n", 3);
-    }
+    const respEncoding *enc = clientRespEncoding(c);
+    addReplyProto(c, enc->null_reply, enc->null_reply_len);
 }
 
 void addReplyBool(client *c, int b) {
-    if (c->resp == 2) {
-        addReply(c, b ? shared.cone : shared.czero);
-    } else {
-        addReplyProto(c, b ? "#t\r\n" : "#f\r\n", 4);
-    }
+    const respEncoding *enc = clientRespEncoding(c);
+    addReplyProto(c, b ? enc->bool_true : enc->bool_false, 4);
 }
 
 /* A null array is a concept that no longer exists in RESP3. However
@@ -1111,11 +1263,8 @@ void addReplyBool(client *c, int b) {
  * RESP2 protocol, however for RESP3 the reply will always be just the
  * Null type "_\r\n". */
 void addReplyNullArray(client *c) {
-    if (c->resp == 2) {
-        addReplyProto(c, "*-1\r\n", 5);
-    } else {
-        addReplyProto(c, "_\r\n", 3);
-    }
+    const respEncoding *enc = clientRespEncoding(c);
+    addReplyProto(c, enc->null_array, enc->null_array_len);
 }
 
 /* Create the length prefix of a bulk reply, example: $2234 */
@@ -1469,6 +1618,19 @@ void acceptCommonHandler(connection *conn, struct ClientFlags flags, char *ip) {
     /* Last chance to keep flags */
     if (flags.unix_socket) c->flag.unix_socket = 1;
 
+    /* Same-host trust: a Unix socket peer running with our own (or root)
+     * effective UID may skip password authentication. Only a flag is
+     * recorded here; authRequired() consults it together with the current
+     * default user state, so ACL rules still apply and a disabled default
+     * user stays disabled. */
+    if (flags.unix_socket && server.unix_ctx_config.trust_peer_uid) {
+        uid_t peer_uid;
+
+        if (anetUnixGetPeerUid(NULL, conn->fd, &peer_uid) == ANET_OK && (peer_uid == geteuid() || peer_uid == 0)) {
+            c->flag.peer_uid_trusted = 1;
+        }
+    }
+
     /* Initiate accept.
      *
      * Note that connAccept() is free to do two things here:
@@ -1640,6 +1802,7 @@ void clearClientConnectionState(client *c) {
     moduleNotifyUserChanged(c);
     discardTransaction(c);
     freeClientPubSubData(c);
+    freeClientChunkedDumpState(c);
 
     if (c->name) {
         decrRefCount(c->name);
@@ -1671,6 +1834,9 @@ void freeClient(client *c) {
     /* Wait for IO operations to be done before proceeding */
     waitForClientIO(c);
 
+    /* Drop any completion event still queued for this client. */
+    purgeClientIOCompletions(c);
+
     /* For connected clients, call the disconnection event of modules hooks. */
     if (c->conn) {
         moduleFireServerEvent(VALKEYMODULE_EVENT_CLIENT_CHANGE, VALKEYMODULE_SUBEVENT_CLIENT_CHANGE_DISCONNECTED, c);
@@ -1728,10 +1894,22 @@ void freeClient(client *c) {
 
     freeClientBlockingState(c);
     freeClientPubSubData(c);
+    freeClientChunkedDumpState(c);
 
     /* Free data structures. */
     listRelease(c->reply);
     c->reply = NULL;
+    /* Discard commands pre-parsed by the IO thread that never got to run. */
+    if (c->io_pre_parsed) {
+        for (int i = c->io_pre_parsed_idx; i < c->io_pre_parsed_count; i++) {
+            preParsedCommand *pp = &c->io_pre_parsed[i];
+            for (int j = 0; j < pp->argc; j++) decrRefCount(pp->argv[j]);
+            zfree(pp->argv);
+        }
+        zfree(c->io_pre_parsed);
+        c->io_pre_parsed = NULL;
+        c->io_pre_parsed_count = c->io_pre_parsed_idx = 0;
+    }
     zfree_with_size(c->buf, c->buf_usable_size);
     c->buf = NULL;
 
@@ -1752,6 +1930,16 @@ void freeClient(client *c) {
      * places where active clients may be referenced. */
     unlinkClient(c);
 
+    /* Release the zero-copy pinned blocks only now that the connection is
+     * closed: close() flushes the socket send queue, so the kernel could
+     * still transmit from these pages before that. When sends are in
+     * flight at close time the socket layer aborts the connection instead
+     * (see connSocketClose()), dropping the kernel's last references. */
+    if (c->zcopy_pinned) {
+        listRelease(c->zcopy_pinned);
+        c->zcopy_pinned = NULL;
+    }
+
     freeClientReplicationData(c);
 
     /* Remove client from memory usage buckets */
@@ -1829,6 +2017,18 @@ void trimClientQueryBuffer(client *c) {
     serverAssert(c->qb_pos <= sdslen(c->querybuf));
 
     if (c->qb_pos > 0) {
+        /* A fully consumed buffer of the standard capacity goes back to the
+         * thread's spare slot so the next initSharedQueryBuf() doesn't have
+         * to allocate; the memmove below is then only paid by clients that
+         * really have a partial command left over. */
+        if (c->qb_pos == sdslen(c->querybuf) && !thread_spare_qb && sdsalloc(c->querybuf) >= PROTO_IOBUF_LEN &&
+            sdsalloc(c->querybuf) <= PROTO_IOBUF_LEN * 2) {
+            sdsclear(c->querybuf);
+            thread_spare_qb = c->querybuf;
+            c->querybuf = NULL;
+            c->qb_pos = 0;
+            return;
+        }
         sdsrange(c->querybuf, c->qb_pos, -1);
         c->qb_pos = 0;
     }
@@ -2115,9 +2315,18 @@ static int writevToClient(client *c) {
 
     serverAssert(iovcnt != 0);
 
+    /* Large reply-list writes can skip the kernel copy: the blocks are heap
+     * allocated and can stay pinned until the NIC is done with them. The
+     * static c->buf is reused right after the write, so only engage once it
+     * has been flushed (bufpos == 0). IO threads keep the copying path since
+     * completions are reaped on the main thread. */
+    int use_zcopy = server.tcp_tx_zerocopy && inMainThread() && bufpos == 0 &&
+                    iov_bytes_len >= PROTO_ZEROCOPY_MIN_WRITE && connMayZeroCopy(c->conn);
+    unsigned int zcopy_start_seq = use_zcopy ? c->conn->zcopy_next_seq : 0;
+
     ssize_t totwritten = 0;
     while (1) {
-        int nwritten = connWritev(c->conn, iov, iovcnt);
+        int nwritten = use_zcopy ? connWritevZeroCopy(c->conn, iov, iovcnt) : connWritev(c->conn, iov, iovcnt);
         if (nwritten <= 0) {
             c->write_flags |= WRITE_FLAGS_WRITE_ERROR;
             totwritten = totwritten > 0 ? totwritten : nwritten;
@@ -2155,6 +2364,10 @@ static int writevToClient(client *c) {
         }
     }
 
+    /* Only flag the write as zero-copy if a send actually pinned pages; the
+     * connection may have silently fallen back to the copying path. */
+    if (use_zcopy && c->conn->zcopy_next_seq != zcopy_start_seq) c->write_flags |= WRITE_FLAGS_ZEROCOPY;
+
     c->nwritten = totwritten;
     return totwritten > 0 ? C_OK : C_ERR;
 }
@@ -2228,7 +2441,15 @@ static void _postWriteToClient(client *c) {
             break;
         }
         remaining -= (ssize_t)(o->used - c->sentlen);
-        c->reply_bytes -= o->size;
+        if (c->write_flags & WRITE_FLAGS_ZEROCOPY) {
+            /* The kernel may still reference the block's pages: detach it
+             * from the node and park it until the completion arrives. It
+             * keeps counting against reply_bytes meanwhile. */
+            pinZeroCopyReplyBlock(c, o);
+            listNodeValue(next) = NULL;
+        } else {
+            c->reply_bytes -= o->size;
+        }
         listDelNode(c->reply, next);
         c->sentlen = 0;
     }
@@ -2291,15 +2512,42 @@ int writeToClient(client *c) {
     c->nwritten = 0;
     c->write_flags = 0;
 
+    /* Opportunistically release reply blocks pinned by earlier zero-copy
+     * writes before queueing more data. */
+    processZeroCopyCompletions(c);
+
+    PHASE_PROFILE_START(prof);
     if (getClientType(c) == CLIENT_TYPE_REPLICA) {
         writeToReplica(c);
     } else {
         _writeToClient(c);
     }
+    PHASE_PROFILE_END(prof, PHASE_REPLY);
 
     return postWriteToClient(c);
 }
 
+/* Stream the accumulated reply to the socket once it grows beyond
+ * reply-stream-threshold. Commands emitting very large aggregate replies
+ * (HGETALL on a huge hash and alike) can call this from their emission
+ * loop so the per-client reply memory stays bounded instead of the whole
+ * reply being buffered before the event loop gets to flush it.
+ *
+ * The write is best effort: if the socket would block, the remainder keeps
+ * accumulating in the output buffer as usual, and the client output buffer
+ * limits still apply. Callers must not have an unresolved deferred length
+ * node in the reply list, since flushing could consume it before it is
+ * populated. */
+void flushReplyToClientIfNeeded(client *c) {
+    if (server.reply_stream_threshold == 0 || c->reply_bytes < server.reply_stream_threshold) return;
+    /* CLIENT_CLOSE_AFTER_REPLY clients must only be closed once the whole
+     * reply has been emitted, so don't risk an early flush of the tail. */
+    if (c->conn == NULL || c->flag.fake || c->flag.close_asap || c->flag.close_after_reply) return;
+    int type = getClientType(c);
+    if (type != CLIENT_TYPE_NORMAL && type != CLIENT_TYPE_PUBSUB) return;
+    writeToClient(c);
+}
+
 /* Write event handler. Just send data to the client. */
 void sendReplyToClient(connection *conn) {
     client *c = connGetPrivateData(conn);
@@ -2496,6 +2744,36 @@ int processIOThreadsWriteDone(void) {
     int processed = 0;
     listNode *ln;
 
+    if (!consumeWriteCompletionsOverflow()) {
+        /* Fast path: visit exactly the clients the IO threads reported done,
+         * instead of polling the completion state of every pending client.
+         * Only the events published before this call are drained, so a
+         * redelivery below cannot make the loop spin. */
+        size_t events = pendingClientWriteCompletions();
+        client *c;
+        while (events-- > 0 && (c = popClientWriteCompletion()) != NULL) {
+            /* Stale event: this write was already processed (e.g. by the
+             * read-done path or an overflow scan). */
+            if (c->io_write_state == CLIENT_IDLE) continue;
+            /* The IO thread pushes the completion event before publishing
+             * CLIENT_COMPLETED_IO, so a freshly popped event may still show
+             * CLIENT_PENDING_IO; the same state also appears when a new job
+             * was queued after an overflow scan consumed this write. Either
+             * way redeliver instead of dropping - once the write is handled
+             * the state returns to CLIENT_IDLE and the duplicate is stale.
+             * A read in flight likewise redelivers: the write is handled
+             * together with the read completion. */
+            if (c->io_write_state == CLIENT_PENDING_IO || c->io_read_state == CLIENT_PENDING_IO) {
+                pushClientWriteCompletion(c);
+                continue;
+            }
+            processed += processClientIOWriteDone(c, 1);
+        }
+        return processed;
+    }
+
+    /* A completion event was dropped on a full ring: fall back to scanning
+     * the whole pending list, polling the per-client completion states. */
     listNode *next = listFirst(server.clients_pending_io_write);
     while (next) {
         ln = next;
@@ -2616,9 +2894,15 @@ void resetClientIOState(client *c) {
     c->io_last_reply_block = NULL;
 }
 
-/* Initializes the shared query buffer to a new sds with the default capacity.
+/* Initializes the shared query buffer, recycling the spare buffer when one
+ * was donated back, otherwise allocating a new sds with the default capacity.
  * Need to ensure the initlen is not less than readlen in readToQueryBuf. */
 void initSharedQueryBuf(void) {
+    if (thread_spare_qb) {
+        thread_shared_qb = thread_spare_qb;
+        thread_spare_qb = NULL;
+        return;
+    }
     thread_shared_qb = sdsnewlen(NULL, PROTO_IOBUF_LEN);
     sdsclear(thread_shared_qb);
 }
@@ -2626,6 +2910,8 @@ void initSharedQueryBuf(void) {
 void freeSharedQueryBuf(void) {
     sdsfree(thread_shared_qb);
     thread_shared_qb = NULL;
+    sdsfree(thread_spare_qb);
+    thread_spare_qb = NULL;
 }
 
 /* This function is used when we want to re-enter the event loop but there
@@ -3067,6 +3353,31 @@ int processCommandAndResetClient(client *c) {
 /* This function will execute any fully parsed commands pending on
  * the client. Returns C_ERR if the client is no longer valid after executing
  * the command, and C_OK for all other cases. */
+/* Execute the commands an IO thread parsed ahead of the main thread (see
+ * preParseRemainingCommands). They precede whatever is left in the query
+ * buffer, so this must run before processInputBuffer(). Returns C_ERR if the
+ * client is no longer valid. */
+static int processPreParsedCommands(client *c) {
+    while (c->io_pre_parsed_idx < c->io_pre_parsed_count) {
+        /* Same stop conditions as the parsing loop: the remaining entries
+         * will be picked up once the client is in a runnable state again. */
+        if (c->flag.blocked || c->flag.unblocked || c->flag.close_after_reply || c->flag.close_asap) break;
+
+        preParsedCommand *pp = &c->io_pre_parsed[c->io_pre_parsed_idx++];
+        serverAssert(c->argv == NULL && c->argc == 0);
+        c->argv = pp->argv;
+        c->argc = pp->argc;
+        c->argv_len = pp->argv_len;
+        c->argv_len_sum = pp->argv_len_sum;
+        c->net_input_bytes_curr_cmd = pp->net_input_bytes;
+        pp->argv = NULL;
+        pp->argc = 0;
+        if (processCommandAndResetClient(c) == C_ERR) return C_ERR;
+    }
+    if (c->io_pre_parsed_idx == c->io_pre_parsed_count) c->io_pre_parsed_idx = c->io_pre_parsed_count = 0;
+    return C_OK;
+}
+
 int processPendingCommandAndInputBuffer(client *c) {
     /* Notice, this code is also called from 'processUnblockedClients'.
      * But in case of a module blocked client (see RM_Call 'K' flag) we do not reach this code path.
@@ -3079,6 +3390,9 @@ int processPendingCommandAndInputBuffer(client *c) {
         }
     }
 
+    /* Commands the IO thread parsed ahead come next in stream order. */
+    if (c->io_pre_parsed_count && processPreParsedCommands(c) == C_ERR) return C_ERR;
+
     /* Now process client if it has more data in it's buffer.
      *
      * Note: when a primary client steps into this function,
@@ -3105,6 +3419,7 @@ void parseCommand(client *c) {
         }
     }
 
+    PHASE_PROFILE_START(prof);
     if (c->reqtype == PROTO_REQ_INLINE) {
         processInlineBuffer(c);
     } else if (c->reqtype == PROTO_REQ_MULTIBULK) {
@@ -3112,11 +3427,16 @@ void parseCommand(client *c) {
     } else {
         serverPanic("Unknown request type");
     }
+    PHASE_PROFILE_END(prof, PHASE_PARSE);
 }
 
 int canParseCommand(client *c) {
     if (c->cmd != NULL) return 0;
 
+    /* Commands pre-parsed by the IO thread must run before anything still
+     * sitting in the query buffer. */
+    if (c->io_pre_parsed_count) return 0;
+
     /* Don't parse a command if the client is in the middle of something. */
     if (c->flag.blocked || c->flag.unblocked) return 0;
 
@@ -3430,7 +3750,9 @@ sds catClientInfoString(sds s, client *client, int hide_user_data) {
             " lib-ver=%s", client->lib_ver ? (char *)client->lib_ver->ptr : "",
             " tot-net-in=%U", client->net_input_bytes,
             " tot-net-out=%U", client->net_output_bytes,
-            " tot-cmds=%U", client->commands_processed));
+            " tot-cmds=%U", client->commands_processed,
+            " tot-exec-usec=%U", client->exec_usec,
+            " tot-alloc-bytes=%I", client->alloc_bytes));
     return ret;
 }
 
@@ -4308,7 +4630,7 @@ void helloCommand(client *c) {
     }
 
     /* At this point we need to be authenticated to continue. */
-    if (!c->flag.authenticated) {
+    if (authRequired(c)) {
         addReplyError(c, "-NOAUTH HELLO must be called with the client already "
                          "authenticated, otherwise the HELLO <proto> AUTH <user> <pass> "
                          "option can be used to authenticate the client and "
@@ -4613,9 +4935,12 @@ char *getClientTypeName(int class) {
  * limit, and also update the state needed to check the soft limit as
  * a side effect.
  *
+ * If 'hard_out' is not NULL it is set to 1 when the hard limit (as opposed
+ * to the soft one) was reached.
+ *
  * Return value: non-zero if the client reached the soft or the hard limit.
  *               Otherwise zero is returned. */
-int checkClientOutputBufferLimits(client *c) {
+int checkClientOutputBufferLimits(client *c, int *hard_out) {
     int soft = 0, hard = 0, class;
     unsigned long used_mem = getClientOutputBufferMemoryUsage(c);
 
@@ -4656,9 +4981,38 @@ int checkClientOutputBufferLimits(client *c) {
     } else {
         c->obuf_soft_limit_reached_time = 0;
     }
+    if (hard_out) *hard_out = hard;
     return soft || hard;
 }
 
+/* Stop reading from a client whose output buffer sits over the soft limit.
+ * The buffer keeps the data it has, the client simply produces no further
+ * work until it drains; the hard limit remains the final safety net. */
+static void clientApplyObufBackpressure(client *c) {
+    if (c->flag.obuf_backpressure) return;
+    c->flag.obuf_backpressure = 1;
+    if (c->conn) connSetReadHandler(c->conn, NULL);
+    server.stat_client_outbuf_backpressure++;
+    serverLog(LL_VERBOSE, "Client id=%llu suspended for overcoming the output buffer soft limit.",
+              (unsigned long long)c->id);
+}
+
+/* Called from clientsCron(): resume reading from a backpressured client
+ * once its output buffer dropped back under the soft limit (or the
+ * feature was disabled at runtime). Returns 0, the client is never freed
+ * here. */
+int clientsCronResumeObufBackpressure(client *c) {
+    if (!c->flag.obuf_backpressure) return 0;
+    int class = getClientType(c);
+    if (class == CLIENT_TYPE_PRIMARY) class = CLIENT_TYPE_NORMAL;
+    if (server.client_obuf_backpressure && server.client_obuf_limits[class].soft_limit_bytes &&
+        getClientOutputBufferMemoryUsage(c) >= server.client_obuf_limits[class].soft_limit_bytes)
+        return 0;
+    c->flag.obuf_backpressure = 0;
+    if (c->conn && !c->flag.protected) connSetReadHandler(c->conn, readQueryFromClient);
+    return 0;
+}
+
 /* Asynchronously close a client if soft or hard limit is reached on the
  * output buffer size. The caller can check if the client will be closed
  * checking if the client CLIENT_CLOSE_ASAP flag is set.
@@ -4679,7 +5033,19 @@ int closeClientOnOutputBufferLimitReached(client *c, int async) {
     if ((c->reply_bytes == 0 && getClientType(c) != CLIENT_TYPE_REPLICA) ||
         (c->flag.close_asap && !(c->flag.protected_rdb_channel)))
         return 0;
-    if (checkClientOutputBufferLimits(c)) {
+    int hard = 0;
+    if (checkClientOutputBufferLimits(c, &hard)) {
+        /* In backpressure mode a tripped soft limit throttles the client
+         * instead of killing it. Replicas keep being fed (their buffer is
+         * mostly references into the shared replication backlog, and a
+         * disconnect converts the overrun into a far more expensive full
+         * sync); other clients stop being read until they drain. Hard
+         * limit overruns still disconnect in every mode. */
+        if (server.client_obuf_backpressure && !hard) {
+            int type = getClientType(c);
+            if (type != CLIENT_TYPE_REPLICA) clientApplyObufBackpressure(c);
+            return 0;
+        }
         sds client = catClientInfoString(sdsempty(), c, server.hide_user_data_from_log);
         /* Remove RDB connection protection on COB overrun */
 
@@ -4926,6 +5292,68 @@ int postponeClientRead(client *c) {
     return (trySendReadToIOThreads(c) == C_OK);
 }
 
+/* Post-process a client whose IO-thread read job has completed. The caller
+ * already verified that no IO is in flight for this client. Returns 1 if the
+ * read was processed, 0 if the client was skipped. */
+static int processClientIOReadDone(client *c) {
+    /* If the write job is done, process it ASAP to free the buffer and handle connection errors */
+    if (c->io_write_state == CLIENT_COMPLETED_IO) {
+        int allow_async_writes = 0; /* Don't send writes for the client to IO threads before processing the reads */
+        processClientIOWriteDone(c, allow_async_writes);
+    }
+    /* memory barrier acquire to get the updated client state */
+    atomic_thread_fence(memory_order_acquire);
+
+    listUnlinkNode(server.clients_pending_io_read, &c->pending_read_list_node);
+    c->flag.pending_read = 0;
+    c->io_read_state = CLIENT_IDLE;
+
+    /* Don't post-process-reads from clients that are going to be closed anyway. */
+    if (c->flag.close_asap) return 0;
+
+    /* If a client is protected, don't do anything,
+     * that may trigger read/write error or recreate handler. */
+    if (c->flag.protected) return 0;
+
+    server.stat_io_reads_processed++;
+
+    /* Save the current conn state, as connUpdateState may modify it */
+    int in_accept_state = (connGetState(c->conn) == CONN_STATE_ACCEPTING);
+    connSetPostponeUpdateState(c->conn, 0);
+    connUpdateState(c->conn);
+
+    /* In accept state, no client's data was read - stop here. */
+    if (in_accept_state) return 1;
+
+    /* On read error - stop here. */
+    if (handleReadResult(c) == C_ERR) {
+        return 1;
+    }
+
+    if (!(c->read_flags & READ_FLAGS_DONT_PARSE)) {
+        parseResult res = handleParseResults(c);
+        /* On parse error - stop here. */
+        if (res == PARSE_ERR) {
+            return 1;
+        } else if (res == PARSE_NEEDMORE) {
+            beforeNextClient(c);
+            return 1;
+        }
+    }
+
+    if (c->argc > 0) {
+        c->flag.pending_command = 1;
+    }
+
+    /* try to add the command to the batch */
+    int ret = addCommandToBatchAndProcessIfFull(c);
+    /* If the command was not added to the commands batch, process it immediately */
+    if (ret == C_ERR) {
+        if (processPendingCommandAndInputBuffer(c) == C_OK) beforeNextClient(c);
+    }
+    return 1;
+}
+
 int processIOThreadsReadDone(void) {
     if (ProcessingEventsWhileBlocked) {
         /* When ProcessingEventsWhileBlocked we may call processIOThreadsReadDone recursively.
@@ -4937,6 +5365,37 @@ int processIOThreadsReadDone(void) {
     int processed = 0;
     listNode *ln;
 
+    if (!consumeReadCompletionsOverflow()) {
+        /* Fast path: visit exactly the clients the IO threads reported done.
+         * Only the events published before this call are drained, so a
+         * redelivery below cannot make the loop spin. */
+        size_t events = pendingClientReadCompletions();
+        client *c;
+        while (events-- > 0 && (c = popClientReadCompletion()) != NULL) {
+            /* Stale event: this read was already processed by an overflow
+             * scan, and no new job was queued since. */
+            if (c->io_read_state == CLIENT_IDLE) continue;
+            /* The IO thread pushes the completion event before publishing
+             * CLIENT_COMPLETED_IO, so a freshly popped event may still show
+             * CLIENT_PENDING_IO; the same state also appears when a new job
+             * was queued after an overflow scan consumed this read. Either
+             * way redeliver instead of dropping - once the read is handled
+             * the state returns to CLIENT_IDLE and the duplicate is stale.
+             * A write in flight on another thread likewise redelivers; the
+             * read stays parked on the pending list meanwhile. */
+            if (c->io_read_state == CLIENT_PENDING_IO || c->io_write_state == CLIENT_PENDING_IO) {
+                pushClientReadCompletion(c);
+                continue;
+            }
+            processed += processClientIOReadDone(c);
+        }
+
+        processClientsCommandsBatch();
+        return processed;
+    }
+
+    /* A completion event was dropped on a full ring: fall back to scanning
+     * the whole pending list, polling the per-client completion states. */
     listNode *next = listFirst(server.clients_pending_io_read);
     while (next) {
         ln = next;
@@ -4945,65 +5404,13 @@ int processIOThreadsReadDone(void) {
 
         /* Client is still waiting for a pending I/O - skip it */
         if (c->io_write_state == CLIENT_PENDING_IO || c->io_read_state == CLIENT_PENDING_IO) continue;
-        /* If the write job is done, process it ASAP to free the buffer and handle connection errors */
-        if (c->io_write_state == CLIENT_COMPLETED_IO) {
-            int allow_async_writes = 0; /* Don't send writes for the client to IO threads before processing the reads */
-            processClientIOWriteDone(c, allow_async_writes);
-        }
-        /* memory barrier acquire to get the updated client state */
-        atomic_thread_fence(memory_order_acquire);
-
-        listUnlinkNode(server.clients_pending_io_read, ln);
-        c->flag.pending_read = 0;
-        c->io_read_state = CLIENT_IDLE;
-
-        /* Don't post-process-reads from clients that are going to be closed anyway. */
-        if (c->flag.close_asap) continue;
-
-        /* If a client is protected, don't do anything,
-         * that may trigger read/write error or recreate handler. */
-        if (c->flag.protected) continue;
 
-        processed++;
-        server.stat_io_reads_processed++;
-
-        /* Save the current conn state, as connUpdateState may modify it */
-        int in_accept_state = (connGetState(c->conn) == CONN_STATE_ACCEPTING);
-        connSetPostponeUpdateState(c->conn, 0);
-        connUpdateState(c->conn);
-
-        /* In accept state, no client's data was read - stop here. */
-        if (in_accept_state) continue;
-
-        /* On read error - stop here. */
-        if (handleReadResult(c) == C_ERR) {
-            continue;
-        }
-
-        if (!(c->read_flags & READ_FLAGS_DONT_PARSE)) {
-            parseResult res = handleParseResults(c);
-            /* On parse error - stop here. */
-            if (res == PARSE_ERR) {
-                continue;
-            } else if (res == PARSE_NEEDMORE) {
-                beforeNextClient(c);
-                continue;
-            }
-        }
-
-        if (c->argc > 0) {
-            c->flag.pending_command = 1;
-        }
-
-        size_t list_length_before_command_execute = listLength(server.clients_pending_io_read);
-        /* try to add the command to the batch */
-        int ret = addCommandToBatchAndProcessIfFull(c);
-        /* If the command was not added to the commands batch, process it immediately */
-        if (ret == C_ERR) {
-            if (processPendingCommandAndInputBuffer(c) == C_OK) beforeNextClient(c);
-        }
-        if (list_length_before_command_execute != listLength(server.clients_pending_io_read)) {
-            /* A client was unlink from the list possibly making the next node invalid */
+        size_t list_length_before = listLength(server.clients_pending_io_read);
+        processed += processClientIOReadDone(c);
+        /* processClientIOReadDone unlinked 'c'; any further length change
+         * means command execution unlinked other clients, possibly making
+         * the next node invalid. */
+        if (listLength(server.clients_pending_io_read) != list_length_before - 1) {
             next = listFirst(server.clients_pending_io_read);
         }
     }
@@ -5066,6 +5473,86 @@ void evictClients(void) {
 
 /* IO threads functions */
 
+/* Called from an IO thread after the first command of the read event was
+ * fully parsed (and left in c->argv). Parses as many additional complete
+ * pipelined commands as possible into c->io_pre_parsed so the main thread
+ * executes them without touching the protocol again.
+ *
+ * Each attempt snapshots the parser state and rolls back unless it yields a
+ * complete command, so a partial or malformed tail is handled by the regular
+ * main-thread path exactly as if no pre-parsing had happened. */
+static void preParseRemainingCommands(client *c) {
+    /* Primary input needs repl_applied bookkeeping, and an unauthenticated
+     * or unrecognized first command is not worth parsing ahead for. */
+    if (c->read_flags & (READ_FLAGS_PRIMARY | READ_FLAGS_AUTH_REQUIRED)) return;
+    if (!c->io_parsed_cmd || !c->querybuf) return;
+    serverAssert(c->io_pre_parsed_count == 0 && c->io_pre_parsed_idx == 0);
+
+    /* Set the first command's parse results aside; the stash attempts below
+     * need the argv/parser fields for themselves. */
+    robj **first_argv = c->argv;
+    int first_argc = c->argc, first_argv_len = c->argv_len;
+    size_t first_argv_len_sum = c->argv_len_sum;
+    unsigned long long first_net_input_bytes = c->net_input_bytes_curr_cmd;
+    int saved_read_flags = c->read_flags;
+
+    while (c->io_pre_parsed_count < IO_THREAD_PREPARSE_CMDS) {
+        size_t remaining = sdslen(c->querybuf) - c->qb_pos;
+        /* Stop before anything that could trigger the big-argument
+         * querybuf stealing optimization in processMultibulkBuffer(),
+         * which would make a rollback impossible. */
+        if (remaining == 0 || remaining >= PROTO_MBULK_BIG_ARG) break;
+
+        size_t saved_qb_pos = c->qb_pos;
+        size_t saved_qb_len = sdslen(c->querybuf);
+        sds saved_qb = c->querybuf;
+
+        c->argv = NULL;
+        c->argc = 0;
+        c->argv_len = 0;
+        c->argv_len_sum = 0;
+        c->net_input_bytes_curr_cmd = 0;
+        c->reqtype = 0;
+        c->multibulklen = 0;
+        c->bulklen = -1;
+        c->read_flags = 0;
+
+        parseCommand(c);
+
+        if (c->read_flags == READ_FLAGS_PARSING_COMPLETED && c->argc > 0) {
+            if (!c->io_pre_parsed) c->io_pre_parsed = zmalloc(sizeof(preParsedCommand) * IO_THREAD_PREPARSE_CMDS);
+            preParsedCommand *pp = &c->io_pre_parsed[c->io_pre_parsed_count++];
+            pp->argv = c->argv;
+            pp->argc = c->argc;
+            pp->argv_len = c->argv_len;
+            pp->argv_len_sum = c->argv_len_sum;
+            pp->net_input_bytes = c->net_input_bytes_curr_cmd;
+            continue;
+        }
+
+        /* Incomplete, empty or malformed: roll back and let the main thread
+         * re-parse the tail from the command boundary. The parser may have
+         * discarded the already consumed prefix of the query buffer
+         * (sdsrange) or reallocated it, in which case the boundary is now
+         * at position zero. */
+        for (int j = 0; j < c->argc; j++) decrRefCount(c->argv[j]);
+        zfree(c->argv);
+        c->qb_pos = (c->querybuf == saved_qb && sdslen(c->querybuf) == saved_qb_len) ? saved_qb_pos : 0;
+        c->reqtype = 0;
+        c->multibulklen = 0;
+        c->bulklen = -1;
+        break;
+    }
+
+    /* Put the first command back in place. */
+    c->argv = first_argv;
+    c->argc = first_argc;
+    c->argv_len = first_argv_len;
+    c->argv_len_sum = first_argv_len_sum;
+    c->net_input_bytes_curr_cmd = first_net_input_bytes;
+    c->read_flags = saved_read_flags;
+}
+
 void ioThreadReadQueryFromClient(void *data) {
     client *c = data;
     serverAssert(c->io_read_state == CLIENT_PENDING_IO);
@@ -5120,12 +5607,19 @@ void ioThreadReadQueryFromClient(void *data) {
         getKeysFreeResult(&result);
     }
 
+    /* Parse ahead whatever complete pipelined commands follow, so the main
+     * thread gets a batch of ready-to-execute commands per read event. */
+    preParseRemainingCommands(c);
+
 done:
     /* Only trim query buffer for non-primary clients
      * Primary client's buffer is handled by main thread using repl_applied position */
     if (!(c->read_flags & READ_FLAGS_PRIMARY)) {
         trimClientQueryBuffer(c);
     }
+    /* Publish the completion before flipping the state: waitForClientIO()
+     * waits on the state, so a freed client can never leave a push behind. */
+    pushClientReadCompletion(c);
     atomic_thread_fence(memory_order_release);
     c->io_read_state = CLIENT_COMPLETED_IO;
 }
@@ -5140,6 +5634,7 @@ void ioThreadWriteToClient(void *data) {
         _writeToClient(c);
     }
 
+    pushClientWriteCompletion(c);
     atomic_thread_fence(memory_order_release);
     c->io_write_state = CLIENT_COMPLETED_IO;
 }
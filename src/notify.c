@@ -117,6 +117,13 @@ void notifyKeyspaceEvent(int type, char *event, robj *key, int dbid) {
     /* If notifications for this class of events are off, return ASAP. */
     if (!(server.notify_keyspace_events & type)) return;
 
+    /* Keyspace notifications are delivered to local subscribers only (the
+     * publish below does not propagate over the cluster bus), so when nobody
+     * is subscribed to any channel or pattern no receiver can exist and all
+     * the channel formatting below would be wasted. This keeps the write
+     * path cheap when notifications are enabled "just in case". */
+    if (kvstoreSize(server.pubsub_channels) == 0 && dictSize(server.pubsub_patterns) == 0) return;
+
     eventobj = createStringObject(event, strlen(event));
 
     /* __keyspace@<db>__:<key> <event> notifications. */
@@ -225,14 +225,17 @@ robj *createStringObject(const char *ptr, size_t len) {
 }
 
 robj *createStringObjectWithKeyAndExpire(const char *ptr, size_t len, const sds key, long long expire) {
-    /* When to embed? Embed when the sum is up to 64 bytes. There may be better
-     * heuristics, e.g. we can look at the jemalloc sizes (16-byte intervals up
-     * to 128 bytes). */
+    /* When to embed? Embed when the value is small enough for EMBSTR encoding
+     * and the whole allocation (robj, expire, key and value) fits in one of
+     * jemalloc's small size classes, which come at 16-byte intervals up to 128
+     * bytes. This keeps the key, the expire and a small value in one
+     * allocation, so a lookup touches a single cache-friendly chunk instead of
+     * chasing a separate value pointer. */
     size_t size = sizeof(robj);
     size += (key != NULL) * (sdslen(key) + 3); /* hdr size (1) + hdr (1) + nullterm (1) */
     size += (expire != -1) * sizeof(long long);
     size += 4 + len; /* embstr header (3) + nullterm (1) */
-    if (size <= 64) {
+    if (len <= OBJ_ENCODING_EMBSTR_SIZE_LIMIT && size <= 128) {
         return createEmbeddedStringObjectWithKeyAndExpire(ptr, len, key, expire);
     } else {
         return createObjectWithKeyAndExpire(OBJ_STRING, sdsnewlen(ptr, len), key, expire);
@@ -1113,7 +1116,6 @@ char *strEncoding(int encoding) {
  * Note that the returned value is just an approximation, especially in the
  * case of aggregated data types where only "sample_size" elements
  * are checked and averaged to estimate the total size. */
-#define OBJ_COMPUTE_SIZE_DEF_SAMPLES 5 /* Default sample size. */
 size_t objectComputeSize(robj *key, robj *o, size_t sample_size, int dbid) {
     size_t asize = 0, elesize = 0, samples = 0;
 
@@ -1171,11 +1173,11 @@ size_t objectComputeSize(robj *key, robj *o, size_t sample_size, int dbid) {
             hashtable *ht = ((zset *)o->ptr)->ht;
             zskiplist *zsl = ((zset *)o->ptr)->zsl;
             zskiplistNode *znode = zsl->header->level[0].forward;
-            asize = sizeof(*o) + sizeof(zset) + sizeof(zskiplist) +
-                    hashtableMemUsage(ht) + zmalloc_size(zsl->header);
+            /* zslAllocSize() covers the node arena, header node included, so
+             * only the element strings need to be sampled. */
+            asize = sizeof(*o) + sizeof(zset) + hashtableMemUsage(ht) + zslAllocSize(zsl);
             while (znode != NULL && samples < sample_size) {
                 elesize += sdsAllocSize(znode->ele);
-                elesize += zmalloc_size(znode);
                 samples++;
                 znode = znode->level[0].forward;
             }
@@ -1656,6 +1658,8 @@ void objectCommand(client *c) {
 void memoryCommand(client *c) {
     if (!strcasecmp(c->argv[1]->ptr, "help") && c->argc == 2) {
         const char *help[] = {
+            "ALLOCATOR-STATS",
+            "    Return utilization statistics per allocator size class.",
             "DOCTOR",
             "    Return memory problems reports.",
             "MALLOC-STATS",
@@ -1814,6 +1818,40 @@ void memoryCommand(client *c) {
 #else
         addReplyBulkCString(c, "Stats not supported for the current allocator");
 #endif
+    } else if (!strcasecmp(c->argv[1]->ptr, "allocator-stats") && c->argc == 2) {
+        allocatorBinStats *bins;
+        unsigned nbins = allocatorGetBinStats(&bins);
+        if (nbins == 0) {
+            addReplyError(c, "Allocator stats not supported for the current allocator");
+            return;
+        }
+        addReplyMapLen(c, nbins);
+        for (unsigned j = 0; j < nbins; j++) {
+            size_t total_regs = bins[j].nregs * bins[j].curr_slabs;
+            char binname[32];
+            snprintf(binname, sizeof(binname), "bin.%zu", bins[j].reg_size);
+            addReplyBulkCString(c, binname);
+            addReplyMapLen(c, 6);
+
+            addReplyBulkCString(c, "regions.per.slab");
+            addReplyLongLong(c, bins[j].nregs);
+
+            addReplyBulkCString(c, "slabs");
+            addReplyLongLong(c, bins[j].curr_slabs);
+
+            addReplyBulkCString(c, "nonfull.slabs");
+            addReplyLongLong(c, bins[j].curr_nonfull_slabs);
+
+            addReplyBulkCString(c, "allocated.regions");
+            addReplyLongLong(c, bins[j].curr_regs);
+
+            addReplyBulkCString(c, "utilization");
+            addReplyDouble(c, total_regs ? (double)bins[j].curr_regs / total_regs : 1.0);
+
+            addReplyBulkCString(c, "fragmentation.bytes");
+            addReplyLongLong(c, bins[j].frag_bytes);
+        }
+        zfree(bins);
     } else if (!strcasecmp(c->argv[1]->ptr, "doctor") && c->argc == 2) {
         sds report = getMemoryDoctorReport();
         addReplyVerbatim(c, report, sdslen(report), "txt");
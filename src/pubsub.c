@@ -508,6 +508,40 @@ int pubsubUnsubscribeAllPatterns(client *c, int notify) {
     return count;
 }
 
+/* Minimum number of channel subscribers before a publish serializes the
+ * message once into a shared reply block instead of copying it into every
+ * subscriber's reply buffer. Small fanouts keep the copying path, which can
+ * use the clients' static output buffers. */
+#define PUBSUB_SHARED_FANOUT_MIN 8
+
+/* Append 'o' to the shared payload as a RESP bulk string. */
+static sds catPubsubBulk(sds payload, robj *o) {
+    if (sdsEncodedObject(o)) {
+        payload = sdscatfmt(payload, "$%U\r\n", (unsigned long long)sdslen(o->ptr));
+        payload = sdscatlen(payload, o->ptr, sdslen(o->ptr));
+    } else {
+        char buf[LONG_STR_SIZE];
+        size_t len = ll2string(buf, sizeof(buf), (long)o->ptr);
+        payload = sdscatfmt(payload, "$%U\r\n", (unsigned long long)len);
+        payload = sdscatlen(payload, buf, len);
+    }
+    return sdscatlen(payload, "\r\n", 2);
+}
+
+/* Serialize a pubsub "message" push for the given RESP version into a shared
+ * reply block, so that fanout to many subscribers is O(subscribers) reference
+ * pushes instead of O(subscribers x payload) memcpy. */
+static clientReplyBlock *buildPubsubSharedBlock(int resp, robj *message_bulk, robj *channel, robj *msg) {
+    sds payload = sdsempty();
+    payload = sdscatlen(payload, resp == 2 ? "*3\r\n" : ">3\r\n", 4);
+    payload = sdscatlen(payload, message_bulk->ptr, sdslen(message_bulk->ptr));
+    payload = catPubsubBulk(payload, channel);
+    payload = catPubsubBulk(payload, msg);
+    clientReplyBlock *block = createSharedReplyBlock(payload, sdslen(payload));
+    sdsfree(payload);
+    return block;
+}
+
 /*
  * Publish a message to all the subscribers.
  */
@@ -525,15 +559,32 @@ int pubsubPublishMessageInternal(robj *channel, robj *message, pubsubtype type)
     if (kvstoreHashtableFind(*type.serverPubSubChannels, (slot == -1) ? 0 : slot, channel, &element)) {
         dict *clients = element;
         dictEntry *entry;
+        /* With a large fanout, serialize the message once per RESP version
+         * and hand every subscriber a reference to the same block. Built
+         * lazily since usually all subscribers speak the same version. */
+        clientReplyBlock *shared_block[2] = {NULL, NULL};
+        int use_shared = dictSize(clients) >= PUBSUB_SHARED_FANOUT_MIN;
         dictIterator *iter = dictGetIterator(clients);
         while ((entry = dictNext(iter)) != NULL) {
             client *c = dictGetKey(entry);
-            addReplyPubsubMessage(c, channel, message, *type.messageBulk);
+            if (use_shared) {
+                int v3 = c->resp > 2;
+                if (!shared_block[v3])
+                    shared_block[v3] = buildPubsubSharedBlock(c->resp, *type.messageBulk, channel, message);
+                struct ClientFlags old_flags = c->flag;
+                c->flag.pushing = 1;
+                addReplySharedBlock(c, shared_block[v3]);
+                if (!old_flags.pushing) c->flag.pushing = 0;
+            } else {
+                addReplyPubsubMessage(c, channel, message, *type.messageBulk);
+            }
             clusterSlotStatsAddNetworkBytesOutForShardedPubSubInternalPropagation(c, slot);
             updateClientMemUsageAndBucket(c);
             receivers++;
         }
         dictReleaseIterator(iter);
+        if (shared_block[0]) releaseSharedReplyBlock(shared_block[0]);
+        if (shared_block[1]) releaseSharedReplyBlock(shared_block[1]);
     }
 
     if (type.shard) {
@@ -118,6 +118,55 @@ static quicklistNode *_quicklistMergeNodes(quicklist *quicklist, quicklistNode *
         (iter)->zi = NULL;      \
     } while (0)
 
+/* The skip index samples every QL_SKIP_INDEX_STRIDE'th node of the chain
+ * together with the number of entries that precede it, so that a seek to a
+ * deep index can jump close to the target node instead of walking the whole
+ * chain from head or tail. It is built lazily by the first deep seek on a
+ * list of at least QL_SKIP_INDEX_MIN_LEN nodes and discarded (cheaply, by
+ * zeroing 'size') by any mutation; the allocation is kept so rebuilding
+ * after a burst of writes is just a refill. */
+#define QL_SKIP_INDEX_STRIDE 16  /* nodes between consecutive samples */
+#define QL_SKIP_INDEX_MIN_LEN 64 /* below this many nodes a plain walk is fine */
+
+typedef struct quicklistSkipIndex {
+    unsigned long size;     /* number of valid samples, 0 when stale */
+    unsigned long capacity; /* allocated sample slots */
+    struct {
+        quicklistNode *node; /* every QL_SKIP_INDEX_STRIDE'th node */
+        unsigned long accum; /* number of entries before 'node' */
+    } samples[];
+} quicklistSkipIndex;
+
+/* Mark the skip index stale. Must be called by every operation that adds,
+ * removes, moves or reorders nodes, or changes any entry count. Exported
+ * because active defrag relocates quicklistNode structs. */
+void quicklistSkipIndexInvalidate(quicklist *quicklist) {
+    if (quicklist->skipidx) quicklist->skipidx->size = 0;
+}
+
+/* (Re)build the skip index by walking the node chain once. */
+static void quicklistSkipIndexBuild(quicklist *quicklist) {
+    unsigned long needed = quicklist->len / QL_SKIP_INDEX_STRIDE + 1;
+    quicklistSkipIndex *idx = quicklist->skipidx;
+
+    if (!idx || idx->capacity < needed) {
+        idx = zrealloc(idx, sizeof(*idx) + needed * sizeof(idx->samples[0]));
+        idx->capacity = needed;
+        quicklist->skipidx = idx;
+    }
+
+    idx->size = 0;
+    unsigned long accum = 0, i = 0;
+    for (quicklistNode *n = quicklist->head; n; n = n->next, i++) {
+        if (i % QL_SKIP_INDEX_STRIDE == 0) {
+            idx->samples[idx->size].node = n;
+            idx->samples[idx->size].accum = accum;
+            idx->size++;
+        }
+        accum += n->count;
+    }
+}
+
 /* Create a new quicklist.
  * Free with quicklistRelease(). */
 quicklist *quicklistCreate(void) {
@@ -130,6 +179,7 @@ quicklist *quicklistCreate(void) {
     quicklist->compress = 0;
     quicklist->fill = -2;
     quicklist->bookmark_count = 0;
+    quicklist->skipidx = NULL;
     return quicklist;
 }
 
@@ -203,6 +253,7 @@ void quicklistRelease(quicklist *quicklist) {
         current = next;
     }
     quicklistBookmarksClear(quicklist);
+    zfree(quicklist->skipidx);
     zfree(quicklist);
 }
 
@@ -415,6 +466,7 @@ static void __quicklistInsertNode(quicklist *quicklist, quicklistNode *old_node,
 
     /* Update len first, so in __quicklistCompress we know exactly len */
     quicklist->len++;
+    quicklistSkipIndexInvalidate(quicklist);
 
     if (old_node) quicklistCompress(quicklist, old_node);
 
@@ -564,6 +616,7 @@ int quicklistPushHead(quicklist *quicklist, void *value, size_t sz) {
     }
     quicklist->count++;
     quicklist->head->count++;
+    quicklistSkipIndexInvalidate(quicklist);
     return (orig_head != quicklist->head);
 }
 
@@ -590,6 +643,7 @@ int quicklistPushTail(quicklist *quicklist, void *value, size_t sz) {
     }
     quicklist->count++;
     quicklist->tail->count++;
+    quicklistSkipIndexInvalidate(quicklist);
     return (orig_tail != quicklist->tail);
 }
 
@@ -654,6 +708,7 @@ static void __quicklistDelNode(quicklist *quicklist, quicklistNode *node) {
     /* Update len first, so in __quicklistCompress we know exactly len */
     quicklist->len--;
     quicklist->count -= node->count;
+    quicklistSkipIndexInvalidate(quicklist);
 
     /* If we deleted a node within our compress depth, we
      * now have compressed nodes needing to be decompressed. */
@@ -687,6 +742,7 @@ static int quicklistDelIndex(quicklist *quicklist, quicklistNode *node, unsigned
         quicklistNodeUpdateSz(node);
     }
     quicklist->count--;
+    quicklistSkipIndexInvalidate(quicklist);
     /* If we deleted the node, the original node is no longer valid */
     return gone ? 1 : 0;
 }
@@ -1076,6 +1132,7 @@ static void _quicklistInsert(quicklistIter *iter, quicklistEntry *entry, void *v
     }
 
     quicklist->count++;
+    quicklistSkipIndexInvalidate(quicklist);
 
     /* In any case, we reset iterator to forbid use of iterator after insert.
      * Notice: iter->current has been compressed in _quicklistInsert(). */
@@ -1162,6 +1219,7 @@ int quicklistDelRange(quicklist *quicklist, const long start, const long count)
             quicklistNodeUpdateSz(node);
             node->count -= del;
             quicklist->count -= del;
+            quicklistSkipIndexInvalidate(quicklist);
             quicklistDeleteIfEmpty(quicklist, node);
             if (node) quicklistRecompressOnly(node);
         }
@@ -1217,29 +1275,58 @@ quicklistIter *quicklistGetIteratorAtIdx(quicklist *quicklist, const int directi
     index = forward ? idx : (-idx) - 1;
     if (index >= quicklist->count) return NULL;
 
-    /* Seek in the other direction if that way is shorter. */
-    int seek_forward = forward;
-    unsigned long long seek_index = index;
-    if (index > (quicklist->count - 1) / 2) {
-        seek_forward = !forward;
-        seek_index = quicklist->count - 1 - index;
-    }
-
-    n = seek_forward ? quicklist->head : quicklist->tail;
-    while (likely(n)) {
-        if ((accum + n->count) > seek_index) {
-            break;
-        } else {
-            D("Skipping over (%p) %u at accum %lld", (void *)n, n->count, accum);
+    if (quicklist->len >= QL_SKIP_INDEX_MIN_LEN) {
+        /* Long chain: jump via the skip index. Find the last sample whose
+         * accum does not exceed the target, then walk forward from it; the
+         * walk visits at most QL_SKIP_INDEX_STRIDE-1 nodes. The samples are
+         * head-relative, so translate a tail-relative index first. */
+        unsigned long long fwd_index = forward ? index : quicklist->count - 1 - index;
+        if (!quicklist->skipidx || quicklist->skipidx->size == 0) quicklistSkipIndexBuild(quicklist);
+        quicklistSkipIndex *skipidx = quicklist->skipidx;
+        unsigned long lo = 0, hi = skipidx->size - 1;
+        while (lo < hi) {
+            unsigned long mid = lo + (hi - lo + 1) / 2;
+            if (skipidx->samples[mid].accum <= fwd_index)
+                lo = mid;
+            else
+                hi = mid - 1;
+        }
+        n = skipidx->samples[lo].node;
+        accum = skipidx->samples[lo].accum;
+        while (likely(n)) {
+            if ((accum + n->count) > fwd_index) break;
             accum += n->count;
-            n = seek_forward ? n->next : n->prev;
+            n = n->next;
+        }
+        if (!n) return NULL;
+
+        /* Fix accum so it looks like we seeked in the requested direction. */
+        if (!forward) accum = quicklist->count - n->count - accum;
+    } else {
+        /* Short chain: seek in whichever direction is shorter. */
+        int seek_forward = forward;
+        unsigned long long seek_index = index;
+        if (index > (quicklist->count - 1) / 2) {
+            seek_forward = !forward;
+            seek_index = quicklist->count - 1 - index;
         }
-    }
 
-    if (!n) return NULL;
+        n = seek_forward ? quicklist->head : quicklist->tail;
+        while (likely(n)) {
+            if ((accum + n->count) > seek_index) {
+                break;
+            } else {
+                D("Skipping over (%p) %u at accum %lld", (void *)n, n->count, accum);
+                accum += n->count;
+                n = seek_forward ? n->next : n->prev;
+            }
+        }
 
-    /* Fix accum so it looks like we seeked in the other direction. */
-    if (seek_forward != forward) accum = quicklist->count - n->count - accum;
+        if (!n) return NULL;
+
+        /* Fix accum so it looks like we seeked in the other direction. */
+        if (seek_forward != forward) accum = quicklist->count - n->count - accum;
+    }
 
     D("Found node: %p at accum %llu, idx %llu, sub+ %llu, sub- %llu", (void *)n, accum, index, index - accum,
       (-index) - 1 + accum);
@@ -1430,6 +1517,7 @@ static void quicklistRotatePlain(quicklist *quicklist) {
     new_head->prev = NULL;
     quicklist->head = new_head;
     quicklist->tail = new_tail;
+    quicklistSkipIndexInvalidate(quicklist);
 }
 
 /* Rotate quicklist by moving the tail element to the head. */
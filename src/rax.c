@@ -452,18 +452,27 @@ raxLowWalk(rax *rax, unsigned char *s, size_t len, raxNode **stopnode, raxNode *
         unsigned char *v = h->data;
 
         if (h->iscompr) {
-            for (j = 0; j < h->size && i < len; j++, i++) {
-                if (v[j] != s[i]) break;
+            /* Compare the whole compressed prefix with memcmp() first: the
+             * libc does it word-at-a-time or with SIMD, and matching the
+             * entire prefix is by far the common case when descending. Only
+             * on a mismatch fall back to the byte loop to locate the split
+             * position (the involved cache lines are warm by then). */
+            size_t cmplen = h->size < len - i ? h->size : len - i;
+            if (memcmp(v, s + i, cmplen) == 0) {
+                j = cmplen;
+                i += cmplen;
+            } else {
+                for (j = 0; j < cmplen; j++, i++) {
+                    if (v[j] != s[i]) break;
+                }
             }
             if (j != h->size) break;
         } else {
-            /* Even when h->size is large, linear scan provides good
-             * performances compared to other approaches that are in theory
-             * more sounding, like performing a binary search. */
-            for (j = 0; j < h->size; j++) {
-                if (v[j] == s[i]) break;
-            }
-            if (j == h->size) break;
+            /* The edge bytes are stored contiguously, so memchr() scans them
+             * with SIMD compares instead of one branch per child. */
+            unsigned char *found = memchr(v, s[i], h->size);
+            if (found == NULL) break;
+            j = found - v;
             i++;
         }
 
@@ -1662,6 +1671,59 @@ int raxNext(raxIterator *it) {
     return 1;
 }
 
+/* Prefetch hint used by raxSeekAndWalk(). */
+#if defined(__GNUC__) || defined(__clang__)
+#define rax_prefetch(p) __builtin_prefetch(p)
+#else
+#define rax_prefetch(p) ((void)(p))
+#endif
+
+/* Seek the tree with the same 'op'/'ele'/'len' semantics as raxSeek() and
+ * invoke the callback for up to 'max' consecutive elements ('max' == 0 means
+ * no limit). The callback returns 1 to continue walking or 0 to stop.
+ *
+ * The walk stays one element ahead of the callback: the iterator is advanced
+ * before the callback runs, and the next element's node and data pointer are
+ * prefetched so their memory loads overlap with the callback's own work
+ * instead of stalling the next iteration step. Since advancing overwrites the
+ * iterator key, the current key is copied into a small buffer; keys larger
+ * than the buffer are walked without the lookahead.
+ *
+ * Returns the number of elements the callback was invoked for. */
+size_t raxSeekAndWalk(rax *rax, const char *op, unsigned char *ele, size_t len, size_t max, raxWalkCallback cb, void *ctx) {
+    raxIterator it;
+    unsigned char keybuf[RAX_ITER_STATIC_LEN];
+    size_t walked = 0;
+
+    raxStart(&it, rax);
+    if (!raxSeek(&it, op, ele, len) || !raxNext(&it)) {
+        raxStop(&it);
+        return walked;
+    }
+    while (max == 0 || walked < max) {
+        unsigned char *key = it.key;
+        size_t key_len = it.key_len;
+        void *data = it.data;
+
+        if (key_len <= sizeof(keybuf)) {
+            memcpy(keybuf, key, key_len);
+            key = keybuf;
+            int more = raxNext(&it);
+            if (more) {
+                rax_prefetch(it.node);
+                rax_prefetch(it.data);
+            }
+            walked++;
+            if (!cb(key, key_len, data, ctx) || !more) break;
+        } else {
+            walked++;
+            if (!cb(key, key_len, data, ctx) || !raxNext(&it)) break;
+        }
+    }
+    raxStop(&it);
+    return walked;
+}
+
 /* Go to the previous element in the scope of the iterator 'it'.
  * If EOF (or out of memory) is reached, 0 is returned, otherwise 1 is
  * returned. In case 0 is returned because of OOM, errno is set to ENOMEM. */
@@ -198,6 +198,8 @@ void raxStart(raxIterator *it, rax *rt);
 int raxSeek(raxIterator *it, const char *op, unsigned char *ele, size_t len);
 int raxNext(raxIterator *it);
 int raxPrev(raxIterator *it);
+typedef int (*raxWalkCallback)(unsigned char *key, size_t key_len, void *data, void *ctx);
+size_t raxSeekAndWalk(rax *rax, const char *op, unsigned char *ele, size_t len, size_t max, raxWalkCallback cb, void *ctx);
 int raxRandomWalk(raxIterator *it, size_t steps);
 int raxCompare(raxIterator *iter, const char *op, unsigned char *key, size_t key_len);
 void raxStop(raxIterator *it);
@@ -54,6 +54,9 @@
 /* Size of the static buffer used for rdbcompression */
 #define LZF_STATIC_BUFFER_SIZE (8 * 1024)
 
+/* Size of the stdio buffer used when loading or saving an RDB file on disk */
+#define RDB_FILE_BUF_SIZE (1024 * 1024)
+
 /* This macro is called when the internal RDB structure is corrupt */
 #define rdbReportCorruptRDB(...) rdbReportError(1, __LINE__, __VA_ARGS__)
 /* This macro is called when RDB read failed (possibly a short read) */
@@ -960,7 +963,7 @@ ssize_t rdbSaveObject(rio *rdb, robj *o, robj *key, int dbid) {
             nwritten += n;
 
             hashtableIterator iter;
-            hashtableInitIterator(&iter, ht, 0);
+            hashtableInitIterator(&iter, ht, HASHTABLE_ITER_PREFETCH_VALUES);
             void *next;
             while (hashtableNext(&iter, &next)) {
                 sds field = hashTypeEntryGetField(next);
@@ -1324,11 +1327,57 @@ werr:
     return -1;
 }
 
+/* Helper of rdbSaveDb(): serialize a single key/value pair of 'db', give the
+ * dismiss mechanism a hint in the fork child, and periodically report
+ * progress. Returns the number of bytes written, or -1 on error. */
+static ssize_t rdbSaveKeyInDb(rio *rdb, serverDb *db, robj *o, int dbid, long *key_counter, char *pname) {
+    static long long info_updated_time = 0;
+    sds keystr = objectGetKey(o);
+    robj key;
+    long long expire;
+    ssize_t written;
+    size_t rdb_bytes_before_key = rdb->processed_bytes;
+
+    initStaticStringObject(key, keystr);
+    expire = getExpire(db, &key);
+    if ((written = rdbSaveKeyValuePair(rdb, &key, o, expire, dbid)) < 0) return -1;
+
+    /* In fork child process, we can try to release memory back to the
+     * OS and possibly avoid or decrease COW. We give the dismiss
+     * mechanism a hint about an estimated size of the object we stored. */
+    size_t dump_size = rdb->processed_bytes - rdb_bytes_before_key;
+    if (server.in_fork_child) dismissObject(o, dump_size);
+
+    /* Update child info every 1 second (approximately).
+     * in order to avoid calling mstime() on each iteration, we will
+     * check the diff every 1024 keys */
+    if (((*key_counter)++ & 1023) == 0) {
+        long long now = mstime();
+        if (now - info_updated_time >= 1000) {
+            sendChildInfo(CHILD_INFO_TYPE_CURRENT_INFO, *key_counter, pname);
+            info_updated_time = now;
+        }
+    }
+    return written;
+}
+
+/* Slot ordering used by rdbSaveDb() in cluster mode: most recently written
+ * slots first, ties broken by slot number for a deterministic file. */
+typedef struct {
+    int didx;
+    unsigned long long dirty;
+} slotSaveOrder;
+
+static int slotSaveOrderCmp(const void *a, const void *b) {
+    const slotSaveOrder *sa = a, *sb = b;
+    if (sa->dirty != sb->dirty) return sa->dirty < sb->dirty ? 1 : -1;
+    return sa->didx - sb->didx;
+}
+
 ssize_t rdbSaveDb(rio *rdb, int dbid, int rdbflags, long *key_counter) {
     ssize_t written = 0;
     ssize_t res;
     kvstoreIterator *kvs_it = NULL;
-    static long long info_updated_time = 0;
     char *pname = (rdbflags & RDBFLAGS_AOF_PREAMBLE) ? "AOF rewrite" : "RDB";
 
     serverDb *db = server.db + dbid;
@@ -1350,51 +1399,57 @@ ssize_t rdbSaveDb(rio *rdb, int dbid, int rdbflags, long *key_counter) {
     if ((res = rdbSaveLen(rdb, expires_size)) < 0) goto werr;
     written += res;
 
-    kvs_it = kvstoreIteratorInit(db->keys, HASHTABLE_ITER_SAFE | HASHTABLE_ITER_PREFETCH_VALUES);
-    int last_slot = -1;
-    /* Iterate this DB writing every entry */
     void *next;
-    while (kvstoreIteratorNext(kvs_it, &next)) {
-        robj *o = next;
-        int curr_slot = kvstoreIteratorGetCurrentHashtableIndex(kvs_it);
-        /* Save slot info. */
-        if (server.cluster_enabled && curr_slot != last_slot) {
+    if (server.cluster_enabled) {
+        /* Walk the slots in order of recent write activity, hottest first.
+         * In the fork child the hot data is then serialized and dismissed
+         * early, before the parent has had time to rewrite those pages, so
+         * fewer of them end up copied. Slot order in the file is free: each
+         * slot is self-contained behind its slot-info field. */
+        int num_slots = 0;
+        slotSaveOrder *order = zmalloc(sizeof(*order) * kvstoreNumNonEmptyHashtables(db->keys));
+        for (int didx = kvstoreGetFirstNonEmptyHashtableIndex(db->keys); didx != -1;
+             didx = kvstoreGetNextNonEmptyHashtableIndex(db->keys, didx)) {
+            order[num_slots].didx = didx;
+            order[num_slots].dirty = kvstoreHashtableDirtyCount(db->keys, didx);
+            num_slots++;
+        }
+        qsort(order, num_slots, sizeof(*order), slotSaveOrderCmp);
+
+        for (int i = 0; i < num_slots; i++) {
+            int curr_slot = order[i].didx;
+            /* Save slot info. */
             sds slot_info = sdscatprintf(sdsempty(), "%i,%lu,%lu", curr_slot, kvstoreHashtableSize(db->keys, curr_slot),
                                          kvstoreHashtableSize(db->expires, curr_slot));
-            if ((res = rdbSaveAuxFieldStrStr(rdb, "slot-info", slot_info)) < 0) {
-                sdsfree(slot_info);
+            res = rdbSaveAuxFieldStrStr(rdb, "slot-info", slot_info);
+            sdsfree(slot_info);
+            if (res < 0) {
+                zfree(order);
                 goto werr;
             }
             written += res;
-            last_slot = curr_slot;
-            sdsfree(slot_info);
-        }
-        sds keystr = objectGetKey(o);
-        robj key;
-        long long expire;
-        size_t rdb_bytes_before_key = rdb->processed_bytes;
-
-        initStaticStringObject(key, keystr);
-        expire = getExpire(db, &key);
-        if ((res = rdbSaveKeyValuePair(rdb, &key, o, expire, dbid)) < 0) goto werr;
-        written += res;
 
-        /* In fork child process, we can try to release memory back to the
-         * OS and possibly avoid or decrease COW. We give the dismiss
-         * mechanism a hint about an estimated size of the object we stored. */
-        size_t dump_size = rdb->processed_bytes - rdb_bytes_before_key;
-        if (server.in_fork_child) dismissObject(o, dump_size);
-
-        /* Update child info every 1 second (approximately).
-         * in order to avoid calling mstime() on each iteration, we will
-         * check the diff every 1024 keys */
-        if (((*key_counter)++ & 1023) == 0) {
-            long long now = mstime();
-            if (now - info_updated_time >= 1000) {
-                sendChildInfo(CHILD_INFO_TYPE_CURRENT_INFO, *key_counter, pname);
-                info_updated_time = now;
+            kvstoreHashtableIterator *slot_it =
+                kvstoreGetHashtableIterator(db->keys, curr_slot, HASHTABLE_ITER_SAFE | HASHTABLE_ITER_PREFETCH_VALUES);
+            while (kvstoreHashtableIteratorNext(slot_it, &next)) {
+                if ((res = rdbSaveKeyInDb(rdb, db, next, dbid, key_counter, pname)) < 0) {
+                    kvstoreReleaseHashtableIterator(slot_it);
+                    zfree(order);
+                    goto werr;
+                }
+                written += res;
             }
+            kvstoreReleaseHashtableIterator(slot_it);
         }
+        zfree(order);
+        return written;
+    }
+
+    kvs_it = kvstoreIteratorInit(db->keys, HASHTABLE_ITER_SAFE | HASHTABLE_ITER_PREFETCH_VALUES);
+    /* Iterate this DB writing every entry */
+    while (kvstoreIteratorNext(kvs_it, &next)) {
+        if ((res = rdbSaveKeyInDb(rdb, db, next, dbid, key_counter, pname)) < 0) goto werr;
+        written += res;
     }
     kvstoreIteratorRelease(kvs_it);
     return written;
@@ -1502,6 +1557,11 @@ static int rdbSaveInternal(int req, const char *filename, rdbSaveInfo *rsi, int
         return C_ERR;
     }
 
+    /* The dump is produced as a long run of small writes. Buffer them so
+     * the child issues one write(2) per megabyte instead of one per stdio
+     * buffer default. */
+    setvbuf(fp, NULL, _IOFBF, RDB_FILE_BUF_SIZE);
+
     rioInitWithFile(&rdb, fp);
 
     if (server.rdb_save_incremental_fsync) {
@@ -1600,6 +1660,13 @@ int rdbSave(int req, char *filename, rdbSaveInfo *rsi, int rdbflags) {
     return C_OK;
 }
 
+/* Age the per-slot write counters that feed rdbSaveDb()'s hottest-first slot
+ * ordering. Called in the parent right after forking a child that serializes
+ * the keyspace, so each snapshot weighs recent writes over older ones. */
+void rdbDecayWriteActivity(void) {
+    for (int i = 0; i < server.dbnum; i++) kvstoreDecayDirtyCounters(server.db[i].keys);
+}
+
 int rdbSaveBackground(int req, char *filename, rdbSaveInfo *rsi, int rdbflags) {
     pid_t childpid;
 
@@ -1632,6 +1699,7 @@ int rdbSaveBackground(int req, char *filename, rdbSaveInfo *rsi, int rdbflags) {
             return C_ERR;
         }
         serverLog(LL_NOTICE, "Background saving started by pid %ld", (long)childpid);
+        rdbDecayWriteActivity();
         server.rdb_save_time_start = time(NULL);
         server.rdb_child_type = RDB_CHILD_TYPE_DISK;
         return C_OK;
@@ -3435,11 +3503,25 @@ int rdbLoad(char *filename, rdbSaveInfo *rsi, int rdbflags) {
 
     if (fstat(fileno(fp), &sb) == -1) sb.st_size = 0;
 
+    /* Loading performs a strictly sequential pass over the file made of many
+     * small reads. Map the file and read straight from the page cache; if
+     * the mapping is not possible (empty file, no address space, ...) fall
+     * back to stdio with a large buffer to cut the number of read(2) calls,
+     * telling the kernel about the access pattern so it reads ahead. */
+    int use_mmap = sb.st_size > 0 && rioInitWithMmap(&rdb, fileno(fp), sb.st_size);
+    if (!use_mmap) {
+        setvbuf(fp, NULL, _IOFBF, RDB_FILE_BUF_SIZE);
+#ifdef HAVE_FADVISE
+        posix_fadvise(fileno(fp), 0, sb.st_size, POSIX_FADV_SEQUENTIAL);
+#endif
+        rioInitWithFile(&rdb, fp);
+    }
+
     startLoadingFile(sb.st_size, filename, rdbflags);
-    rioInitWithFile(&rdb, fp);
 
     retval = rdbLoadRio(&rdb, rdbflags, rsi);
 
+    if (use_mmap) rioFreeMmap(&rdb);
     fclose(fp);
     stopLoading(retval == C_OK);
     /* Reclaim the cache backed by rdb */
@@ -3691,6 +3773,7 @@ int rdbSaveToReplicasSockets(int req, rdbSaveInfo *rsi) {
                       dual_channel ? "direct socket to replica" : "pipe through parent process",
                       skip_rdb_checksum ? " while skipping RDB checksum for this transfer" : "");
 
+            rdbDecayWriteActivity();
             server.rdb_save_time_start = time(NULL);
             server.rdb_child_type = RDB_CHILD_TYPE_SOCKET;
             if (dual_channel) {
@@ -3783,6 +3866,100 @@ void bgsaveCommand(client *c) {
     }
 }
 
+/* RESTOREDB <path>
+ *
+ * Atomically replaces the whole dataset with the contents of the given RDB
+ * file. The file is loaded into a temporary keyspace while the current
+ * dataset keeps serving reads (the same async-loading mechanics used by the
+ * diskless replica load with repl-diskless-load swapdb), then the two are
+ * swapped and the old dataset is reclaimed in the background, so there is
+ * no flush storm and no unavailability window. Writes are refused with
+ * -LOADING for the duration of the load, since anything written to the old
+ * dataset would be silently discarded by the swap.
+ *
+ * The command does not propagate: the new dataset is outside the current
+ * replication history, so on success the replication ID is changed and the
+ * replicas are disconnected to force a full resynchronization. */
+void restoredbCommand(client *c) {
+    char *path = c->argv[1]->ptr;
+
+    if (server.cluster_enabled) {
+        addReplyError(c, "RESTOREDB is not allowed in cluster mode");
+        return;
+    }
+    if (server.primary_host != NULL) {
+        addReplyError(c, "Can't replace the dataset of a replica, it would be overwritten by the primary");
+        return;
+    }
+    if (server.loading || server.async_loading) {
+        addReplyError(c, "Another loading operation is in progress");
+        return;
+    }
+
+    FILE *fp = fopen(path, "r");
+    if (fp == NULL) {
+        addReplyErrorFormat(c, "Can't open the RDB file '%s': %s", path, strerror(errno));
+        return;
+    }
+    struct stat sb;
+    if (fstat(fileno(fp), &sb) == -1) sb.st_size = 0;
+
+    /* Stop any AOF rewrite or RDB save child before loading: a snapshot in
+     * progress would capture the pre-swap dataset, and holding both datasets
+     * next to a forked child is a copy-on-write disaster. */
+    if (server.aof_state != AOF_OFF) stopAppendOnly();
+    if (server.child_type == CHILD_TYPE_RDB) killRDBChild();
+
+    serverDb *temp_db = initTempDb();
+    functionsLibCtx *temp_functions_lib_ctx = functionsLibCtxCreate();
+    moduleFireServerEvent(VALKEYMODULE_EVENT_REPL_ASYNC_LOAD, VALKEYMODULE_SUBEVENT_REPL_ASYNC_LOAD_STARTED, NULL);
+
+    serverLog(LL_NOTICE, "RESTOREDB: loading the replacement dataset from '%s'", path);
+    rio rdb;
+    setvbuf(fp, NULL, _IOFBF, RDB_FILE_BUF_SIZE);
+    rioInitWithFile(&rdb, fp);
+    startLoading(sb.st_size, RDBFLAGS_NONE, 1);
+    server.loading_dataset_swap = 1;
+
+    rdbLoadingCtx loading_ctx = {.dbarray = temp_db, .functions_lib_ctx = temp_functions_lib_ctx};
+    int retval = rdbLoadRioWithLoadingCtxScopedRdb(&rdb, RDBFLAGS_NONE, NULL, &loading_ctx);
+    fclose(fp);
+    server.loading_dataset_swap = 0;
+
+    if (retval != C_OK) {
+        stopLoading(0);
+        moduleFireServerEvent(VALKEYMODULE_EVENT_REPL_ASYNC_LOAD, VALKEYMODULE_SUBEVENT_REPL_ASYNC_LOAD_ABORTED, NULL);
+        discardTempDb(temp_db);
+        freeFunctionsAsync(temp_functions_lib_ctx);
+        if (server.aof_enabled && server.aof_state == AOF_OFF) restartAOFAfterSYNC();
+        serverLog(LL_WARNING, "RESTOREDB: failed loading '%s', the dataset is unchanged", path);
+        addReplyError(c, "Error loading the RDB file, the dataset is unchanged, check server logs");
+        return;
+    }
+
+    serverLog(LL_NOTICE, "RESTOREDB: swapping the active dataset with the loaded one");
+    swapMainDbWithTempDb(temp_db);
+    functionsLibCtxSwapWithCurrent(temp_functions_lib_ctx, 1);
+    moduleFireServerEvent(VALKEYMODULE_EVENT_REPL_ASYNC_LOAD, VALKEYMODULE_SUBEVENT_REPL_ASYNC_LOAD_COMPLETED, NULL);
+
+    /* The old dataset now lives in temp_db: reclaim it in the background. */
+    discardTempDb(temp_db);
+    stopLoading(1);
+
+    /* The dataset changed outside the replication stream: move to a new
+     * replication history and force the replicas to fully resync. The dirty
+     * counter still signals the change so a snapshot gets scheduled, but the
+     * command itself must not reach the AOF or the (gone) replicas. */
+    changeReplicationId();
+    clearReplicationId2();
+    disconnectReplicas();
+    preventCommandPropagation(c);
+    server.dirty++;
+
+    if (server.aof_enabled && server.aof_state == AOF_OFF) restartAOFAfterSYNC();
+    addReply(c, shared.ok);
+}
+
 /* Populate the rdbSaveInfo structure used to persist the replication
  * information inside the RDB file. Currently the structure explicitly
  * contains just the currently selected DB from the primary stream, however
@@ -77,6 +77,14 @@ typedef enum ValkeyRdmaOpcode {
 #define VALKEY_RDMA_SYNCIO_RES 10
 #define VALKEY_RDMA_INVALID_OPCODE 0xffff
 #define VALKEY_RDMA_KEEPALIVE_MS 3000
+/* Payloads up to this size are requested as QP inline data: the provider
+ * copies them into the work queue entry at post time, so the send skips the
+ * MR lookup and the staging copy into the TX buffer. Providers may round the
+ * value up, or reject it entirely (then the QP is created without inline). */
+#define VALKEY_RDMA_MAX_INLINE_DATA 256
+/* Max work requests chained into a single ibv_post_send (one doorbell) by
+ * connRdmaWritev. */
+#define VALKEY_RDMA_DOORBELL_BATCH 16
 
 #define RDMA_CONN_FLAG_POSTPONE_UPDATE_STATE (1 << 0)
 
@@ -96,12 +104,38 @@ typedef struct RdmaXfer {
     uint32_t pos;      /* the position in use of the transfer buffer */
 } RdmaXfer;
 
+/* A transfer buffer parked in the per-device pool, with its memory region
+ * still registered so the next connection skips both the allocation and the
+ * registration. */
+typedef struct RdmaPooledBuffer {
+    struct ibv_mr *mr;
+    char *addr;
+    uint32_t length;
+    struct RdmaPooledBuffer *next;
+} RdmaPooledBuffer;
+
+/* Resources shared by every connection on the same RDMA device: the
+ * protection domain, the optional shared receive queue for command messages,
+ * and the transfer buffer pool. Shared contexts live for the whole process,
+ * their count is bound by the number of RDMA devices. */
+typedef struct RdmaSharedContext {
+    struct ibv_context *verbs;
+    struct ibv_pd *pd;
+    struct ibv_srq *srq;           /* shared recv queue for CMD messages, may be NULL */
+    ValkeyRdmaCmd *srq_cmd_buf;    /* recv buffer slab posted to the SRQ */
+    struct ibv_mr *srq_cmd_mr;     /* memory region of the SRQ slab */
+    RdmaPooledBuffer *pooled_bufs; /* free list of recyclable transfer buffers */
+    int pooled_count;
+    struct RdmaSharedContext *next;
+} RdmaSharedContext;
+
 typedef struct RdmaContext {
     connection *conn;
     char *ip;
     int port;
     long long keepalive_te; /* RDMA has no transport layer keepalive */
-    struct ibv_pd *pd;
+    RdmaSharedContext *shared;
+    struct ibv_pd *pd; /* owned by 'shared', kept for convenience */
     struct rdma_event_channel *cm_channel;
     struct ibv_comp_channel *comp_channel;
     struct ibv_cq *cq;
@@ -113,13 +147,18 @@ typedef struct RdmaContext {
     uint32_t tx_length; /* remote transfer buffer length */
     uint32_t tx_offset; /* remote transfer buffer offset */
     uint32_t tx_ops;    /* operations on remote transfer */
+    uint32_t max_inline_data; /* max inline data bytes supported by the QP, 0 if none */
 
     /* RX */
     RdmaXfer rx;
 
-    /* CMD 0 ~ VALKEY_RDMA_MAX_WQE for recv buffer
-     * VALKEY_RDMA_MAX_WQE ~ 2 * VALKEY_RDMA_MAX_WQE -1 for send buffer */
+    /* Without SRQ: CMD 0 ~ VALKEY_RDMA_MAX_WQE for recv buffer,
+     * VALKEY_RDMA_MAX_WQE ~ 2 * VALKEY_RDMA_MAX_WQE -1 for send buffer.
+     * With SRQ the recv half lives in the shared context and the
+     * buffer here only holds the send half. */
     ValkeyRdmaCmd *cmd_buf;
+    uint32_t cmd_buf_length; /* bytes of cmd_buf */
+    ValkeyRdmaCmd *send_buf; /* send half within cmd_buf */
     struct ibv_mr *cmd_mr;
 } RdmaContext;
 
@@ -166,6 +205,8 @@ static inline int connRdmaAllowRW(connection *conn) {
     return connRdmaAllowCommand();
 }
 
+static int rdmaPostSrqRecv(RdmaSharedContext *shared, ValkeyRdmaCmd *cmd);
+
 static int rdmaPostRecv(RdmaContext *ctx, struct rdma_cm_id *cm_id, ValkeyRdmaCmd *cmd) {
     struct ibv_sge sge;
     size_t length = sizeof(ValkeyRdmaCmd);
@@ -176,6 +217,10 @@ static int rdmaPostRecv(RdmaContext *ctx, struct rdma_cm_id *cm_id, ValkeyRdmaCm
         return C_ERR;
     }
 
+    if (ctx->shared && ctx->shared->srq) {
+        return rdmaPostSrqRecv(ctx->shared, cmd);
+    }
+
     sge.addr = (uint64_t)cmd;
     sge.length = length;
     sge.lkey = ctx->cmd_mr->lkey;
@@ -246,68 +291,213 @@ static void rdmaMemoryFree(void *ptr, size_t size) {
     }
 }
 
-static void rdmaDestroyIoBuf(RdmaContext *ctx) {
-    if (ctx->rx.mr) {
-        ibv_dereg_mr(ctx->rx.mr);
-        ctx->rx.mr = NULL;
+static RdmaSharedContext *shared_contexts;
+
+static int rdmaPostSrqRecv(RdmaSharedContext *shared, ValkeyRdmaCmd *cmd) {
+    struct ibv_sge sge;
+    struct ibv_recv_wr recv_wr, *bad_wr;
+    int ret;
+
+    sge.addr = (uint64_t)cmd;
+    sge.length = sizeof(ValkeyRdmaCmd);
+    sge.lkey = shared->srq_cmd_mr->lkey;
+
+    recv_wr.wr_id = (uint64_t)cmd;
+    recv_wr.sg_list = &sge;
+    recv_wr.num_sge = 1;
+    recv_wr.next = NULL;
+
+    ret = ibv_post_srq_recv(shared->srq, &recv_wr, &bad_wr);
+    if (ret && (ret != EAGAIN)) {
+        serverLog(LL_WARNING, "RDMA: post srq recv failed: %d", ret);
+        return C_ERR;
+    }
+
+    return C_OK;
+}
+
+/* Create the shared receive queue for CMD messages along with its pinned
+ * buffer slab. One slab serves every connection on the device, instead of
+ * VALKEY_RDMA_MAX_WQE posted recv buffers per connection. */
+static int rdmaSharedSrqInit(RdmaSharedContext *shared) {
+    struct ibv_srq_init_attr srq_attr = {0};
+    size_t length = sizeof(ValkeyRdmaCmd) * VALKEY_RDMA_MAX_WQE;
+    int i;
+
+    srq_attr.attr.max_wr = VALKEY_RDMA_MAX_WQE;
+    srq_attr.attr.max_sge = 1;
+    shared->srq = ibv_create_srq(shared->pd, &srq_attr);
+    if (!shared->srq) {
+        serverLog(LL_WARNING, "RDMA: ibv create srq failed");
+        return C_ERR;
     }
 
-    rdmaMemoryFree(ctx->rx.addr, ctx->rx.length);
-    ctx->rx.addr = NULL;
+    shared->srq_cmd_buf = rdmaMemoryAlloc(length);
+    shared->srq_cmd_mr = ibv_reg_mr(shared->pd, shared->srq_cmd_buf, length, IBV_ACCESS_LOCAL_WRITE);
+    if (!shared->srq_cmd_mr) {
+        serverLog(LL_WARNING, "RDMA: reg mr for SRQ CMD failed");
+        return C_ERR;
+    }
+
+    for (i = 0; i < VALKEY_RDMA_MAX_WQE; i++) {
+        if (rdmaPostSrqRecv(shared, shared->srq_cmd_buf + i) == C_ERR) {
+            return C_ERR;
+        }
+    }
+
+    return C_OK;
+}
+
+/* Look up the shared resources of an RDMA device, creating them on first
+ * use. Shared contexts are never freed, their count is bound by the number
+ * of devices on the host. */
+static RdmaSharedContext *rdmaGetSharedContext(struct ibv_context *verbs) {
+    RdmaSharedContext *shared;
+
+    for (shared = shared_contexts; shared; shared = shared->next) {
+        if (shared->verbs == verbs) {
+            return shared;
+        }
+    }
+
+    shared = zcalloc(sizeof(*shared));
+    shared->verbs = verbs;
+    shared->pd = ibv_alloc_pd(verbs);
+    if (!shared->pd) {
+        serverLog(LL_WARNING, "RDMA: ibv alloc pd failed");
+        zfree(shared);
+        return NULL;
+    }
+
+    if (rdma_config && rdma_config->use_srq) {
+        if (rdmaSharedSrqInit(shared) == C_ERR) {
+            if (shared->srq_cmd_mr) ibv_dereg_mr(shared->srq_cmd_mr);
+            rdmaMemoryFree(shared->srq_cmd_buf, sizeof(ValkeyRdmaCmd) * VALKEY_RDMA_MAX_WQE);
+            if (shared->srq) ibv_destroy_srq(shared->srq);
+            ibv_dealloc_pd(shared->pd);
+            zfree(shared);
+            return NULL;
+        }
+    }
+
+    shared->next = shared_contexts;
+    shared_contexts = shared;
+
+    return shared;
+}
+
+/* Take a transfer buffer of 'length' bytes. A pooled buffer of the exact
+ * length comes back with its memory region already registered, saving both
+ * the allocation and the registration on the connection setup path. */
+static int rdmaXferBufferGet(RdmaSharedContext *shared, RdmaXfer *xfer, uint32_t length) {
+    int access = IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_READ | IBV_ACCESS_REMOTE_WRITE;
+    RdmaPooledBuffer *buf, **prev = &shared->pooled_bufs;
+
+    for (buf = shared->pooled_bufs; buf; prev = &buf->next, buf = buf->next) {
+        if (buf->length == length) {
+            *prev = buf->next;
+            shared->pooled_count--;
+            xfer->mr = buf->mr;
+            xfer->addr = buf->addr;
+            xfer->length = buf->length;
+            zfree(buf);
+            return C_OK;
+        }
+    }
+
+    xfer->addr = rdmaMemoryAlloc(length);
+    xfer->length = length;
+    xfer->mr = ibv_reg_mr(shared->pd, xfer->addr, length, access);
+    if (!xfer->mr) {
+        serverLog(LL_WARNING, "RDMA: reg mr for transfer buffer failed");
+        rdmaMemoryFree(xfer->addr, length);
+        xfer->addr = NULL;
+        xfer->length = 0;
+        return C_ERR;
+    }
+
+    return C_OK;
+}
 
-    if (ctx->tx.mr) {
-        ibv_dereg_mr(ctx->tx.mr);
-        ctx->tx.mr = NULL;
+/* Return a transfer buffer. Up to rdma-mr-pool-size buffers are parked with
+ * their memory region still registered for reuse by a later connection, the
+ * rest are deregistered and freed. */
+static void rdmaXferBufferPut(RdmaSharedContext *shared, RdmaXfer *xfer) {
+    RdmaPooledBuffer *buf;
+    int pool_size = rdma_config ? rdma_config->mr_pool_size : 0;
+
+    if (!xfer->mr) {
+        rdmaMemoryFree(xfer->addr, xfer->length);
+    } else if (shared && shared->pooled_count < pool_size) {
+        buf = zmalloc(sizeof(*buf));
+        buf->mr = xfer->mr;
+        buf->addr = xfer->addr;
+        buf->length = xfer->length;
+        buf->next = shared->pooled_bufs;
+        shared->pooled_bufs = buf;
+        shared->pooled_count++;
+    } else {
+        ibv_dereg_mr(xfer->mr);
+        rdmaMemoryFree(xfer->addr, xfer->length);
     }
 
-    rdmaMemoryFree(ctx->tx.addr, ctx->tx.length);
-    ctx->tx.addr = NULL;
+    xfer->mr = NULL;
+    xfer->addr = NULL;
+    xfer->length = 0;
+}
+
+static void rdmaDestroyIoBuf(RdmaContext *ctx) {
+    rdmaXferBufferPut(ctx->shared, &ctx->rx);
+    rdmaXferBufferPut(ctx->shared, &ctx->tx);
 
     if (ctx->cmd_mr) {
         ibv_dereg_mr(ctx->cmd_mr);
         ctx->cmd_mr = NULL;
     }
 
-    rdmaMemoryFree(ctx->cmd_buf, sizeof(ValkeyRdmaCmd) * VALKEY_RDMA_MAX_WQE * 2);
+    rdmaMemoryFree(ctx->cmd_buf, ctx->cmd_buf_length);
     ctx->cmd_buf = NULL;
+    ctx->send_buf = NULL;
+    ctx->cmd_buf_length = 0;
 }
 
 static int rdmaSetupIoBuf(RdmaContext *ctx, struct rdma_cm_id *cm_id) {
     int access = IBV_ACCESS_LOCAL_WRITE;
-    size_t length = sizeof(ValkeyRdmaCmd) * VALKEY_RDMA_MAX_WQE * 2;
+    int use_srq = ctx->shared->srq != NULL;
+    size_t length;
     ValkeyRdmaCmd *cmd;
     int i;
 
-    /* setup CMD buf & MR */
+    /* setup CMD buf & MR. With SRQ the recv half is the shared slab, only
+     * the send half is per connection. */
+    length = sizeof(ValkeyRdmaCmd) * VALKEY_RDMA_MAX_WQE * (use_srq ? 1 : 2);
     ctx->cmd_buf = rdmaMemoryAlloc(length);
+    ctx->cmd_buf_length = length;
+    ctx->send_buf = use_srq ? ctx->cmd_buf : ctx->cmd_buf + VALKEY_RDMA_MAX_WQE;
     ctx->cmd_mr = ibv_reg_mr(ctx->pd, ctx->cmd_buf, length, access);
     if (!ctx->cmd_mr) {
         serverLog(LL_WARNING, "RDMA: reg mr for CMD failed");
         goto destroy_iobuf;
     }
 
-    for (i = 0; i < VALKEY_RDMA_MAX_WQE; i++) {
-        cmd = ctx->cmd_buf + i;
+    if (!use_srq) {
+        for (i = 0; i < VALKEY_RDMA_MAX_WQE; i++) {
+            cmd = ctx->cmd_buf + i;
 
-        if (rdmaPostRecv(ctx, cm_id, cmd) == C_ERR) {
-            serverLog(LL_WARNING, "RDMA: post recv failed");
-            goto destroy_iobuf;
+            if (rdmaPostRecv(ctx, cm_id, cmd) == C_ERR) {
+                serverLog(LL_WARNING, "RDMA: post recv failed");
+                goto destroy_iobuf;
+            }
         }
     }
 
-    for (i = VALKEY_RDMA_MAX_WQE; i < VALKEY_RDMA_MAX_WQE * 2; i++) {
-        cmd = ctx->cmd_buf + i;
+    for (i = 0; i < VALKEY_RDMA_MAX_WQE; i++) {
+        cmd = ctx->send_buf + i;
         cmd->keepalive.opcode = VALKEY_RDMA_INVALID_OPCODE;
     }
 
     /* setup recv buf & MR */
-    access = IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_READ | IBV_ACCESS_REMOTE_WRITE;
-    length = rdma_config->rx_size;
-    ctx->rx.addr = rdmaMemoryAlloc(length);
-    ctx->rx.length = length;
-    ctx->rx.mr = ibv_reg_mr(ctx->pd, ctx->rx.addr, length, access);
-    if (!ctx->rx.mr) {
-        serverLog(LL_WARNING, "RDMA: reg mr for recv buffer failed");
+    if (rdmaXferBufferGet(ctx->shared, &ctx->rx, rdma_config->rx_size) == C_ERR) {
         goto destroy_iobuf;
     }
 
@@ -324,7 +514,7 @@ static int rdmaCreateResource(RdmaContext *ctx, struct rdma_cm_id *cm_id) {
     struct ibv_qp_init_attr init_attr;
     struct ibv_comp_channel *comp_channel = NULL;
     struct ibv_cq *cq = NULL;
-    struct ibv_pd *pd = NULL;
+    RdmaSharedContext *shared = NULL;
     int comp_vector = rdma_config->completion_vector;
 
     if (ibv_query_device(cm_id->verbs, &device_attr)) {
@@ -332,13 +522,13 @@ static int rdmaCreateResource(RdmaContext *ctx, struct rdma_cm_id *cm_id) {
         return C_ERR;
     }
 
-    pd = ibv_alloc_pd(cm_id->verbs);
-    if (!pd) {
-        serverLog(LL_WARNING, "RDMA: ibv alloc pd failed");
+    shared = rdmaGetSharedContext(cm_id->verbs);
+    if (!shared) {
         return C_ERR;
     }
 
-    ctx->pd = pd;
+    ctx->shared = shared;
+    ctx->pd = shared->pd;
 
     comp_channel = ibv_create_comp_channel(cm_id->verbs);
     if (!comp_channel) {
@@ -365,18 +555,29 @@ static int rdmaCreateResource(RdmaContext *ctx, struct rdma_cm_id *cm_id) {
 
     memset(&init_attr, 0, sizeof(init_attr));
     init_attr.cap.max_send_wr = VALKEY_RDMA_MAX_WQE;
-    init_attr.cap.max_recv_wr = VALKEY_RDMA_MAX_WQE;
+    init_attr.cap.max_recv_wr = shared->srq ? 0 : VALKEY_RDMA_MAX_WQE;
     init_attr.cap.max_send_sge = device_attr.max_sge;
     init_attr.cap.max_recv_sge = 1;
+    init_attr.cap.max_inline_data = VALKEY_RDMA_MAX_INLINE_DATA;
     init_attr.qp_type = IBV_QPT_RC;
     init_attr.send_cq = cq;
     init_attr.recv_cq = cq;
-    ret = rdma_create_qp(cm_id, pd, &init_attr);
+    init_attr.srq = shared->srq;
+    ret = rdma_create_qp(cm_id, shared->pd, &init_attr);
+    if (ret) {
+        /* Inline data support is provider specific, retry without it. */
+        init_attr.cap.max_inline_data = 0;
+        ret = rdma_create_qp(cm_id, shared->pd, &init_attr);
+    }
     if (ret) {
         serverLog(LL_WARNING, "RDMA: create qp failed");
         return C_ERR;
     }
 
+    /* On success the provider updates the caps with the actual values, which
+     * may exceed what we asked for. */
+    ctx->max_inline_data = init_attr.cap.max_inline_data;
+
     if (rdmaSetupIoBuf(ctx, cm_id)) {
         return C_ERR;
     }
@@ -395,38 +596,30 @@ static void rdmaReleaseResource(RdmaContext *ctx) {
         ibv_destroy_comp_channel(ctx->comp_channel);
     }
 
-    if (ctx->pd) {
-        ibv_dealloc_pd(ctx->pd);
-    }
+    /* the protection domain is owned by the shared context */
+    ctx->pd = NULL;
 }
 
 static int rdmaAdjustSendbuf(RdmaContext *ctx, unsigned int length) {
-    int access = IBV_ACCESS_LOCAL_WRITE | IBV_ACCESS_REMOTE_READ | IBV_ACCESS_REMOTE_WRITE;
-
     if (length == ctx->tx_length) {
         return C_OK;
     }
 
-    /* try to free old MR & buffer */
+    /* release the old buffer, it may be parked in the pool for reuse */
     if (ctx->tx_length) {
-        ibv_dereg_mr(ctx->tx.mr);
-        zlibc_free(ctx->tx.addr);
+        rdmaXferBufferPut(ctx->shared, &ctx->tx);
         ctx->tx_length = 0;
     }
 
-    /* create a new buffer & MR */
-    ctx->tx.addr = rdmaMemoryAlloc(length);
-    ctx->tx_length = length;
-    ctx->tx.mr = ibv_reg_mr(ctx->pd, ctx->tx.addr, length, access);
-    if (!ctx->tx.mr) {
+    /* get a new buffer & MR */
+    if (rdmaXferBufferGet(ctx->shared, &ctx->tx, length) == C_ERR) {
         serverRdmaError(server.neterr, "RDMA: reg send mr failed");
         serverLog(LL_WARNING, "RDMA: FATAL error, recv corrupted cmd");
-        zlibc_free(ctx->tx.addr);
-        ctx->tx.addr = NULL;
-        ctx->tx_length = 0;
         return C_ERR;
     }
 
+    ctx->tx_length = length;
+
     return C_OK;
 }
 
@@ -436,15 +629,15 @@ static int rdmaSendCommand(RdmaContext *ctx, struct rdma_cm_id *cm_id, ValkeyRdm
     ValkeyRdmaCmd *_cmd;
     int i, ret;
 
-    /* find an unused cmd buffer */
-    for (i = VALKEY_RDMA_MAX_WQE; i < 2 * VALKEY_RDMA_MAX_WQE; i++) {
-        _cmd = ctx->cmd_buf + i;
+    /* find an unused cmd buffer in the send half */
+    for (i = 0; i < VALKEY_RDMA_MAX_WQE; i++) {
+        _cmd = ctx->send_buf + i;
         if (_cmd->keepalive.opcode == VALKEY_RDMA_INVALID_OPCODE) {
             break;
         }
     }
 
-    assert(i < 2 * VALKEY_RDMA_MAX_WQE);
+    assert(i < VALKEY_RDMA_MAX_WQE);
 
     memcpy(_cmd, cmd, sizeof(ValkeyRdmaCmd));
     sge.addr = (uint64_t)_cmd;
@@ -1272,36 +1465,66 @@ static void connRdmaClose(connection *conn) {
     zfree(conn);
 }
 
+/* A signaled completion is requested once every 'rdma-completion-moderation'
+ * data sends, the unsignaled ones are reaped along with it. */
+static inline int rdmaSendSignaled(RdmaContext *ctx) {
+    int interval = rdma_config ? rdma_config->completion_moderation : VALKEY_RDMA_MAX_WQE / 2;
+
+    return (++ctx->tx_ops % interval) ? 0 : IBV_SEND_SIGNALED;
+}
+
+/* Build a work request which pushes 'data_len' bytes into the remote transfer
+ * buffer at the current TX position, and advance the TX position. The caller
+ * is responsible for posting the work request, possibly chained with others
+ * to share a single doorbell. */
+static void rdmaSetupSendWR(RdmaContext *ctx,
+                            struct ibv_send_wr *send_wr,
+                            struct ibv_sge *sge,
+                            const void *data,
+                            uint32_t data_len) {
+    uint32_t off = ctx->tx.offset;
+    char *addr = ctx->tx.addr + off;
+    char *remote_addr = ctx->tx_addr + off;
+
+    sge->length = data_len;
+    send_wr->sg_list = sge;
+    send_wr->num_sge = 1;
+    send_wr->opcode = IBV_WR_RDMA_WRITE_WITH_IMM;
+    send_wr->send_flags = rdmaSendSignaled(ctx);
+    if (data_len <= ctx->max_inline_data) {
+        /* The provider copies inline payloads into the work queue entry at
+         * post time: no MR lookup, no staging copy into the TX buffer, and
+         * the source buffer may be reused as soon as ibv_post_send returns. */
+        sge->addr = (uint64_t)data;
+        sge->lkey = 0;
+        send_wr->send_flags |= IBV_SEND_INLINE;
+    } else {
+        memcpy(addr, data, data_len);
+        sge->addr = (uint64_t)addr;
+        sge->lkey = ctx->tx.mr->lkey;
+    }
+    send_wr->imm_data = htonl(data_len);
+    send_wr->wr.rdma.remote_addr = (uint64_t)remote_addr;
+    send_wr->wr.rdma.rkey = ctx->tx_key;
+    send_wr->wr_id = 0;
+    send_wr->next = NULL;
+
+    ctx->tx.offset += data_len;
+}
+
 static size_t connRdmaSend(connection *conn, const void *data, size_t data_len) {
     rdma_connection *rdma_conn = (rdma_connection *)conn;
     struct rdma_cm_id *cm_id = rdma_conn->cm_id;
     RdmaContext *ctx = cm_id->context;
     struct ibv_send_wr send_wr, *bad_wr;
     struct ibv_sge sge;
-    uint32_t off = ctx->tx.offset;
-    char *addr = ctx->tx.addr + off;
-    char *remote_addr = ctx->tx_addr + ctx->tx.offset;
     int ret;
 
     if (connRdmaAllowCommand()) {
         return C_ERR;
     }
 
-    memcpy(addr, data, data_len);
-
-    sge.addr = (uint64_t)addr;
-    sge.lkey = ctx->tx.mr->lkey;
-    sge.length = data_len;
-
-    send_wr.sg_list = &sge;
-    send_wr.num_sge = 1;
-    send_wr.opcode = IBV_WR_RDMA_WRITE_WITH_IMM;
-    send_wr.send_flags = (++ctx->tx_ops % (VALKEY_RDMA_MAX_WQE / 2)) ? 0 : IBV_SEND_SIGNALED;
-    send_wr.imm_data = htonl(data_len);
-    send_wr.wr.rdma.remote_addr = (uint64_t)remote_addr;
-    send_wr.wr.rdma.rkey = ctx->tx_key;
-    send_wr.wr_id = 0;
-    send_wr.next = NULL;
+    rdmaSetupSendWR(ctx, &send_wr, &sge, data, data_len);
     ret = ibv_post_send(cm_id->qp, &send_wr, &bad_wr);
     if (ret) {
         serverLog(LL_WARNING, "RDMA: post send failed: %d", ret);
@@ -1309,8 +1532,6 @@ static size_t connRdmaSend(connection *conn, const void *data, size_t data_len)
         return C_ERR;
     }
 
-    ctx->tx.offset += data_len;
-
     return data_len;
 }
 
@@ -1333,13 +1554,66 @@ static int connRdmaWrite(connection *conn, const void *data, size_t data_len) {
     return connRdmaSend(conn, data, towrite);
 }
 
+/* Vectored write: chain up to VALKEY_RDMA_DOORBELL_BATCH work requests and
+ * post them with a single ibv_post_send, so a multi-buffer reply rings the
+ * doorbell once instead of once per buffer. */
 static int connRdmaWritev(connection *conn, const struct iovec *iov, int iovcnt) {
-    int ret, nwritten = 0;
+    rdma_connection *rdma_conn = (rdma_connection *)conn;
+    struct rdma_cm_id *cm_id = rdma_conn->cm_id;
+    RdmaContext *ctx = cm_id->context;
+    struct ibv_send_wr send_wrs[VALKEY_RDMA_DOORBELL_BATCH], *bad_wr;
+    struct ibv_sge sges[VALKEY_RDMA_DOORBELL_BATCH];
+    int i = 0, ret, nwritten = 0;
+
+    if (connRdmaAllowRW(conn)) {
+        return C_ERR;
+    }
+
+    while (i < iovcnt) {
+        int batch = 0, tx_full = 0;
 
-    for (int i = 0; i < iovcnt; i++) {
-        ret = connRdmaWrite(conn, iov[i].iov_base, iov[i].iov_len);
-        if (ret == C_ERR) return C_ERR;
-        nwritten += ret;
+        while (i < iovcnt && batch < VALKEY_RDMA_DOORBELL_BATCH) {
+            uint32_t towrite;
+
+            if (!iov[i].iov_len) {
+                i++;
+                continue;
+            }
+
+            assert(ctx->tx.offset <= ctx->tx.length);
+            towrite = MIN(ctx->tx.length - ctx->tx.offset, iov[i].iov_len);
+            if (!towrite) {
+                tx_full = 1;
+                break;
+            }
+
+            rdmaSetupSendWR(ctx, &send_wrs[batch], &sges[batch], iov[i].iov_base, towrite);
+            if (batch) {
+                send_wrs[batch - 1].next = &send_wrs[batch];
+            }
+            batch++;
+            nwritten += towrite;
+
+            if (towrite < iov[i].iov_len) {
+                /* Short write, the remaining bytes go out on a later call. */
+                tx_full = 1;
+                break;
+            }
+            i++;
+        }
+
+        if (batch) {
+            ret = ibv_post_send(cm_id->qp, &send_wrs[0], &bad_wr);
+            if (ret) {
+                serverLog(LL_WARNING, "RDMA: post send failed: %d", ret);
+                conn->state = CONN_STATE_ERROR;
+                return C_ERR;
+            }
+        }
+
+        if (tx_full) {
+            break;
+        }
     }
 
     return nwritten;
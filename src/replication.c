@@ -552,6 +552,8 @@ void replicationFeedReplicas(int dictid, robj **argv, int argc) {
     /* We can't have replicas attached and no backlog. */
     serverAssert(!(listLength(server.replicas) != 0 && server.repl_backlog == NULL));
 
+    VALKEY_USDT_REPL_FEED(dictid, argc);
+
     /* Must install write handler for all replicas first before feeding
      * replication stream. */
     prepareReplicasToWrite();
@@ -4586,6 +4588,7 @@ void unblockClientWaitingReplicas(client *c) {
     serverAssert(c->bstate->client_waiting_acks_list_node);
     listDelNode(server.clients_waiting_acks, c->bstate->client_waiting_acks_list_node);
     c->bstate->client_waiting_acks_list_node = NULL;
+    if (c->bstate->numlocal) server.waitaof_blocked_clients--;
     updateStatsOnUnblock(c, 0, 0, 0);
 }
 
@@ -46,6 +46,7 @@
 #define RIO_TYPE_BUFFER (1 << 1)
 #define RIO_TYPE_CONN (1 << 2)
 #define RIO_TYPE_FD (1 << 3)
+#define RIO_TYPE_MMAP (1 << 4)
 
 struct _rio {
     /* Backend functions.
@@ -99,6 +100,13 @@ struct _rio {
             off_t pos;
             sds buf;
         } fd;
+        /* Memory mapped file source (used to read RDB files from disk). */
+        struct {
+            char *map;      /* Mapped region, read-only. */
+            size_t size;    /* Size of the mapping. */
+            size_t pos;     /* Offset of the next byte to read. */
+            size_t advised; /* Offset up to which readahead was advised. */
+        } mmap;
         /* Multiple connections target (used to write to N sockets). */
         struct {
             connection **conns; /* Connections */
@@ -187,9 +195,11 @@ void rioInitWithFile(rio *r, FILE *fp);
 void rioInitWithBuffer(rio *r, sds s);
 void rioInitWithConn(rio *r, connection *conn, size_t read_limit);
 void rioInitWithFd(rio *r, int fd);
+int rioInitWithMmap(rio *r, int fd, size_t size);
 
 void rioFreeFd(rio *r);
 void rioFreeConn(rio *r, sds *out_remainingBufferedData);
+void rioFreeMmap(rio *r);
 
 size_t rioWriteBulkCount(rio *r, char prefix, long count);
 size_t rioWriteBulkString(rio *r, const char *buf, size_t len);
@@ -95,6 +95,8 @@ static mstime_t sentinel_election_timeout = 10000;
 static mstime_t sentinel_script_max_runtime = 60000; /* 60 seconds max exec time. */
 static mstime_t sentinel_script_retry_delay = 30000; /* 30 seconds between retries. */
 static mstime_t sentinel_default_failover_timeout = 60 * 3 * 1000;
+static mstime_t sentinel_dns_cache_period = 60000;         /* Reuse a resolved address for 1 minute. */
+static mstime_t sentinel_dns_cache_failure_period = 10000; /* Retry a failed resolution after 10 seconds. */
 
 #define SENTINEL_HELLO_CHANNEL "__sentinel__:hello"
 #define SENTINEL_DEFAULT_REPLICA_PRIORITY 100
@@ -274,8 +276,18 @@ struct sentinelState {
     char *sentinel_auth_user;          /* Username for ACLs AUTH against other sentinel. */
     int resolve_hostnames;             /* Support use of hostnames, assuming DNS is well configured. */
     int announce_hostnames;            /* Announce hostnames instead of IPs when we have them. */
+    dict *dns_cache;                   /* hostname -> sentinelDnsCacheEntry. The blocking resolver
+                                          runs in the timer path, caching keeps a slow or hanging
+                                          DNS server from stalling the checks of every instance. */
 } sentinel;
 
+/* Cached result of a hostname resolution, negative results are cached
+ * with an empty ip. */
+typedef struct sentinelDnsCacheEntry {
+    char ip[NET_IP_STR_LEN]; /* resolved address, empty string if resolution failed */
+    mstime_t ctime;          /* when the resolution was performed */
+} sentinelDnsCacheEntry;
+
 /* A script execution job. */
 typedef struct sentinelScriptJob {
     int flags;           /* Script job flags: SENTINEL_SCRIPT_* */
@@ -446,6 +458,16 @@ dictType leaderVotesDictType = {
     NULL               /* allow to expand */
 };
 
+/* Hostname (sds) -> sentinelDnsCacheEntry pointer. */
+dictType dnsCacheDictType = {
+    dictSdsCaseHash,       /* hash function */
+    NULL,                  /* key dup */
+    dictSdsKeyCaseCompare, /* key compare */
+    dictSdsDestructor,     /* key destructor */
+    dictVanillaFree,       /* val destructor */
+    NULL                   /* allow to expand */
+};
+
 /* Instance renamed commands table. */
 dictType renamedCommandsDictType = {
     dictSdsCaseHash,       /* hash function */
@@ -503,6 +525,7 @@ void initSentinel(void) {
     sentinel.sentinel_auth_user = NULL;
     sentinel.resolve_hostnames = SENTINEL_DEFAULT_RESOLVE_HOSTNAMES;
     sentinel.announce_hostnames = SENTINEL_DEFAULT_ANNOUNCE_HOSTNAMES;
+    sentinel.dns_cache = dictCreate(&dnsCacheDictType);
     memset(sentinel.myid, 0, sizeof(sentinel.myid));
     server.sentinel_config = NULL;
 }
@@ -547,6 +570,46 @@ void sentinelIsRunning(void) {
 
 /* ============================== sentinelAddr ============================== */
 
+/* Resolve a hostname like anetResolve, going through a small cache when
+ * hostname resolution is enabled. The resolver is blocking and Sentinel
+ * resolves during the timer handler and while processing hello messages,
+ * so without the cache a slow or hanging DNS server stalls the health
+ * checks of every monitored instance. Successful resolutions are reused
+ * for sentinel_dns_cache_period milliseconds, failed ones are retried
+ * after sentinel_dns_cache_failure_period. */
+static int sentinelResolveHostname(char *hostname, char *ip, size_t ip_len) {
+    sentinelDnsCacheEntry *entry;
+    mstime_t period, now = mstime();
+
+    /* Without hostname support anetResolve only accepts numeric addresses
+     * and never hits the resolver, no point caching. */
+    if (!sentinel.resolve_hostnames) {
+        return anetResolve(NULL, hostname, ip, ip_len, ANET_IP_ONLY);
+    }
+
+    entry = dictFetchValue(sentinel.dns_cache, hostname);
+    if (entry) {
+        period = entry->ip[0] ? sentinel_dns_cache_period : sentinel_dns_cache_failure_period;
+        if (now - entry->ctime < period) {
+            if (!entry->ip[0]) return ANET_ERR;
+            valkey_strlcpy(ip, entry->ip, ip_len);
+            return ANET_OK;
+        }
+        dictDelete(sentinel.dns_cache, hostname);
+    }
+
+    entry = zmalloc(sizeof(*entry));
+    entry->ctime = now;
+    if (anetResolve(NULL, hostname, ip, ip_len, ANET_NONE) == ANET_ERR) {
+        entry->ip[0] = '\0';
+        dictAdd(sentinel.dns_cache, sdsnew(hostname), entry);
+        return ANET_ERR;
+    }
+    valkey_strlcpy(entry->ip, ip, sizeof(entry->ip));
+    dictAdd(sentinel.dns_cache, sdsnew(hostname), entry);
+    return ANET_OK;
+}
+
 /* Create a sentinelAddr object and return it on success.
  * On error NULL is returned and errno is set to:
  *  ENOENT: Can't resolve the hostname, unless accept_unresolved is non-zero.
@@ -560,8 +623,7 @@ sentinelAddr *createSentinelAddr(char *hostname, int port, int is_accept_unresol
         errno = EINVAL;
         return NULL;
     }
-    if (anetResolve(NULL, hostname, ip, sizeof(ip), sentinel.resolve_hostnames ? ANET_NONE : ANET_IP_ONLY) ==
-        ANET_ERR) {
+    if (sentinelResolveHostname(hostname, ip, sizeof(ip)) == ANET_ERR) {
         serverLog(LL_WARNING, "Failed to resolve hostname '%s'", hostname);
         if (sentinel.resolve_hostnames && is_accept_unresolved) {
             ip[0] = '\0';
@@ -607,8 +669,7 @@ int sentinelAddrEqualsHostname(sentinelAddr *a, char *hostname) {
     char ip[NET_IP_STR_LEN];
 
     /* Try resolve the hostname and compare it to the address */
-    if (anetResolve(NULL, hostname, ip, sizeof(ip), sentinel.resolve_hostnames ? ANET_NONE : ANET_IP_ONLY) ==
-        ANET_ERR) {
+    if (sentinelResolveHostname(hostname, ip, sizeof(ip)) == ANET_ERR) {
         /* If failed resolve then compare based on hostnames. That is our best effort as
          * long as the server is unavailable for some reason. It is fine since an
          * instance cannot have multiple hostnames for a given setup */
@@ -662,6 +662,7 @@ hashtableType hashHashtableType = {
     .entryGetKey = hashHashtableTypeGetKey,
     .keyCompare = hashtableSdsKeyCompare,
     .entryDestructor = hashHashtableTypeDestructor,
+    .entryPrefetchValue = hashTypeEntryPrefetchValue,
 };
 
 /* Hash type hash table (note that small hashes are represented with listpacks) */
@@ -981,6 +982,18 @@ int clientsCronResizeOutputBuffer(client *c, mstime_t now_ms) {
         server.stat_reply_buffer_expands++;
     }
 
+    /* Deep-idle tier: a connection that has not interacted for a while and
+     * has nothing buffered does not need the minimum working buffer either.
+     * Drop it to a dormant footprint - with tens of thousands of mostly-idle
+     * connections those kilobytes add up to real memory. The regular
+     * doubling above grows the buffer back lazily once the client talks
+     * again, with overflow spilling to the reply list in the meantime. */
+    if (new_buffer_size == 0 && c->bufpos == 0 && listLength(c->reply) == 0 &&
+        c->buf_usable_size > PROTO_REPLY_DORMANT_BYTES && server.unixtime - c->last_interaction > 2) {
+        new_buffer_size = PROTO_REPLY_DORMANT_BYTES;
+        server.stat_reply_buffer_shrinks++;
+    }
+
     serverAssertWithInfo(c, NULL, (!new_buffer_size) || (new_buffer_size >= (size_t)c->bufpos));
 
     /* reset the peak value each server.reply_buffer_peak_reset_time seconds. in case the client will be idle
@@ -1164,10 +1177,22 @@ void getExpensiveClientsInfo(size_t *in_usage, size_t *out_usage) {
  * It is very important for this function, and the functions it calls, to be
  * very fast. Sometimes the server has tens of thousands of connected clients, and all
  * of them need to be processed every second.
- */
-static void clientsCron(int clients_this_cycle) {
+ *
+ * Besides the iteration cap the caller computed, the loop runs under a
+ * microsecond budget: a cycle that lands on a batch of expensive clients
+ * (huge buffers to sample, eviction buckets to update) stops early instead
+ * of stretching the tick, and reports how many clients it actually served
+ * so the caller can reschedule the remainder. Returns the number of clients
+ * processed. */
+#define CLIENTS_CRON_TIME_BUDGET_US 500
+static int clientsCron(int clients_this_cycle) {
+    int processed = 0;
+    monotime budget_timer;
+
     /* for debug purposes: skip actual cron work if pause_cron is on */
-    if (server.pause_cron) return;
+    if (server.pause_cron) return clients_this_cycle;
+
+    elapsedStart(&budget_timer);
 
     mstime_t now = mstime();
 
@@ -1191,21 +1216,33 @@ static void clientsCron(int clients_this_cycle) {
         client *c;
         listNode *head;
 
+        /* Stop once the time budget is gone, even if the iteration cap was
+         * not reached: the caller reschedules the leftover clients instead
+         * of letting this cycle stretch the event loop. Checking the clock
+         * every few clients keeps its overhead negligible. */
+        if ((processed & 7) == 7 && elapsedUs(budget_timer) > CLIENTS_CRON_TIME_BUDGET_US) break;
+
         /* Take the current head, process, and then rotate the head to tail.
          * This way we can fairly iterate all clients step by step. */
         head = listFirst(server.clients);
         c = listNodeValue(head);
         listRotateHeadToTail(server.clients);
+        processed++;
         if (c->io_read_state != CLIENT_IDLE || c->io_write_state != CLIENT_IDLE) continue;
 
         /* The following functions do different service checks on the client.
          * The protocol is that they return non-zero if the client was
          * terminated. */
         if (clientsCronHandleTimeout(c, now)) continue;
+        if (clientsCronResumeObufBackpressure(c)) continue;
         if (clientsCronResizeQueryBuffer(c)) continue;
         if (clientsCronResizeOutputBuffer(c, now)) continue;
         if (clientsCronTrackExpensiveClients(c, curr_peak_mem_usage_slot)) continue;
 
+        /* Release reply blocks pinned by zero-copy sends the kernel has
+         * finished with, so an idle client does not hold them forever. */
+        processZeroCopyCompletions(c);
+
         /* Iterating all the clients in getMemoryOverheadData() is too slow and
          * in turn would make the INFO command too slow. So we perform this
          * computation incrementally and track the (not instantaneous but updated
@@ -1216,6 +1253,7 @@ static void clientsCron(int clients_this_cycle) {
 
         if (closeClientOnOutputBufferLimitReached(c, 0)) continue;
     }
+    return processed;
 }
 
 /* A periodic timer that performs client maintenance.
@@ -1225,6 +1263,9 @@ static void clientsCron(int clients_this_cycle) {
  *  - The maximum rate will be defined by CONFIG_MAX_HZ
  *  - At least CLIENTS_CRON_MIN_ITERATIONS will be performed each cycle
  *  - All clients need to be checked (at least) once per second (if possible given other constraints)
+ *  - A cycle cut short by clientsCron()'s time budget carries the deficit over and
+ *    reschedules itself on the next event-loop iteration, so the once-per-second
+ *    goal degrades gracefully instead of one tick doing all the work at once
  */
 long long clientsTimeProc(struct aeEventLoop *eventLoop, long long id, void *clientData) {
     UNUSED(eventLoop);
@@ -1233,6 +1274,7 @@ long long clientsTimeProc(struct aeEventLoop *eventLoop, long long id, void *cli
 
     const int MIN_CLIENTS_PER_CYCLE = 5;
     const int MAX_CLIENTS_PER_CYCLE = 200;
+    static int carried_clients = 0; /* Quota left unserved by a budget-bound cycle. */
 
     monotime start_time;
     elapsedStart(&start_time);
@@ -1254,7 +1296,17 @@ long long clientsTimeProc(struct aeEventLoop *eventLoop, long long id, void *cli
         delay_ms = 1000 / server.hz;
     }
 
-    clientsCron(clients_this_cycle);
+    /* Aged quota from previous short cycles is served on top of this one. */
+    clients_this_cycle += carried_clients;
+    if (clients_this_cycle > numclients) clients_this_cycle = numclients;
+
+    int processed = clientsCron(clients_this_cycle);
+
+    /* Whatever the time budget cut from this cycle is owed to the next one,
+     * which we run on the very next event-loop iteration rather than a full
+     * tick away: the same total work gets done, in bounded slices. */
+    carried_clients = clients_this_cycle - processed;
+    if (carried_clients > 0) delay_ms = 1;
 
     server.clients_hz = 1000 / delay_ms;
     server.el_cron_duration += elapsedUs(start_time);
@@ -1510,6 +1562,34 @@ long long serverCron(struct aeEventLoop *eventLoop, long long id, void *clientDa
                                  factor);
         trackInstantaneousMetric(STATS_METRIC_EL_DURATION, server.duration_stats[EL_DURATION_TYPE_EL].sum,
                                  server.duration_stats[EL_DURATION_TYPE_EL].cnt, 1);
+        trackInstantaneousMetric(STATS_METRIC_EL_POLL_DURATION, server.duration_stats[EL_DURATION_TYPE_POLL].sum,
+                                 server.duration_stats[EL_DURATION_TYPE_POLL].cnt, 1);
+    }
+
+    /* Roll the window over which the max eventloop cycle duration is reported. */
+    run_with_period(1000) {
+        server.el_duration_recent_max_prev = server.el_duration_recent_max;
+        server.el_duration_recent_max = 0;
+    }
+
+    /* After a mass deletion (nightly GC jobs and the like) the allocator keeps
+     * dirty pages around until background purging or defrag gets to them, so
+     * RSS can stay inflated for a long while. When enough keys were removed
+     * within the last second, ask the allocator to hand the unused pages back
+     * right away. The purge is held back until pending lazy frees have drained
+     * (so it actually covers the released memory) and while a child process is
+     * running (to not defeat copy-on-write). */
+    run_with_period(1000) {
+        static long long deleted_keys_snapshot = 0;
+        static int purge_pending = 0;
+        long long deleted = server.stat_deleted_keys - deleted_keys_snapshot;
+        deleted_keys_snapshot = server.stat_deleted_keys;
+        if (server.delete_burst_purge_threshold && deleted >= server.delete_burst_purge_threshold)
+            purge_pending = 1;
+        if (purge_pending && bioPendingJobsOfType(BIO_LAZY_FREE) == 0 && !hasActiveChildProcess()) {
+            purge_pending = 0;
+            if (jemalloc_purge() == 0) server.stat_delete_burst_purges++;
+        }
     }
 
     /* We have just LRU_BITS bits per object for LRU information.
@@ -1666,6 +1746,12 @@ long long serverCron(struct aeEventLoop *eventLoop, long long id, void *clientDa
         migrateCloseTimedoutSockets();
     }
 
+    /* Rotate the rolling per-command latency histogram windows. The function
+     * is a no-op until the current window expires. */
+    run_with_period(1000) {
+        latencyTrackingRotateWindows();
+    }
+
     /* Resize tracking keys table if needed. This is also done at every
      * command execution, but we want to be sure that if the last command
      * executed changes the value via CONFIG SET, the server will perform
@@ -1846,6 +1932,13 @@ void beforeSleep(struct aeEventLoop *eventLoop) {
      * ASAP if a fast cycle is not needed). */
     if (server.active_expire_enabled && !server.import_mode && iAmPrimary()) activeExpireCycle(ACTIVE_EXPIRE_CYCLE_FAST);
 
+    /* Reclaim the expired keys that read lookups met since the previous
+     * iteration and left for us to delete. */
+    reclaimDeferredExpiredKeys();
+
+    /* The read coalescing cache is only valid within one iteration. */
+    if (server.read_coalesce.key) resetReadCoalescingCache();
+
     if (moduleCount()) {
         moduleFireServerEvent(VALKEYMODULE_EVENT_EVENTLOOP, VALKEYMODULE_SUBEVENT_EVENTLOOP_BEFORE_SLEEP, NULL);
     }
@@ -1936,6 +2029,7 @@ void beforeSleep(struct aeEventLoop *eventLoop) {
     if (server.el_start > 0) {
         monotime el_duration = getMonotonicUs() - server.el_start;
         durationAddSample(EL_DURATION_TYPE_EL, el_duration);
+        if (el_duration > server.el_duration_recent_max) server.el_duration_recent_max = el_duration;
     }
     server.el_cron_duration += duration_before_aof + duration_after_write;
     durationAddSample(EL_DURATION_TYPE_CRON, server.el_cron_duration);
@@ -1952,6 +2046,10 @@ void beforeSleep(struct aeEventLoop *eventLoop) {
      * connection has pending data) */
     aeSetDontWait(server.el, dont_sleep);
 
+    /* Take note of when we stop doing work, so that afterSleep() can account
+     * the time spent waiting in the multiplexing API. */
+    server.el_sleep_start = getMonotonicUs();
+
     /* Before we are going to sleep, let the threads access the dataset by
      * releasing the GIL. The server main thread will not touch anything at this
      * time. */
@@ -1981,6 +2079,13 @@ void afterSleep(struct aeEventLoop *eventLoop, int numevents) {
             latencyEndMonitor(latency);
             latencyAddSampleIfNeeded("module-acquire-GIL", latency);
         }
+        /* Record the time spent sleeping in the multiplexing API. The module
+         * GIL wait above is included on purpose: the loop is stalled either
+         * way. */
+        if (server.el_sleep_start > 0) {
+            durationAddSample(EL_DURATION_TYPE_POLL, getMonotonicUs() - server.el_sleep_start);
+            server.el_sleep_start = 0;
+        }
         /* Set the eventloop start time. */
         server.el_start = getMonotonicUs();
         /* Set the eventloop command count at start. */
@@ -2218,6 +2323,8 @@ void initServerConfig(void) {
     server.skip_checksum_validation = 0;
     server.loading = 0;
     server.async_loading = 0;
+    server.loading_early_reads = 0;
+    server.loading_dataset_swap = 0;
     server.loading_rdb_used_mem = 0;
     server.aof_state = AOF_OFF;
     server.aof_rewrite_base_size = 0;
@@ -2686,12 +2793,16 @@ void resetServerStats(void) {
     server.stat_expired_time_cap_reached_count = 0;
     server.stat_expire_cycle_time_used = 0;
     server.stat_evictedkeys = 0;
+    server.stat_evictedpoolghosts = 0;
+    server.stat_deleted_keys = 0;
+    server.stat_delete_burst_purges = 0;
     server.stat_evictedclients = 0;
     server.stat_evictedscripts = 0;
     server.stat_total_eviction_exceeded_time = 0;
     server.stat_last_eviction_exceeded_time = 0;
     server.stat_keyspace_misses = 0;
     server.stat_keyspace_hits = 0;
+    server.stat_coalesced_reads = 0;
     server.stat_active_defrag_hits = 0;
     server.stat_active_defrag_misses = 0;
     server.stat_active_defrag_key_hits = 0;
@@ -2715,6 +2826,7 @@ void resetServerStats(void) {
     server.stat_total_writes_processed = 0;
     server.stat_client_qbuf_limit_disconnections = 0;
     server.stat_client_outbuf_limit_disconnections = 0;
+    server.stat_client_outbuf_backpressure = 0;
     for (j = 0; j < STATS_METRIC_COUNT; j++) {
         server.inst_metric[j].idx = 0;
         server.inst_metric[j].last_sample_base = 0;
@@ -2722,6 +2834,8 @@ void resetServerStats(void) {
         memset(server.inst_metric[j].samples, 0, sizeof(server.inst_metric[j].samples));
     }
     server.stat_aof_rewrites = 0;
+    server.stat_aof_writes = 0;
+    server.stat_aof_fsyncs = 0;
     server.stat_rdb_saves = 0;
     server.stat_aofrw_consecutive_failures = 0;
     server.stat_net_input_bytes = 0;
@@ -2787,11 +2901,16 @@ void initServer(void) {
     server.ready_keys = listCreate();
     server.tracking_pending_keys = listCreate();
     server.pending_push_messages = listCreate();
+    server.pending_expired_keys = listCreate();
+    server.read_coalesce.key = NULL;
+    server.read_coalesce.block = NULL;
     server.clients_waiting_acks = listCreate();
+    server.waitaof_blocked_clients = 0;
     server.get_ack_from_replicas = 0;
     server.paused_actions = 0;
     memset(server.client_pause_per_purpose, 0, sizeof(server.client_pause_per_purpose));
     server.postponed_clients = listCreate();
+    server.scan_slice_clients = listCreate();
     server.events_processed_while_blocked = 0;
     server.system_memory_size = zmalloc_get_memory_size();
     server.blocked_last_cron = 0;
@@ -2829,7 +2948,7 @@ void initServer(void) {
         flags |= KVSTORE_FREE_EMPTY_HASHTABLES;
     }
     for (j = 0; j < server.dbnum; j++) {
-        server.db[j].keys = kvstoreCreate(&kvstoreKeysHashtableType, slot_count_bits, flags);
+        server.db[j].keys = kvstoreCreate(&kvstoreKeysHashtableType, slot_count_bits, flags | KVSTORE_TRACK_WRITE_ACTIVITY);
         server.db[j].expires = kvstoreCreate(&kvstoreExpiresHashtableType, slot_count_bits, flags);
         server.db[j].expires_cursor = 0;
         server.db[j].blocking_keys = dictCreate(&keylistDictType);
@@ -2929,6 +3048,7 @@ void initServer(void) {
     /* Register before and after sleep handlers (note this needs to be done
      * before loading persistence since it is used by processEventsWhileBlocked. */
     aeSetBeforeSleepProc(server.el, beforeSleep);
+    aeSetBusyPoll(server.el, server.busy_poll_usec);
     aeSetAfterSleepProc(server.el, afterSleep);
 
     /* 32 bit instances are limited to 4GB of address space, so if there is
@@ -3275,6 +3395,12 @@ void resetCommandTableStats(hashtable *commands) {
             hdr_close(c->latency_histogram);
             c->latency_histogram = NULL;
         }
+        for (int i = 0; i < 2; i++) {
+            if (c->latency_histogram_recent[i]) {
+                hdr_close(c->latency_histogram_recent[i]);
+                c->latency_histogram_recent[i] = NULL;
+            }
+        }
         if (c->subcommands_ht) resetCommandTableStats(c->subcommands_ht);
     }
     hashtableResetIterator(&iter);
@@ -3537,15 +3663,62 @@ void preventCommandReplication(client *c) {
 
 /* This function is called in order to update the total command histogram duration.
  * The latency unit is nano-seconds.
- * If needed it will allocate the histogram memory and trim the duration to the upper/lower tracking limits*/
-void updateCommandLatencyHistogram(struct hdr_histogram **latency_histogram, int64_t duration_hist) {
+ * If needed it will allocate the histogram memory and trim the duration to the upper/lower tracking limits.
+ * When rolling windows are enabled (latency-tracking-window > 0) the sample is
+ * also recorded into the window histogram that is currently collecting. */
+void updateCommandLatencyHistogram(struct serverCommand *cmd, int64_t duration_hist) {
     if (duration_hist < LATENCY_HISTOGRAM_MIN_VALUE) duration_hist = LATENCY_HISTOGRAM_MIN_VALUE;
     if (duration_hist > LATENCY_HISTOGRAM_MAX_VALUE) duration_hist = LATENCY_HISTOGRAM_MAX_VALUE;
-    if (*latency_histogram == NULL)
+    if (cmd->latency_histogram == NULL)
         hdr_init(LATENCY_HISTOGRAM_MIN_VALUE, LATENCY_HISTOGRAM_MAX_VALUE, LATENCY_HISTOGRAM_PRECISION,
-                 latency_histogram);
-    hdr_record_value(*latency_histogram, duration_hist);
+                 &cmd->latency_histogram);
+    hdr_record_value(cmd->latency_histogram, duration_hist);
+    if (server.latency_tracking_window > 0) {
+        struct hdr_histogram **recent = &cmd->latency_histogram_recent[server.latency_tracking_recent_idx];
+        if (*recent == NULL)
+            hdr_init(LATENCY_HISTOGRAM_MIN_VALUE, LATENCY_HISTOGRAM_MAX_VALUE, LATENCY_WINDOW_HISTOGRAM_PRECISION,
+                     recent);
+        hdr_record_value(*recent, duration_hist);
+    }
+}
+
+#ifdef USE_PHASE_PROFILING
+/* Cumulative per-phase cycle counts and log2 duration histograms. The reply
+ * phase is recorded from the I/O threads as well as the main thread, hence
+ * the relaxed atomics. */
+static const char *phase_profile_names[PHASE_NUM] = {"parse", "execute", "reply", "propagate"};
+static struct {
+    _Atomic uint64_t count[PHASE_NUM];
+    _Atomic uint64_t cycles[PHASE_NUM];
+    _Atomic uint64_t hist[PHASE_NUM][PHASE_HIST_BUCKETS];
+} phase_profile;
+
+void phaseProfileRecord(int phase, uint64_t cycles) {
+    int bucket = 63 - __builtin_clzll(cycles | 1);
+    if (bucket >= PHASE_HIST_BUCKETS) bucket = PHASE_HIST_BUCKETS - 1;
+    atomic_fetch_add_explicit(&phase_profile.count[phase], 1, memory_order_relaxed);
+    atomic_fetch_add_explicit(&phase_profile.cycles[phase], cycles, memory_order_relaxed);
+    atomic_fetch_add_explicit(&phase_profile.hist[phase][bucket], 1, memory_order_relaxed);
+}
+
+/* INFO PHASEPROFILE: one line per phase with cumulative counts and the log2
+ * histogram; bucket i counts durations in [2^i, 2^(i+1)) cycles, listed from
+ * bucket 0 upward. */
+sds genValkeyInfoStringPhaseProfile(sds info) {
+    for (int p = 0; p < PHASE_NUM; p++) {
+        info = sdscatprintf(info, "phase_%s:calls=%llu,cycles=%llu,hist=", phase_profile_names[p],
+                            (unsigned long long)atomic_load_explicit(&phase_profile.count[p], memory_order_relaxed),
+                            (unsigned long long)atomic_load_explicit(&phase_profile.cycles[p], memory_order_relaxed));
+        for (int b = 0; b < PHASE_HIST_BUCKETS; b++) {
+            info = sdscatprintf(info, b ? ",%llu" : "%llu",
+                                (unsigned long long)atomic_load_explicit(&phase_profile.hist[p][b],
+                                                                         memory_order_relaxed));
+        }
+        info = sdscatlen(info, "\r\n", 2);
+    }
+    return info;
 }
+#endif /* USE_PHASE_PROFILING */
 
 /* Handle the alsoPropagate() API to handle commands that want to propagate
  * multiple separated commands. Note that alsoPropagate() is not affected
@@ -3553,6 +3726,7 @@ void updateCommandLatencyHistogram(struct hdr_histogram **latency_histogram, int
 static void propagatePendingCommands(void) {
     if (server.also_propagate.numops == 0) return;
 
+    PHASE_PROFILE_START(prof);
     int j;
     serverOp *rop;
 
@@ -3587,6 +3761,7 @@ static void propagatePendingCommands(void) {
     }
 
     serverOpArrayFree(&server.also_propagate);
+    PHASE_PROFILE_END(prof, PHASE_PROPAGATE);
 }
 
 /* Performs operations that should be performed after an execution unit ends.
@@ -3732,7 +3907,17 @@ void call(client *c, int flags) {
     monotime monotonic_start = 0;
     if (monotonicGetType() == MONOTONIC_CLOCK_HW) monotonic_start = getMonotonicUs();
 
+    /* Allocator usage before the command runs, to attribute the delta to the
+     * client. This is approximate: memory freed lazily or by other deferred
+     * work is not accounted to the command that caused it. */
+    size_t zmalloc_used_before = zmalloc_used_memory();
+
+    VALKEY_USDT_COMMAND_START(c->cmd->fullname, c->id);
+    PHASE_PROFILE_START(prof);
     c->cmd->proc(c);
+    PHASE_PROFILE_END(prof, PHASE_EXECUTE);
+
+    long long alloc_delta = (long long)zmalloc_used_memory() - (long long)zmalloc_used_before;
 
     /* Clear the CLIENT_REPROCESSING_COMMAND flag after the proc is executed. */
     if (reprocessing_command) c->flag.reprocessing_command = 0;
@@ -3751,6 +3936,8 @@ void call(client *c, int flags) {
     else
         duration = ustime() - call_timer;
 
+    VALKEY_USDT_COMMAND_END(c->cmd->fullname, c->id, duration);
+
     c->duration += duration;
     dirty = server.dirty - dirty;
     if (dirty < 0) dirty = 0;
@@ -3805,8 +3992,22 @@ void call(client *c, int flags) {
         real_cmd->calls++;
         real_cmd->microseconds += c->duration;
         if (server.latency_tracking_enabled && !c->flag.blocked)
-            updateCommandLatencyHistogram(&(real_cmd->latency_histogram), c->duration * 1000);
+            updateCommandLatencyHistogram(real_cmd, c->duration * 1000);
         clusterSlotStatsAddCpuDuration(c, c->duration);
+        /* Attribute the resources to the client and to its ACL user, for
+         * CLIENT LIST and INFO userstats. */
+        c->exec_usec += c->duration;
+        c->alloc_bytes += alloc_delta;
+        if (c->user) {
+            c->user->stat_commands++;
+            c->user->stat_exec_usec += c->duration;
+            c->user->stat_net_input_bytes += c->net_input_bytes_curr_cmd;
+            c->user->stat_net_output_bytes += c->net_output_bytes_curr_cmd;
+            c->user->stat_alloc_bytes += alloc_delta;
+        }
+        /* Feed the module command tracing ring, if some module enabled it. */
+        if (moduleCommandTraceEnabled())
+            moduleCommandTraceRecord(c, real_cmd, c->duration, c->net_output_bytes_curr_cmd);
     }
 
     /* The duration needs to be reset after each call except for a blocked command,
@@ -4013,6 +4214,34 @@ uint64_t getCommandFlags(client *c) {
     return cmd_flags;
 }
 
+/* During the initial RDB load we can safely serve read-only commands whose
+ * keys have all been loaded already: every key appears exactly once in an
+ * RDB file, so a key that exists in the keyspace is complete. A missing key
+ * is indistinguishable from a not-yet-loaded one, so commands referencing
+ * one keep getting -LOADING until the load finishes. Writes are never
+ * allowed, since data appearing later in the file would silently overwrite
+ * them. Returns 1 if the command can be served right now. */
+static int canServeEarlyReadWhileLoading(client *c) {
+    if (!server.loading_early_reads) return 0;
+    if (!(c->cmd->flags & CMD_READONLY)) return 0;
+    /* Scripts may access keys they did not declare, and queued MULTI
+     * commands are vetted again as a whole at EXEC time: refuse both. */
+    if (c->cmd->proc == evalRoCommand || c->cmd->proc == evalShaRoCommand || c->cmd->proc == fcallroCommand) return 0;
+    if (c->flag.multi || c->mstate) return 0;
+
+    int ret = 1;
+    getKeysResult result;
+    initGetKeysResult(&result);
+    int numkeys = getKeysFromCommand(c->cmd, c->argv, c->argc, &result);
+    if (numkeys <= 0) ret = 0;
+    for (int j = 0; j < numkeys && ret; j++) {
+        robj *key = c->argv[result.keys[j].pos];
+        if (lookupKeyReadWithFlags(c->db, key, LOOKUP_NOEFFECTS) == NULL) ret = 0;
+    }
+    getKeysFreeResult(&result);
+    return ret;
+}
+
 /* If this function gets called we already read a whole
  * command, arguments are in the client argv/argc fields.
  * processCommand() execute the command or prepare the
@@ -4298,8 +4527,9 @@ int processCommand(client *c) {
     }
 
     /* Loading DB? Return an error if the command has not the
-     * CMD_LOADING flag. */
-    if (server.loading && !server.async_loading && is_denyloading_command) {
+     * CMD_LOADING flag. During the initial RDB load, reads of keys that
+     * were already loaded may still be served when configured to. */
+    if (server.loading && !server.async_loading && is_denyloading_command && !canServeEarlyReadWhileLoading(c)) {
         rejectCommand(c, shared.loadingerr);
         return C_OK;
     }
@@ -4310,6 +4540,13 @@ int processCommand(client *c) {
         return C_OK;
     }
 
+    /* While RESTOREDB is loading the replacement dataset, anything written
+     * to the current dataset would be silently discarded by the swap. */
+    if (server.loading_dataset_swap && is_write_command) {
+        rejectCommand(c, shared.loadingerr);
+        return C_OK;
+    }
+
     /* when a busy job is being done (script / module)
      * Only allow a limited number of commands.
      * Note that we need to allow the transactions commands, otherwise clients
@@ -5885,6 +6122,8 @@ sds genValkeyInfoString(dict *section_dict, int all_sections, int everything) {
                 "aof_current_rewrite_time_sec:%jd\r\n", (intmax_t)((server.child_type != CHILD_TYPE_AOF) ? -1 : time(NULL) - server.aof_rewrite_time_start),
                 "aof_last_bgrewrite_status:%s\r\n", (server.aof_lastbgrewrite_status == C_OK ? "ok" : "err"),
                 "aof_rewrites:%lld\r\n", server.stat_aof_rewrites,
+                "aof_writes:%lld\r\n", server.stat_aof_writes,
+                "aof_fsyncs:%lld\r\n", server.stat_aof_fsyncs,
                 "aof_rewrites_consecutive_failures:%lld\r\n", server.stat_aofrw_consecutive_failures,
                 "aof_last_write_status:%s\r\n", (server.aof_last_write_status == C_OK && aof_bio_fsync_status == C_OK) ? "ok" : "err",
                 "aof_last_cow_size:%zu\r\n", server.stat_aof_cow_bytes,
@@ -5946,6 +6185,16 @@ sds genValkeyInfoString(dict *section_dict, int all_sections, int everything) {
         long long current_active_defrag_time =
             server.stat_last_active_defrag_time ? (long long)elapsedUs(server.stat_last_active_defrag_time) : 0;
 
+        /* Main thread utilization: fraction of a cycle spent doing work rather
+         * than waiting in the multiplexing API, from the per-cycle averages. */
+        long long el_work_usec = getInstantaneousMetric(STATS_METRIC_EL_DURATION);
+        long long el_poll_usec = getInstantaneousMetric(STATS_METRIC_EL_POLL_DURATION);
+        double el_util_perc =
+            (el_work_usec + el_poll_usec) ? (double)el_work_usec * 100 / (el_work_usec + el_poll_usec) : 0;
+        monotime el_duration_max_recent = server.el_duration_recent_max > server.el_duration_recent_max_prev
+                                              ? server.el_duration_recent_max
+                                              : server.el_duration_recent_max_prev;
+
         if (sections++) info = sdscat(info, "\r\n");
         info = sdscatprintf(
             info,
@@ -5970,12 +6219,16 @@ sds genValkeyInfoString(dict *section_dict, int all_sections, int everything) {
                 "expired_time_cap_reached_count:%lld\r\n", server.stat_expired_time_cap_reached_count,
                 "expire_cycle_cpu_milliseconds:%lld\r\n", server.stat_expire_cycle_time_used / 1000,
                 "evicted_keys:%lld\r\n", server.stat_evictedkeys,
+                "evicted_pool_ghosts:%lld\r\n", server.stat_evictedpoolghosts,
+                "deleted_keys:%lld\r\n", server.stat_deleted_keys,
+                "delete_burst_purges:%lld\r\n", server.stat_delete_burst_purges,
                 "evicted_clients:%lld\r\n", server.stat_evictedclients,
                 "evicted_scripts:%lld\r\n", server.stat_evictedscripts,
                 "total_eviction_exceeded_time:%lld\r\n", (server.stat_total_eviction_exceeded_time + current_eviction_exceeded_time) / 1000,
                 "current_eviction_exceeded_time:%lld\r\n", current_eviction_exceeded_time / 1000,
                 "keyspace_hits:%lld\r\n", server.stat_keyspace_hits,
                 "keyspace_misses:%lld\r\n", server.stat_keyspace_misses,
+                "coalesced_reads:%lld\r\n", server.stat_coalesced_reads,
                 "pubsub_channels:%llu\r\n", kvstoreSize(server.pubsub_channels),
                 "pubsub_patterns:%lu\r\n", dictSize(server.pubsub_patterns),
                 "pubsubshard_channels:%llu\r\n", kvstoreSize(server.pubsubshard_channels),
@@ -6006,13 +6259,24 @@ sds genValkeyInfoString(dict *section_dict, int all_sections, int everything) {
                 "io_threaded_total_prefetch_entries:%lld\r\n", server.stat_total_prefetch_entries,
                 "client_query_buffer_limit_disconnections:%lld\r\n", server.stat_client_qbuf_limit_disconnections,
                 "client_output_buffer_limit_disconnections:%lld\r\n", server.stat_client_outbuf_limit_disconnections,
+                "client_output_buffer_backpressure_events:%lld\r\n", server.stat_client_outbuf_backpressure,
                 "reply_buffer_shrinks:%lld\r\n", server.stat_reply_buffer_shrinks,
                 "reply_buffer_expands:%lld\r\n", server.stat_reply_buffer_expands,
                 "eventloop_cycles:%llu\r\n", server.duration_stats[EL_DURATION_TYPE_EL].cnt,
                 "eventloop_duration_sum:%llu\r\n", server.duration_stats[EL_DURATION_TYPE_EL].sum,
                 "eventloop_duration_cmd_sum:%llu\r\n", server.duration_stats[EL_DURATION_TYPE_CMD].sum,
                 "instantaneous_eventloop_cycles_per_sec:%llu\r\n", getInstantaneousMetric(STATS_METRIC_EL_CYCLE),
-                "instantaneous_eventloop_duration_usec:%llu\r\n", getInstantaneousMetric(STATS_METRIC_EL_DURATION)));
+                "instantaneous_eventloop_duration_usec:%llu\r\n", getInstantaneousMetric(STATS_METRIC_EL_DURATION),
+                "eventloop_duration_poll_sum:%llu\r\n", server.duration_stats[EL_DURATION_TYPE_POLL].sum,
+                "instantaneous_eventloop_poll_usec:%llu\r\n", el_poll_usec,
+                "instantaneous_eventloop_util_perc:%.2f\r\n", el_util_perc,
+                "eventloop_duration_max_recent:%llu\r\n", (unsigned long long)el_duration_max_recent,
+                "io_threads_queued_jobs:%llu\r\n", (unsigned long long)ioThreadsQueuedJobs(),
+                "io_threads_pending_read_completions:%llu\r\n", (unsigned long long)pendingClientReadCompletions(),
+                "io_threads_pending_write_completions:%llu\r\n", (unsigned long long)pendingClientWriteCompletions(),
+                "clients_pending_write:%lu\r\n", listLength(server.clients_pending_write),
+                "clients_pending_io_read:%lu\r\n", listLength(server.clients_pending_io_read),
+                "clients_pending_io_write:%lu\r\n", listLength(server.clients_pending_io_write)));
         info = genValkeyInfoStringACLStats(info);
     }
 
@@ -6171,6 +6435,15 @@ sds genValkeyInfoString(dict *section_dict, int all_sections, int everything) {
         info = genValkeyInfoStringCommandStats(info, server.commands);
     }
 
+#ifdef USE_PHASE_PROFILING
+    /* Hot-path phase cycle accounting (compile-time opt-in) */
+    if (all_sections || (dictFind(section_dict, "phaseprofile") != NULL)) {
+        if (sections++) info = sdscat(info, "\r\n");
+        info = sdscatprintf(info, "# Phaseprofile\r\n");
+        info = genValkeyInfoStringPhaseProfile(info);
+    }
+#endif
+
     /* Error statistics */
     if (all_sections || (dictFind(section_dict, "errorstats") != NULL)) {
         if (sections++) info = sdscat(info, "\r\n");
@@ -6198,6 +6471,13 @@ sds genValkeyInfoString(dict *section_dict, int all_sections, int everything) {
         }
     }
 
+    /* Resources consumed per ACL user */
+    if (all_sections || (dictFind(section_dict, "userstats") != NULL)) {
+        if (sections++) info = sdscat(info, "\r\n");
+        info = sdscatprintf(info, "# Userstats\r\n");
+        info = genValkeyInfoStringUserStats(info);
+    }
+
     /* Cluster */
     if (all_sections || (dictFind(section_dict, "cluster") != NULL)) {
         if (sections++) info = sdscat(info, "\r\n");
@@ -6704,7 +6984,17 @@ void loadDataFromDisk(void) {
             createReplicationBacklog();
             rdb_flags |= RDBFLAGS_FEED_REPL;
         }
+        if (server.loading_serve_reads) {
+            /* Keys loaded from an RDB file are complete as soon as they are
+             * in the keyspace, so reads of already loaded keys can be served
+             * from the events processed during loading. This does not hold
+             * for an AOF tail (a loaded key may still be rewritten), hence
+             * early reads are only armed on this path. */
+            server.loading_early_reads = 1;
+            serverLog(LL_NOTICE, "Serving reads of already loaded keys while loading the dataset");
+        }
         int rdb_load_ret = rdbLoad(server.rdb_filename, &rsi, rdb_flags);
+        server.loading_early_reads = 0;
         if (rdb_load_ret == RDB_OK) {
             serverLog(LL_NOTICE, "DB loaded from disk: %.3f seconds", (float)(ustime() - start) / 1000000);
 
@@ -6902,11 +7192,21 @@ int iAmPrimary(void) {
             (server.cluster_enabled && clusterNodeIsPrimary(getMyClusterNode())));
 }
 
+/* Log the time spent in a startup stage and restart the stage timer.
+ * The per-stage breakdown shows what delays serving traffic, which is
+ * valuable when many shards are restarted in a rolling fashion. */
+static void logStartupStage(long long *stage_start, const char *stage) {
+    long long now = ustime();
+    serverLog(LL_VERBOSE, "Startup stage '%s' took %.3f milliseconds", stage, (double)(now - *stage_start) / 1000);
+    *stage_start = now;
+}
+
 /* Main is marked as weak so that unit tests can use their own main function. */
 __attribute__((weak)) int main(int argc, char **argv) {
     struct timeval tv;
     int j;
     char config_from_stdin = 0;
+    long long stage_start = ustime();
 
     /* We need to initialize our libraries, and the server configuration. */
 #ifdef INIT_SETPROCTITLE_REPLACEMENT
@@ -6925,6 +7225,7 @@ __attribute__((weak)) int main(int argc, char **argv) {
     srandom(time(NULL) ^ getpid() ^ tv.tv_usec);
     init_genrand64(((long long)tv.tv_sec * 1000000 + tv.tv_usec) ^ getpid());
     crc64_init();
+    crc16_init();
 
     /* Store umask value. Because umask(2) only offers a set-and-get API we have
      * to reset it and restore it back. We do this early to avoid a potential
@@ -7091,6 +7392,7 @@ __attribute__((weak)) int main(int argc, char **argv) {
         sdsfree(options);
     }
     if (server.sentinel_mode) sentinelCheckConfigFile();
+    logStartupStage(&stage_start, "configuration loading");
 
         /* Do system checks */
 #ifdef __linux__
@@ -7143,24 +7445,30 @@ __attribute__((weak)) int main(int argc, char **argv) {
         serverLog(LL_NOTICE, "Configuration loaded");
     }
 
+    stage_start = ustime(); /* Don't account system checks and daemonizing. */
     initServer();
+    logStartupStage(&stage_start, "core server initialization");
     if (background || server.pidfile) createPidFile();
     if (server.set_proc_title) serverSetProcTitle(NULL);
     serverAsciiArt();
     checkTcpBacklogSettings();
     if (server.cluster_enabled) {
         clusterInit();
+        logStartupStage(&stage_start, "cluster initialization");
     }
     if (!server.sentinel_mode) {
         moduleInitModulesSystemLast();
         moduleLoadFromQueue();
+        logStartupStage(&stage_start, "module loading");
     }
     ACLLoadUsersAtStartup();
+    logStartupStage(&stage_start, "ACL user loading");
     initListeners();
     if (server.cluster_enabled) {
         clusterInitLast();
     }
     InitServerLast();
+    logStartupStage(&stage_start, "listeners and threads initialization");
 
     if (!server.sentinel_mode) {
         /* Things not needed when running in Sentinel mode. */
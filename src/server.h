@@ -81,6 +81,7 @@ typedef long long ustime_t; /* microsecond time type. */
 #include "rax.h"        /* Radix tree */
 #include "connection.h" /* Connection abstraction */
 #include "memory_prefetch.h"
+#include "usdt.h"       /* Optional static tracing probe points */
 
 #define dismissMemory zmadvise_dontneed
 
@@ -188,7 +189,8 @@ struct hdr_histogram;
 #define STATS_METRIC_NET_OUTPUT_REPLICATION 4 /* Bytes written to network during replication. */
 #define STATS_METRIC_EL_CYCLE 5               /* Number of eventloop cycled. */
 #define STATS_METRIC_EL_DURATION 6            /* Eventloop duration. */
-#define STATS_METRIC_COUNT 7
+#define STATS_METRIC_EL_POLL_DURATION 7       /* Time spent waiting in the multiplexing API. */
+#define STATS_METRIC_COUNT 8
 
 /* Protocol and I/O related defines */
 #define PROTO_IOBUF_LEN (1024 * 16)         /* Generic I/O buffer size */
@@ -197,6 +199,8 @@ struct hdr_histogram;
 #define PROTO_MBULK_BIG_ARG (1024 * 32)
 #define PROTO_RESIZE_THRESHOLD (1024 * 32)     /* Threshold for determining whether to resize query buffer */
 #define PROTO_REPLY_MIN_BYTES (1024)           /* the lower limit on reply buffer size */
+#define PROTO_REPLY_DORMANT_BYTES (256)        /* reply buffer footprint of deep-idle clients */
+#define PROTO_ZEROCOPY_MIN_WRITE (1024 * 16)   /* Below this, MSG_ZEROCOPY page pinning costs more than the copy */
 #define REDIS_AUTOSYNC_BYTES (1024 * 1024 * 4) /* Sync file every 4MB. */
 
 #define REPLY_BUFFER_DEFAULT_PEAK_RESET_TIME 5000 /* 5 seconds */
@@ -359,6 +363,7 @@ typedef enum blocking_type {
     BLOCKED_MODULE,   /* Blocked by a loadable module. */
     BLOCKED_STREAM,   /* XREAD. */
     BLOCKED_ZSET,     /* BZPOP et al. */
+    BLOCKED_SCAN,     /* KEYS executed incrementally in cursor slices. */
     BLOCKED_POSTPONE, /* Blocked by processCommand, re-try processing later. */
     BLOCKED_SHUTDOWN, /* SHUTDOWN. */
     BLOCKED_NUM,      /* Number of blocked states. */
@@ -385,6 +390,7 @@ typedef enum {
     COMMANDLOG_TYPE_SLOW = 0,
     COMMANDLOG_TYPE_LARGE_REQUEST,
     COMMANDLOG_TYPE_LARGE_REPLY,
+    COMMANDLOG_TYPE_TRACE,
     COMMANDLOG_TYPE_NUM
 } commandlog_type;
 
@@ -681,6 +687,9 @@ typedef enum {
 #define LATENCY_HISTOGRAM_PRECISION 2           /* Maintain a value precision of 2 significant digits across LATENCY_HISTOGRAM_MIN_VALUE and                  \
                                                  * LATENCY_HISTOGRAM_MAX_VALUE range. Value quantization within the range will thus be no larger than 1/100th \
                                                  * (or 1%) of any value. The total size per histogram should sit around 40 KiB Bytes. */
+#define LATENCY_WINDOW_HISTOGRAM_PRECISION 1    /* The rolling window histograms keep only 1 significant digit (5% quantization): two of them are     \
+                                                 * allocated per command on top of the lifetime histogram, and at this precision each one costs a few \
+                                                 * KiB instead of another 40 KiB. */
 
 /* Busy module flags, see busy_module_yield_flags */
 #define BUSY_MODULE_YIELD_NONE (0)
@@ -788,6 +797,9 @@ struct evictionPoolEntry; /* Defined in evict.c */
  * which is actually a linked list of blocks like that, that is: client->reply. */
 typedef struct clientReplyBlock {
     size_t size, used;
+    _Atomic int refcount; /* Pubsub fanout shares one block across many reply
+                           * lists; the last release, which can happen on an IO
+                           * thread draining a reply list, frees the block. */
     char buf[];
 } clientReplyBlock;
 
@@ -871,6 +883,9 @@ typedef struct multiState {
     size_t argv_len_sums; /* mem used by all commands arguments */
     int alloc_count;      /* total number of multiCmd struct memory reserved. */
     list watched_keys;
+    void *acl_user;                    /* User the queued commands were checked against
+                                          (the user typedef comes later in this file). */
+    unsigned long long acl_generation; /* ACL generation when queueing started. */
 } multiState;
 
 /* This structure holds the blocking operation state for a client.
@@ -899,6 +914,11 @@ typedef struct blockingState {
     int numlocal;         /* Indication if WAITAOF is waiting for local fsync. */
     long long reploffset; /* Replication offset to reach. */
 
+    /* BLOCKED_SCAN */
+    unsigned long long scan_cursor; /* Keyspace scan cursor for the next slice. */
+    list *scan_keys;                /* Matching keys (sds) collected so far. */
+    int scan_slot;                  /* Slot to scan, -1 for the whole keyspace. */
+
     /* BLOCKED_MODULE */
     void *module_blocked_handle; /* ValkeyModuleBlockedClient structure.
                                     which is opaque for the Redis core, only
@@ -961,6 +981,15 @@ typedef struct {
                          against. This list will always contain at least
                          one selector for backwards compatibility. */
     robj *acl_string; /* cached string represent of ACLs */
+    /* Cumulative resources consumed by the clients authenticated as this
+     * user, updated inline when command stats are collected and reported by
+     * INFO userstats. The counters follow the user object lifetime, so
+     * ACL DELUSER or a full ACL load discards them. */
+    unsigned long long stat_commands;         /* Commands executed. */
+    unsigned long long stat_exec_usec;        /* Command execution time. */
+    unsigned long long stat_net_input_bytes;  /* Bytes read from the network. */
+    unsigned long long stat_net_output_bytes; /* Bytes queued for the network. */
+    long long stat_alloc_bytes;               /* Allocator usage delta, may be negative. */
 } user;
 
 /* With multiplexing we need to take per-client state.
@@ -1000,6 +1029,47 @@ typedef struct {
     size_t mem_usage_sum;
 } clientMemUsageBucket;
 
+/* Hot-path phase cycle accounting. Compiled in only when the server is built
+ * with -DUSE_PHASE_PROFILING in SERVER_CFLAGS; otherwise the macros below
+ * expand to nothing and the fast path is untouched. Recorded durations are
+ * aggregated into per-phase log2 histograms exported by INFO PHASEPROFILE. */
+#ifdef USE_PHASE_PROFILING
+typedef enum {
+    PHASE_PARSE = 0, /* Protocol parsing, parseCommand(). */
+    PHASE_EXECUTE,   /* Command proc execution, call(). */
+    PHASE_REPLY,     /* Socket writes, writeToClient(). */
+    PHASE_PROPAGATE, /* Replication/AOF feed, propagatePendingCommands(). */
+    PHASE_NUM
+} serverPhase;
+
+#define PHASE_HIST_BUCKETS 32
+
+static inline uint64_t phaseProfileCycles(void) {
+#if defined(__x86_64__) || defined(__i386__)
+    unsigned int lo, hi;
+    __asm__ __volatile__("rdtsc" : "=a"(lo), "=d"(hi));
+    return ((uint64_t)hi << 32) | lo;
+#elif defined(__aarch64__)
+    uint64_t val;
+    __asm__ __volatile__("mrs %0, cntvct_el0" : "=r"(val));
+    return val;
+#else
+    struct timespec ts;
+    clock_gettime(CLOCK_MONOTONIC, &ts);
+    return (uint64_t)ts.tv_sec * 1000000000ULL + ts.tv_nsec;
+#endif
+}
+
+void phaseProfileRecord(int phase, uint64_t cycles);
+sds genValkeyInfoStringPhaseProfile(sds info);
+
+#define PHASE_PROFILE_START(var) uint64_t var = phaseProfileCycles()
+#define PHASE_PROFILE_END(var, phase) phaseProfileRecord((phase), phaseProfileCycles() - (var))
+#else
+#define PHASE_PROFILE_START(var)
+#define PHASE_PROFILE_END(var, phase)
+#endif
+
 #ifdef LOG_REQ_RES
 /* Structure used to log client's requests and their
  * responses (see logreqres.c) */
@@ -1108,7 +1178,10 @@ typedef struct ClientFlags {
                                             * flag, we won't cache the primary in freeClient. */
     uint64_t fake : 1;                     /* This is a fake client without a real connection. */
     uint64_t import_source : 1;            /* This client is importing data to server and can visit expired key. */
-    uint64_t reserved : 4;                 /* Reserved for future use */
+    uint64_t obuf_backpressure : 1;        /* Reading suspended until the output buffer drains below the soft limit. */
+    uint64_t peer_uid_trusted : 1;         /* Unix socket peer with our own (or root) UID: skips only the password
+                                            * check, see authRequired(). */
+    uint64_t reserved : 2;                 /* Reserved for future use */
 } ClientFlags;
 
 typedef struct ClientPubSubData {
@@ -1194,6 +1267,10 @@ typedef struct client {
     struct serverCommand *lastcmd;       /* Last command executed. */
     struct serverCommand *realcmd;       /* The original command that was executed by the client */
     struct serverCommand *io_parsed_cmd; /* The command that was parsed by the IO thread. */
+    struct preParsedCommand *io_pre_parsed; /* Pipelined commands fully parsed by the IO thread
+                                             * (lazily allocated, IO_THREAD_PREPARSE_CMDS entries). */
+    int io_pre_parsed_count;             /* Number of valid entries in io_pre_parsed. */
+    int io_pre_parsed_idx;               /* Next entry to execute on the main thread. */
     time_t last_interaction;             /* Time of the last interaction, used for timeout */
     serverDb *db;                        /* Pointer to currently SELECTed DB. */
     /* Client state structs. */
@@ -1202,6 +1279,7 @@ typedef struct client {
     ClientModuleData *module_data;    /* Required for Module operations. lazily initialized when first needed */
     multiState *mstate;               /* MULTI/EXEC state, lazily initialized when first needed */
     blockingState *bstate;            /* Blocking state, lazily initialized when first needed */
+    struct chunkedDumpState *chunk_state; /* Chunked DUMP/RESTORE transfer in progress, lazily initialized */
     /* Output buffer and reply handling */
     long duration;                       /* Current command duration. Used for measuring latency of blocking/non-blocking cmds */
     char *buf;                           /* Output buffer */
@@ -1210,6 +1288,8 @@ typedef struct client {
     listNode *io_last_reply_block;       /* Last client reply block when sent to IO thread */
     size_t io_last_bufpos;               /* The client's bufpos at the time it was sent to the IO thread */
     unsigned long long reply_bytes;      /* Tot bytes of objects in reply list. */
+    list *zcopy_pinned;                  /* Reply blocks sent with MSG_ZEROCOPY, pinned until the kernel
+                                          * reports their completion. Lazily created. */
     size_t sentlen;                      /* Amount of bytes already sent in the current buffer or object being sent. */
     listNode clients_pending_write_node; /* list node in clients_pending_write or in clients_pending_io_write list */
     int bufpos;
@@ -1239,6 +1319,9 @@ typedef struct client {
     unsigned long long net_output_bytes;          /* Total network output bytes sent to this client. */
     unsigned long long commands_processed;        /* Total count of commands this client executed. */
     unsigned long long net_output_bytes_curr_cmd; /* Total network output bytes sent to this client, by the current command. */
+    unsigned long long exec_usec;                 /* Total execution time of this client's commands. */
+    long long alloc_bytes;                        /* Allocator usage delta attributed to this client's commands,
+                                                   * may be negative (e.g. a client that mostly deletes keys). */
     size_t buf_peak;                              /* Peak used size of buffer in last 5 sec interval. */
     int nwritten;                                 /* Number of bytes of the last write. */
     int nread;                                    /* Number of bytes of the last read. */
@@ -1340,6 +1423,7 @@ typedef struct zskiplist {
     struct zskiplistNode *header, *tail;
     unsigned long length;
     int level;
+    struct zslArena *arena; /* Slab storage for the nodes, see zslCreateNode() in t_zset.c. */
 } zskiplist;
 
 typedef struct zset {
@@ -1482,6 +1566,7 @@ typedef struct serverTLSContextConfig {
     char *ciphers;
     char *ciphersuites;
     int prefer_server_ciphers;
+    int ktls; /* Offload record encryption to the kernel when supported */
     int session_caching;
     int session_cache_size;
     int session_cache_timeout;
@@ -1492,8 +1577,9 @@ typedef struct serverTLSContextConfig {
  *----------------------------------------------------------------------------*/
 
 typedef struct serverUnixContextConfig {
-    char *group;       /* UNIX socket group */
-    unsigned int perm; /* UNIX socket permission (see mode_t) */
+    char *group;        /* UNIX socket group */
+    unsigned int perm;  /* UNIX socket permission (see mode_t) */
+    int trust_peer_uid; /* skip password auth for peers with our own (or root) UID */
 } serverUnixContextConfig;
 
 /*-----------------------------------------------------------------------------
@@ -1505,6 +1591,9 @@ typedef struct serverRdmaContextConfig {
     int port;
     int rx_size;
     int completion_vector;
+    int completion_moderation;
+    int use_srq;
+    int mr_pool_size;
 } serverRdmaContextConfig;
 
 /*-----------------------------------------------------------------------------
@@ -1649,9 +1738,12 @@ struct valkeyServer {
     rax *clients_index;         /* Active clients dictionary by client ID. */
     uint32_t paused_actions;    /* Bitmask of actions that are currently paused */
     list *postponed_clients;    /* List of postponed clients */
+    list *scan_slice_clients;   /* Clients executing KEYS in cursor slices. */
     pause_event client_pause_per_purpose[NUM_PAUSE_PURPOSES];
     char neterr[ANET_ERR_LEN];                /* Error buffer for anet.c */
     dict *migrate_cached_sockets;             /* MIGRATE cached sockets */
+    size_t dump_payload_cache_size;           /* Byte budget for cached DUMP payloads, 0 disables. */
+    size_t changelog_ring_size;               /* Entries in the dirty-key changelog ring, 0 disables. */
     _Atomic uint64_t next_client_id;          /* Next client unique ID. Incremental. */
     int protected_mode;                       /* Don't accept external connections. */
     int io_threads_num;                       /* Number of IO threads to use. */
@@ -1673,6 +1765,9 @@ struct valkeyServer {
     time_t loading_start_time;
     off_t loading_process_events_interval_bytes;
     time_t loading_process_events_interval_ms;
+    int loading_serve_reads;      /* Config: serve reads of already loaded keys during RDB load. */
+    int loading_early_reads;      /* True while the initial RDB load may serve early reads. */
+    int loading_dataset_swap;     /* True while RESTOREDB loads the replacement dataset. */
     /* Fields used only for stats */
     time_t stat_starttime;                         /* Server start time */
     long long stat_numcommands;                    /* Number of processed commands */
@@ -1682,12 +1777,16 @@ struct valkeyServer {
     long long stat_expired_time_cap_reached_count; /* Early expire cycle stops.*/
     long long stat_expire_cycle_time_used;         /* Cumulative microseconds used. */
     long long stat_evictedkeys;                    /* Number of evicted keys (maxmemory) */
+    long long stat_evictedpoolghosts;              /* Stale eviction pool entries skipped */
+    long long stat_deleted_keys;                   /* Number of keys removed from the keyspace */
+    long long stat_delete_burst_purges;            /* Allocator purges triggered by delete bursts */
     long long stat_evictedclients;                 /* Number of evicted clients */
     long long stat_evictedscripts;                 /* Number of evicted lua scripts. */
     long long stat_total_eviction_exceeded_time;   /* Total time over the memory limit, unit us */
     monotime stat_last_eviction_exceeded_time;     /* Timestamp of current eviction start, unit us */
     long long stat_keyspace_hits;                  /* Number of successful lookups of keys */
     long long stat_keyspace_misses;                /* Number of failed lookups of keys */
+    long long stat_coalesced_reads;                /* Number of GETs served from the coalescing cache */
     long long stat_active_defrag_hits;             /* number of allocations moved */
     long long stat_active_defrag_misses;           /* number of allocations scanned but not moved */
     long long stat_active_defrag_key_hits;         /* number of keys with moved allocations */
@@ -1697,6 +1796,8 @@ struct valkeyServer {
     monotime stat_last_active_defrag_time;         /* Timestamp of current active defrag start */
     size_t stat_peak_memory;                       /* Max used memory record */
     long long stat_aof_rewrites;                   /* number of aof file rewrites performed */
+    long long stat_aof_writes;                     /* number of aof write(2) calls */
+    long long stat_aof_fsyncs;                     /* number of aof fsyncs, issued inline or via bio */
     long long stat_aofrw_consecutive_failures;     /* The number of consecutive failures of aofrw */
     long long stat_rdb_saves;                      /* number of rdb saves performed */
     long long stat_fork_time;                      /* Time needed to perform latest fork() */
@@ -1737,6 +1838,7 @@ struct valkeyServer {
     long long stat_total_writes_processed;             /* Total number of write events processed */
     long long stat_client_qbuf_limit_disconnections;   /* Total number of clients reached query buf length limit */
     long long stat_client_outbuf_limit_disconnections; /* Total number of clients reached output buf length limit */
+    long long stat_client_outbuf_backpressure;         /* Times a client was throttled instead of disconnected. */
     long long stat_total_prefetch_entries;             /* Total number of prefetched dict entries */
     long long stat_total_prefetch_batches;             /* Total number of prefetched batches */
     /* The following two are used to track instantaneous metrics, like
@@ -1750,6 +1852,12 @@ struct valkeyServer {
     long long stat_reply_buffer_shrinks; /* Total number of output buffer shrinks */
     long long stat_reply_buffer_expands; /* Total number of output buffer expands */
     monotime el_start;
+    monotime el_sleep_start; /* Set before blocking in the multiplexing API, to measure the poll time. */
+    /* Max single eventloop cycle duration, over the current and the previous
+     * one second window, so INFO can report a recent max instead of only the
+     * lifetime one. */
+    monotime el_duration_recent_max;
+    monotime el_duration_recent_max_prev;
     /* The following two are used to record the max number of commands executed in one eventloop.
      * Note that commands in transactions are also counted. */
     long long el_cmd_cnt_start;
@@ -1764,6 +1872,8 @@ struct valkeyServer {
     int hide_user_data_from_log; /* Hide or redact user data, or data that may contain user data, from the log. */
     int maxidletime;             /* Client timeout in seconds */
     int tcpkeepalive;            /* Set SO_KEEPALIVE if non-zero. */
+    int tcp_tx_zerocopy;         /* Send large replies with MSG_ZEROCOPY when supported. */
+    int busy_poll_usec;          /* Busy-poll the event loop and sockets this long (us) before sleeping. */
     int active_expire_enabled;   /* Can be disabled for testing purposes. */
     int active_expire_effort;    /* From 1 (default) to 10, active effort. */
     int lazy_expire_disabled;    /* If > 0, don't trigger lazy expire */
@@ -1789,12 +1899,15 @@ struct valkeyServer {
     int set_proc_title;                          /* True if change proc title */
     char *proc_title_template;                   /* Process title template format */
     clientBufferLimitsConfig client_obuf_limits[CLIENT_TYPE_OBUF_COUNT];
+    int client_obuf_backpressure; /* Throttle clients at the soft output buffer limit instead of closing them. */
     int extended_redis_compat;                 /* True if extended Redis OSS compatibility is enabled */
     int pause_cron;                            /* Don't run cron tasks (debug) */
     int dict_resizing;                         /* Whether to allow main dict and expired dict to be resized (debug) */
-    int latency_tracking_enabled;              /* 1 if extended latency tracking is enabled, 0 otherwise. */
     double *latency_tracking_info_percentiles; /* Extended latency tracking info output percentile list configuration. */
     int latency_tracking_info_percentiles_len;
+    int latency_tracking_window;               /* Length in seconds of the rolling latency histogram windows,
+                                                * 0 to only keep the cumulative histograms. */
+    int latency_tracking_recent_idx;           /* Which of the two windowed histograms is currently collecting. */
     unsigned int max_new_tls_conns_per_cycle; /* The maximum number of tls connections that will be accepted during each
                                                  invocation of the event loop. */
     unsigned int max_new_conns_per_cycle;     /* The maximum number of tcp connections that will be accepted during each
@@ -1986,18 +2099,46 @@ struct valkeyServer {
     /* Import Mode */
     int import_mode; /* If true, server is in import mode and forbid expiration and eviction. */
     /* Synchronous replication. */
-    list *clients_waiting_acks; /* Clients waiting in WAIT or WAITAOF. */
+    list *clients_waiting_acks;           /* Clients waiting in WAIT or WAITAOF. */
+    unsigned int waitaof_blocked_clients; /* # of clients in WAITAOF waiting for the local fsynced offset. */
     int get_ack_from_replicas;  /* If true we send REPLCONF GETACK. */
+    /* Hot tunables. The configs below are read on (nearly) every command:
+     * the eviction policy on every key lookup, the notification flags on
+     * every write, the listpack limits on every aggregate-type write, and
+     * so on. They are grouped and aligned here so the per-command reads
+     * share a cache line instead of faulting in scattered pieces of this
+     * large struct. Each one is a single word, so CONFIG SET updates it
+     * with one store and concurrent readers never see a torn value. */
+    unsigned long long maxmemory __attribute__((aligned(CACHE_LINE_SIZE))); /* Max number of memory bytes to use */
+    long long proto_max_bulk_len;   /* Protocol bulk length maximum size. */
+    int maxmemory_policy;           /* Policy for key eviction */
+    int notify_keyspace_events;     /* Events to propagate via Pub/Sub. This is an
+                                       xor of NOTIFY_... flags. */
+    int latency_tracking_enabled;   /* 1 if extended latency tracking is enabled, 0 otherwise. */
+    int list_max_listpack_size;
+    /* Lazy free */
+    int lazyfree_lazy_eviction;
+    int lazyfree_lazy_expire;
+    int lazyfree_lazy_server_del;
+    int lazyfree_lazy_user_del;
+    long long delete_burst_purge_threshold; /* Deletions per second that trigger an allocator purge. 0 = off. */
+    /* Zip structure config, see valkey.conf for more information  */
+    size_t hash_max_listpack_entries;
+    size_t hash_max_listpack_value;
+    size_t set_max_intset_entries;
+    size_t set_max_listpack_entries;
+    size_t set_max_listpack_value;
+    size_t zset_max_listpack_entries;
+    size_t zset_max_listpack_value;
     /* Limits */
     unsigned int maxclients;                    /* Max number of simultaneous clients */
-    unsigned long long maxmemory;               /* Max number of memory bytes to use */
     ssize_t maxmemory_clients;                  /* Memory limit for total client buffers */
-    int maxmemory_policy;                       /* Policy for key eviction */
     int maxmemory_samples;                      /* Precision of random sampling */
     int maxmemory_eviction_tenacity;            /* Aggressiveness of eviction processing */
     int lfu_log_factor;                         /* LFU logarithmic counter factor. */
     int lfu_decay_time;                         /* LFU counter decay factor. */
-    long long proto_max_bulk_len;               /* Protocol bulk length maximum size. */
+    size_t reply_stream_threshold;              /* Stream large aggregate replies to the socket
+                                                 * once this many reply bytes accumulate (0: off). */
     int oom_score_adj_values[CONFIG_OOM_COUNT]; /* Linux oom_score_adj configuration */
     int oom_score_adj;                          /* If true, oom_score_adj is managed */
     int disable_thp;                            /* If true, disable THP by syscall */
@@ -2011,25 +2152,26 @@ struct valkeyServer {
     size_t tracking_table_max_keys; /* Max number of keys in tracking table. */
     list *tracking_pending_keys;    /* tracking invalidation keys pending to flush */
     list *pending_push_messages;    /* pending publish or other push messages to flush */
+    list *pending_expired_keys;     /* expired keys met by read lookups, reclaimed in beforeSleep() */
+    int read_reply_coalescing;      /* Coalesce identical GETs within an event loop iteration. */
+    struct {
+        sds key;                 /* Last GET key seen this iteration, or NULL. */
+        int dbid;                /* Database of the cached key. */
+        long long dirty;         /* server.dirty when the key was remembered. */
+        mstime_t expire;         /* Expire time of the cached value, -1 if none. */
+        clientReplyBlock *block; /* Shared encoded reply, NULL until the key is hot. */
+    } read_coalesce;            /* Cache backing read-reply-coalescing, see getCommand(). */
     /* Sort parameters - qsort_r() is only available under BSD so we
      * have to take this state global, in order to pass it to sortCompare() */
     int sort_desc;
     int sort_alpha;
     int sort_bypattern;
     int sort_store;
-    /* Zip structure config, see redis.conf for more information  */
-    size_t hash_max_listpack_entries;
-    size_t hash_max_listpack_value;
-    size_t set_max_intset_entries;
-    size_t set_max_listpack_entries;
-    size_t set_max_listpack_value;
-    size_t zset_max_listpack_entries;
-    size_t zset_max_listpack_value;
+    /* Zip structure config (hottest limits live in the hot tunables block above) */
     size_t hll_sparse_max_bytes;
     size_t stream_node_max_bytes;
     long long stream_node_max_entries;
     /* List parameters */
-    int list_max_listpack_size;
     int list_compress_depth;
     /* time cache */
     time_t unixtime;             /* Unix time sampled every cron cycle. */
@@ -2043,8 +2185,6 @@ struct valkeyServer {
     /* Pubsub */
     kvstore *pubsub_channels;      /* Map channels to list of subscribed clients */
     dict *pubsub_patterns;         /* A dict of pubsub_patterns */
-    int notify_keyspace_events;    /* Events to propagate via Pub/Sub. This is an
-                                      xor of NOTIFY_... flags. */
     kvstore *pubsubshard_channels; /* Map shard channels in every slot to list of subscribed clients */
     unsigned int pubsub_clients;   /* # of clients in Pub/Sub mode */
     unsigned int watching_clients; /* # of clients are watching keys */
@@ -2088,16 +2228,15 @@ struct valkeyServer {
     uint32_t debug_cluster_close_link_on_packet_drop : 1;
     /* Debug config to control the random ping. When set, we will disable the random ping in clusterCron. */
     uint32_t debug_cluster_disable_random_ping : 1;
-    sds cached_cluster_slot_info[CACHE_CONN_TYPE_MAX]; /* Index in array is a bitwise or of CACHE_CONN_TYPE_* */
+    sds cached_cluster_slot_info[CACHE_CONN_TYPE_MAX];   /* Index in array is a bitwise or of CACHE_CONN_TYPE_* */
+    sds cached_cluster_shards_info[CACHE_CONN_TYPE_MAX]; /* Cached CLUSTER SHARDS replies, same indexing. */
     /* Scripting */
     mstime_t busy_reply_threshold;  /* Script / module timeout in milliseconds */
     int pre_command_oom_state;      /* OOM before command (script?) was started */
     int script_disable_deny_script; /* Allow running commands marked "noscript" inside a script. */
-    /* Lazy free */
-    int lazyfree_lazy_eviction;
-    int lazyfree_lazy_expire;
-    int lazyfree_lazy_server_del;
-    int lazyfree_lazy_user_del;
+    /* Incremental full scans */
+    int keys_incremental_scan; /* Execute KEYS in cursor slices from beforeSleep(). */
+    /* Lazy free (the per-key flags live in the hot tunables block above) */
     int lazyfree_lazy_user_flush;
     /* Latency monitor */
     long long latency_monitor_threshold;
@@ -2123,6 +2262,7 @@ struct valkeyServer {
     serverRdmaContextConfig rdma_ctx_config;
     /* cpu affinity */
     char *server_cpulist;      /* cpu affinity list of server main/io thread. */
+    char *io_threads_cpulist;  /* cpu affinity list of io threads, overrides server_cpulist. */
     char *bio_cpulist;         /* cpu affinity list of bio thread. */
     char *aof_rewrite_cpulist; /* cpu affinity list of aof rewrite process. */
     char *bgsave_cpulist;      /* cpu affinity list of bgsave process. */
@@ -2468,6 +2608,9 @@ struct serverCommand {
     sds current_name; /* Same as fullname, becomes a separate string if command is renamed. */
     struct hdr_histogram
         *latency_histogram;        /* Points to the command latency command histogram (unit of time nanosecond). */
+    struct hdr_histogram *latency_histogram_recent[2]; /* Rotating pair of windowed latency histograms: one collects
+                                                        * the current window, the other holds the previous one. See
+                                                        * latencyTrackingRotateWindows(). */
     keySpec legacy_range_key_spec; /* The legacy (first,last,step) key spec is
                                     * still maintained (if applicable) so that
                                     * we can still support the reply format of
@@ -2628,9 +2771,25 @@ void dictVanillaFree(void *val);
 #define READ_FLAGS_DONT_PARSE (1 << 15)
 #define READ_FLAGS_AUTH_REQUIRED (1 << 16)
 
+/* Max number of additional pipelined commands an IO thread parses ahead of
+ * the main thread in a single read event. */
+#define IO_THREAD_PREPARSE_CMDS 16
+
+/* A complete command parsed ahead by an IO thread, waiting for the main
+ * thread to execute it. */
+typedef struct preParsedCommand {
+    robj **argv;
+    int argc;
+    int argv_len;
+    size_t argv_len_sum;
+    unsigned long long net_input_bytes; /* Value for c->net_input_bytes_curr_cmd. */
+} preParsedCommand;
+
 /* Write flags for various write errors and states */
 #define WRITE_FLAGS_WRITE_ERROR (1 << 0)
 #define WRITE_FLAGS_IS_REPLICA (1 << 1)
+#define WRITE_FLAGS_ZEROCOPY (1 << 2) /* Some bytes of this write event went out with MSG_ZEROCOPY \
+                                       * and their reply blocks must stay pinned. */
 
 client *createClient(connection *conn);
 void freeClient(client *c);
@@ -2704,6 +2863,10 @@ void deferredAfterErrorReply(client *c, list *errors);
 size_t getStringObjectSdsUsedMemory(robj *o);
 void freeClientReplyValue(void *o);
 void *dupClientReplyValue(void *o);
+clientReplyBlock *createSharedReplyBlock(const char *s, size_t len);
+void addReplySharedBlock(client *c, clientReplyBlock *o);
+void releaseSharedReplyBlock(clientReplyBlock *o);
+void resetReadCoalescingCache(void);
 char *getClientPeerId(client *client);
 char *getClientSockName(client *client);
 int isClientConnIpV6(client *c);
@@ -2719,6 +2882,7 @@ size_t getClientOutputBufferMemoryUsage(client *c);
 size_t getClientMemoryUsage(client *c, size_t *output_buffer_mem_usage);
 int freeClientsInAsyncFreeQueue(void);
 int closeClientOnOutputBufferLimitReached(client *c, int async);
+int clientsCronResumeObufBackpressure(client *c);
 int getClientType(client *c);
 int getClientTypeByName(char *name);
 char *getClientTypeName(int class);
@@ -2746,6 +2910,8 @@ void removeClientFromMemUsageBucket(client *c, int allow_eviction);
 void unlinkClient(client *c);
 void removeFromServerClientList(client *c);
 int writeToClient(client *c);
+void processZeroCopyCompletions(client *c);
+void flushReplyToClientIfNeeded(client *c);
 void linkClient(client *c);
 void protectClient(client *c);
 void unprotectClient(client *c);
@@ -2886,6 +3052,8 @@ int getLongDoubleFromObject(robj *o, long double *target);
 int getLongDoubleFromObjectOrReply(client *c, robj *o, long double *target, const char *msg);
 int getIntFromObjectOrReply(client *c, robj *o, int *target, const char *msg);
 char *strEncoding(int encoding);
+#define OBJ_COMPUTE_SIZE_DEF_SAMPLES 5 /* Default sample size. */
+size_t objectComputeSize(robj *key, robj *o, size_t sample_size, int dbid);
 int compareStringObjects(const robj *a, const robj *b);
 int collateStringObjects(const robj *a, const robj *b);
 int equalStringObjects(robj *a, robj *b);
@@ -3047,6 +3215,7 @@ int ACLUserCheckChannelPerm(user *u, sds channel, int literal);
 int ACLCheckAllUserCommandPerm(user *u, struct serverCommand *cmd, robj **argv, int argc, int *idxptr);
 int ACLUserCheckCmdWithUnrestrictedKeyAccess(user *u, struct serverCommand *cmd, robj **argv, int argc, int flags);
 int ACLCheckAllPerm(client *c, int *idxptr);
+unsigned long long ACLGetGeneration(void);
 int ACLSetUser(user *u, const char *op, ssize_t oplen);
 sds ACLStringSetUser(user *u, sds username, sds *argv, int argc);
 uint64_t ACLGetCommandCategoryFlagByName(const char *name);
@@ -3063,6 +3232,7 @@ void addACLLogEntry(client *c, int reason, int context, int argpos, sds username
 sds getAclErrorMessage(int acl_res, user *user, struct serverCommand *cmd, sds errored_val, int verbose);
 void ACLUpdateDefaultUserPassword(sds password);
 sds genValkeyInfoStringACLStats(sds info);
+sds genValkeyInfoStringUserStats(sds info);
 void ACLRecomputeCommandBitsFromCommandRulesAllUsers(void);
 
 /* Sorted sets data type */
@@ -3099,6 +3269,7 @@ typedef struct {
 
 zskiplist *zslCreate(void);
 void zslFree(zskiplist *zsl);
+size_t zslAllocSize(zskiplist *zsl);
 zskiplistNode *zslInsert(zskiplist *zsl, double score, sds ele);
 zskiplistNode *zslNthInRange(zskiplist *zsl, zrangespec *range, long n);
 double zzlGetScore(unsigned char *sptr);
@@ -3167,7 +3338,7 @@ void preventCommandPropagation(client *c);
 void preventCommandAOF(client *c);
 void preventCommandReplication(client *c);
 void commandlogPushCurrentCommand(client *c, struct serverCommand *cmd);
-void updateCommandLatencyHistogram(struct hdr_histogram **latency_histogram, int64_t duration_hist);
+void updateCommandLatencyHistogram(struct serverCommand *cmd, int64_t duration_hist);
 int prepareForShutdown(client *c, int flags);
 void replyToClientsBlockedOnShutdown(void);
 int abortShutdown(void);
@@ -3252,6 +3423,7 @@ typedef struct hashTypeEntry hashTypeEntry;
 hashTypeEntry *hashTypeCreateEntry(sds field, sds value);
 sds hashTypeEntryGetField(const hashTypeEntry *entry);
 sds hashTypeEntryGetValue(const hashTypeEntry *entry);
+void hashTypeEntryPrefetchValue(const void *entry);
 size_t hashTypeEntryAllocSize(hashTypeEntry *entry);
 hashTypeEntry *hashTypeEntryDefrag(hashTypeEntry *entry, void *(*defragfn)(void *), sds (*sdsdefragfn)(sds));
 void dismissHashTypeEntry(hashTypeEntry *entry);
@@ -3448,6 +3620,8 @@ size_t lazyfreeGetPendingObjectsCount(void);
 size_t lazyfreeGetFreedObjectsCount(void);
 void lazyfreeResetStats(void);
 void freeObjAsync(robj *key, robj *obj, int dbid);
+void lazyfreeBatchBegin(void);
+void lazyfreeBatchEnd(void);
 void freeReplicationBacklogRefMemAsync(list *blocks, rax *index);
 
 /* API to get key arguments from commands */
@@ -3484,6 +3658,7 @@ int setGetKeys(struct serverCommand *cmd, robj **argv, int argc, getKeysResult *
 int bitfieldGetKeys(struct serverCommand *cmd, robj **argv, int argc, getKeysResult *result);
 
 unsigned short crc16(const char *buf, int len);
+void crc16_init(void);
 
 /* Sentinel */
 void initSentinelConfig(void);
@@ -3538,6 +3713,9 @@ void blockForKeys(client *c, int btype, robj **keys, int numkeys, mstime_t timeo
 void blockClientShutdown(client *c);
 void blockPostponeClient(client *c);
 void blockClientForReplicaAck(client *c, mstime_t timeout, long long offset, long numreplicas, int numlocal);
+void blockClientForIncrementalScan(client *c, int slot);
+void incrementalScanSliceCycle(void);
+void replyToScanBlockedClient(client *c);
 void replicationRequestAckFromReplicas(void);
 void signalDeletedKeyAsReady(serverDb *db, robj *key, int type);
 void updateStatsOnUnblock(client *c, long blocked_us, long reply_us, int failed_or_rejected);
@@ -3555,6 +3733,8 @@ int clientsCronHandleTimeout(client *c, mstime_t now_ms);
 
 /* expire.c -- Handling of expired keys */
 void activeExpireCycle(int type);
+void deferExpiredKeyDeletion(serverDb *db, robj *key);
+void reclaimDeferredExpiredKeys(void);
 void expireReplicaKeys(void);
 void rememberReplicaKeyWithExpire(serverDb *db, robj *key);
 void flushReplicaKeysWithExpireList(void);
@@ -3627,10 +3807,13 @@ void swapdbCommand(client *c);
 void randomkeyCommand(client *c);
 void keysCommand(client *c);
 void scanCommand(client *c);
+void changelogCommand(client *c);
+void changelogResizeRing(void);
 void dbsizeCommand(client *c);
 void lastsaveCommand(client *c);
 void saveCommand(client *c);
 void bgsaveCommand(client *c);
+void restoredbCommand(client *c);
 void bgrewriteaofCommand(client *c);
 void shutdownCommand(client *c);
 void slowlogCommand(client *c);
@@ -3781,6 +3964,7 @@ void askingCommand(client *c);
 void readonlyCommand(client *c);
 void readwriteCommand(client *c);
 int verifyDumpPayload(unsigned char *p, size_t len, uint16_t *rdbver_ptr);
+void freeClientChunkedDumpState(client *c);
 void dumpCommand(client *c);
 void objectCommand(client *c);
 void memoryCommand(client *c);
@@ -3844,6 +4028,12 @@ void pfaddCommand(client *c);
 void pfcountCommand(client *c);
 void pfmergeCommand(client *c);
 void pfdebugCommand(client *c);
+void cmsIncrByCommand(client *c);
+void cmsQueryCommand(client *c);
+void cmsMergeCommand(client *c);
+void cmsInfoCommand(client *c);
+void topkAddCommand(client *c);
+void topkListCommand(client *c);
 void latencyCommand(client *c);
 void moduleCommand(client *c);
 void securityWarningCommand(client *c);
@@ -31,6 +31,10 @@
 #include "connhelpers.h"
 #include "io_threads.h"
 
+#ifdef HAVE_MSG_ZEROCOPY
+#include <linux/errqueue.h>
+#endif
+
 /* The connections module provides a lean abstraction of network connections
  * to avoid direct socket and async event management across the server code base.
  *
@@ -136,9 +140,27 @@ static void connSocketShutdown(connection *conn) {
 }
 
 /* Close the connection and free resources. */
+#ifdef HAVE_MSG_ZEROCOPY
+static void connSocketReapZeroCopy(connection *conn);
+#endif
+
 static void connSocketClose(connection *conn) {
     if (conn->fd != -1) {
         aeDeleteFileEvent(server.el, conn->fd, AE_READABLE | AE_WRITABLE);
+#ifdef HAVE_MSG_ZEROCOPY
+        /* A regular close() flushes the send queue, so the kernel could keep
+         * transmitting straight from zero-copy pinned buffers the caller is
+         * about to free. If any zero-copy send did not complete yet, abort
+         * the connection instead: the RST purges the send queue and drops
+         * the kernel's references to our buffers. */
+        if (conn->flags & CONN_FLAG_TX_ZEROCOPY) {
+            connSocketReapZeroCopy(conn);
+            if (conn->zcopy_completed < conn->zcopy_next_seq) {
+                struct linger lin = {.l_onoff = 1, .l_linger = 0};
+                setsockopt(conn->fd, SOL_SOCKET, SO_LINGER, &lin, sizeof(lin));
+            }
+        }
+#endif
         close(conn->fd);
         conn->fd = -1;
     }
@@ -186,6 +208,63 @@ static int connSocketWritev(connection *conn, const struct iovec *iov, int iovcn
     return ret;
 }
 
+#ifdef HAVE_MSG_ZEROCOPY
+/* Like connSocketWritev() but sends with MSG_ZEROCOPY so the kernel
+ * transmits straight from the caller's buffers. SO_ZEROCOPY is enabled
+ * lazily on the first zero-copy write. We fall back to the copying path
+ * when the socket option is refused or when the kernel runs out of optmem
+ * to account the pinned pages (ENOBUFS); in both cases conn->zcopy_next_seq
+ * does not advance, which tells the caller no pinning happened. */
+static int connSocketWritevZeroCopy(connection *conn, const struct iovec *iov, int iovcnt) {
+    if (!(conn->flags & CONN_FLAG_TX_ZEROCOPY)) {
+        int yes = 1;
+        if (setsockopt(conn->fd, SOL_SOCKET, SO_ZEROCOPY, &yes, sizeof(yes)) == -1)
+            return connSocketWritev(conn, iov, iovcnt);
+        conn->flags |= CONN_FLAG_TX_ZEROCOPY;
+    }
+
+    struct msghdr msg = {0};
+    msg.msg_iov = (struct iovec *)iov;
+    msg.msg_iovlen = iovcnt;
+    int ret = sendmsg(conn->fd, &msg, MSG_ZEROCOPY);
+    if (ret < 0) {
+        if (errno == ENOBUFS) return connSocketWritev(conn, iov, iovcnt);
+        if (errno != EAGAIN) {
+            conn->last_errno = errno;
+            if (errno != EINTR && conn->state == CONN_STATE_CONNECTED) conn->state = CONN_STATE_ERROR;
+        }
+        return ret;
+    }
+    conn->zcopy_next_seq++;
+    return ret;
+}
+
+/* Drain the MSG_ZEROCOPY completion notifications queued on the socket
+ * error queue. Each notification carries a [ee_info, ee_data] range of
+ * send sequence numbers whose buffers the kernel no longer references;
+ * TCP reports them in order so tracking the highest one is enough. */
+static void connSocketReapZeroCopy(connection *conn) {
+    if (!(conn->flags & CONN_FLAG_TX_ZEROCOPY)) return;
+    while (1) {
+        char control[CMSG_SPACE(sizeof(struct sock_extended_err)) + 64];
+        struct msghdr msg = {0};
+        msg.msg_control = control;
+        msg.msg_controllen = sizeof(control);
+        if (recvmsg(conn->fd, &msg, MSG_ERRQUEUE | MSG_DONTWAIT) == -1) return;
+
+        struct cmsghdr *cmsg;
+        for (cmsg = CMSG_FIRSTHDR(&msg); cmsg != NULL; cmsg = CMSG_NXTHDR(&msg, cmsg)) {
+            if (!((cmsg->cmsg_level == SOL_IP && cmsg->cmsg_type == IP_RECVERR) ||
+                  (cmsg->cmsg_level == SOL_IPV6 && cmsg->cmsg_type == IPV6_RECVERR)))
+                continue;
+            struct sock_extended_err *serr = (struct sock_extended_err *)CMSG_DATA(cmsg);
+            if (serr->ee_errno != 0 || serr->ee_origin != SO_EE_ORIGIN_ZEROCOPY) continue;
+            if (serr->ee_data + 1 > conn->zcopy_completed) conn->zcopy_completed = serr->ee_data + 1;
+        }
+    }
+}
+#endif /* HAVE_MSG_ZEROCOPY */
+
 static int connSocketRead(connection *conn, void *buf, size_t buf_len) {
     /* Assert the main thread is not reading from a connection that is currently offloaded. */
     debugServerAssert(!(conn->flags & CONN_FLAG_ALLOW_ACCEPT_OFFLOAD) || !inMainThread() ||
@@ -207,17 +286,51 @@ static int connSocketRead(connection *conn, void *buf, size_t buf_len) {
     return ret;
 }
 
+/* Per-socket option setup for freshly accepted client connections. Pure
+ * setsockopt work, safe to run from an IO thread. */
+static void connSocketApplyAcceptedOptions(connection *conn) {
+    anetEnableTcpNoDelay(NULL, conn->fd);
+    if (server.tcpkeepalive) anetKeepAlive(NULL, conn->fd, server.tcpkeepalive);
+    if (server.busy_poll_usec) anetEnableBusyPoll(NULL, conn->fd, server.busy_poll_usec);
+}
+
 static int connSocketAccept(connection *conn, ConnectionCallbackFunc accept_handler) {
     int ret = C_OK;
 
     if (conn->state != CONN_STATE_ACCEPTING) return C_ERR;
+
+    if (accept_handler) conn->conn_handler = accept_handler;
+
+    /* We're in an IO thread: do the kernel-facing socket setup here, the
+     * main thread will invoke the accept handler when it processes the
+     * completion (see connSocketUpdateState). */
+    if (!inMainThread()) {
+        connSocketApplyAcceptedOptions(conn);
+        return C_OK;
+    }
+
+    /* Try to offload the socket setup to the IO threads. */
+    if (trySendAcceptToIOThreads(conn) == C_OK) return C_OK;
+
+    connSocketApplyAcceptedOptions(conn);
     conn->state = CONN_STATE_CONNECTED;
 
-    if (!callHandler(conn, accept_handler)) ret = C_ERR;
+    if (!callHandler(conn, conn->conn_handler)) ret = C_ERR;
+    conn->conn_handler = NULL;
 
     return ret;
 }
 
+/* Called by the main thread when it processes the completion of an accept
+ * that was offloaded to an IO thread: run the deferred accept handler. */
+static void connSocketUpdateState(connection *conn) {
+    if (conn->state == CONN_STATE_ACCEPTING && conn->conn_handler) {
+        conn->state = CONN_STATE_CONNECTED;
+        if (!callHandler(conn, conn->conn_handler)) return;
+        conn->conn_handler = NULL;
+    }
+}
+
 /* Register a write handler, to be called when the connection is writable.
  * If NULL, the existing handler is removed.
  *
@@ -311,25 +424,33 @@ static void connSocketEventHandler(struct aeEventLoop *el, int fd, void *clientD
 }
 
 static void connSocketAcceptHandler(aeEventLoop *el, int fd, void *privdata, int mask) {
-    int cport, cfd;
     int max = server.max_new_conns_per_cycle;
+    int cfds[max];
+    int cports[max];
+    char cips[max][NET_IP_STR_LEN];
     struct ClientFlags flags = {0};
-    char cip[NET_IP_STR_LEN];
+    int accepted = 0;
     UNUSED(el);
     UNUSED(mask);
     UNUSED(privdata);
 
-    while (max--) {
-        cfd = anetTcpAccept(server.neterr, fd, cip, sizeof(cip), &cport);
+    /* Drain the accept backlog in one tight syscall burst before doing any
+     * per-connection setup. */
+    while (accepted < max) {
+        int cfd = anetTcpAccept(server.neterr, fd, cips[accepted], NET_IP_STR_LEN, &cports[accepted]);
         if (cfd == ANET_ERR) {
             if (errno != EWOULDBLOCK) serverLog(LL_WARNING, "Accepting client connection: %s", server.neterr);
-            return;
+            break;
         }
-        serverLog(LL_VERBOSE, "Accepted %s:%d", cip, cport);
+        cfds[accepted++] = cfd;
+    }
 
-        anetEnableTcpNoDelay(NULL, cfd);
-        if (server.tcpkeepalive) anetKeepAlive(NULL, cfd, server.tcpkeepalive);
-        acceptCommonHandler(connCreateAcceptedSocket(cfd, NULL), flags, cip);
+    /* Hand each socket over; the option setup of each connection is pushed
+     * round-robin to the IO threads when they are active (see
+     * connSocketAccept). */
+    for (int i = 0; i < accepted; i++) {
+        serverLog(LL_VERBOSE, "Accepted %s:%d", cips[i], cports[i]);
+        acceptCommonHandler(connCreateAcceptedSocket(cfds[i], NULL), flags, cips[i]);
     }
 }
 
@@ -437,6 +558,10 @@ static ConnectionType CT_Socket = {
     /* IO */
     .write = connSocketWrite,
     .writev = connSocketWritev,
+#ifdef HAVE_MSG_ZEROCOPY
+    .writev_zerocopy = connSocketWritevZeroCopy,
+    .reap_zerocopy = connSocketReapZeroCopy,
+#endif
     .read = connSocketRead,
     .set_write_handler = connSocketSetWriteHandler,
     .set_read_handler = connSocketSetReadHandler,
@@ -449,7 +574,7 @@ static ConnectionType CT_Socket = {
     .has_pending_data = NULL,
     .process_pending_data = NULL,
     .postpone_update_state = NULL,
-    .update_state = NULL,
+    .update_state = connSocketUpdateState,
 
     /* Miscellaneous */
     .connIntegrityChecked = NULL,
@@ -21,6 +21,11 @@ typedef struct stream {
     streamID max_deleted_entry_id; /* The maximal ID that was deleted. */
     uint64_t entries_added;        /* All time count of elements added. */
     rax *cgroups;                  /* Consumer groups dictionary: name -> streamCG */
+    unsigned char *tail_lp;        /* Cached tail node listpack, or NULL. Lets
+                                    * streamAppendItem() skip the rax seek; any
+                                    * other change to the rax or its listpacks
+                                    * must reset it to NULL. */
+    uint64_t tail_rax_key[2];      /* Rax key of the cached tail node. */
 } stream;
 
 /* We define an iterator to iterate stream items in an abstract way, without
@@ -35,22 +35,41 @@
  *----------------------------------------------------------------------------*/
 
 struct hashTypeEntry {
-    sds value;
+    sds value;                  /* points into field_data when value_embedded */
+    unsigned char value_embedded;
     char field_offset;
-    char field_data[];
+    char field_data[];          /* field sds, followed by the value sds when embedded */
 };
 
+/* Embed the value in the entry allocation when the whole entry still fits a
+ * small allocator size class (they come at 16 byte intervals up to 128
+ * bytes). A field-value pair then costs one allocation instead of two, and
+ * reading the value doesn't leave the entry's cache lines. */
+#define HASH_ENTRY_EMBED_LIMIT 128
+
 /* takes ownership of value, does not take ownership of field */
 hashTypeEntry *hashTypeCreateEntry(sds field, sds value) {
     size_t field_len = sdslen(field);
     char field_sds_type = sdsReqType(field_len);
     size_t field_size = sdsReqSize(field_len, field_sds_type);
+    size_t value_len = sdslen(value);
+    char value_sds_type = sdsReqType(value_len);
+    size_t value_size = sdsReqSize(value_len, value_sds_type);
     size_t total_size = sizeof(hashTypeEntry) + field_size;
+    int embed_value = (total_size + value_size <= HASH_ENTRY_EMBED_LIMIT);
+    if (embed_value) total_size += value_size;
     hashTypeEntry *entry = zmalloc(total_size);
 
-    entry->value = value;
     entry->field_offset = sdsHdrSize(field_sds_type);
     sdswrite(entry->field_data, field_size, field_sds_type, field, field_len);
+    if (embed_value) {
+        entry->value = sdswrite(entry->field_data + field_size, value_size, value_sds_type, value, value_len);
+        entry->value_embedded = 1;
+        sdsfree(value);
+    } else {
+        entry->value = value;
+        entry->value_embedded = 0;
+    }
     return entry;
 }
 
@@ -63,8 +82,33 @@ sds hashTypeEntryGetValue(const hashTypeEntry *entry) {
     return entry->value;
 }
 
+/* Prefetch the value of a hash table entry when it lives in a separate
+ * allocation. Embedded values share the entry's cache lines, which the
+ * iterator prefetches anyway. */
+void hashTypeEntryPrefetchValue(const void *entry) {
+    const hashTypeEntry *hash_entry = entry;
+    if (!hash_entry->value_embedded) valkey_prefetch(hash_entry->value);
+}
+
 /* frees previous value, takes ownership of new value */
 static void hashTypeEntryReplaceValue(hashTypeEntry *entry, sds value) {
+    if (entry->value_embedded) {
+        size_t len = sdslen(value);
+        if (len <= sdsalloc(entry->value)) {
+            /* The new value fits in the embedded slot: keep the
+             * single-allocation layout. */
+            memcpy(entry->value, value, len);
+            sdssetlen(entry->value, len);
+            entry->value[len] = '\0';
+            sdsfree(value);
+        } else {
+            /* Doesn't fit: switch to a separate allocation. The embedded
+             * slot is reclaimed when the entry is freed. */
+            entry->value = value;
+            entry->value_embedded = 0;
+        }
+        return;
+    }
     sdsfree(entry->value);
     entry->value = value;
 }
@@ -73,7 +117,7 @@ static void hashTypeEntryReplaceValue(hashTypeEntry *entry, sds value) {
  * even if not embedded in the same allocation. */
 size_t hashTypeEntryAllocSize(hashTypeEntry *entry) {
     size_t size = zmalloc_usable_size(entry);
-    size += sdsAllocSize(entry->value);
+    if (!entry->value_embedded) size += sdsAllocSize(entry->value);
     return size;
 }
 
@@ -85,11 +129,18 @@ size_t hashTypeEntryAllocSize(hashTypeEntry *entry) {
  * If the location of the hashTypeEntry changed we return the new location,
  * otherwise we return NULL. */
 hashTypeEntry *hashTypeEntryDefrag(hashTypeEntry *entry, void *(*defragfn)(void *), sds (*sdsdefragfn)(sds)) {
+    /* An embedded value moves along with the entry; remember where it sits
+     * inside the old allocation before the entry is possibly relocated. */
+    size_t value_offset = entry->value_embedded ? (size_t)((char *)entry->value - (char *)entry) : 0;
     hashTypeEntry *new_entry = defragfn(entry);
     if (new_entry) entry = new_entry;
 
-    sds new_value = sdsdefragfn(entry->value);
-    if (new_value) entry->value = new_value;
+    if (entry->value_embedded) {
+        entry->value = (sds)((char *)entry + value_offset);
+    } else {
+        sds new_value = sdsdefragfn(entry->value);
+        if (new_value) entry->value = new_value;
+    }
 
     return new_entry;
 }
@@ -97,12 +148,13 @@ hashTypeEntry *hashTypeEntryDefrag(hashTypeEntry *entry, void *(*defragfn)(void
 /* Used for releasing memory to OS to avoid unnecessary CoW. Called when we've
  * forked and memory won't be used again. See zmadvise_dontneed() */
 void dismissHashTypeEntry(hashTypeEntry *entry) {
-    /* Only dismiss values memory since the field size usually is small. */
-    dismissSds(entry->value);
+    /* Only dismiss values memory since the field size usually is small. An
+     * embedded value shares the entry allocation and is not dismissed. */
+    if (!entry->value_embedded) dismissSds(entry->value);
 }
 
 void freeHashTypeEntry(hashTypeEntry *entry) {
-    sdsfree(entry->value);
+    if (!entry->value_embedded) sdsfree(entry->value);
     zfree(entry);
 }
 
@@ -117,12 +169,18 @@ void hashTypeTryConversion(robj *o, robj **argv, int start, int end) {
     int i;
     size_t sum = 0;
 
-    if (o->encoding != OBJ_ENCODING_LISTPACK) return;
+    size_t new_fields = (end - start + 1) / 2;
+    if (o->encoding != OBJ_ENCODING_LISTPACK) {
+        /* Already a real hash: grow it upfront so the insertions of a
+         * multi field HSET don't rehash one bucket at a time. */
+        if (o->encoding == OBJ_ENCODING_HASHTABLE && new_fields > 1)
+            hashtableExpand(o->ptr, hashTypeLength(o) + new_fields);
+        return;
+    }
 
     /* We guess that most of the values in the input are unique, so
      * if there are enough arguments we create a pre-sized hash, which
      * might over allocate memory if there are duplicates. */
-    size_t new_fields = (end - start + 1) / 2;
     if (new_fields > server.hash_max_listpack_entries) {
         hashTypeConvert(o, OBJ_ENCODING_HASHTABLE);
         hashtableExpand(o->ptr, new_fields);
@@ -514,27 +572,32 @@ void hashTypeConvertListpack(robj *o, int enc) {
         /* Nothing to do... */
 
     } else if (enc == OBJ_ENCODING_HASHTABLE) {
-        hashTypeIterator hi;
+        unsigned char *p = lpFirst(o->ptr);
+        listpackEntry entries[128];
 
         hashtable *ht = hashtableCreate(&hashHashtableType);
 
         /* Presize the hashtable to avoid rehashing */
         hashtableExpand(ht, hashTypeLength(o));
 
-        hashTypeInitIterator(o, &hi);
-        while (hashTypeNext(&hi) != C_ERR) {
-            sds field = hashTypeCurrentObjectNewSds(&hi, OBJ_HASH_FIELD);
-            sds value = hashTypeCurrentObjectNewSds(&hi, OBJ_HASH_VALUE);
-            hashTypeEntry *entry = hashTypeCreateEntry(field, value);
-            sdsfree(field);
-            if (!hashtableAdd(ht, entry)) {
-                freeHashTypeEntry(entry);
-                hashTypeResetIterator(&hi); /* Needed for gcc ASAN */
-                serverLogHexDump(LL_WARNING, "listpack with dup elements dump", o->ptr, lpBytes(o->ptr));
-                serverPanic("Listpack corruption detected");
+        /* Decode the listpack in batches of field-value pairs. */
+        while (p) {
+            unsigned int n = lpGetRange(o->ptr, p, entries, 128, &p);
+            serverAssert(n % 2 == 0); /* fail on corrupt data */
+            for (unsigned int i = 0; i < n; i += 2) {
+                sds field = entries[i].sval ? sdsnewlen(entries[i].sval, entries[i].slen)
+                                            : sdsfromlonglong(entries[i].lval);
+                sds value = entries[i + 1].sval ? sdsnewlen(entries[i + 1].sval, entries[i + 1].slen)
+                                                : sdsfromlonglong(entries[i + 1].lval);
+                hashTypeEntry *entry = hashTypeCreateEntry(field, value);
+                sdsfree(field);
+                if (!hashtableAdd(ht, entry)) {
+                    freeHashTypeEntry(entry);
+                    serverLogHexDump(LL_WARNING, "listpack with dup elements dump", o->ptr, lpBytes(o->ptr));
+                    serverPanic("Listpack corruption detected");
+                }
             }
         }
-        hashTypeResetIterator(&hi);
         zfree(o->ptr);
         o->encoding = OBJ_ENCODING_HASHTABLE;
         o->ptr = ht;
@@ -560,7 +623,6 @@ void hashTypeConvert(robj *o, int enc) {
  * The resulting object always has refcount set to 1 */
 robj *hashTypeDup(robj *o) {
     robj *hobj;
-    hashTypeIterator hi;
 
     serverAssert(o->type == OBJ_HASH);
 
@@ -575,17 +637,21 @@ robj *hashTypeDup(robj *o) {
         hashtable *ht = hashtableCreate(&hashHashtableType);
         hashtableExpand(ht, hashtableSize((const hashtable *)o->ptr));
 
-        hashTypeInitIterator(o, &hi);
-        while (hashTypeNext(&hi) != C_ERR) {
-            /* Extract a field-value pair from an original hash object.*/
-            sds field = hashTypeCurrentFromHashTable(&hi, OBJ_HASH_FIELD);
-            sds value = hashTypeCurrentFromHashTable(&hi, OBJ_HASH_VALUE);
-
-            /* Add a field-value pair to a new hash object. */
+        /* Iterate the low level table directly with value prefetching
+         * enabled: the iterator pipelines bucket chains, so duplicating the
+         * current pair overlaps the fetches of the entries a bucket ahead. */
+        hashtableIterator iter;
+        hashtableInitIterator(&iter, o->ptr, HASHTABLE_ITER_PREFETCH_VALUES);
+        void *next;
+        while (hashtableNext(&iter, &next)) {
+            /* Extract a field-value pair from an original hash object and
+             * add the copy to the new hash object. */
+            sds field = hashTypeEntryGetField(next);
+            sds value = hashTypeEntryGetValue(next);
             hashTypeEntry *entry = hashTypeCreateEntry(field, sdsdup(value));
             hashtableAdd(ht, entry);
         }
-        hashTypeResetIterator(&hi);
+        hashtableResetIterator(&iter);
 
         hobj = createObject(OBJ_HASH, ht);
         hobj->encoding = OBJ_ENCODING_HASHTABLE;
@@ -870,6 +936,14 @@ static void addHashIteratorCursorToReply(writePreparedClient *wpc, hashTypeItera
     }
 }
 
+/* Reply with a single entry decoded by lpGetRange(). */
+static void addListpackEntryToReply(writePreparedClient *wpc, const listpackEntry *e) {
+    if (e->sval)
+        addWritePreparedReplyBulkCBuffer(wpc, e->sval, e->slen);
+    else
+        addWritePreparedReplyBulkLongLong(wpc, e->lval);
+}
+
 void genericHgetallCommand(client *c, int flags) {
     robj *o;
     hashTypeIterator hi;
@@ -889,6 +963,33 @@ void genericHgetallCommand(client *c, int flags) {
         addWritePreparedReplyArrayLen(wpc, length);
     }
 
+    if (o->encoding == OBJ_ENCODING_LISTPACK) {
+        /* Walk the listpack in batches of field-value pairs instead of
+         * decoding each entry twice through the generic iterator. */
+        unsigned char *p = lpFirst(o->ptr);
+        listpackEntry entries[128];
+
+        while (p) {
+            unsigned int n = lpGetRange(o->ptr, p, entries, 128, &p);
+            serverAssert(n % 2 == 0); /* fail on corrupt data */
+            for (unsigned int i = 0; i < n; i += 2) {
+                if (flags & OBJ_HASH_FIELD) {
+                    addListpackEntryToReply(wpc, &entries[i]);
+                    count++;
+                }
+                if (flags & OBJ_HASH_VALUE) {
+                    addListpackEntryToReply(wpc, &entries[i + 1]);
+                    count++;
+                }
+            }
+        }
+
+        /* Make sure we returned the right number of elements. */
+        if (flags & OBJ_HASH_FIELD && flags & OBJ_HASH_VALUE) count /= 2;
+        serverAssert(count == length);
+        return;
+    }
+
     hashTypeInitIterator(o, &hi);
     while (hashTypeNext(&hi) != C_ERR) {
         if (flags & OBJ_HASH_FIELD) {
@@ -899,6 +1000,9 @@ void genericHgetallCommand(client *c, int flags) {
             addHashIteratorCursorToReply(wpc, &hi, OBJ_HASH_VALUE);
             count++;
         }
+        /* Hashes of this encoding can be arbitrarily large: stream what
+         * accumulated so far instead of buffering the whole reply. */
+        flushReplyToClientIfNeeded(c);
     }
 
     hashTypeResetIterator(&hi);
@@ -1071,58 +1175,48 @@ void hrandfieldWithCountCommand(client *c, long l, int withvalues) {
     /* CASE 3:
      * The number of elements inside the hash is not greater than
      * HRANDFIELD_SUB_STRATEGY_MUL times the number of requested elements.
-     * In this case we create a hash from scratch with all the elements, and
-     * subtract random elements to reach the requested number of elements.
+     * In this case we run a single pass of reservoir sampling (algorithm R)
+     * over the hash: the first 'count' fields fill the reservoir, every
+     * following field replaces a random slot with decreasing probability.
+     * One traversal, O(count) memory, no matter how big the hash is.
      *
      * This is done because if the number of requested elements is just
      * a bit less than the number of elements in the hash, the natural approach
      * used into CASE 4 is highly inefficient. */
     if (count * HRANDFIELD_SUB_STRATEGY_MUL > size) {
-        /* Hashtable encoding (generic implementation) */
-        dict *d = dictCreate(&sdsReplyDictType);
-        dictExpand(d, size);
+        sds *fields = zmalloc(sizeof(sds) * count);
+        sds *values = withvalues ? zmalloc(sizeof(sds) * count) : NULL;
+        unsigned long seen = 0;
         hashTypeIterator hi;
         hashTypeInitIterator(hash, &hi);
 
-        /* Add all the elements into the temporary dictionary. */
-        while ((hashTypeNext(&hi)) != C_ERR) {
-            int ret = DICT_ERR;
-            sds field, value = NULL;
-
-            field = hashTypeCurrentObjectNewSds(&hi, OBJ_HASH_FIELD);
-            if (withvalues) value = hashTypeCurrentObjectNewSds(&hi, OBJ_HASH_VALUE);
-            ret = dictAdd(d, field, value);
-
-            serverAssert(ret == DICT_OK);
+        while (hashTypeNext(&hi) != C_ERR) {
+            unsigned long slot = seen;
+            if (seen >= count) {
+                slot = randomULong() % (seen + 1);
+                if (slot >= count) {
+                    seen++;
+                    continue;
+                }
+                sdsfree(fields[slot]);
+                if (withvalues) sdsfree(values[slot]);
+            }
+            fields[slot] = hashTypeCurrentObjectNewSds(&hi, OBJ_HASH_FIELD);
+            if (withvalues) values[slot] = hashTypeCurrentObjectNewSds(&hi, OBJ_HASH_VALUE);
+            seen++;
         }
-        serverAssert(dictSize(d) == size);
         hashTypeResetIterator(&hi);
+        serverAssert(seen == size);
 
-        /* Remove random elements to reach the right count. */
-        while (size > count) {
-            dictEntry *de;
-            de = dictGetFairRandomKey(d);
-            dictUnlink(d, dictGetKey(de));
-            sdsfree(dictGetKey(de));
-            sdsfree(dictGetVal(de));
-            dictFreeUnlinkedEntry(d, de);
-            size--;
-        }
-
-        /* Reply with what's in the dict and release memory */
-        dictIterator *di;
-        dictEntry *de;
-        di = dictGetIterator(d);
-        while ((de = dictNext(di)) != NULL) {
-            sds field = dictGetKey(de);
-            sds value = dictGetVal(de);
+        /* Reply with the reservoir; the reply takes ownership of the sds
+         * strings, we only release the arrays. */
+        for (unsigned long i = 0; i < count; i++) {
             if (withvalues && c->resp > 2) addWritePreparedReplyArrayLen(wpc, 2);
-            addWritePreparedReplyBulkSds(wpc, field);
-            if (withvalues) addWritePreparedReplyBulkSds(wpc, value);
+            addWritePreparedReplyBulkSds(wpc, fields[i]);
+            if (withvalues) addWritePreparedReplyBulkSds(wpc, values[i]);
         }
-
-        dictReleaseIterator(di);
-        dictRelease(d);
+        zfree(fields);
+        zfree(values);
     }
 
     /* CASE 4: We have a big hash compared to the requested number of elements.
@@ -665,6 +665,8 @@ void addListQuicklistRangeReply(client *c, robj *o, int from, int rangelen, int
         } else {
             addWritePreparedReplyBulkLongLong(wpc, qe.longval);
         }
+        /* Quicklists can hold huge ranges: stream the reply as it grows. */
+        flushReplyToClientIfNeeded(c);
     }
     quicklistReleaseIterator(iter);
 }
@@ -678,19 +680,37 @@ void addListListpackRangeReply(client *c, robj *o, int from, int rangelen, int r
     /* Return the result in form of a multi-bulk reply */
     addWritePreparedReplyArrayLen(wpc, rangelen);
     unsigned char *p = lpSeek(o->ptr, from);
-    unsigned char *vstr;
-    unsigned int vlen;
-    long long lval;
 
-    while (rangelen--) {
-        serverAssert(p); /* fail on corrupt data */
-        vstr = lpGetValue(p, &vlen, &lval);
-        if (vstr) {
-            addWritePreparedReplyBulkCBuffer(wpc, vstr, vlen);
-        } else {
-            addWritePreparedReplyBulkLongLong(wpc, lval);
+    if (!reverse) {
+        listpackEntry entries[128];
+        while (rangelen > 0) {
+            unsigned int n = (rangelen < 128) ? rangelen : 128;
+            serverAssert(p); /* fail on corrupt data */
+            serverAssert(lpGetRange(o->ptr, p, entries, n, &p) == n);
+            for (unsigned int i = 0; i < n; i++) {
+                if (entries[i].sval) {
+                    addWritePreparedReplyBulkCBuffer(wpc, entries[i].sval, entries[i].slen);
+                } else {
+                    addWritePreparedReplyBulkLongLong(wpc, entries[i].lval);
+                }
+            }
+            rangelen -= n;
+        }
+    } else {
+        unsigned char *vstr;
+        unsigned int vlen;
+        long long lval;
+
+        while (rangelen--) {
+            serverAssert(p); /* fail on corrupt data */
+            vstr = lpGetValue(p, &vlen, &lval);
+            if (vstr) {
+                addWritePreparedReplyBulkCBuffer(wpc, vstr, vlen);
+            } else {
+                addWritePreparedReplyBulkLongLong(wpc, lval);
+            }
+            p = lpPrev(o->ptr, p);
         }
-        p = reverse ? lpPrev(o->ptr, p) : lpNext(o->ptr, p);
     }
 }
 
@@ -810,6 +830,12 @@ void mpopGenericCommand(client *c, robj **keys, int numkeys, int where, long cou
     robj *key;
 
     for (j = 0; j < numkeys; j++) {
+        /* Most probed keys are typically missing; overlap the lookups'
+         * cache misses a window at a time instead of paying them one by
+         * one. */
+        if (numkeys >= PREFETCH_INLINE_MIN_KEYS && j % PREFETCH_INLINE_WINDOW == 0)
+            prefetchKeysInline(c->db, keys + j, numkeys - j);
+
         key = keys[j];
         o = lookupKeyWrite(c->db, key);
 
@@ -61,6 +61,10 @@ void setTypeMaybeConvert(robj *set, size_t size_hint) {
     if ((set->encoding == OBJ_ENCODING_LISTPACK && size_hint > server.set_max_listpack_entries) ||
         (set->encoding == OBJ_ENCODING_INTSET && size_hint > server.set_max_intset_entries)) {
         setTypeConvertAndExpand(set, OBJ_ENCODING_HASHTABLE, size_hint, 1);
+    } else if (set->encoding == OBJ_ENCODING_HASHTABLE && size_hint > 1) {
+        /* Make room for the elements about to be added, to avoid rehash
+         * checks on every insertion of a multi element SADD. */
+        hashtableExpand(set->ptr, setTypeSize(set) + size_hint);
     }
 }
 
@@ -1052,6 +1056,29 @@ void srandmemberWithCountCommand(client *c) {
             return;
         }
 
+        if (set->encoding == OBJ_ENCODING_HASHTABLE && count > 1) {
+            /* Specialized case for the hashtable encoding: draw a whole batch
+             * of entries per sampling burst instead of paying a full burst
+             * for every single element. Each reply element is then picked
+             * with replacement from the fair batch. */
+            unsigned long limit, sample_count;
+            limit = count > SRANDFIELD_RANDOM_SAMPLE_LIMIT ? SRANDFIELD_RANDOM_SAMPLE_LIMIT : count;
+            void **entries = zmalloc(limit * sizeof(void *));
+            while (count) {
+                sample_count = count > limit ? limit : count;
+                count -= sample_count;
+                unsigned drawn = hashtableFairRandomEntries(set->ptr, entries, sample_count);
+                serverAssert(drawn != 0);
+                for (unsigned long i = 0; i < sample_count; i++) {
+                    sds ele = entries[random() % drawn];
+                    addReplyBulkCBuffer(c, ele, sdslen(ele));
+                }
+                if (c->flag.close_asap) break;
+            }
+            zfree(entries);
+            return;
+        }
+
         while (count--) {
             setTypeRandomElement(set, &str, &len, &llele);
             if (str == NULL) {
@@ -1140,14 +1167,23 @@ void srandmemberWithCountCommand(client *c) {
         setTypeReleaseIterator(si);
         serverAssert(hashtableSize(ht) == size);
 
-        /* Remove random elements to reach the right count. */
+        /* Remove random elements to reach the right count. Sampling a batch
+         * per burst keeps this O(size - count) instead of paying a sampling
+         * burst per removed element. */
+        unsigned long limit = size - count > SRANDFIELD_RANDOM_SAMPLE_LIMIT ? SRANDFIELD_RANDOM_SAMPLE_LIMIT
+                                                                            : size - count;
+        void **entries = zmalloc(limit * sizeof(void *));
         while (size > count) {
-            void *element;
-            hashtableFairRandomEntry(ht, &element);
-            hashtableDelete(ht, element);
-            sdsfree((sds)element);
-            size--;
+            unsigned long batch = size - count > limit ? limit : size - count;
+            unsigned drawn = hashtableFairRandomEntries(ht, entries, batch);
+            serverAssert(drawn != 0);
+            for (unsigned i = 0; i < drawn; i++) {
+                hashtableDelete(ht, entries[i]);
+                sdsfree((sds)entries[i]);
+                size--;
+            }
         }
+        zfree(entries);
     }
 
     /* CASE 4: We have a big set compared to the requested number of elements.
@@ -1159,20 +1195,41 @@ void srandmemberWithCountCommand(client *c) {
         sds sdsele;
 
         hashtableExpand(ht, count);
-        while (added < count) {
-            setTypeRandomElement(set, &str, &len, &llele);
-            if (str == NULL) {
-                sdsele = sdsfromlonglong(llele);
-            } else {
-                sdsele = sdsnewlen(str, len);
+        if (set->encoding == OBJ_ENCODING_HASHTABLE) {
+            /* Draw batches of unique entries per sampling burst. Batches from
+             * different bursts may overlap, in which case hashtableAdd()
+             * rejects the duplicates and we just draw again. */
+            unsigned long limit = count > SRANDFIELD_RANDOM_SAMPLE_LIMIT ? SRANDFIELD_RANDOM_SAMPLE_LIMIT : count;
+            void **entries = zmalloc(limit * sizeof(void *));
+            while (added < count) {
+                unsigned long batch = count - added > limit ? limit : count - added;
+                unsigned drawn = hashtableFairRandomEntries(set->ptr, entries, batch);
+                serverAssert(drawn != 0);
+                for (unsigned i = 0; i < drawn && added < count; i++) {
+                    sdsele = sdsdup((sds)entries[i]);
+                    if (hashtableAdd(ht, sdsele))
+                        added++;
+                    else
+                        sdsfree(sdsele);
+                }
+            }
+            zfree(entries);
+        } else {
+            while (added < count) {
+                setTypeRandomElement(set, &str, &len, &llele);
+                if (str == NULL) {
+                    sdsele = sdsfromlonglong(llele);
+                } else {
+                    sdsele = sdsnewlen(str, len);
+                }
+                /* Try to add the object to the dictionary. If it already
+                 * exists free it, otherwise increment the number of objects
+                 * we have in the result dictionary. */
+                if (hashtableAdd(ht, sdsele))
+                    added++;
+                else
+                    sdsfree(sdsele);
             }
-            /* Try to add the object to the dictionary. If it already exists
-             * free it, otherwise increment the number of objects we have
-             * in the result dictionary. */
-            if (hashtableAdd(ht, sdsele))
-                added++;
-            else
-                sdsfree(sdsele);
         }
     }
 
@@ -1296,6 +1353,16 @@ void sinterGenericCommand(client *c,
      * algorithm's performance */
     qsort(sets, setnum, sizeof(robj *), qsortCompareSetsByCardinality);
 
+    /* Probe order over sets[1..setnum-1]. We start in cardinality order and
+     * adaptively move the set that most recently rejected an element to the
+     * front of the order: rejections tend to come from the same set for runs
+     * of elements, so the last rejecting set is the best first probe for the
+     * next element. This keeps the per-element work close to one membership
+     * test when one of the sets is much more selective than its size
+     * suggests. */
+    unsigned long *probe = zmalloc(sizeof(unsigned long) * setnum);
+    for (j = 0; j < setnum; j++) probe[j] = j;
+
     /* The first thing we should output is the total number of elements...
      * since this is a multi-bulk write, but at this stage we don't know
      * the intersection set size, so we use a trick, append an empty object
@@ -1330,44 +1397,89 @@ void sinterGenericCommand(client *c,
      * the element against all the other sets, if at least one set does
      * not include the element it is discarded */
     int only_integers = 1;
-    si = setTypeInitIterator(sets[0]);
-    while ((encoding = setTypeNext(si, &str, &len, &intobj)) != -1) {
-        for (j = 1; j < setnum; j++) {
-            if (sets[j] == sets[0]) continue;
-            if (!setTypeIsMemberAux(sets[j], str, len, intobj, encoding == OBJ_ENCODING_HASHTABLE)) break;
+    if (sets[0]->encoding == OBJ_ENCODING_INTSET) {
+        /* Fast path: bulk-export the smallest set in blocks instead of
+         * decoding one element per iterator step. Every element is an
+         * integer, so the string handling of the generic loop is not
+         * needed, and when there is a dstkey it is an intset as well. */
+        int64_t values[64];
+        uint32_t n, ipos = 0;
+        int done = 0;
+
+        while (!done && (n = intsetGetMany(sets[0]->ptr, ipos, 64, values)) > 0) {
+            ipos += n;
+            for (uint32_t i = 0; i < n && !done; i++) {
+                for (j = 1; j < setnum; j++) {
+                    unsigned long p = probe[j];
+                    if (sets[p] == sets[0]) continue;
+                    if (!setTypeIsMemberAux(sets[p], NULL, 0, values[i], 0)) {
+                        memmove(probe + 2, probe + 1, (j - 1) * sizeof(unsigned long));
+                        probe[1] = p;
+                        break;
+                    }
+                }
+
+                /* Only take action when all sets contain the member */
+                if (j != setnum) continue;
+                if (cardinality_only) {
+                    cardinality++;
+
+                    /* We stop the searching after reaching the limit. */
+                    if (limit && cardinality >= limit) done = 1;
+                } else if (!dstkey) {
+                    addReplyBulkLongLong(c, values[i]);
+                    cardinality++;
+                } else {
+                    setTypeAddAux(dstset, NULL, 0, values[i], 0);
+                }
+            }
         }
 
-        /* Only take action when all sets contain the member */
-        if (j == setnum) {
-            if (cardinality_only) {
-                cardinality++;
+    } else {
+        si = setTypeInitIterator(sets[0]);
+        while ((encoding = setTypeNext(si, &str, &len, &intobj)) != -1) {
+            for (j = 1; j < setnum; j++) {
+                unsigned long p = probe[j];
+                if (sets[p] == sets[0]) continue;
+                if (!setTypeIsMemberAux(sets[p], str, len, intobj, encoding == OBJ_ENCODING_HASHTABLE)) {
+                    memmove(probe + 2, probe + 1, (j - 1) * sizeof(unsigned long));
+                    probe[1] = p;
+                    break;
+                }
+            }
 
-                /* We stop the searching after reaching the limit. */
-                if (limit && cardinality >= limit) break;
-            } else if (!dstkey) {
-                if (str != NULL)
-                    addReplyBulkCBuffer(c, str, len);
-                else
-                    addReplyBulkLongLong(c, intobj);
-                cardinality++;
-            } else {
-                if (str && only_integers) {
-                    /* It may be an integer although we got it as a string. */
-                    if (encoding == OBJ_ENCODING_HASHTABLE && string2ll(str, len, (long long *)&intobj)) {
-                        if (dstset->encoding == OBJ_ENCODING_LISTPACK || dstset->encoding == OBJ_ENCODING_INTSET) {
-                            /* Adding it as an integer is more efficient. */
-                            str = NULL;
+            /* Only take action when all sets contain the member */
+            if (j == setnum) {
+                if (cardinality_only) {
+                    cardinality++;
+
+                    /* We stop the searching after reaching the limit. */
+                    if (limit && cardinality >= limit) break;
+                } else if (!dstkey) {
+                    if (str != NULL)
+                        addReplyBulkCBuffer(c, str, len);
+                    else
+                        addReplyBulkLongLong(c, intobj);
+                    cardinality++;
+                } else {
+                    if (str && only_integers) {
+                        /* It may be an integer although we got it as a string. */
+                        if (encoding == OBJ_ENCODING_HASHTABLE && string2ll(str, len, (long long *)&intobj)) {
+                            if (dstset->encoding == OBJ_ENCODING_LISTPACK || dstset->encoding == OBJ_ENCODING_INTSET) {
+                                /* Adding it as an integer is more efficient. */
+                                str = NULL;
+                            }
+                        } else {
+                            /* It's not an integer */
+                            only_integers = 0;
                         }
-                    } else {
-                        /* It's not an integer */
-                        only_integers = 0;
                     }
+                    setTypeAddAux(dstset, str, len, intobj, encoding == OBJ_ENCODING_HASHTABLE);
                 }
-                setTypeAddAux(dstset, str, len, intobj, encoding == OBJ_ENCODING_HASHTABLE);
             }
         }
+        setTypeReleaseIterator(si);
     }
-    setTypeReleaseIterator(si);
 
     if (cardinality_only) {
         addReplyLongLong(c, cardinality);
@@ -1397,6 +1509,7 @@ void sinterGenericCommand(client *c,
     } else {
         setDeferredSetLen(c, replylen, cardinality);
     }
+    zfree(probe);
     zfree(sets);
 }
 
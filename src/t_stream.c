@@ -82,6 +82,7 @@ stream *streamNew(void) {
     s->max_deleted_entry_id.ms = 0;
     s->entries_added = 0;
     s->cgroups = NULL; /* Created on demand to save memory when not used. */
+    s->tail_lp = NULL;
     return s;
 }
 
@@ -471,19 +472,9 @@ int streamAppendItem(stream *s, robj **argv, int64_t numfields, streamID *added_
     }
 
     /* Add the new entry. */
-    raxIterator ri;
-    raxStart(&ri, s->rax);
-    raxSeek(&ri, "$", NULL, 0);
-
-    size_t lp_bytes = 0;      /* Total bytes in the tail listpack. */
-    unsigned char *lp = NULL; /* Tail listpack pointer. */
-
-    if (!raxEOF(&ri)) {
-        /* Get a reference to the tail node listpack. */
-        lp = ri.data;
-        lp_bytes = lpBytes(lp);
-    }
-    raxStop(&ri);
+    size_t lp_bytes = 0;             /* Total bytes in the tail listpack. */
+    unsigned char *lp = NULL;        /* Tail listpack pointer. */
+    unsigned char *lp_in_rax = NULL; /* Tail pointer currently stored in the rax. */
 
     /* We have to add the key into the radix tree in lexicographic order,
      * to do so we consider the ID as a single 128 bit number written in
@@ -491,6 +482,27 @@ int streamAppendItem(stream *s, robj **argv, int64_t numfields, streamID *added_
     uint64_t rax_key[2]; /* Key in the radix tree containing the listpack.*/
     streamID primary_id; /* ID of the primary entry in the listpack. */
 
+    if (s->tail_lp != NULL) {
+        /* The tail node was cached by a previous append, no need to seek it
+         * in the radix tree. */
+        lp = s->tail_lp;
+        lp_bytes = lpBytes(lp);
+        memcpy(rax_key, s->tail_rax_key, sizeof(rax_key));
+    } else {
+        raxIterator ri;
+        raxStart(&ri, s->rax);
+        raxSeek(&ri, "$", NULL, 0);
+        if (!raxEOF(&ri)) {
+            /* Get a reference to the tail node listpack. */
+            lp = ri.data;
+            lp_bytes = lpBytes(lp);
+            serverAssert(ri.key_len == sizeof(rax_key));
+            memcpy(rax_key, ri.key, sizeof(rax_key));
+        }
+        raxStop(&ri);
+    }
+    lp_in_rax = lp;
+
     /* Create a new listpack and radix tree node if needed. Note that when
      * a new listpack is created, we populate it with a "primary entry". This
      * is just a set of fields that is taken as references in order to compress
@@ -542,7 +554,7 @@ int streamAppendItem(stream *s, robj **argv, int64_t numfields, streamID *added_
         if (new_node) {
             /* Shrink extra pre-allocated memory */
             lp = lpShrinkToFit(lp);
-            if (ri.data != lp) raxInsert(s->rax, ri.key, ri.key_len, lp, NULL);
+            if (lp_in_rax != lp) raxInsert(s->rax, (unsigned char *)rax_key, sizeof(rax_key), lp, NULL);
             lp = NULL;
         }
     }
@@ -571,13 +583,11 @@ int streamAppendItem(stream *s, robj **argv, int64_t numfields, streamID *added_
         }
         lp = lpAppendInteger(lp, 0); /* primary entry zero terminator. */
         raxInsert(s->rax, (unsigned char *)&rax_key, sizeof(rax_key), lp, NULL);
+        lp_in_rax = lp;
         /* The first entry we insert, has obviously the same fields of the
          * primary entry. */
         flags |= STREAM_ITEM_FLAG_SAMEFIELDS;
     } else {
-        serverAssert(ri.key_len == sizeof(rax_key));
-        memcpy(rax_key, ri.key, sizeof(rax_key));
-
         /* Read the primary ID from the radix tree key. */
         streamDecodeID(rax_key, &primary_id);
         unsigned char *lp_ele = lpFirst(lp);
@@ -651,7 +661,10 @@ int streamAppendItem(stream *s, robj **argv, int64_t numfields, streamID *added_
     lp = lpAppendInteger(lp, lp_count);
 
     /* Insert back into the tree in order to update the listpack pointer. */
-    if (ri.data != lp) raxInsert(s->rax, (unsigned char *)&rax_key, sizeof(rax_key), lp, NULL);
+    if (lp_in_rax != lp) raxInsert(s->rax, (unsigned char *)&rax_key, sizeof(rax_key), lp, NULL);
+    /* Cache the tail node so the next append starts right at it. */
+    s->tail_lp = lp;
+    memcpy(s->tail_rax_key, rax_key, sizeof(rax_key));
     s->length++;
     s->entries_added++;
     s->last_id = id;
@@ -716,6 +729,9 @@ int64_t streamTrim(stream *s, streamAddTrimArgs *args) {
 
     if (trim_strategy == TRIM_STRATEGY_NONE) return 0;
 
+    /* Trimming may remove or reallocate any node, including the tail. */
+    s->tail_lp = NULL;
+
     raxIterator ri;
     raxStart(&ri, s->rax);
     raxSeek(&ri, "^", NULL, 0);
@@ -1280,6 +1296,9 @@ void streamIteratorRemoveEntry(streamIterator *si, streamID *current) {
         if (si->lp != lp) raxInsert(si->stream->rax, si->ri.key, si->ri.key_len, lp, NULL);
     }
 
+    /* The removed or reallocated node may have been the cached tail. */
+    si->stream->tail_lp = NULL;
+
     /* Update the number of entries counter. */
     si->stream->length--;
 
@@ -1728,7 +1747,8 @@ size_t streamReplyWithRange(client *c,
              * will not require extra lookups. We'll fix the problem later
              * if we find that there is already a entry for this ID. */
             streamNACK *nack = streamCreateNACK(consumer);
-            int group_inserted = raxTryInsert(group->pel, buf, sizeof(buf), nack, NULL);
+            void *existing_nack = NULL;
+            int group_inserted = raxTryInsert(group->pel, buf, sizeof(buf), nack, &existing_nack);
             int consumer_inserted = raxTryInsert(consumer->pel, buf, sizeof(buf), nack, NULL);
 
             /* Now we can check if the entry was already busy, and
@@ -1736,10 +1756,8 @@ size_t streamReplyWithRange(client *c,
              * or update it if the consumer is the same as before. */
             if (group_inserted == 0) {
                 streamFreeNACK(nack);
-                void *result;
-                int found = raxFind(group->pel, buf, sizeof(buf), &result);
-                serverAssert(found);
-                nack = result;
+                serverAssert(existing_nack != NULL);
+                nack = existing_nack;
                 raxRemove(nack->consumer->pel, buf, sizeof(buf), NULL);
                 /* Update the consumer and NACK metadata. */
                 nack->consumer = consumer;
@@ -1785,44 +1803,56 @@ size_t streamReplyWithRange(client *c,
  * seek into the radix tree of the messages in order to emit the full message
  * to the client. However clients only reach this code path when they are
  * fetching the history of already retrieved messages, which is rare. */
+/* Context and callback for the raxSeekAndWalk() call below. */
+typedef struct streamPELWalkContext {
+    client *c;
+    stream *s;
+    unsigned char *endkey; /* Encoded end ID, or NULL for no end condition. */
+    size_t arraylen;
+} streamPELWalkContext;
+
+static int streamReplyPELEntryCallback(unsigned char *key, size_t key_len, void *data, void *ctx) {
+    streamPELWalkContext *wc = ctx;
+    if (wc->endkey && memcmp(key, wc->endkey, key_len) > 0) return 0;
+    streamID thisid;
+    streamDecodeID(key, &thisid);
+    if (streamReplyWithRange(wc->c, wc->s, &thisid, &thisid, 1, 0, NULL, NULL, STREAM_RWR_RAWENTRIES, NULL) == 0) {
+        /* Note that we may have a not acknowledged entry in the PEL
+         * about a message that's no longer here because was removed
+         * by the user by other means. In that case we signal it emitting
+         * the ID but then a NULL entry for the fields. */
+        addReplyArrayLen(wc->c, 2);
+        addReplyStreamID(wc->c, &thisid);
+        addReplyNullArray(wc->c);
+    } else {
+        streamNACK *nack = data;
+        nack->delivery_time = commandTimeSnapshot();
+        nack->delivery_count++;
+    }
+    wc->arraylen++;
+    return 1;
+}
+
 size_t streamReplyWithRangeFromConsumerPEL(client *c,
                                            stream *s,
                                            streamID *start,
                                            streamID *end,
                                            size_t count,
                                            streamConsumer *consumer) {
-    raxIterator ri;
     unsigned char startkey[sizeof(streamID)];
     unsigned char endkey[sizeof(streamID)];
     streamEncodeID(startkey, start);
     if (end) streamEncodeID(endkey, end);
 
-    size_t arraylen = 0;
     void *arraylen_ptr = addReplyDeferredLen(c);
-    raxStart(&ri, consumer->pel);
-    raxSeek(&ri, ">=", startkey, sizeof(startkey));
-    while (raxNext(&ri) && (!count || arraylen < count)) {
-        if (end && memcmp(ri.key, end, ri.key_len) > 0) break;
-        streamID thisid;
-        streamDecodeID(ri.key, &thisid);
-        if (streamReplyWithRange(c, s, &thisid, &thisid, 1, 0, NULL, NULL, STREAM_RWR_RAWENTRIES, NULL) == 0) {
-            /* Note that we may have a not acknowledged entry in the PEL
-             * about a message that's no longer here because was removed
-             * by the user by other means. In that case we signal it emitting
-             * the ID but then a NULL entry for the fields. */
-            addReplyArrayLen(c, 2);
-            addReplyStreamID(c, &thisid);
-            addReplyNullArray(c);
-        } else {
-            streamNACK *nack = ri.data;
-            nack->delivery_time = commandTimeSnapshot();
-            nack->delivery_count++;
-        }
-        arraylen++;
-    }
-    raxStop(&ri);
-    setDeferredArrayLen(c, arraylen_ptr, arraylen);
-    return arraylen;
+    streamPELWalkContext wc = {.c = c, .s = s, .endkey = end ? endkey : NULL, .arraylen = 0};
+    /* raxSeekAndWalk() prefetches the next PEL entry while the current one
+     * is being emitted. Note that the walk may stop one short of 'count'
+     * entries when the end condition fires, so the emitted length is taken
+     * from the context and not from the return value. */
+    raxSeekAndWalk(consumer->pel, ">=", startkey, sizeof(startkey), count, streamReplyPELEntryCallback, &wc);
+    setDeferredArrayLen(c, arraylen_ptr, wc.arraylen);
+    return wc.arraylen;
 }
 
 /* -----------------------------------------------------------------------
@@ -2824,13 +2854,13 @@ void xackCommand(client *c) {
         unsigned char buf[sizeof(streamID)];
         streamEncodeID(buf, &ids[j - 3]);
 
-        /* Lookup the ID in the group PEL: it will have a reference to the
-         * NACK structure that will have a reference to the consumer, so that
-         * we are able to remove the entry from both PELs. */
+        /* Remove the ID from the group PEL: the removed entry is the NACK
+         * structure that has a reference to the consumer, so that we are able
+         * to remove the entry from its PEL as well, without paying a separate
+         * lookup before the removal. */
         void *result;
-        if (raxFind(group->pel, buf, sizeof(buf), &result)) {
+        if (raxRemove(group->pel, buf, sizeof(buf), &result)) {
             streamNACK *nack = result;
-            raxRemove(group->pel, buf, sizeof(buf), NULL);
             raxRemove(nack->consumer->pel, buf, sizeof(buf), NULL);
             streamFreeNACK(nack);
             acknowledged++;
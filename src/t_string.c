@@ -33,6 +33,23 @@
 /* Forward declarations */
 int getGenericCommand(client *c);
 
+/* Once a string is larger than SDS_MAX_PREALLOC the sds greedy growth policy
+ * only reserves a fixed 1MB of headroom, so APPEND-heavy keys pay a full
+ * realloc (and possibly a copy of the whole string) every megabyte of
+ * growth. Before extending a big string we reserve a fraction of its current
+ * length instead, which makes the number of reallocations logarithmic in the
+ * final size and amortizes each append to O(1).
+ *
+ * 'o' must be a raw string object, 'addlen' is the number of bytes the
+ * caller is about to write past the current length. */
+static void stringReserveForGrowth(robj *o, size_t addlen) {
+    size_t len = sdslen(o->ptr);
+    if (len < SDS_MAX_PREALLOC || sdsavail(o->ptr) >= addlen) return;
+    size_t reserve = len / 8;
+    if (reserve < addlen) reserve = addlen;
+    o->ptr = sdsMakeRoomForNonGreedy(o->ptr, reserve);
+}
+
 /*-----------------------------------------------------------------------------
  * String Commands
  *----------------------------------------------------------------------------*/
@@ -389,7 +406,78 @@ int getGenericCommand(client *c) {
     return C_OK;
 }
 
+/* Drop the read coalescing cache. Called whenever the cached reply may no
+ * longer be reusable, and from beforeSleep() so that the cache never outlives
+ * one event loop iteration. */
+void resetReadCoalescingCache(void) {
+    if (server.read_coalesce.key) {
+        sdsfree(server.read_coalesce.key);
+        server.read_coalesce.key = NULL;
+    }
+    if (server.read_coalesce.block) {
+        releaseSharedReplyBlock(server.read_coalesce.block);
+        server.read_coalesce.block = NULL;
+    }
+}
+
+/* GET with read-reply-coalescing enabled: repeated GETs of the same key
+ * within one event loop iteration are served from a shared encoded reply.
+ * The first occurrence only remembers the key, the second encodes the reply
+ * into a shared block, and further ones just push a reference to it, skipping
+ * the keyspace lookup and the encoding. Any write invalidates the cache via
+ * the server.dirty comparison, and beforeSleep() drops it at the end of the
+ * iteration, so the hot key still gets its LRU/LFU touch at least once per
+ * iteration and a value change is never served stale. */
+static void getCommandWithCoalescing(client *c) {
+    sds keyname = c->argv[1]->ptr;
+    int cache_matches = server.read_coalesce.key != NULL && server.read_coalesce.dbid == c->db->id &&
+                        server.read_coalesce.dirty == server.dirty && sdscmp(server.read_coalesce.key, keyname) == 0;
+    if (cache_matches && server.read_coalesce.block != NULL &&
+        (server.read_coalesce.expire == -1 || commandTimeSnapshot() < server.read_coalesce.expire)) {
+        addReplySharedBlock(c, server.read_coalesce.block);
+        server.stat_keyspace_hits++;
+        server.stat_coalesced_reads++;
+        return;
+    }
+
+    robj *o;
+    if ((o = lookupKeyReadOrReply(c, c->argv[1], shared.null[c->resp])) == NULL) return;
+    if (checkType(c, o, OBJ_STRING)) return;
+    addReplyBulk(c, o);
+
+    if (cache_matches) {
+        /* Second read of the same key in this iteration: encode the shared
+         * reply. Cold keys never reach this point, so they don't pay for
+         * the cache. */
+        if (server.read_coalesce.block == NULL) {
+            sds payload = sdsempty();
+            if (sdsEncodedObject(o)) {
+                payload = sdscatfmt(payload, "$%U\r\n", (unsigned long long)sdslen(o->ptr));
+                payload = sdscatlen(payload, o->ptr, sdslen(o->ptr));
+            } else {
+                char buf[LONG_STR_SIZE];
+                size_t len = ll2string(buf, sizeof(buf), (long)o->ptr);
+                payload = sdscatfmt(payload, "$%U\r\n", (unsigned long long)len);
+                payload = sdscatlen(payload, buf, len);
+            }
+            payload = sdscatlen(payload, "\r\n", 2);
+            server.read_coalesce.block = createSharedReplyBlock(payload, sdslen(payload));
+            server.read_coalesce.expire = objectGetExpire(o);
+            sdsfree(payload);
+        }
+    } else {
+        resetReadCoalescingCache();
+        server.read_coalesce.key = sdsdup(keyname);
+        server.read_coalesce.dbid = c->db->id;
+        server.read_coalesce.dirty = server.dirty;
+    }
+}
+
 void getCommand(client *c) {
+    if (server.read_reply_coalescing) {
+        getCommandWithCoalescing(c);
+        return;
+    }
     getGenericCommand(c);
 }
 
@@ -503,6 +591,33 @@ void setrangeCommand(client *c) {
     }
 
     o = lookupKeyWrite(c->db, c->argv[1]);
+
+    /* Key exists, check type */
+    if (o != NULL && checkType(c, o, OBJ_STRING))
+        return;
+
+    /* Full overwrite fast path: when the write starts at offset zero and
+     * covers the entire existing value (or the key does not exist), the
+     * result is exactly the argument, so store the argument object itself
+     * instead of copying its payload into the old allocation. This keeps
+     * the memcpy of multi-megabyte full rewrites off the event loop.
+     * Restricted to raw-encoded arguments so the stored encoding matches
+     * what the copying path below produces. */
+    if (offset == 0 && sdslen(value) > 0 && c->argv[3]->encoding == OBJ_ENCODING_RAW &&
+        (o == NULL || sdslen(value) >= stringObjectLen(o))) {
+        if (checkStringLength(c, 0, sdslen(value)) != C_OK)
+            return;
+
+        size_t newlen = sdslen(value);
+        int flags = (o ? SETKEY_ALREADY_EXIST : SETKEY_DOESNT_EXIST) | SETKEY_KEEPTTL;
+        setKey(c, c->db, c->argv[1], &c->argv[3], flags);
+        incrRefCount(c->argv[3]);
+        notifyKeyspaceEvent(NOTIFY_STRING, "setrange", c->argv[1], c->db->id);
+        server.dirty++;
+        addReplyLongLong(c, newlen);
+        return;
+    }
+
     if (o == NULL) {
         /* Return 0 when setting nothing on a non-existing string */
         if (sdslen(value) == 0) {
@@ -517,16 +632,9 @@ void setrangeCommand(client *c) {
         o = createObject(OBJ_STRING, sdsnewlen(NULL, offset + sdslen(value)));
         dbAdd(c->db, c->argv[1], &o);
     } else {
-        size_t olen;
-
-        /* Key exists, check type */
-        if (checkType(c, o, OBJ_STRING))
-            return;
-
         /* Return existing string length when setting nothing */
-        olen = stringObjectLen(o);
         if (sdslen(value) == 0) {
-            addReplyLongLong(c, olen);
+            addReplyLongLong(c, stringObjectLen(o));
             return;
         }
 
@@ -539,6 +647,8 @@ void setrangeCommand(client *c) {
     }
 
     if (sdslen(value) > 0) {
+        if (offset + sdslen(value) > sdslen(o->ptr))
+            stringReserveForGrowth(o, offset + sdslen(value) - sdslen(o->ptr));
         o->ptr = sdsgrowzero(o->ptr, offset + sdslen(value));
         memcpy((char *)o->ptr + offset, value, sdslen(value));
         signalModifiedKey(c, c->db, c->argv[1]);
@@ -592,9 +702,16 @@ void getrangeCommand(client *c) {
 
 void mgetCommand(client *c) {
     int j;
+    int numkeys = c->argc - 1;
 
-    addReplyArrayLen(c, c->argc - 1);
+    addReplyArrayLen(c, numkeys);
     for (j = 1; j < c->argc; j++) {
+        /* Walk a window of upcoming keys concurrently so their cache misses
+         * overlap instead of being paid serially by lookupKeyRead(). A large
+         * MGET is one command, so the io-thread batching layer only ever
+         * covers its first few keys. */
+        if (numkeys >= PREFETCH_INLINE_MIN_KEYS && (j - 1) % PREFETCH_INLINE_WINDOW == 0)
+            prefetchKeysInline(c->db, c->argv + j, c->argc - j);
         robj *o = lookupKeyRead(c->db, c->argv[j]);
         if (o == NULL) {
             addReplyNull(c);
@@ -767,6 +884,7 @@ void appendCommand(client *c) {
 
         /* Append the value */
         o = dbUnshareStringValue(c->db, c->argv[1], o);
+        stringReserveForGrowth(o, sdslen(append->ptr));
         o->ptr = sdscatlen(o->ptr, append->ptr, sdslen(append->ptr));
         totlen = sdslen(o->ptr);
     }
@@ -236,6 +236,15 @@ static SSL_CTX *createSSLContext(serverTLSContextConfig *ctx_config, int protoco
     SSL_CTX_set_options(ctx, SSL_OP_NO_COMPRESSION);
 #endif
 
+#ifdef SSL_OP_ENABLE_KTLS
+    /* With kTLS, OpenSSL pushes the negotiated session keys into the kernel
+     * once the handshake completes, and SSL_read/SSL_write become plain
+     * recv(2)/send(2) on the socket with record encryption done in the
+     * kernel (or the NIC). OpenSSL transparently falls back to userspace
+     * encryption when the kernel or the negotiated cipher lacks support. */
+    if (ctx_config->ktls) SSL_CTX_set_options(ctx, SSL_OP_ENABLE_KTLS);
+#endif
+
     SSL_CTX_set_mode(ctx, SSL_MODE_ENABLE_PARTIAL_WRITE | SSL_MODE_ACCEPT_MOVING_WRITE_BUFFER);
     SSL_CTX_set_verify(ctx, SSL_VERIFY_PEER | SSL_VERIFY_FAIL_IF_NO_PEER_CERT, NULL);
 
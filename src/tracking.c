@@ -41,7 +41,12 @@
  *
  * Clients will normally take frequently requested objects in memory, removing
  * them when invalidation messages are received. */
-rax *TrackingTable = NULL;
+/* The tracking table is sharded by key hash: huge caching workloads would
+ * otherwise funnel every read and every invalidation through one deep radix
+ * tree, so splitting it keeps the individual trees shallow and the per-key
+ * bookkeeping cheap. */
+#define TRACKING_TABLE_SHARDS 16 /* Must be a power of two. */
+rax **TrackingTable = NULL;
 rax *PrefixTable = NULL;
 uint64_t TrackingTableTotalItems = 0; /* Total number of IDs stored across
                                          the whole tracking table. This gives
@@ -58,6 +63,12 @@ typedef struct bcastState {
                      prefix. */
 } bcastState;
 
+/* Return the tracking table shard holding the specified key. */
+static rax *trackingGetTableShard(unsigned char *key, size_t keylen) {
+    uint64_t hash = dictGenHashFunction(key, keylen);
+    return TrackingTable[hash & (TRACKING_TABLE_SHARDS - 1)];
+}
+
 /* Remove the tracking state from the client 'c'. Note that there is not much
  * to do for us here, if not to decrement the counter of the clients in
  * tracking mode, because we just store the ID of the client in the tracking
@@ -192,7 +203,8 @@ void enableTracking(client *c, uint64_t redirect_to, struct ClientFlags options,
     /* This may be the first client we ever enable. Create the tracking
      * table if it does not exist. */
     if (TrackingTable == NULL) {
-        TrackingTable = raxNew();
+        TrackingTable = zmalloc(sizeof(rax *) * TRACKING_TABLE_SHARDS);
+        for (int j = 0; j < TRACKING_TABLE_SHARDS; j++) TrackingTable[j] = raxNew();
         PrefixTable = raxNew();
         TrackingChannelName = createStringObject("__redis__:invalidate", 20);
     }
@@ -248,9 +260,10 @@ void trackingRememberKeys(client *tracking, client *executing) {
         sds sdskey = executing->argv[idx]->ptr;
         void *result;
         rax *ids;
-        if (!raxFind(TrackingTable, (unsigned char *)sdskey, sdslen(sdskey), &result)) {
+        rax *shard = trackingGetTableShard((unsigned char *)sdskey, sdslen(sdskey));
+        if (!raxFind(shard, (unsigned char *)sdskey, sdslen(sdskey), &result)) {
             ids = raxNew();
-            int inserted = raxTryInsert(TrackingTable, (unsigned char *)sdskey, sdslen(sdskey), ids, NULL);
+            int inserted = raxTryInsert(shard, (unsigned char *)sdskey, sdslen(sdskey), ids, NULL);
             serverAssert(inserted == 1);
         } else {
             ids = result;
@@ -379,7 +392,8 @@ void trackingInvalidateKey(client *c, robj *keyobj, int bcast) {
     if (bcast && raxSize(PrefixTable) > 0) trackingRememberKeyToBroadcast(c, (char *)key, keylen);
 
     void *result;
-    if (!raxFind(TrackingTable, key, keylen, &result)) return;
+    rax *shard = trackingGetTableShard(key, keylen);
+    if (!raxFind(shard, key, keylen, &result)) return;
     rax *ids = result;
 
     raxIterator ri;
@@ -420,7 +434,26 @@ void trackingInvalidateKey(client *c, robj *keyobj, int bcast) {
      * again if more keys will be modified in this caching slot. */
     TrackingTableTotalItems -= raxSize(ids);
     raxFree(ids);
-    raxRemove(TrackingTable, (unsigned char *)key, keylen, NULL);
+    raxRemove(shard, (unsigned char *)key, keylen, NULL);
+}
+
+/* Send the keys accumulated in '*batch' (already encoded as a sequence of
+ * '*batchlen' RESP bulk strings) to the current client as a single
+ * invalidation message, and reset the batch. */
+static void trackingSendPendingBatch(sds *batch, uint64_t *batchlen) {
+    if (*batch == NULL) return;
+    char buf[32];
+    size_t len = ll2string(buf, sizeof(buf), *batchlen);
+    sds proto = sdsempty();
+    proto = sdscatlen(proto, "*", 1);
+    proto = sdscatlen(proto, buf, len);
+    proto = sdscatlen(proto, "\r\n", 2);
+    proto = sdscatsds(proto, *batch);
+    sendTrackingMessage(server.current_client, proto, sdslen(proto), 1);
+    sdsfree(proto);
+    sdsfree(*batch);
+    *batch = NULL;
+    *batchlen = 0;
 }
 
 void trackingHandlePendingKeyInvalidations(void) {
@@ -432,6 +465,8 @@ void trackingHandlePendingKeyInvalidations(void) {
 
     listNode *ln;
     listIter li;
+    sds batch = NULL;
+    uint64_t batchlen = 0;
 
     listRewind(server.tracking_pending_keys, &li);
     while ((ln = listNext(&li)) != NULL) {
@@ -440,14 +475,32 @@ void trackingHandlePendingKeyInvalidations(void) {
          * message only when current_client is still alive */
         if (server.current_client != NULL) {
             if (key != NULL) {
-                sendTrackingMessage(server.current_client, (char *)key->ptr, sdslen(key->ptr), 0);
+                /* Coalesce the pending keys into a single push message:
+                 * the invalidation payload is an array, so clients already
+                 * handle several keys per message (BCAST mode relies on
+                 * that), and this way a pipeline touching many tracked keys
+                 * pays for one push header instead of one per key. */
+                char buf[32];
+                size_t len = ll2string(buf, sizeof(buf), sdslen(key->ptr));
+                if (batch == NULL) batch = sdsempty();
+                batch = sdscatlen(batch, "$", 1);
+                batch = sdscatlen(batch, buf, len);
+                batch = sdscatlen(batch, "\r\n", 2);
+                batch = sdscatsds(batch, key->ptr);
+                batch = sdscatlen(batch, "\r\n", 2);
+                batchlen++;
             } else {
+                /* A NULL key means "all keys are invalid": flush what was
+                 * batched so far to preserve ordering, then send the RESP
+                 * NULL on its own. */
+                trackingSendPendingBatch(&batch, &batchlen);
                 sendTrackingMessage(server.current_client, shared.null[server.current_client->resp]->ptr,
                                     sdslen(shared.null[server.current_client->resp]->ptr), 1);
             }
         }
         if (key != NULL) decrRefCount(key);
     }
+    trackingSendPendingBatch(&batch, &batchlen);
     listEmpty(server.tracking_pending_keys);
 }
 
@@ -487,12 +540,14 @@ void trackingInvalidateKeysOnFlush(int async) {
 
     /* In case of FLUSHALL, reclaim all the memory used by tracking. */
     if (TrackingTable) {
-        if (async) {
-            freeTrackingRadixTreeAsync(TrackingTable);
-        } else {
-            freeTrackingRadixTree(TrackingTable);
+        for (int j = 0; j < TRACKING_TABLE_SHARDS; j++) {
+            if (async) {
+                freeTrackingRadixTreeAsync(TrackingTable[j]);
+            } else {
+                freeTrackingRadixTree(TrackingTable[j]);
+            }
+            TrackingTable[j] = raxNew();
         }
-        TrackingTable = raxNew();
         TrackingTableTotalItems = 0;
     }
 }
@@ -512,7 +567,7 @@ void trackingLimitUsedSlots(void) {
     if (TrackingTable == NULL) return;
     if (server.tracking_table_max_keys == 0) return; /* No limits set. */
     size_t max_keys = server.tracking_table_max_keys;
-    if (raxSize(TrackingTable) <= max_keys) {
+    if (trackingGetTotalKeys() <= max_keys) {
         timeout_counter = 0;
         return; /* Limit not reached. */
     }
@@ -522,27 +577,34 @@ void trackingLimitUsedSlots(void) {
      * function and found that we are still over the limit. */
     int effort = 100 * (timeout_counter + 1);
 
-    /* We just remove one key after another by using a random walk. */
+    /* We just remove one key after another by using a random walk,
+     * rotating over the table shards so the eviction pressure is
+     * spread evenly. */
     raxIterator ri;
-    raxStart(&ri, TrackingTable);
+    static unsigned int shard_idx = 0;
     while (effort > 0) {
         effort--;
+        rax *shard = TrackingTable[shard_idx++ & (TRACKING_TABLE_SHARDS - 1)];
+        if (raxSize(shard) == 0) continue;
+        raxStart(&ri, shard);
         raxSeek(&ri, "^", NULL, 0);
         raxRandomWalk(&ri, 0);
-        if (raxEOF(&ri)) break;
+        if (raxEOF(&ri)) {
+            raxStop(&ri);
+            continue;
+        }
         robj *keyobj = createStringObject((char *)ri.key, ri.key_len);
+        raxStop(&ri);
         trackingInvalidateKey(NULL, keyobj, 0);
         decrRefCount(keyobj);
-        if (raxSize(TrackingTable) <= max_keys) {
+        if (trackingGetTotalKeys() <= max_keys) {
             timeout_counter = 0;
-            raxStop(&ri);
             return; /* Return ASAP: we are again under the limit. */
         }
     }
 
     /* If we reach this point, we were not able to go under the configured
      * limit using the maximum effort we had for this run. */
-    raxStop(&ri);
     timeout_counter++;
 }
 
@@ -653,7 +715,9 @@ uint64_t trackingGetTotalItems(void) {
 
 uint64_t trackingGetTotalKeys(void) {
     if (TrackingTable == NULL) return 0;
-    return raxSize(TrackingTable);
+    uint64_t total = 0;
+    for (int j = 0; j < TRACKING_TABLE_SHARDS; j++) total += raxSize(TrackingTable[j]);
+    return total;
 }
 
 uint64_t trackingGetTotalPrefixes(void) {
@@ -163,6 +163,10 @@ static ssize_t connUnixSyncReadLine(connection *conn, char *ptr, ssize_t size, l
     return syncReadLine(conn->fd, ptr, size, timeout);
 }
 
+static void connUnixUpdateState(connection *conn) {
+    connectionTypeTcp()->update_state(conn);
+}
+
 static ConnectionType CT_Unix = {
     /* connection type */
     .get_type = connUnixGetType,
@@ -206,7 +210,7 @@ static ConnectionType CT_Unix = {
     .has_pending_data = NULL,
     .process_pending_data = NULL,
     .postpone_update_state = NULL,
-    .update_state = NULL,
+    .update_state = connUnixUpdateState,
 
     /* Miscellaneous */
     .connIntegrityChecked = NULL,
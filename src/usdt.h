@@ -0,0 +1,70 @@
+/* usdt.h -- User-level statically defined tracing (USDT) probe points.
+ *
+ * Built with `make SERVER_CFLAGS="-DUSE_USDT"` on a host that has the
+ * systemtap development headers (<sys/sdt.h>), the server embeds stable
+ * probe points at the hot control-flow boundaries: command dispatch, event
+ * loop iterations, the replication feed, the active expire cycle and bio
+ * job execution. An unprobed site costs a single nop, so the flag is safe
+ * to leave on in production builds; without the flag the macros compile to
+ * nothing and the binary is unchanged.
+ *
+ * The probes can be consumed by bpftrace, perf or systemtap, e.g.:
+ *
+ *   bpftrace -e 'usdt:./valkey-server:valkey:command_end
+ *                { @us[str(arg0)] = hist(arg2); }'
+ *
+ * Probe names and argument order are meant to stay stable across releases;
+ * append new arguments rather than reordering existing ones.
+ *
+ * Copyright Valkey Contributors.
+ * All rights reserved.
+ * SPDX-License-Identifier: BSD 3-Clause
+ */
+
+#ifndef USDT_H
+#define USDT_H
+
+#ifdef USE_USDT
+#include <sys/sdt.h>
+
+/* Command dispatch, fired around c->cmd->proc() in call().
+ * arg0: fully qualified command name (char *), arg1: client id,
+ * arg2 (end only): execution time in microseconds. */
+#define VALKEY_USDT_COMMAND_START(name, client_id) DTRACE_PROBE2(valkey, command_start, name, client_id)
+#define VALKEY_USDT_COMMAND_END(name, client_id, duration_us) \
+    DTRACE_PROBE3(valkey, command_end, name, client_id, duration_us)
+
+/* One pair per aeProcessEvents() call, i.e. per event loop iteration.
+ * arg0 at start: AE_* flags; arg0 at end: number of events processed. */
+#define VALKEY_USDT_EVENTLOOP_START(flags) DTRACE_PROBE1(valkey, eventloop_start, flags)
+#define VALKEY_USDT_EVENTLOOP_END(processed) DTRACE_PROBE1(valkey, eventloop_end, processed)
+
+/* A command is about to be appended to the replication stream.
+ * arg0: database id (-1 when no SELECT is needed), arg1: argument count. */
+#define VALKEY_USDT_REPL_FEED(dbid, argc) DTRACE_PROBE2(valkey, repl_feed, dbid, argc)
+
+/* Active expire cycle boundaries. arg0: cycle type (fast/slow); the end
+ * probe also carries keys sampled, keys expired and elapsed microseconds. */
+#define VALKEY_USDT_EXPIRE_CYCLE_START(type) DTRACE_PROBE1(valkey, expire_cycle_start, type)
+#define VALKEY_USDT_EXPIRE_CYCLE_END(type, sampled, expired, elapsed_us) \
+    DTRACE_PROBE4(valkey, expire_cycle_end, type, sampled, expired, elapsed_us)
+
+/* Background I/O job execution. arg0: worker index, arg1: BIO_* job type. */
+#define VALKEY_USDT_BIO_JOB_START(worker, job_type) DTRACE_PROBE2(valkey, bio_job_start, worker, job_type)
+#define VALKEY_USDT_BIO_JOB_END(worker, job_type) DTRACE_PROBE2(valkey, bio_job_end, worker, job_type)
+
+#else
+
+#define VALKEY_USDT_COMMAND_START(name, client_id)
+#define VALKEY_USDT_COMMAND_END(name, client_id, duration_us)
+#define VALKEY_USDT_EVENTLOOP_START(flags)
+#define VALKEY_USDT_EVENTLOOP_END(processed)
+#define VALKEY_USDT_REPL_FEED(dbid, argc)
+#define VALKEY_USDT_EXPIRE_CYCLE_START(type)
+#define VALKEY_USDT_EXPIRE_CYCLE_END(type, sampled, expired, elapsed_us)
+#define VALKEY_USDT_BIO_JOB_START(worker, job_type)
+#define VALKEY_USDT_BIO_JOB_END(worker, job_type)
+
+#endif /* USE_USDT */
+
+#endif /* USDT_H */
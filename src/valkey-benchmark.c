@@ -65,6 +65,7 @@
 #define DEFAULT_LATENCY_PRECISION 3
 #define MAX_LATENCY_PRECISION 4
 #define MAX_THREADS 500
+#define MAX_MIX_COMMANDS 16
 #define CLUSTER_SLOTS 16384
 #define CONFIG_LATENCY_HISTOGRAM_MIN_VALUE 10L              /* >= 10 usecs */
 #define CONFIG_LATENCY_HISTOGRAM_MAX_VALUE 3000000L         /* <= 3 secs(us precision) */
@@ -104,6 +105,14 @@ static struct config {
     int randomkeys_keyspacelen;
     int keepalive;
     int pipeline;
+    int rps; /* Target requests per second across all clients (0 = unthrottled) */
+    struct mixCommand {
+        sds name;
+        int weight;
+        sds cmd; /* Formatted command, built right before the run. */
+    } mix[MAX_MIX_COMMANDS]; /* Weighted command mix (--mix). */
+    int mix_len;
+    int mix_total_weight;
     long long start;
     long long totlatency;
     const char *title;
@@ -145,9 +154,12 @@ typedef struct _client {
     char **stagptr;     /* Pointers to slot hashtags (cluster mode only) */
     size_t staglen;     /* Number of pointers in client->stagptr */
     size_t stagfree;    /* Number of unused pointers in client->stagptr */
-    size_t written;     /* Bytes of 'obuf' already written */
-    long long start;    /* Start time of a request */
-    long long latency;  /* Request latency */
+    size_t written;         /* Bytes of 'obuf' already written */
+    long long start;        /* Start time of a request */
+    long long sched;        /* Intended start time of the current request batch
+                               (fixed-rate mode only) */
+    long long sched_timer;  /* Pending schedule timer id, or -1 */
+    long long latency;      /* Request latency */
     int pending;        /* Number of pending requests (replies to consume) */
     int prefix_pending; /* If non-zero, number of pending prefix commands. Commands
                            such as auth and select are prefixed to the pipeline of
@@ -189,6 +201,7 @@ typedef struct serverConfig {
 /* Prototypes */
 static void writeHandler(aeEventLoop *el, int fd, void *privdata, int mask);
 static void createMissingClients(client c);
+static void benchmark(const char *title, char *cmd, int len);
 static benchmarkThread *createBenchmarkThread(int index);
 static void freeBenchmarkThread(benchmarkThread *thread);
 static void freeBenchmarkThreads(void);
@@ -354,6 +367,7 @@ static void freeClient(client c) {
     listNode *ln;
     aeDeleteFileEvent(el, c->context->fd, AE_WRITABLE);
     aeDeleteFileEvent(el, c->context->fd, AE_READABLE);
+    if (c->sched_timer != -1) aeDeleteTimeEvent(el, c->sched_timer);
     if (c->thread_id >= 0) {
         int requests_finished = atomic_load_explicit(&config.requests_finished, memory_order_relaxed);
         if (requests_finished >= config.requests) {
@@ -383,13 +397,39 @@ static void freeAllClients(void) {
     }
 }
 
+/* Interval in microseconds between two request batches of the same client
+ * when a target request rate is configured with --rps. */
+static long long clientSchedInterval(void) {
+    return (1000000LL * config.pipeline * config.numclients) / config.rps;
+}
+
+/* Timer callback used in fixed-rate mode: re-arm the writable event once the
+ * client's next scheduled send time has arrived. */
+static long long scheduledWriteHandler(aeEventLoop *el, long long id, void *clientData) {
+    UNUSED(id);
+    client c = clientData;
+    c->sched_timer = -1;
+    aeCreateFileEvent(el, c->context->fd, AE_WRITABLE, writeHandler, c);
+    return AE_NOMORE;
+}
+
 static void resetClient(client c) {
     aeEventLoop *el = CLIENT_GET_EVENTLOOP(c);
     aeDeleteFileEvent(el, c->context->fd, AE_WRITABLE);
     aeDeleteFileEvent(el, c->context->fd, AE_READABLE);
-    aeCreateFileEvent(el, c->context->fd, AE_WRITABLE, writeHandler, c);
     c->written = 0;
     c->pending = config.pipeline;
+    if (config.rps > 0) {
+        c->sched += clientSchedInterval();
+        long long delay = c->sched - ustime();
+        if (delay > 0) {
+            c->sched_timer = aeCreateTimeEvent(el, delay / 1000, scheduledWriteHandler, c, NULL);
+            return;
+        }
+        /* We are behind schedule: send immediately. The latency accounting
+         * in writeHandler() charges the accumulated delay to the request. */
+    }
+    aeCreateFileEvent(el, c->context->fd, AE_WRITABLE, writeHandler, c);
 }
 
 static void randomizeClientKey(client c) {
@@ -581,6 +621,14 @@ static void writeHandler(aeEventLoop *el, int fd, void *privdata, int mask) {
         if (config.cluster_mode && c->staglen > 0) setClusterKeyHashTag(c);
         c->slots_last_update = atomic_load_explicit(&config.slots_last_update, memory_order_relaxed);
         c->start = ustime();
+        if (config.rps > 0) {
+            /* Measure latency from the intended send time rather than the
+             * actual one, so that a server stall is charged to every request
+             * that should have been issued while it lasted (coordinated
+             * omission correction). */
+            if (c->sched == 0) c->sched = c->start;
+            c->start = c->sched;
+        }
         c->latency = -1;
     }
     const ssize_t buflen = sdslen(c->obuf);
@@ -734,22 +782,36 @@ static client createClient(char *cmd, size_t len, client from, int thread_id) {
 
     c->prefixlen = sdslen(c->obuf);
     /* Append the request itself. */
-    if (from) {
+    if (config.mix_len) {
+        /* Sample a fresh weighted sequence for every client, so that the
+         * aggregate traffic over all clients and pipeline slots matches the
+         * requested command mix. */
+        for (j = 0; j < config.pipeline; j++) {
+            int r = random() % config.mix_total_weight;
+            int k = 0;
+            while (r >= config.mix[k].weight) r -= config.mix[k++].weight;
+            c->obuf = sdscatsds(c->obuf, config.mix[k].cmd);
+        }
+    } else if (from) {
         c->obuf = sdscatlen(c->obuf, from->obuf + from->prefixlen, sdslen(from->obuf) - from->prefixlen);
     } else {
         for (j = 0; j < config.pipeline; j++) c->obuf = sdscatlen(c->obuf, cmd, len);
     }
 
     c->written = 0;
+    c->sched = 0;
+    c->sched_timer = -1;
     c->pending = config.pipeline + c->prefix_pending;
     c->randptr = NULL;
     c->randlen = 0;
     c->stagptr = NULL;
     c->staglen = 0;
 
-    /* Find substrings in the output buffer that need to be randomized. */
+    /* Find substrings in the output buffer that need to be randomized. Mixed
+     * workload clients each carry a different command sequence, so their
+     * offsets cannot be cloned and are always rescanned. */
     if (config.randomkeys) {
-        if (from) {
+        if (from && !config.mix_len) {
             c->randlen = from->randlen;
             c->randfree = 0;
             c->randptr = zmalloc(sizeof(char *) * c->randlen);
@@ -955,6 +1017,86 @@ static void startBenchmarkThreads(void) {
     for (i = 0; i < config.num_threads; i++) pthread_join(config.threads[i]->thread, NULL);
 }
 
+/* Format one command of a mixed workload (--mix). The key patterns match the
+ * ones used by the corresponding standard tests, so a mixed run hits the same
+ * keyspace a sequence of -t runs would. Returns NULL for unsupported names. */
+static sds mixFormatCommand(const char *name, const char *data) {
+    char *cmd = NULL;
+    int len = 0;
+
+    if (!strcmp(name, "ping")) {
+        len = redisFormatCommand(&cmd, "PING");
+    } else if (!strcmp(name, "set")) {
+        len = redisFormatCommand(&cmd, "SET key:__rand_int__ %s", data);
+    } else if (!strcmp(name, "get")) {
+        len = redisFormatCommand(&cmd, "GET key:__rand_int__");
+    } else if (!strcmp(name, "incr")) {
+        len = redisFormatCommand(&cmd, "INCR counter:__rand_int__");
+    } else if (!strcmp(name, "lpush")) {
+        len = redisFormatCommand(&cmd, "LPUSH mylist %s", data);
+    } else if (!strcmp(name, "rpush")) {
+        len = redisFormatCommand(&cmd, "RPUSH mylist %s", data);
+    } else if (!strcmp(name, "lpop")) {
+        len = redisFormatCommand(&cmd, "LPOP mylist");
+    } else if (!strcmp(name, "rpop")) {
+        len = redisFormatCommand(&cmd, "RPOP mylist");
+    } else if (!strcmp(name, "sadd")) {
+        len = redisFormatCommand(&cmd, "SADD myset element:__rand_int__");
+    } else if (!strcmp(name, "spop")) {
+        len = redisFormatCommand(&cmd, "SPOP myset");
+    } else if (!strcmp(name, "hset")) {
+        len = redisFormatCommand(&cmd, "HSET myhash element:__rand_int__ %s", data);
+    } else if (!strcmp(name, "zadd")) {
+        const char *score = config.randomkeys ? "__rand_int__" : "0";
+        len = redisFormatCommand(&cmd, "ZADD myzset %s element:__rand_int__", score);
+    } else if (!strcmp(name, "zpopmin")) {
+        len = redisFormatCommand(&cmd, "ZPOPMIN myzset");
+    } else if (!strcmp(name, "mset") || !strcmp(name, "mget")) {
+        int is_mset = (name[1] == 's');
+        const char *cmd_argv[21];
+        int cmd_argc = is_mset ? 21 : 11;
+        cmd_argv[0] = is_mset ? "MSET" : "MGET";
+        for (int i = 1; i < cmd_argc; i += is_mset ? 2 : 1) {
+            cmd_argv[i] = "key:__rand_int__";
+            if (is_mset) cmd_argv[i + 1] = data;
+        }
+        len = redisFormatCommandArgv(&cmd, cmd_argc, cmd_argv, NULL);
+    } else {
+        return NULL;
+    }
+
+    sds formatted = sdsnewlen(cmd, len);
+    free(cmd);
+    return formatted;
+}
+
+/* Run the --mix benchmark: build the command table, then let createClient()
+ * sample each client's pipeline from it. */
+static void mixBenchmark(const char *data) {
+    sds title = sdsnew("MIXED (");
+
+    for (int i = 0; i < config.mix_len; i++) {
+        config.mix[i].cmd = mixFormatCommand(config.mix[i].name, data);
+        if (config.mix[i].cmd == NULL) {
+            fprintf(stderr, "Unsupported command \"%s\" in --mix. Supported commands: "
+                            "ping, set, get, incr, lpush, rpush, lpop, rpop, sadd, spop, "
+                            "hset, zadd, zpopmin, mset, mget.\n",
+                    config.mix[i].name);
+            exit(1);
+        }
+        title = sdscatprintf(title, "%s%s:%d", i ? "," : "", config.mix[i].name, config.mix[i].weight);
+    }
+    title = sdscat(title, ")");
+
+    benchmark(title, NULL, 0);
+
+    for (int i = 0; i < config.mix_len; i++) {
+        sdsfree(config.mix[i].cmd);
+        config.mix[i].cmd = NULL;
+    }
+    sdsfree(title);
+}
+
 static void benchmark(const char *title, char *cmd, int len) {
     client c;
 
@@ -1357,6 +1499,37 @@ int parseOptions(int argc, char **argv) {
             if (lastarg) goto invalid;
             config.pipeline = atoi(argv[++i]);
             if (config.pipeline <= 0) config.pipeline = 1;
+        } else if (!strcmp(argv[i], "--rps")) {
+            if (lastarg) goto invalid;
+            config.rps = atoi(argv[++i]);
+            if (config.rps < 0) config.rps = 0;
+        } else if (!strcmp(argv[i], "--mix")) {
+            if (lastarg) goto invalid;
+            int ntokens;
+            char *mixspec = argv[++i];
+            sds *tokens = sdssplitlen(mixspec, strlen(mixspec), ",", 1, &ntokens);
+            if (!tokens || ntokens == 0 || ntokens > MAX_MIX_COMMANDS) {
+                fprintf(stderr, "Invalid --mix specification: expected 1 to %d comma separated "
+                                "<command>:<weight> entries.\n",
+                        MAX_MIX_COMMANDS);
+                exit(1);
+            }
+            for (int t = 0; t < ntokens; t++) {
+                char *colon = strchr(tokens[t], ':');
+                int weight = colon ? atoi(colon + 1) : 0;
+                if (!colon || weight <= 0) {
+                    fprintf(stderr, "Invalid --mix entry \"%s\": expected <command>:<weight> "
+                                    "with a positive weight.\n",
+                            tokens[t]);
+                    exit(1);
+                }
+                config.mix[t].name = sdsnewlen(tokens[t], colon - tokens[t]);
+                sdstolower(config.mix[t].name);
+                config.mix[t].weight = weight;
+                config.mix_total_weight += weight;
+            }
+            config.mix_len = ntokens;
+            sdsfreesplitres(tokens, ntokens);
         } else if (!strcmp(argv[i], "-r")) {
             if (lastarg) goto invalid;
             const char *next = argv[++i], *p = next;
@@ -1503,7 +1676,7 @@ usage:
         "";
 
     printf(
-        "%s%s%s", /* Split to avoid strings longer than 4095 (-Woverlength-strings). */
+        "%s%s%s%s", /* Split to avoid strings longer than 4095 (-Woverlength-strings). */
         "Usage: valkey-benchmark [OPTIONS] [COMMAND ARGS...]\n\n"
         "Options:\n"
         " -h <hostname>      Server hostname (default 127.0.0.1)\n"
@@ -1548,7 +1721,15 @@ usage:
         "                    Note: If -r is omitted, all commands in a benchmark will\n"
         "                    use the same key.\n"
         " -P <numreq>        Pipeline <numreq> requests. Default 1 (no pipeline).\n"
-        " -q                 Quiet. Just show query/sec values\n"
+        " --rps <rate>       Issue requests at a fixed total rate across all clients\n"
+        "                    instead of as fast as possible. Latency is then measured\n"
+        "                    from each request's scheduled send time, correcting for\n"
+        "                    coordinated omission. Default is unthrottled.\n"
+        " --mix <spec>       Run a weighted mix of commands instead of the standard\n"
+        "                    tests, e.g. --mix get:70,set:20,zadd:5,mget:5. Each\n"
+        "                    client samples its pipeline from the weights, so the\n"
+        "                    aggregate traffic matches the requested proportions.\n"
+        " -q                 Quiet. Just show query/sec values\n",
         " --precision        Number of decimal places to display in latency output (default 0)\n"
         " --csv              Output in CSV format\n"
         " -l                 Loop. Run the tests forever\n"
@@ -1701,6 +1882,7 @@ int main(int argc, char **argv) {
     config.keepalive = 1;
     config.datasize = 3;
     config.pipeline = 1;
+    config.rps = 0;
     config.randomkeys = 0;
     config.randomkeys_keyspacelen = 0;
     config.quiet = 0;
@@ -1735,6 +1917,11 @@ int main(int argc, char **argv) {
     argc -= i;
     argv += i;
 
+    if (config.mix_len && config.cluster_mode) {
+        fprintf(stderr, "Error: --mix is not supported in cluster mode.\n");
+        exit(1);
+    }
+
     tag = "";
 
 #ifdef USE_OPENSSL
@@ -1876,6 +2063,12 @@ int main(int argc, char **argv) {
         genBenchmarkRandomData(data, config.datasize);
         data[config.datasize] = '\0';
 
+        /* A mixed workload replaces the standard test suite. */
+        if (config.mix_len) {
+            mixBenchmark(data);
+            continue;
+        }
+
         if (test_is_selected("ping_inline") || test_is_selected("ping")) benchmark("PING_INLINE", "PING\r\n", 6);
 
         if (test_is_selected("ping_mbulk") || test_is_selected("ping")) {
@@ -31,6 +31,7 @@
 #include "server.h"
 #include "rdb.h"
 #include "module.h"
+#include "cluster.h"
 
 #include <stdarg.h>
 #include <sys/time.h>
@@ -40,6 +41,7 @@
 void createSharedObjects(void);
 void rdbLoadProgressCallback(rio *r, const void *buf, size_t len);
 int rdbCheckMode = 0;
+static int rdbStatsMode = 0; /* True when invoked with --stats. */
 
 struct {
     rio *rio;
@@ -104,6 +106,159 @@ char *rdb_type_string[] = {
     "stream-v3",
 };
 
+/* Aggregated histograms collected while streaming the RDB in --stats mode.
+ * Sizes are the serialized footprint of each record as found in the file,
+ * expire/LRU/LFU opcodes included. */
+typedef struct {
+    unsigned long long count;
+    unsigned long long bytes;
+} rdbStatsBucket;
+
+#define RDB_STATS_TTL_BUCKETS 6
+#define RDB_STATS_TOP_PREFIXES 20
+#define RDB_STATS_TOP_SLOTS 10
+
+static char *rdb_stats_ttl_string[RDB_STATS_TTL_BUCKETS] = {
+    "no ttl", "already expired", "< 1 hour", "< 1 day", "< 1 week", ">= 1 week",
+};
+
+static struct {
+    rdbStatsBucket types[sizeof(rdb_type_string) / sizeof(char *)];
+    rdbStatsBucket ttl[RDB_STATS_TTL_BUCKETS];
+    rdbStatsBucket slots[CLUSTER_SLOTS];
+    dict *prefixes; /* key prefix (sds) -> rdbStatsBucket */
+} rdbstats;
+
+static dictType prefixStatsDictType = {
+    dictSdsHash,       /* hash function */
+    NULL,              /* key dup */
+    dictSdsKeyCompare, /* key compare */
+    dictSdsDestructor, /* key destructor */
+    dictVanillaFree,   /* val destructor */
+    NULL               /* allow to expand */
+};
+
+/* Account one key record into the --stats histograms. */
+static void rdbStatsCollectKey(sds key, int type, unsigned long long bytes, long long expiretime, long long now) {
+    int bucket;
+
+    rdbstats.types[type].count++;
+    rdbstats.types[type].bytes += bytes;
+
+    if (expiretime == -1)
+        bucket = 0;
+    else if (expiretime < now)
+        bucket = 1;
+    else if (expiretime < now + 3600 * 1000LL)
+        bucket = 2;
+    else if (expiretime < now + 24 * 3600 * 1000LL)
+        bucket = 3;
+    else if (expiretime < now + 7 * 24 * 3600 * 1000LL)
+        bucket = 4;
+    else
+        bucket = 5;
+    rdbstats.ttl[bucket].count++;
+    rdbstats.ttl[bucket].bytes += bytes;
+
+    unsigned int slot = keyHashSlot(key, sdslen(key));
+    rdbstats.slots[slot].count++;
+    rdbstats.slots[slot].bytes += bytes;
+
+    /* Group keys by the part up to the first ':'. Keys without a separator
+     * share a single bucket, so a keyspace of unique flat names can't blow
+     * up the prefix table. */
+    char *sep = memchr(key, ':', sdslen(key));
+    sds prefix = sep ? sdsnewlen(key, sep - key + 1) : sdsnew("(none)");
+    dictEntry *de = dictFind(rdbstats.prefixes, prefix);
+    rdbStatsBucket *b;
+    if (de) {
+        b = dictGetVal(de);
+        sdsfree(prefix);
+    } else {
+        b = zcalloc(sizeof(*b));
+        dictAdd(rdbstats.prefixes, prefix, b);
+    }
+    b->count++;
+    b->bytes += bytes;
+}
+
+static int prefixStatsCompare(const void *a, const void *b) {
+    rdbStatsBucket *ba = dictGetVal(*(dictEntry **)a);
+    rdbStatsBucket *bb = dictGetVal(*(dictEntry **)b);
+    if (ba->bytes != bb->bytes) return (bb->bytes > ba->bytes) ? 1 : -1;
+    return 0;
+}
+
+static int slotStatsCompare(const void *a, const void *b) {
+    rdbStatsBucket *ba = &rdbstats.slots[*(unsigned int *)a];
+    rdbStatsBucket *bb = &rdbstats.slots[*(unsigned int *)b];
+    if (ba->bytes != bb->bytes) return (bb->bytes > ba->bytes) ? 1 : -1;
+    return 0;
+}
+
+/* Print the histograms collected in --stats mode. */
+static void rdbShowStats(void) {
+    unsigned int i;
+
+    printf("\n--- types ---\n");
+    for (i = 0; i < sizeof(rdb_type_string) / sizeof(char *); i++) {
+        rdbStatsBucket *b = &rdbstats.types[i];
+        if (b->count == 0) continue;
+        printf("%-16s %llu keys, %llu bytes (avg %.2f)\n", rdb_type_string[i], b->count, b->bytes,
+               (double)b->bytes / b->count);
+    }
+
+    printf("\n--- ttl distribution ---\n");
+    for (i = 0; i < RDB_STATS_TTL_BUCKETS; i++) {
+        rdbStatsBucket *b = &rdbstats.ttl[i];
+        if (b->count == 0) continue;
+        printf("%-16s %llu keys, %llu bytes\n", rdb_stats_ttl_string[i], b->count, b->bytes);
+    }
+
+    printf("\n--- top prefixes ---\n");
+    unsigned long num_prefixes = dictSize(rdbstats.prefixes), j = 0;
+    dictEntry **entries = zmalloc(sizeof(dictEntry *) * num_prefixes);
+    dictIterator *di = dictGetIterator(rdbstats.prefixes);
+    dictEntry *de;
+    while ((de = dictNext(di))) entries[j++] = de;
+    dictReleaseIterator(di);
+    qsort(entries, num_prefixes, sizeof(dictEntry *), prefixStatsCompare);
+    for (j = 0; j < num_prefixes && j < RDB_STATS_TOP_PREFIXES; j++) {
+        rdbStatsBucket *b = dictGetVal(entries[j]);
+        printf("%-16s %llu keys, %llu bytes\n", (sds)dictGetKey(entries[j]), b->count, b->bytes);
+    }
+    if (num_prefixes > RDB_STATS_TOP_PREFIXES) printf("(%lu more prefixes)\n", num_prefixes - RDB_STATS_TOP_PREFIXES);
+    zfree(entries);
+
+    /* Dumping all 16384 slots would be noise: report the spread and the
+     * heaviest ones, which is what shard sizing needs. */
+    unsigned int used_slots = 0;
+    unsigned long long min_bytes = 0, max_bytes = 0, tot_bytes = 0;
+    for (i = 0; i < CLUSTER_SLOTS; i++) {
+        rdbStatsBucket *b = &rdbstats.slots[i];
+        if (b->count == 0) continue;
+        if (used_slots == 0 || b->bytes < min_bytes) min_bytes = b->bytes;
+        if (b->bytes > max_bytes) max_bytes = b->bytes;
+        tot_bytes += b->bytes;
+        used_slots++;
+    }
+    printf("\n--- slots ---\n");
+    printf("%u of %d slots populated", used_slots, CLUSTER_SLOTS);
+    if (used_slots)
+        printf(" (bytes per slot: min %llu, avg %.2f, max %llu)", min_bytes, (double)tot_bytes / used_slots, max_bytes);
+    printf("\n");
+    if (used_slots) {
+        unsigned int *idx = zmalloc(sizeof(unsigned int) * used_slots), n = 0;
+        for (i = 0; i < CLUSTER_SLOTS; i++)
+            if (rdbstats.slots[i].count) idx[n++] = i;
+        qsort(idx, n, sizeof(unsigned int), slotStatsCompare);
+        for (i = 0; i < n && i < RDB_STATS_TOP_SLOTS; i++)
+            printf("slot %-11u %llu keys, %llu bytes\n", idx[i], rdbstats.slots[idx[i]].count,
+                   rdbstats.slots[idx[i]].bytes);
+        zfree(idx);
+    }
+}
+
 /* Show a few stats collected into 'rdbstate' */
 void rdbShowGenericInfo(void) {
     printf("[info] %lu keys read\n", rdbstate.keys);
@@ -216,9 +371,15 @@ int redis_check_rdb(char *rdbfilename, FILE *fp) {
     }
 
     expiretime = -1;
+    uint64_t record_start = 0;
+    int record_pending = 0; /* An expire/LRU/LFU opcode was read, the key record continues. */
     while (1) {
         robj *key, *val;
 
+        /* Remember where the record starts so --stats can measure its full
+         * serialized footprint. */
+        if (!record_pending) record_start = rdb.processed_bytes;
+
         /* Read type. */
         rdbstate.doing = RDB_CHECK_DOING_READ_TYPE;
         if ((type = rdbLoadType(&rdb)) == -1) goto eoferr;
@@ -232,6 +393,7 @@ int redis_check_rdb(char *rdbfilename, FILE *fp) {
             expiretime = rdbLoadTime(&rdb);
             expiretime *= 1000;
             if (rioGetReadError(&rdb)) goto eoferr;
+            record_pending = 1;
             continue; /* Read next opcode. */
         } else if (type == RDB_OPCODE_EXPIRETIME_MS) {
             /* EXPIRETIME_MS: milliseconds precision expire times introduced
@@ -239,15 +401,18 @@ int redis_check_rdb(char *rdbfilename, FILE *fp) {
             rdbstate.doing = RDB_CHECK_DOING_READ_EXPIRE;
             expiretime = rdbLoadMillisecondTime(&rdb, rdbver);
             if (rioGetReadError(&rdb)) goto eoferr;
+            record_pending = 1;
             continue; /* Read next opcode. */
         } else if (type == RDB_OPCODE_FREQ) {
             /* FREQ: LFU frequency. */
             uint8_t byte;
             if (rioRead(&rdb, &byte, 1) == 0) goto eoferr;
+            record_pending = 1;
             continue; /* Read next opcode. */
         } else if (type == RDB_OPCODE_IDLE) {
             /* IDLE: LRU idle time. */
             if (rdbLoadLen(&rdb, NULL) == RDB_LENERR) goto eoferr;
+            record_pending = 1;
             continue; /* Read next opcode. */
         } else if (type == RDB_OPCODE_EOF) {
             /* EOF: End of file, exit the main loop. */
@@ -335,11 +500,14 @@ int redis_check_rdb(char *rdbfilename, FILE *fp) {
         /* Check if the key already expired. */
         if (expiretime != -1 && expiretime < now) rdbstate.already_expired++;
         if (expiretime != -1) rdbstate.expires++;
+        if (rdbStatsMode)
+            rdbStatsCollectKey(key->ptr, type, rdb.processed_bytes - record_start, expiretime, now);
         rdbstate.key = NULL;
         decrRefCount(key);
         decrRefCount(val);
         rdbstate.key_type = -1;
         expiretime = -1;
+        record_pending = 0;
     }
     /* Verify the checksum if RDB version is >= 5 */
     if (rdbver >= 5 && server.rdb_checksum) {
@@ -388,15 +556,21 @@ err:
  * C_ERR depending on the success or failure. */
 int redis_check_rdb_main(int argc, char **argv, FILE *fp) {
     struct timeval tv;
-
-    if (argc != 2 && fp == NULL) {
-        fprintf(stderr, "Usage: %s <rdb-file-name>\n", argv[0]);
-        exit(1);
-    } else if (!strcmp(argv[1], "-v") || !strcmp(argv[1], "--version")) {
-        sds version = getVersion();
-        printf("valkey-check-rdb %s\n", version);
-        sdsfree(version);
-        exit(0);
+    char *rdbfilename = argv[1];
+
+    if (fp == NULL) {
+        if (argc == 2 && (!strcmp(argv[1], "-v") || !strcmp(argv[1], "--version"))) {
+            sds version = getVersion();
+            printf("valkey-check-rdb %s\n", version);
+            sdsfree(version);
+            exit(0);
+        } else if (argc == 3 && !strcmp(argv[1], "--stats")) {
+            rdbStatsMode = 1;
+            rdbfilename = argv[2];
+        } else if (argc != 2) {
+            fprintf(stderr, "Usage: %s [--stats] <rdb-file-name>\n", argv[0]);
+            exit(1);
+        }
     }
 
     gettimeofday(&tv, NULL);
@@ -409,12 +583,14 @@ int redis_check_rdb_main(int argc, char **argv, FILE *fp) {
     server.loading_process_events_interval_bytes = 0;
     server.sanitize_dump_payload = SANITIZE_DUMP_YES;
     rdbCheckMode = 1;
-    rdbCheckInfo("Checking RDB file %s", argv[1]);
+    if (rdbStatsMode) rdbstats.prefixes = dictCreate(&prefixStatsDictType);
+    rdbCheckInfo("Checking RDB file %s", rdbfilename);
     rdbCheckSetupSignals();
-    int retval = redis_check_rdb(argv[1], fp);
+    int retval = redis_check_rdb(rdbfilename, fp);
     if (retval == 0) {
         rdbCheckInfo("\\o/ RDB looks OK! \\o/");
         rdbShowGenericInfo();
+        if (rdbStatsMode) rdbShowStats();
     }
     if (fp) return (retval == 0) ? C_OK : C_ERR;
     exit(retval);
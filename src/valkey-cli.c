@@ -236,6 +236,7 @@ static struct config {
     int get_functions_rdb_mode;
     int stat_mode;
     int scan_mode;
+    int commandlog_stacks_mode;
     int count;
     int intrinsic_latency_mode;
     int intrinsic_latency_duration;
@@ -299,6 +300,7 @@ size_t valkey_strlcpy(char *dst, const char *src, size_t dsize);
 static void cliPushHandler(void *, void *);
 
 uint16_t crc16(const char *buf, int len);
+static unsigned int clusterManagerKeyHashSlot(char *key, int keylen);
 
 static long long ustime(void) {
     struct timeval tv;
@@ -1707,6 +1709,177 @@ static int cliSendAsking(void) {
     return result;
 }
 
+/* -----------------------------------------------------------------------------
+ * Proactive cluster routing
+ *
+ * In cluster mode (-c), instead of waiting for -MOVED redirects (one round
+ * trip plus a reconnect per mis-routed key), fetch the slot map once, compute
+ * each key's slot locally and send the command straight to the owning node.
+ * Connections to previously visited nodes are parked and reused, so bulk jobs
+ * alternating between shards don't reconnect on every node switch. A -MOVED
+ * reply invalidates the map and the next routed command refetches it.
+ * -------------------------------------------------------------------------- */
+
+static struct {
+    int broken;  /* Slot map could not be obtained, fall back to redirects. */
+    int loaded;  /* Slot map is current; cleared when a -MOVED is seen. */
+    sds *addrs;  /* Unique "host:port" owner addresses. */
+    int numaddrs;
+    sds owner[CLUSTER_MANAGER_SLOTS]; /* Borrowed pointers into addrs, or NULL. */
+    dict *pool;                       /* "host:port" (sds) -> parked redisContext. */
+} cluster_routing;
+
+static dictType clusterRoutingPoolDictType = {
+    dictSdsHash,       /* hash function */
+    NULL,              /* key dup */
+    dictSdsKeyCompare, /* key compare */
+    dictSdsDestructor, /* key destructor */
+    NULL,              /* val destructor (contexts are freed explicitly) */
+    NULL               /* allow to expand */
+};
+
+static void clusterRoutingResetMap(void) {
+    for (int i = 0; i < cluster_routing.numaddrs; i++) sdsfree(cluster_routing.addrs[i]);
+    zfree(cluster_routing.addrs);
+    cluster_routing.addrs = NULL;
+    cluster_routing.numaddrs = 0;
+    memset(cluster_routing.owner, 0, sizeof(cluster_routing.owner));
+    cluster_routing.loaded = 0;
+}
+
+/* Populate the slot -> owner address map from CLUSTER SLOTS. On failure the
+ * routing layer is disabled and the cli degrades to reactive redirects. */
+static int clusterRoutingLoadMap(void) {
+    redisReply *reply = redisCommand(context, "CLUSTER SLOTS");
+
+    if (reply == NULL || reply->type != REDIS_REPLY_ARRAY || reply->elements == 0) {
+        cluster_routing.broken = 1;
+        if (reply) freeReplyObject(reply);
+        return REDIS_ERR;
+    }
+    clusterRoutingResetMap();
+    for (size_t i = 0; i < reply->elements; i++) {
+        redisReply *range = reply->element[i];
+        if (range->type != REDIS_REPLY_ARRAY || range->elements < 3) continue;
+        if (range->element[0]->type != REDIS_REPLY_INTEGER || range->element[1]->type != REDIS_REPLY_INTEGER) continue;
+        redisReply *node = range->element[2]; /* First node is the primary. */
+        if (node->type != REDIS_REPLY_ARRAY || node->elements < 2) continue;
+        if (node->element[0]->type != REDIS_REPLY_STRING || node->element[0]->len == 0) continue;
+
+        sds addr = sdscatfmt(sdsempty(), "%s:%i", node->element[0]->str, (int)node->element[1]->integer);
+        int j;
+        for (j = 0; j < cluster_routing.numaddrs; j++)
+            if (sdscmp(cluster_routing.addrs[j], addr) == 0) break;
+        if (j == cluster_routing.numaddrs) {
+            cluster_routing.addrs = zrealloc(cluster_routing.addrs, sizeof(sds) * (cluster_routing.numaddrs + 1));
+            cluster_routing.addrs[cluster_routing.numaddrs++] = addr;
+        } else {
+            sdsfree(addr);
+        }
+
+        long long first = range->element[0]->integer, last = range->element[1]->integer;
+        for (long long slot = first; slot >= 0 && slot <= last && slot < CLUSTER_MANAGER_SLOTS; slot++)
+            cluster_routing.owner[slot] = cluster_routing.addrs[j];
+    }
+    freeReplyObject(reply);
+    cluster_routing.loaded = 1;
+    return REDIS_OK;
+}
+
+/* Return the argv index of the command's first key, or 0 when the command has
+ * no key or its position can't be derived from the commands table. Only the
+ * common shape "command [subcommand] key ..." is recognized: commands whose
+ * first key comes after other arguments (EVAL and friends) keep using the
+ * reactive redirect path. */
+static int cliCommandFirstKeyPos(int argc, char **argv) {
+    struct commandDocs *cmd = NULL;
+    int pos = 1;
+
+    for (int i = 0; serverCommandTable[i].name != NULL; i++) {
+        if (!strcasecmp(serverCommandTable[i].name, argv[0])) {
+            cmd = &serverCommandTable[i];
+            break;
+        }
+    }
+    if (cmd == NULL) return 0;
+    if (cmd->subcommands != NULL) {
+        if (argc < 3) return 0;
+        struct commandDocs *sub = NULL;
+        for (int i = 0; cmd->subcommands[i].name != NULL; i++) {
+            if (!strcasecmp(cmd->subcommands[i].name, argv[1])) {
+                sub = &cmd->subcommands[i];
+                break;
+            }
+        }
+        if (sub == NULL) return 0;
+        cmd = sub;
+        pos = 2;
+    }
+    if (cmd->numargs < 1 || pos >= argc) return 0;
+    cliCommandArg *arg = &cmd->args[0];
+    if (arg->type == ARG_TYPE_KEY) return pos;
+    /* MSET-like commands: a repeated block whose first element is the key. */
+    if (arg->type == ARG_TYPE_BLOCK && arg->numsubargs > 0 && arg->subargs[0].type == ARG_TYPE_KEY) return pos;
+    return 0;
+}
+
+/* Switch the active connection to the owner of the command's first key,
+ * parking the current one for reuse. Silently does nothing whenever routing
+ * doesn't apply, so the caller always falls back to redirect handling. */
+static void cliClusterProactiveRoute(int argc, char **argv) {
+    if (!config.cluster_mode || cluster_routing.broken || context == NULL) return;
+    if (config.in_multi || config.pubsub_mode || config.cluster_send_asking) return;
+
+    int keypos = cliCommandFirstKeyPos(argc, argv);
+    if (keypos == 0) return;
+    if (!cluster_routing.loaded && clusterRoutingLoadMap() != REDIS_OK) return;
+
+    sds owner = cluster_routing.owner[clusterManagerKeyHashSlot(argv[keypos], strlen(argv[keypos]))];
+    if (owner == NULL) return;
+
+    sds current = sdscatfmt(sdsempty(), "%s:%i", config.conn_info.hostip, config.conn_info.hostport);
+    if (sdscmp(owner, current) == 0) {
+        sdsfree(current);
+        return;
+    }
+
+    /* Point conn_info at the owner, keeping the previous endpoint around in
+     * case the owner turns out to be unreachable. */
+    redisContext *prev = context;
+    sds prev_host = config.conn_info.hostip;
+    int prev_port = config.conn_info.hostport;
+    char *colon = strrchr(owner, ':');
+    config.conn_info.hostip = sdsnewlen(owner, colon - owner);
+    config.conn_info.hostport = atoi(colon + 1);
+
+    if (cluster_routing.pool == NULL) cluster_routing.pool = dictCreate(&clusterRoutingPoolDictType);
+    dictEntry *de = dictFind(cluster_routing.pool, owner);
+    if (de) {
+        context = dictGetVal(de);
+        dictDelete(cluster_routing.pool, owner);
+        resetConfig();
+    } else {
+        context = NULL;
+        if (cliConnect(CC_QUIET) != REDIS_OK) {
+            if (context) redisFree(context);
+            context = prev;
+            sdsfree(config.conn_info.hostip);
+            config.conn_info.hostip = prev_host;
+            config.conn_info.hostport = prev_port;
+            sdsfree(current);
+            return;
+        }
+    }
+
+    /* Park the previous connection for reuse on the next switch back. */
+    if (dictAdd(cluster_routing.pool, current, prev) != DICT_OK) {
+        redisFree(prev);
+        sdsfree(current);
+    }
+    sdsfree(prev_host);
+    cliRefreshPrompt();
+}
+
 static void cliPrintContextError(void) {
     if (context == NULL) return;
     fprintf(stderr, "Error: %s\n", context->errstr);
@@ -2217,6 +2390,9 @@ static int cliReadReply(int output_raw_strings) {
             printf("-> Redirected to slot [%d] located at %s:%d\n", slot, config.conn_info.hostip,
                    config.conn_info.hostport);
         config.cluster_reissue_command = 1;
+        /* The topology changed under us: refetch the slot map before the
+         * next proactively routed command. */
+        cluster_routing.loaded = 0;
         if (!strncmp(reply->str, "ASK ", 4)) {
             config.cluster_send_asking = 1;
         }
@@ -2645,6 +2821,8 @@ static int parseOptions(int argc, char **argv) {
             config.stat_mode = 1;
         } else if (!strcmp(argv[i], "--scan")) {
             config.scan_mode = 1;
+        } else if (!strcmp(argv[i], "--commandlog-stacks")) {
+            config.commandlog_stacks_mode = 1;
         } else if (!strcmp(argv[i], "--pattern") && !lastarg) {
             sdsfree(config.pattern);
             config.pattern = sdsnew(argv[++i]);
@@ -3016,6 +3194,8 @@ static void usage(int err) {
             "  --count <count>    Count option when using the --scan, --bigkeys or --hotkeys (default: 10).\n"
             "  --quoted-pattern <pat> Same as --pattern, but the specified string can be\n"
             "                         quoted, in order to pass an otherwise non binary-safe string.\n"
+            "  --commandlog-stacks Dump the sampled command trace (see commandlog-trace-sample-rate)\n"
+            "                     as folded stacks suitable for flamegraph.pl.\n"
             "  --intrinsic-latency <sec> Run a test to measure intrinsic system latency.\n"
             "                     The test will run for the specified amount of seconds.\n"
             "  --eval <file>      Send an EVAL command using the Lua script at <file>.\n"
@@ -3098,6 +3278,7 @@ static int issueCommandRepeat(int argc, char **argv, long repeat) {
                 return REDIS_ERR;
             }
         }
+        cliClusterProactiveRoute(argc, argv);
         if (cliSendCommand(argc, argv, repeat) != REDIS_OK) {
             cliPrintContextError();
             redisFree(context);
@@ -8598,14 +8779,23 @@ static void pipeMode(void) {
  * Find big keys
  *--------------------------------------------------------------------------- */
 
-static redisReply *sendScan(unsigned long long *it) {
-    redisReply *reply;
-
+/* Append a SCAN command to the pipeline without waiting for the reply, so
+ * that the server can start walking the next batch of buckets while we are
+ * still busy with the per-key commands of the current one. */
+static void appendScan(unsigned long long it) {
     if (config.pattern)
-        reply = redisCommand(context, "SCAN %llu MATCH %b COUNT %d", *it, config.pattern, sdslen(config.pattern),
-                             config.count);
+        redisAppendCommand(context, "SCAN %llu MATCH %b COUNT %d", it, config.pattern, sdslen(config.pattern),
+                           config.count);
     else
-        reply = redisCommand(context, "SCAN %llu COUNT %d", *it, config.count);
+        redisAppendCommand(context, "SCAN %llu COUNT %d", it, config.count);
+}
+
+/* Read and validate the reply of a SCAN appended with appendScan(), updating
+ * the cursor. */
+static redisReply *readScanReply(unsigned long long *it) {
+    redisReply *reply;
+
+    if (redisGetReply(context, (void **)&reply) != REDIS_OK) reply = NULL;
 
     /* Handle any error conditions */
     if (reply == NULL) {
@@ -8632,6 +8822,11 @@ static redisReply *sendScan(unsigned long long *it) {
     return reply;
 }
 
+static redisReply *sendScan(unsigned long long *it) {
+    appendScan(*it);
+    return readScanReply(it);
+}
+
 static int getDbSize(void) {
     redisReply *reply;
     int size;
@@ -8720,18 +8915,22 @@ static dictType typeinfoDictType = {
     NULL               /* allow to expand */
 };
 
-static void getKeyTypes(dict *types_dict, redisReply *keys, typeinfo **types) {
-    redisReply *reply;
+/* Append TYPE commands for a batch of keys to the pipeline. */
+static void pipelineKeyTypes(redisReply *keys) {
     unsigned int i;
 
-    /* Pipeline TYPE commands */
     for (i = 0; i < keys->elements; i++) {
         const char *argv[] = {"TYPE", keys->element[i]->str};
         size_t lens[] = {4, keys->element[i]->len};
         redisAppendCommandArgv(context, 2, argv, lens);
     }
+}
+
+/* Read the replies of the TYPE commands appended with pipelineKeyTypes(). */
+static void readKeyTypes(dict *types_dict, redisReply *keys, typeinfo **types) {
+    redisReply *reply;
+    unsigned int i;
 
-    /* Retrieve types */
     for (i = 0; i < keys->elements; i++) {
         if (redisGetReply(context, (void **)&reply) != REDIS_OK) {
             fprintf(stderr, "Error getting type for key '%s' (%d: %s)\n", keys->element[i]->str, context->err,
@@ -8759,15 +8958,16 @@ static void getKeyTypes(dict *types_dict, redisReply *keys, typeinfo **types) {
     }
 }
 
-static void
-getKeySizes(redisReply *keys, typeinfo **types, unsigned long long *sizes, int memkeys, unsigned memkeys_samples) {
-    redisReply *reply;
+/* Append size commands for a batch of keys to the pipeline. In memkeys mode
+ * the command is MEMORY USAGE for every key regardless of its type, so the
+ * caller may pass a NULL types array to pipeline the commands before the TYPE
+ * replies have been read. */
+static void pipelineKeySizes(redisReply *keys, typeinfo **types, int memkeys, unsigned memkeys_samples) {
     unsigned int i;
 
-    /* Pipeline size commands */
     for (i = 0; i < keys->elements; i++) {
         /* Skip keys that disappeared between SCAN and TYPE (or unknown types when not in memkeys mode) */
-        if (!types[i] || (!types[i]->sizecmd && !memkeys)) continue;
+        if (types && (!types[i] || (!types[i]->sizecmd && !memkeys))) continue;
 
         if (!memkeys) {
             const char *argv[] = {types[i]->sizecmd, keys->element[i]->str};
@@ -8785,12 +8985,26 @@ getKeySizes(redisReply *keys, typeinfo **types, unsigned long long *sizes, int m
             sdsfree(samplesstr);
         }
     }
+}
+
+/* Read the replies of the size commands appended with pipelineKeySizes(). */
+static void readKeySizes(redisReply *keys, typeinfo **types, unsigned long long *sizes, int memkeys) {
+    redisReply *reply;
+    unsigned int i;
 
-    /* Retrieve sizes */
     for (i = 0; i < keys->elements; i++) {
-        /* Skip keys that disappeared between SCAN and TYPE (or unknown types when not in memkeys mode) */
+        /* In memkeys mode a MEMORY USAGE was pipelined for every key, so a
+         * reply has to be consumed even for keys that turned out to be
+         * deleted. Otherwise skip the keys we didn't send a command for. */
         if (!types[i] || (!types[i]->sizecmd && !memkeys)) {
             sizes[i] = 0;
+            if (!memkeys) continue;
+            if (redisGetReply(context, (void **)&reply) != REDIS_OK) {
+                fprintf(stderr, "Error getting size for key '%s' (%d: %s)\n", keys->element[i]->str, context->err,
+                        context->errstr);
+                exit(1);
+            }
+            freeReplyObject(reply);
             continue;
         }
 
@@ -8863,13 +9077,18 @@ static void findBigKeys(int memkeys, unsigned memkeys_samples) {
     /* Use readonly in cluster */
     sendReadOnly();
 
+    /* Grab the first batch of keys. From here on each next SCAN is pipelined
+     * together with the per-key commands of the batch in hand, so the server
+     * walks the next buckets while we process the previous replies. */
+    reply = sendScan(&it);
+
     /* SCAN loop */
     do {
+        redisReply *next = NULL;
+
         /* Calculate approximate percentage completion */
         pct = 100 * (double)sampled / total_keys;
 
-        /* Grab some keys and point to the keys array */
-        reply = sendScan(&it);
         scan_loops++;
         keys = reply->element[1];
 
@@ -8886,9 +9105,17 @@ static void findBigKeys(int memkeys, unsigned memkeys_samples) {
             arrsize = keys->elements;
         }
 
-        /* Retrieve types and then sizes */
-        getKeyTypes(types_dict, keys, types);
-        getKeySizes(keys, types, sizes, memkeys, memkeys_samples);
+        /* Pipeline the next SCAN with this batch's TYPE commands. In memkeys
+         * mode MEMORY USAGE doesn't depend on the type, so it joins the same
+         * flight and the whole batch costs a single round trip. */
+        if (it != 0) appendScan(it);
+        pipelineKeyTypes(keys);
+        if (memkeys) pipelineKeySizes(keys, NULL, memkeys, memkeys_samples);
+
+        if (it != 0) next = readScanReply(&it);
+        readKeyTypes(types_dict, keys, types);
+        if (!memkeys) pipelineKeySizes(keys, types, memkeys, memkeys_samples);
+        readKeySizes(keys, types, sizes, memkeys);
 
         /* Now update our stats */
         for (i = 0; i < keys->elements; i++) {
@@ -8929,7 +9156,9 @@ static void findBigKeys(int memkeys, unsigned memkeys_samples) {
         }
 
         freeReplyObject(reply);
-    } while (force_cancel_loop == 0 && it != 0);
+        reply = next;
+    } while (force_cancel_loop == 0 && reply != NULL);
+    if (reply) freeReplyObject(reply);
 
     if (types) zfree(types);
     if (sizes) zfree(sizes);
@@ -9268,6 +9497,77 @@ static void scanMode(void) {
     exit(0);
 }
 
+/*------------------------------------------------------------------------------
+ * Commandlog folded stacks mode
+ *--------------------------------------------------------------------------- */
+
+/* Frames are joined with ';' and separated from the weight by a space in the
+ * folded stack format, so those characters cannot appear inside a frame. */
+static sds foldedStackCatFrame(sds stack, const char *frame, size_t len) {
+    for (size_t i = 0; i < len; i++) {
+        char ch = frame[i];
+        if (ch == ';' || isspace(ch) || !isprint(ch)) ch = '_';
+        stack = sdscatlen(stack, &ch, 1);
+    }
+    return stack;
+}
+
+static int foldedStackCompare(const void *a, const void *b) {
+    return sdscmp(*(sds *)a, *(sds *)b);
+}
+
+/* Fetch the sampled command trace (see the commandlog-trace-sample-rate
+ * directive) and aggregate it into folded stack lines, the input format of
+ * flamegraph.pl and similar tooling: "cmd;firstarg <samples>". Since the
+ * server records one command out of every N, a frame's width in the resulting
+ * flamegraph is proportional to how often that command/key was executed. */
+static void commandlogStacksMode(void) {
+    redisReply *reply = redisCommand(context, "COMMANDLOG GET -1 TRACE");
+    if (reply == NULL) {
+        fprintf(stderr, "I/O error while fetching the command trace\n");
+        exit(1);
+    } else if (reply->type == REDIS_REPLY_ERROR) {
+        fprintf(stderr, "COMMANDLOG GET TRACE error: %s\n", reply->str);
+        exit(1);
+    } else if (reply->elements == 0) {
+        fprintf(stderr, "The command trace is empty: make sure commandlog-trace-sample-rate\n"
+                        "is set and some traffic was served since it was enabled.\n");
+        freeReplyObject(reply);
+        exit(1);
+    }
+
+    /* One folded stack per trace entry: sorting them groups the duplicates
+     * so they can be counted in a single pass. */
+    sds *stacks = zmalloc(reply->elements * sizeof(sds));
+    size_t nstacks = 0;
+    for (size_t i = 0; i < reply->elements; i++) {
+        redisReply *entry = reply->element[i];
+        if (entry->type != REDIS_REPLY_ARRAY || entry->elements < 4) continue;
+        redisReply *argv = entry->element[3];
+        if (argv->type != REDIS_REPLY_ARRAY || argv->elements == 0) continue;
+        sds stack = sdsempty();
+        stack = foldedStackCatFrame(stack, argv->element[0]->str, argv->element[0]->len);
+        sdstolower(stack);
+        if (argv->elements > 1) {
+            stack = sdscatlen(stack, ";", 1);
+            stack = foldedStackCatFrame(stack, argv->element[1]->str, argv->element[1]->len);
+        }
+        stacks[nstacks++] = stack;
+    }
+    freeReplyObject(reply);
+
+    qsort(stacks, nstacks, sizeof(sds), foldedStackCompare);
+    for (size_t i = 0; i < nstacks;) {
+        size_t j = i + 1;
+        while (j < nstacks && sdscmp(stacks[i], stacks[j]) == 0) j++;
+        printf("%s %zu\n", stacks[i], j - i);
+        i = j;
+    }
+    for (size_t i = 0; i < nstacks; i++) sdsfree(stacks[i]);
+    zfree(stacks);
+    exit(0);
+}
+
 /*------------------------------------------------------------------------------
  * LRU test mode
  *--------------------------------------------------------------------------- */
@@ -9550,6 +9850,7 @@ int main(int argc, char **argv) {
     config.get_functions_rdb_mode = 0;
     config.stat_mode = 0;
     config.scan_mode = 0;
+    config.commandlog_stacks_mode = 0;
     config.count = 10;
     config.intrinsic_latency_mode = 0;
     config.pattern = NULL;
@@ -9713,6 +10014,12 @@ int main(int argc, char **argv) {
         scanMode();
     }
 
+    /* Commandlog folded stacks mode */
+    if (config.commandlog_stacks_mode) {
+        if (cliConnect(0) == REDIS_ERR) exit(1);
+        commandlogStacksMode();
+    }
+
     /* LRU test mode */
     if (config.lru_test_mode) {
         if (cliConnect(0) == REDIS_ERR) exit(1);
@@ -688,6 +688,23 @@ typedef struct ValkeyModuleClientInfo {
 
 #define VALKEYMODULE_CLIENTINFO_INITIALIZER_V1 {.version = 1}
 
+/* One executed command as recorded by the command tracing ring, see
+ * ValkeyModule_CommandTraceStart(). */
+#define VALKEYMODULE_COMMANDTRACE_VERSION 1
+typedef struct ValkeyModuleCommandTrace {
+    uint64_t id;           /* Monotonic id assigned at recording time. */
+    uint64_t key_hash;     /* Hash slot of the first key, or
+                              VALKEYMODULE_CMDTRACE_NO_KEY. */
+    uint64_t duration_us;  /* Main thread execution time in microseconds. */
+    uint64_t reply_bytes;  /* Size of the produced reply. */
+    char cmdname[64];      /* Lowercase command name, null terminated. */
+} ValkeyModuleCommandTraceV1;
+
+#define ValkeyModuleCommandTrace ValkeyModuleCommandTraceV1
+
+/* key_hash value for commands that take no keys. */
+#define VALKEYMODULE_CMDTRACE_NO_KEY UINT64_MAX
+
 #define VALKEYMODULE_REPLICATIONINFO_VERSION 1
 typedef struct ValkeyModuleReplicationInfo {
     uint64_t version;      /* Not used since this structure is never passed
@@ -1743,6 +1760,11 @@ VALKEYMODULE_API int (*ValkeyModule_CommandFilterArgDelete)(ValkeyModuleCommandF
                                                             int pos) VALKEYMODULE_ATTR;
 VALKEYMODULE_API unsigned long long (*ValkeyModule_CommandFilterGetClientId)(ValkeyModuleCommandFilterCtx *fctx)
     VALKEYMODULE_ATTR;
+VALKEYMODULE_API int (*ValkeyModule_CommandTraceStart)(ValkeyModuleCtx *ctx, size_t ring_size) VALKEYMODULE_ATTR;
+VALKEYMODULE_API int (*ValkeyModule_CommandTraceStop)(ValkeyModuleCtx *ctx) VALKEYMODULE_ATTR;
+VALKEYMODULE_API size_t (*ValkeyModule_CommandTracePoll)(uint64_t *cursor,
+                                                         ValkeyModuleCommandTrace *entries,
+                                                         size_t count) VALKEYMODULE_ATTR;
 VALKEYMODULE_API int (*ValkeyModule_Fork)(ValkeyModuleForkDoneHandler cb, void *user_data) VALKEYMODULE_ATTR;
 VALKEYMODULE_API void (*ValkeyModule_SendChildHeartbeat)(double progress) VALKEYMODULE_ATTR;
 VALKEYMODULE_API int (*ValkeyModule_ExitFromChild)(int retcode) VALKEYMODULE_ATTR;
@@ -2200,6 +2222,9 @@ static int ValkeyModule_Init(ValkeyModuleCtx *ctx, const char *name, int ver, in
     VALKEYMODULE_GET_API(CommandFilterArgReplace);
     VALKEYMODULE_GET_API(CommandFilterArgDelete);
     VALKEYMODULE_GET_API(CommandFilterGetClientId);
+    VALKEYMODULE_GET_API(CommandTraceStart);
+    VALKEYMODULE_GET_API(CommandTraceStop);
+    VALKEYMODULE_GET_API(CommandTracePoll);
     VALKEYMODULE_GET_API(Fork);
     VALKEYMODULE_GET_API(SendChildHeartbeat);
     VALKEYMODULE_GET_API(ExitFromChild);
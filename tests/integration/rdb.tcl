@@ -295,6 +295,48 @@ test {client freed during loading} {
     }
 }
 
+test {loading-serve-reads serves already loaded keys during loading} {
+    start_server [list overrides [list key-load-delay 50 loading-process-events-interval-bytes 1024 rdbcompression no save "900 1" loading-serve-reads yes]] {
+        # create a big rdb that will take long to load, so there is a wide
+        # window where the dataset is only partially in the keyspace.
+        r debug populate 100000 key 1000
+
+        restart_server 0 false false
+
+        # make sure it's still loading
+        assert_equal [s loading] 1
+
+        # writes and reads of keys that are not in the keyspace yet (or
+        # simply don't exist) are still refused.
+        assert_error "*LOADING*" {r set somekey somevalue}
+        assert_error "*LOADING*" {r get nonexisting-key-123}
+
+        # a loaded key becomes readable while the load is still running
+        set served_during_loading 0
+        for {set i 0} {$i < 200} {incr i} {
+            set err [catch {r get key:1} res]
+            if {!$err} {
+                if {[s loading] == 1} {
+                    set served_during_loading 1
+                    assert_match "value:1*" $res
+                }
+                break
+            }
+            assert_match "*LOADING*" $res
+            after 50
+        }
+        assert_equal 1 $served_during_loading
+
+        # let the load finish and verify nothing was lost
+        wait_for_condition 1000 100 {
+            [s loading] == 0
+        } else {
+            fail "loading didn't finish"
+        }
+        assert_equal 100000 [r dbsize]
+    }
+}
+
 start_server {} {
     test {Test RDB load info} {
         r debug populate 1000
@@ -498,3 +540,41 @@ start_server {} {
 }
 
 } ;# tags
+
+start_server {} {
+    test {RESTOREDB atomically swaps in the dataset from an RDB file} {
+        r config set save ""
+        for {set j 0} {$j < 1000} {incr j} {r set new:$j v$j}
+        r save
+        set dir [lindex [r config get dir] 1]
+        file copy -force [file join $dir dump.rdb] [file join $dir replacement.rdb]
+
+        r flushall
+        for {set j 0} {$j < 100} {incr j} {r set old:$j v$j}
+        assert_equal 100 [r dbsize]
+
+        assert_equal {OK} [r restoredb replacement.rdb]
+        assert_equal 1000 [r dbsize]
+        assert_equal {v7} [r get new:7]
+        assert_equal {} [r get old:7]
+    }
+
+    test {RESTOREDB with a missing file leaves the dataset unchanged} {
+        assert_error "*Can't open the RDB file*" {r restoredb no-such-file.rdb}
+        assert_equal 1000 [r dbsize]
+    }
+
+    test {RESTOREDB with a corrupt file leaves the dataset unchanged} {
+        set dir [lindex [r config get dir] 1]
+        set in [open [file join $dir replacement.rdb] rb]
+        set data [read $in 64]
+        close $in
+        set out [open [file join $dir corrupt.rdb] wb]
+        puts -nonewline $out $data
+        close $out
+
+        assert_error "*Error loading the RDB file*" {r restoredb corrupt.rdb}
+        assert_equal 1000 [r dbsize]
+        assert_equal {v7} [r get new:7]
+    }
+}
@@ -0,0 +1,159 @@
+/* Test module for the command tracing ring API: starts the ring, drains it
+ * from a background thread (without the GIL, as a real consumer would), and
+ * exposes the aggregated result back to the test suite. */
+
+#include "valkeymodule.h"
+
+#include <pthread.h>
+#include <string.h>
+#include <strings.h>
+#include <unistd.h>
+
+#define CMDTRACE_KEEP 1024
+
+static pthread_t poller_thread;
+static int poller_running = 0;
+static volatile int poller_stop = 0;
+
+/* Traces drained by the poller thread, kept under a mutex so the command
+ * handlers can inspect them from the main thread. */
+static pthread_mutex_t traces_mutex = PTHREAD_MUTEX_INITIALIZER;
+static ValkeyModuleCommandTrace traces[CMDTRACE_KEEP];
+static size_t num_traces = 0;
+static long long total_traces = 0;
+
+static void *CmdTrace_PollerMain(void *arg) {
+    (void) arg;
+    uint64_t cursor = 0;
+    ValkeyModuleCommandTrace batch[64];
+
+    while (!poller_stop) {
+        size_t n = ValkeyModule_CommandTracePoll(&cursor, batch, 64);
+        if (n == 0) {
+            usleep(1000);
+            continue;
+        }
+        pthread_mutex_lock(&traces_mutex);
+        for (size_t i = 0; i < n; i++) {
+            if (num_traces < CMDTRACE_KEEP) traces[num_traces++] = batch[i];
+            total_traces++;
+        }
+        pthread_mutex_unlock(&traces_mutex);
+    }
+    return NULL;
+}
+
+/* cmdtrace.start [ring-size] */
+int CmdTrace_Start(ValkeyModuleCtx *ctx, ValkeyModuleString **argv, int argc) {
+    long long ring_size = 0;
+    if (argc > 2) return ValkeyModule_WrongArity(ctx);
+    if (argc == 2 && ValkeyModule_StringToLongLong(argv[1], &ring_size) != VALKEYMODULE_OK)
+        return ValkeyModule_ReplyWithError(ctx, "ERR invalid ring size");
+
+    if (poller_running)
+        return ValkeyModule_ReplyWithError(ctx, "ERR tracing already started");
+    if (ValkeyModule_CommandTraceStart(ctx, ring_size) != VALKEYMODULE_OK)
+        return ValkeyModule_ReplyWithError(ctx, "ERR failed to start tracing");
+
+    pthread_mutex_lock(&traces_mutex);
+    num_traces = 0;
+    total_traces = 0;
+    pthread_mutex_unlock(&traces_mutex);
+
+    poller_stop = 0;
+    if (pthread_create(&poller_thread, NULL, CmdTrace_PollerMain, NULL) != 0) {
+        ValkeyModule_CommandTraceStop(ctx);
+        return ValkeyModule_ReplyWithError(ctx, "ERR failed to start poller thread");
+    }
+    poller_running = 1;
+    return ValkeyModule_ReplyWithSimpleString(ctx, "OK");
+}
+
+/* cmdtrace.stop */
+int CmdTrace_Stop(ValkeyModuleCtx *ctx, ValkeyModuleString **argv, int argc) {
+    (void) argv;
+    if (argc != 1) return ValkeyModule_WrongArity(ctx);
+    if (!poller_running)
+        return ValkeyModule_ReplyWithError(ctx, "ERR tracing not started");
+
+    ValkeyModule_CommandTraceStop(ctx);
+    poller_stop = 1;
+    pthread_join(poller_thread, NULL);
+    poller_running = 0;
+    return ValkeyModule_ReplyWithSimpleString(ctx, "OK");
+}
+
+/* cmdtrace.count — total number of traces drained by the poller thread. */
+int CmdTrace_Count(ValkeyModuleCtx *ctx, ValkeyModuleString **argv, int argc) {
+    (void) argv;
+    if (argc != 1) return ValkeyModule_WrongArity(ctx);
+    pthread_mutex_lock(&traces_mutex);
+    long long count = total_traces;
+    pthread_mutex_unlock(&traces_mutex);
+    return ValkeyModule_ReplyWithLongLong(ctx, count);
+}
+
+/* cmdtrace.find <cmdname> — number of drained traces for the command, plus
+ * the key hash and reply size of the most recent one. Key hash is -1 for
+ * keyless commands. */
+int CmdTrace_Find(ValkeyModuleCtx *ctx, ValkeyModuleString **argv, int argc) {
+    if (argc != 2) return ValkeyModule_WrongArity(ctx);
+    size_t namelen;
+    const char *name = ValkeyModule_StringPtrLen(argv[1], &namelen);
+
+    long long count = 0;
+    long long key_hash = -1;
+    long long reply_bytes = -1;
+    pthread_mutex_lock(&traces_mutex);
+    for (size_t i = 0; i < num_traces; i++) {
+        if (strlen(traces[i].cmdname) != namelen ||
+            strncasecmp(traces[i].cmdname, name, namelen) != 0) continue;
+        count++;
+        key_hash = traces[i].key_hash == VALKEYMODULE_CMDTRACE_NO_KEY ?
+            -1 : (long long) traces[i].key_hash;
+        reply_bytes = (long long) traces[i].reply_bytes;
+    }
+    pthread_mutex_unlock(&traces_mutex);
+
+    ValkeyModule_ReplyWithArray(ctx, 3);
+    ValkeyModule_ReplyWithLongLong(ctx, count);
+    ValkeyModule_ReplyWithLongLong(ctx, key_hash);
+    ValkeyModule_ReplyWithLongLong(ctx, reply_bytes);
+    return VALKEYMODULE_OK;
+}
+
+int ValkeyModule_OnLoad(ValkeyModuleCtx *ctx, ValkeyModuleString **argv, int argc) {
+    (void) argv;
+    (void) argc;
+
+    if (ValkeyModule_Init(ctx, "cmdtrace", 1, VALKEYMODULE_APIVER_1) == VALKEYMODULE_ERR)
+        return VALKEYMODULE_ERR;
+
+    if (ValkeyModule_CreateCommand(ctx, "cmdtrace.start",
+                CmdTrace_Start, "", 0, 0, 0) == VALKEYMODULE_ERR)
+        return VALKEYMODULE_ERR;
+
+    if (ValkeyModule_CreateCommand(ctx, "cmdtrace.stop",
+                CmdTrace_Stop, "", 0, 0, 0) == VALKEYMODULE_ERR)
+        return VALKEYMODULE_ERR;
+
+    if (ValkeyModule_CreateCommand(ctx, "cmdtrace.count",
+                CmdTrace_Count, "", 0, 0, 0) == VALKEYMODULE_ERR)
+        return VALKEYMODULE_ERR;
+
+    if (ValkeyModule_CreateCommand(ctx, "cmdtrace.find",
+                CmdTrace_Find, "", 0, 0, 0) == VALKEYMODULE_ERR)
+        return VALKEYMODULE_ERR;
+
+    return VALKEYMODULE_OK;
+}
+
+int ValkeyModule_OnUnload(ValkeyModuleCtx *ctx) {
+    (void) ctx;
+    if (poller_running) {
+        poller_stop = 1;
+        pthread_join(poller_thread, NULL);
+        poller_running = 0;
+    }
+    return VALKEYMODULE_OK;
+}
@@ -30,6 +30,26 @@ start_server {tags {"auth external:skip"} overrides {requirepass foobar}} {
         r incr foo
     } {101}
 
+    test {Trusted Unix socket peer can run commands without AUTH} {
+        set sockpath [lindex [r config get unixsocket] 1]
+        r config set unixsocket-trust-peer-uid yes
+        assert_equal {PONG} [exec {*}[valkeycli_unixsocket $sockpath ping]]
+        r config set unixsocket-trust-peer-uid no
+        catch {exec {*}[valkeycli_unixsocket $sockpath ping]} e
+        assert_match {*NOAUTH*} $e
+    }
+
+    test {Trusted Unix socket peer cannot use a disabled default user} {
+        set sockpath [lindex [r config get unixsocket] 1]
+        r config set unixsocket-trust-peer-uid yes
+        r acl setuser default off
+        catch {exec {*}[valkeycli_unixsocket $sockpath ping]} e
+        assert_match {*NOAUTH*} $e
+        r acl setuser default on
+        assert_equal {PONG} [exec {*}[valkeycli_unixsocket $sockpath ping]]
+        r config set unixsocket-trust-peer-uid no
+    }
+
     test {For unauthenticated clients multibulk and bulk length are limited} {
         set rr [valkey [srv "host"] [srv "port"] 0 $::tls]
         $rr write "*100\r\n"
@@ -0,0 +1,82 @@
+start_server {tags {"changelog"}} {
+    test {CHANGELOG is disabled by default} {
+        assert_error "*disabled*" {r changelog 0}
+    }
+
+    test {CHANGELOG records key modifications in order} {
+        r config set changelog-ring-size 1024
+        r set k1 v1
+        r set k2 v2
+        r del k1
+        set res [r changelog 0]
+        lassign $res next lost records
+        assert_equal 0 $lost
+        assert_equal 3 [llength $records]
+        assert_equal $next [lindex $records end 0]
+        # Versions are strictly increasing.
+        set prev 0
+        foreach rec $records {
+            assert {[lindex $rec 0] > $prev}
+            set prev [lindex $rec 0]
+        }
+        # Same key, same hash: k2 never changed but k1 was set and deleted.
+        assert_equal [lindex $records 0 2] [lindex $records 2 2]
+    }
+
+    test {CHANGELOG cursor resumes where the last drain stopped} {
+        lassign [r changelog 0] cursor lost records
+        assert_equal {} [lindex [r changelog $cursor] 2]
+        r set k3 v3
+        lassign [r changelog $cursor] next lost records
+        assert_equal 1 [llength $records]
+        assert_equal 0 $lost
+    }
+
+    test {CHANGELOG COUNT limits the returned records} {
+        r config set changelog-ring-size 1024
+        for {set i 0} {$i < 10} {incr i} {
+            r set key:$i $i
+        }
+        lassign [r changelog 0 count 4] next lost records
+        assert_equal 4 [llength $records]
+        lassign [r changelog $next count 1000] next2 lost records2
+        assert {[llength $records2] > 0}
+        assert {[lindex $records2 0 0] > [lindex $records end 0]}
+    }
+
+    test {CHANGELOG reports loss when a consumer falls behind the ring} {
+        r config set changelog-ring-size 16
+        for {set i 0} {$i < 100} {incr i} {
+            r set churn:$i $i
+        }
+        lassign [r changelog 0] next lost records
+        assert_equal 1 $lost
+        assert {[llength $records] <= 16}
+    }
+
+    test {CHANGELOG survives a ring resize with a monotonic cursor} {
+        r config set changelog-ring-size 1024
+        r set after-resize v
+        lassign [r changelog 0] next lost records
+        # Old records were dropped by the resize, so loss is reported, but
+        # the version counter did not restart.
+        assert_equal 1 $lost
+        assert {$next > 100}
+    }
+
+    test {CHANGELOG rejects bad cursors and counts} {
+        assert_error "*out of range*" {r changelog -1}
+        assert_error "*out of range*" {r changelog 0 count 0}
+        assert_error "*syntax*" {r changelog 0 bogus 3}
+    }
+
+    test {CHANGELOG rejects a cursor past the head} {
+        lassign [r changelog 0] head lost records
+        assert_error "*out of range*" {r changelog [expr {$head + 1}]}
+        assert_error "*out of range*" {r changelog [expr {$head + 1}] count 9223372036854775807}
+        # The head itself is a valid cursor and returns nothing.
+        lassign [r changelog $head] next lost records
+        assert_equal $head $next
+        assert_equal {} $records
+    }
+}
@@ -0,0 +1,145 @@
+start_server {tags {"cmsketch"}} {
+    test {CMSINCRBY creates the key and returns updated estimates} {
+        r del cms
+        assert_equal {5} [r cmsincrby cms foo 5]
+        assert_equal {8} [r cmsincrby cms foo 3]
+        assert_equal {1 8} [r cmsincrby cms bar 1 foo 0]
+        assert_equal 1 [r exists cms]
+    }
+
+    test {CMSQUERY returns estimates, zero for unseen items} {
+        assert_equal {8 1 0} [r cmsquery cms foo bar never-seen]
+    }
+
+    test {CMSQUERY against a missing key returns all zeros} {
+        r del cms-missing
+        assert_equal {0 0} [r cmsquery cms-missing a b]
+    }
+
+    test {Count-min estimates never under-count} {
+        r del cms-dense
+        for {set i 0} {$i < 5000} {incr i} {
+            r cmsincrby cms-dense item:$i 1
+        }
+        r cmsincrby cms-dense hot 1000
+        # Collisions may inflate the estimate but can never deflate it.
+        assert {[r cmsquery cms-dense hot] >= 1000}
+        for {set i 0} {$i < 100} {incr i} {
+            assert {[r cmsquery cms-dense item:$i] >= 1}
+        }
+    }
+
+    test {CMSMERGE sums counters across sketches} {
+        r del cms-a cms-b cms-dst
+        r cmsincrby cms-a x 10 y 5
+        r cmsincrby cms-b x 7
+        assert_equal {OK} [r cmsmerge cms-dst cms-a cms-b cms-nonexisting]
+        assert_equal {17} [r cmsquery cms-dst x]
+        assert_equal {5} [r cmsquery cms-dst y]
+    }
+
+    test {CMSMERGE with a bad source does not create the destination} {
+        r del cms-dst cms-bad-src
+        r lpush cms-bad-src x
+        assert_error "WRONGTYPE*" {r cmsmerge cms-dst cms-bad-src}
+        assert_equal 0 [r exists cms-dst]
+    }
+
+    test {CMSINFO reports geometry and total count} {
+        r del cms-info
+        r cmsincrby cms-info a 3 b 4
+        set res [r cmsinfo cms-info]
+        assert_equal 2048 [dict get $res width]
+        assert_equal 5 [dict get $res depth]
+        assert_equal 7 [dict get $res count]
+        assert_equal [r strlen cms-info] [dict get $res size]
+    }
+
+    test {CMSINFO against a missing key reports an error} {
+        r del cms-missing
+        assert_error "*no such key*" {r cmsinfo cms-missing}
+    }
+
+    test {CMS commands reject keys holding other types} {
+        r del not-a-cms
+        r lpush not-a-cms x
+        assert_error "WRONGTYPE*" {r cmsincrby not-a-cms a 1}
+        assert_error "WRONGTYPE*" {r cmsquery not-a-cms a}
+        r del not-a-cms
+        r set not-a-cms "plain string"
+        assert_error "*Corrupted CMS*" {r cmsquery not-a-cms a}
+    }
+
+    test {CMSINCRBY rejects negative increments} {
+        r del cms-neg
+        assert_error "*non negative*" {r cmsincrby cms-neg a -1}
+        assert_equal 0 [r exists cms-neg]
+    }
+
+    test {Count-min sketch survives DEBUG RELOAD} {
+        r del cms-reload
+        r cmsincrby cms-reload alpha 100 beta 42
+        r debug reload
+        assert_equal {100 42} [r cmsquery cms-reload alpha beta]
+    } {} {needs:debug}
+
+    test {TOPKADD without contention evicts nothing} {
+        r del tk
+        assert_equal {{} {} {}} [r topkadd tk a b c]
+        assert_equal {{} {}} [r topkadd tk a a]
+    }
+
+    test {TOPKLIST returns items sorted by descending count} {
+        assert_equal {a 3 0 b 1 0 c 1 0} [r topklist tk]
+    }
+
+    test {TOPKLIST against a missing key returns an empty summary} {
+        r del tk-missing
+        assert_equal {} [r topklist tk-missing]
+    }
+
+    test {Top-K summary keeps heavy hitters under churn} {
+        r del tk-churn
+        # Heavy items get 200 occurrences each, noise items one each.
+        for {set i 0} {$i < 200} {incr i} {
+            r topkadd tk-churn heavy:1 heavy:2 heavy:3
+            r topkadd tk-churn noise:[expr {$i * 7}] noise:[expr {$i * 7 + 1}]
+        }
+        set listed [r topklist tk-churn]
+        foreach heavy {heavy:1 heavy:2 heavy:3} {
+            assert {[lsearch $listed $heavy] != -1}
+        }
+    }
+
+    test {TOPKADD reports the displaced candidate once slots are full} {
+        r del tk-full
+        # Fill all ten slots, then push an eleventh distinct item twice so
+        # it must displace a minimum-count candidate.
+        for {set i 0} {$i < 10} {incr i} {
+            r topkadd tk-full filler:$i
+        }
+        set res [r topkadd tk-full newcomer]
+        assert_match {filler:*} [lindex $res 0]
+    }
+
+    test {TOPKADD rejects oversized items} {
+        r del tk-big
+        assert_error "*too long*" {r topkadd tk-big [string repeat x 300]}
+    }
+
+    test {TOPK commands reject keys holding other types} {
+        r del not-a-topk
+        r sadd not-a-topk x
+        assert_error "WRONGTYPE*" {r topkadd not-a-topk a}
+        r del not-a-topk
+        r set not-a-topk "plain string"
+        assert_error "*Corrupted TOPK*" {r topklist not-a-topk}
+    }
+
+    test {Top-K summary survives DEBUG RELOAD} {
+        r del tk-reload
+        r topkadd tk-reload a a a b
+        r debug reload
+        assert_equal {a 3 0 b 1 0} [r topklist tk-reload]
+    } {} {needs:debug}
+}
@@ -358,4 +358,32 @@ start_server {tags {"commandlog"} overrides {commandlog-execution-slower-than 10
             assert_equal {test-client} [lindex $ping_cmd 5]
         }
     }
+
+    test {COMMANDLOG trace - samples one command out of every N} {
+        r commandlog reset trace
+        assert_equal [r commandlog len trace] 0
+
+        # Disabled by default.
+        for {set i 0} {$i < 10} {incr i} {
+            r ping
+        }
+        assert_equal [r commandlog len trace] 0
+
+        r config set commandlog-trace-sample-rate 5
+        for {set i 0} {$i < 50} {incr i} {
+            r ping
+        }
+        # The config set itself may or may not be sampled, and external
+        # servers see other traffic, so only check the lower bound.
+        assert {[r commandlog len trace] >= 10}
+
+        # The entry value is a microsecond timestamp of the execution.
+        set entry [lindex [r commandlog get 1 trace] 0]
+        assert {[lindex $entry 2] > [expr {[lindex $entry 1] * 1000000 - 1000000}]}
+
+        r config set commandlog-trace-sample-rate -1
+        r commandlog reset trace
+        r ping
+        assert_equal [r commandlog len trace] 0
+    }
 }
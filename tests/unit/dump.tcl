@@ -144,6 +144,59 @@ start_server {tags {"dump"}} {
         r dump nonexisting_key
     } {}
 
+    test {DUMP CHUNKED chunks concatenate to the whole payload} {
+        r del mylist
+        for {set j 0} {$j < 1000} {incr j} {r rpush mylist "item-$j"}
+        set encoded [r dump mylist]
+        set chunks {}
+        set cursor 0
+        while 1 {
+            set res [r dump mylist chunked $cursor 100]
+            set cursor [lindex $res 0]
+            append chunks [lindex $res 1]
+            if {$cursor == 0} break
+        }
+        assert_equal [string length $encoded] [string length $chunks]
+        assert_equal $encoded $chunks
+    }
+
+    test {RESTORE CHUNKED rebuilds the original value} {
+        set encoded [r dump mylist]
+        r del mylist
+        set cursor 0
+        set len [string length $encoded]
+        for {set off 0} {$off < $len} {incr off 100} {
+            set chunk [string range $encoded $off [expr {$off+99}]]
+            set cursor [r restore mylist 0 $chunk chunked $cursor]
+        }
+        assert_equal {OK} [r restore mylist 0 {} chunked $cursor]
+        assert_equal 1000 [r llen mylist]
+        assert_equal {item-42} [r lindex mylist 42]
+        r del mylist
+    }
+
+    test {DUMP and RESTORE CHUNKED reject a stale cursor} {
+        r set foo bar
+        set res [r dump foo chunked 0 1]
+        assert {[lindex $res 0] != 0}
+        assert_error "*Invalid dump cursor*" {r dump foo chunked 12345 1}
+        assert_error "*Invalid restore cursor*" {r restore newkey 0 {} chunked 999}
+    }
+
+    test {RESTORE CHUNKED propagates a single plain RESTORE} {
+        set repl [attach_to_replication_stream]
+        r set foo bar
+        set encoded [r dump foo]
+        set cursor [r restore foo 0 $encoded chunked 0]
+        assert_equal {OK} [r restore foo 0 {} chunked $cursor replace]
+        assert_replication_stream $repl {
+            {select *}
+            {set foo bar}
+            {restore foo 0 * replace}
+        }
+        close_replication_stream $repl
+    } {} {needs:repl}
+
     test {MIGRATE is caching connections} {
         # Note, we run this as first test so that the connection cache
         # is empty.
@@ -425,3 +478,55 @@ start_server {tags {"dump"}} {
         }
     } {} {external:skip}
 }
+
+start_server {tags {"dump"} overrides {dump-payload-cache-size 1mb}} {
+    test {DUMP of an unmodified key returns identical bytes on repeats} {
+        r set cached-key "some payload worth caching"
+        set first [r dump cached-key]
+        set second [r dump cached-key]
+        assert_equal $first $second
+        r del cached-key
+        r restore cached-key 0 $first
+        r get cached-key
+    } {some payload worth caching}
+
+    test {Cached DUMP payload is dropped when the key is modified} {
+        r set cached-key "before"
+        r dump cached-key
+        r append cached-key "-after"
+        set encoded [r dump cached-key]
+        r del cached-key
+        r restore cached-key 0 $encoded
+        r get cached-key
+    } {before-after}
+
+    test {Cached DUMP payload does not survive FLUSHALL} {
+        r set cached-key "first life"
+        r dump cached-key
+        r flushall
+        r set cached-key "second life"
+        set encoded [r dump cached-key]
+        r del cached-key
+        r restore cached-key 0 $encoded
+        r get cached-key
+    } {second life}
+
+    test {DUMP works with the payload cache disabled at runtime} {
+        r config set dump-payload-cache-size 0
+        r set cached-key "uncached"
+        set first [r dump cached-key]
+        assert_equal $first [r dump cached-key]
+        r config set dump-payload-cache-size 1mb
+        r get cached-key
+    } {uncached}
+
+    test {Payloads over the cache budget are still dumped correctly} {
+        r config set dump-payload-cache-size 1024
+        r set big-key [string repeat x 4096]
+        set encoded [r dump big-key]
+        r del big-key
+        r restore big-key 0 $encoded
+        assert_equal 4096 [r strlen big-key]
+        r config set dump-payload-cache-size 1mb
+    }
+}
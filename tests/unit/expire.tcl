@@ -828,10 +828,11 @@ start_server {tags {"expire"}} {
 
         r scan 0
 
+        # Both keys expire within one execution unit, so their deletions
+        # coalesce into a single multi-key UNLINK (and no MULTI/EXEC).
         assert_replication_stream $repl {
             {select *}
-            {unlink foo*}
-            {unlink foo*}
+            {unlink foo* foo*}
         }
         close_replication_stream $repl
         assert_equal [r debug set-active-expire 1] {OK}
@@ -849,10 +850,10 @@ start_server {tags {"expire"}} {
 
         r randomkey
 
+        # As with SCAN above, the two deletions coalesce into one UNLINK.
         assert_replication_stream $repl {
             {select *}
-            {unlink foo*}
-            {unlink foo*}
+            {unlink foo* foo*}
         }
         close_replication_stream $repl
         assert_equal [r debug set-active-expire 1] {OK}
@@ -871,6 +872,33 @@ start_server {tags {"expire"}} {
         assert_match {*flags=N*} [r client list id [r client id]]
     }
 
+    test {Active expire: mass expiry coalesces deletions into a multi-key UNLINK} {
+        r flushall
+        r debug set-active-expire 0
+
+        # Give all keys the same absolute deadline so a single expire cycle
+        # burst reclaims them together.
+        set deadline [expr [clock milliseconds]+100]
+        for {set j 1} {$j <= 5} {incr j} {
+            r set foo$j bar pxat $deadline
+        }
+
+        set repl [attach_to_replication_stream]
+        r debug set-active-expire 1
+
+        wait_for_condition 40 100 {
+            [r dbsize] eq 0
+        } else {
+            fail "Keys did not actively expire."
+        }
+
+        assert_replication_stream $repl {
+            {select *}
+            {unlink foo* foo* foo* foo* foo*}
+        }
+        close_replication_stream $repl
+    } {} {needs:debug}
+
     test {Import mode should forbid active expiration} {
         r flushall
 
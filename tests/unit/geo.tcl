@@ -342,7 +342,9 @@ start_server {tags {"geo"}} {
     test {GEORADIUSBYMEMBER crossing pole search} {
         r del k1
         r geoadd k1 45 65 n1 -135 85.05 n2
-        set ret [r GEORADIUSBYMEMBER k1 n1 5009431 m]
+        # No sorting requested: the scan visits the covering score ranges in
+        # score order, so compare as a set.
+        set ret [lsort [r GEORADIUSBYMEMBER k1 n1 5009431 m]]
         assert_equal $ret {n1 n2}
     }
 
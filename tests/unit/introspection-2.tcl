@@ -241,6 +241,44 @@ start_server {tags {"introspection"}} {
         assert_equal {{}} [r command info config|get|key]
     }
 
+    test {DEBUG OBJECT-CENSUS buckets sampled keys by type and encoding} {
+        r flushall
+        r debug populate 100
+        r rpush census_list a b c
+        r set census_vol x ex 100
+        set census [r debug object-census 5000]
+        assert_equal 102 [dict get $census keys]
+        assert_equal 5000 [dict get $census sampled]
+        set strings [dict get $census string:embstr]
+        assert {[dict get $strings count] > 0}
+        assert {[dict get $strings volatile] > 0}
+        assert {[dict get $strings bytes] > 0}
+        assert {[dict get [dict get $census list:listpack] count] > 0}
+        assert_error "*samples must be between*" {r debug object-census 0}
+        r flushall
+    }
+
+    test {DEBUG OBJECT-SAMPLES returns key/freq/idle/size tuples} {
+        r flushall
+        r debug populate 100
+        set tuples [r debug object-samples 10]
+        assert_equal 10 [llength $tuples]
+        foreach tuple $tuples {
+            lassign $tuple key freq idle size
+            assert_match "key:*" $key
+            # Under the default LRU policy freq is not tracked.
+            assert_equal -1 $freq
+            assert {$idle >= 0}
+            assert {$size > 0}
+        }
+        r config set maxmemory-policy allkeys-lfu
+        lassign [lindex [r debug object-samples 1] 0] key freq idle size
+        assert {$freq >= 0}
+        assert_equal -1 $idle
+        r config set maxmemory-policy noeviction
+        r flushall
+    }
+
     foreach cmd {SET GET MSET BITFIELD LMOVE LPOP BLPOP PING MEMORY MEMORY|USAGE RENAME GEORADIUS_RO} {
         test "$cmd command will not be marked with movablekeys" {
             set info [lindex [r command info $cmd] 0]
@@ -7,7 +7,7 @@ start_server {tags {"introspection"}} {
 
     test {CLIENT LIST} {
         r client list
-    } {id=* addr=*:* laddr=*:* fd=* name=* age=* idle=* flags=N capa= db=* sub=0 psub=0 ssub=0 multi=-1 watch=0 qbuf=0 qbuf-free=* argv-mem=* multi-mem=0 rbs=* rbp=* obl=0 oll=0 omem=0 tot-mem=* events=r cmd=client|list user=* redir=-1 resp=* lib-name=* lib-ver=* tot-net-in=* tot-net-out=* tot-cmds=*}
+    } {id=* addr=*:* laddr=*:* fd=* name=* age=* idle=* flags=N capa= db=* sub=0 psub=0 ssub=0 multi=-1 watch=0 qbuf=0 qbuf-free=* argv-mem=* multi-mem=0 rbs=* rbp=* obl=0 oll=0 omem=0 tot-mem=* events=r cmd=client|list user=* redir=-1 resp=* lib-name=* lib-ver=* tot-net-in=* tot-net-out=* tot-cmds=* tot-exec-usec=* tot-alloc-bytes=*}
 
     test {CLIENT LIST with IDs} {
         set myid [r client id]
@@ -17,7 +17,7 @@ start_server {tags {"introspection"}} {
 
     test {CLIENT INFO} {
         r client info
-    } {id=* addr=*:* laddr=*:* fd=* name=* age=* idle=* flags=N capa= db=* sub=0 psub=0 ssub=0 multi=-1 watch=0 qbuf=0 qbuf-free=* argv-mem=* multi-mem=0 rbs=* rbp=* obl=0 oll=0 omem=0 tot-mem=* events=r cmd=client|info user=* redir=-1 resp=* lib-name=* lib-ver=* tot-net-in=* tot-net-out=* tot-cmds=*}
+    } {id=* addr=*:* laddr=*:* fd=* name=* age=* idle=* flags=N capa= db=* sub=0 psub=0 ssub=0 multi=-1 watch=0 qbuf=0 qbuf-free=* argv-mem=* multi-mem=0 rbs=* rbp=* obl=0 oll=0 omem=0 tot-mem=* events=r cmd=client|info user=* redir=-1 resp=* lib-name=* lib-ver=* tot-net-in=* tot-net-out=* tot-cmds=* tot-exec-usec=* tot-alloc-bytes=*}
 
     test {CLIENT LIST with ADDR filter} {
         set client_info [r client info]
@@ -682,10 +682,12 @@ start_server {tags {"introspection"}} {
             slaveof
             requirepass
             server-cpulist
+            io-threads-cpulist
             bio-cpulist
             aof-rewrite-cpulist
             bgsave-cpulist
             server_cpulist
+            io_threads_cpulist
             bio_cpulist
             aof_rewrite_cpulist
             bgsave_cpulist
@@ -696,6 +698,7 @@ start_server {tags {"introspection"}} {
             oom-score-adj-values
             enable-protected-configs
             enable-debug-command
+            loading-serve-reads
             enable-module-command
             dbfilename
             logfile
@@ -705,6 +708,10 @@ start_server {tags {"introspection"}} {
             client-default-resp
             dual-channel-replication-enabled
             rdma-completion-vector
+            rdma-completion-moderation
+            rdma-inline-threshold
+            rdma-use-srq
+            rdma-mr-pool-size
             rdma-rx-size
             rdma-bind
             rdma-port
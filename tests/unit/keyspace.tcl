@@ -34,6 +34,17 @@ start_server {tags {"keyspace"}} {
         r dbsize
     } {6}
 
+    test {KEYS with incremental scan} {
+        r config set keys-incremental-scan yes
+        assert_equal {foo_a foo_b foo_c} [lsort [r keys foo*]]
+        assert_equal {foo_a foo_b foo_c key_x key_y key_z} [lsort [r keys *]]
+        # Inside MULTI the client can't block, KEYS runs synchronously.
+        r multi
+        r keys foo*
+        assert_equal {foo_a foo_b foo_c} [lsort [lindex [r exec] 0]]
+        r config set keys-incremental-scan no
+    }
+
     test {KEYS with hashtag} {
         foreach key {"{a}x" "{a}y" "{a}z" "{b}a" "{b}b" "{b}c"} {
             r set $key hello
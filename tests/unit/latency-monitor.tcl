@@ -60,6 +60,25 @@ start_server {tags {"latency-monitor needs:latency"}} {
         assert {[llength [r latency histogram set get]] == 4}
     }
 
+    test {LATENCY HISTOGRAM rolling window distribution} {
+        r config resetstat
+        r set a b
+        set histo [dict create {*}[r latency histogram set]]
+        assert_match {calls 1 histogram_usec * recent_calls 1 histogram_usec_recent *} [dict get $histo set]
+
+        # With windows disabled only the cumulative histogram is replied,
+        # and samples recorded meanwhile don't enter the recent view.
+        r config set latency-tracking-window 0
+        r set a b
+        set histo [dict create {*}[r latency histogram set]]
+        assert_match {calls 2 histogram_usec *} [dict get $histo set]
+        assert_no_match {*recent_calls*} [dict get $histo set]
+        r config set latency-tracking-window 60
+
+        set histo [dict create {*}[r latency histogram set]]
+        assert_match {calls 2 histogram_usec * recent_calls 1 histogram_usec_recent *} [dict get $histo set]
+    }
+
     test {LATENCY HISTOGRAM with wrong command name skips the invalid one} {
         r config resetstat
         assert {[llength [r latency histogram blabla]] == 0}
@@ -88,3 +88,37 @@ start_server {tags {"lazyfree"}} {
         assert_equal [s lazyfreed_objects] 0
     } {} {needs:config-resetstat}
 }
+
+start_server {tags {"lazyfree"}} {
+    test "delete burst triggers an allocator purge" {
+        r config resetstat
+        r config set delete-burst-purge-threshold 50
+        for {set i 0} {$i < 100} {incr i} {
+            r set burstkey:$i [string repeat x 100]
+        }
+        for {set i 0} {$i < 100} {incr i} {
+            r unlink burstkey:$i
+        }
+        assert {[s deleted_keys] >= 100}
+        # serverCron evaluates the burst once per second, and holds the
+        # purge until pending lazy frees have drained.
+        wait_for_condition 50 100 {
+            [s delete_burst_purges] > 0
+        } else {
+            fail "no purge was triggered by the delete burst"
+        }
+        r config set delete-burst-purge-threshold 0
+    } {OK} {needs:config-resetstat}
+
+    test "no purge below the delete burst threshold" {
+        r config resetstat
+        r config set delete-burst-purge-threshold 1000
+        for {set i 0} {$i < 10} {incr i} {
+            r set smallburst:$i foo
+            r del smallburst:$i
+        }
+        after 1100
+        assert_equal 0 [s delete_burst_purges]
+        r config set delete-burst-purge-threshold 0
+    } {OK} {needs:config-resetstat}
+}
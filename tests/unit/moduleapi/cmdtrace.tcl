@@ -0,0 +1,57 @@
+set testmodule [file normalize tests/modules/cmdtrace.so]
+
+start_server {tags {"modules"}} {
+    r module load $testmodule
+
+    test {Command trace ring records executed commands} {
+        r cmdtrace.start 1024
+        r set traced-key some-value
+        r get traced-key
+        # The poller runs on a module thread, give it a moment to drain.
+        wait_for_condition 50 100 {
+            [lindex [r cmdtrace.find get] 0] >= 1
+        } else {
+            fail "Trace for GET never showed up"
+        }
+        set trace [r cmdtrace.find set]
+        assert {[lindex $trace 0] >= 1}
+        # The key hash is the cluster hash slot of the first key:
+        # CRC16("traced-key") modulo 16384 is 3083.
+        assert_equal 3083 [lindex $trace 1]
+        # SET replies +OK, i.e. 5 bytes including CRLF.
+        assert_equal 5 [lindex $trace 2]
+    }
+
+    test {Command trace reports keyless commands with no key hash} {
+        r ping
+        wait_for_condition 50 100 {
+            [lindex [r cmdtrace.find ping] 0] >= 1
+        } else {
+            fail "Trace for PING never showed up"
+        }
+        assert_equal -1 [lindex [r cmdtrace.find ping] 1]
+    }
+
+    test {Command trace stop halts recording} {
+        r cmdtrace.stop
+        set count [r cmdtrace.count]
+        r set untraced-key some-value
+        after 100
+        assert_equal $count [r cmdtrace.count]
+    }
+
+    test {Command trace ring survives a restart cycle} {
+        r cmdtrace.start
+        r set traced-again some-value
+        wait_for_condition 50 100 {
+            [lindex [r cmdtrace.find set] 0] >= 1
+        } else {
+            fail "Trace for SET never showed up after restart"
+        }
+        r cmdtrace.stop
+    } {OK}
+
+    test {Unload the module - cmdtrace} {
+        assert_equal {OK} [r module unload cmdtrace]
+    }
+}
@@ -328,3 +328,31 @@ start_server {config "minimal.conf" tags {"external:skip"} overrides {enable-deb
         }
     }
 }
+
+start_server {tags {"repl-stream"}} {
+    test {reply-stream-threshold streams large aggregate replies correctly} {
+        r config set reply-stream-threshold 16kb
+        r del myhash mylist myzset
+        for {set j 0} {$j < 10000} {incr j} {
+            r hset myhash field:$j value:$j
+            r rpush mylist value:$j
+            r zadd myzset $j member:$j
+        }
+        assert_equal 10000 [expr {[llength [r hgetall myhash]] / 2}]
+        assert_equal {value:0 value:1} [lrange [r lrange mylist 0 -1] 0 1]
+        assert_equal 10000 [llength [r lrange mylist 0 -1]]
+        assert_equal 10000 [llength [r zrange myzset 0 -1]]
+        assert_equal {member:9999} [lindex [r zrange myzset 0 -1] end]
+
+        # Pipelined large replies must come back in order and intact.
+        set rd [valkey_deferring_client]
+        $rd hgetall myhash
+        $rd lrange mylist 0 -1
+        $rd zrange myzset 0 -1 withscores
+        assert_equal 20000 [llength [$rd read]]
+        assert_equal 10000 [llength [$rd read]]
+        assert_equal 20000 [llength [$rd read]]
+        $rd close
+        r config set reply-stream-threshold 0
+    }
+}
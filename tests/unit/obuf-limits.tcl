@@ -227,4 +227,50 @@ start_server {tags {"obuf-limits external:skip logreqres:skip"}} {
         assert_match "*I/O error*" $e
         reconnect
     }
+
+    test "Soft limit backpressure throttles the client instead of closing it" {
+        r flushall
+        r config set client-output-buffer-backpressure yes
+        r config set client-output-buffer-limit {pubsub 0 100000 1}
+        set rd1 [valkey_deferring_client]
+
+        $rd1 client setname bp_client
+        assert_equal OK [$rd1 read]
+        $rd1 subscribe foo
+        assert_equal "subscribe foo 1" [$rd1 read]
+
+        # Fill the output buffer past the soft limit without the subscriber
+        # reading, then keep it there longer than the soft limit seconds.
+        set omem 0
+        while 1 {
+            r publish foo [string repeat x 1000]
+            set clients [split [r client list] "\r\n"]
+            set c [lsearch -inline $clients *name=bp_client*]
+            regexp {omem=([0-9]+)} $c - omem
+            if {$omem > 100000} break
+        }
+        # The soft limit time is counted with second granularity, wait long
+        # enough for the cron sweep to act on the overrun.
+        wait_for_condition 50 100 {
+            [s client_output_buffer_backpressure_events] > 0
+        } else {
+            fail "No backpressure event was recorded"
+        }
+
+        # The client survived the overrun.
+        assert_match "*name=bp_client*" [r client list]
+
+        # Drain the subscriber: reading is resumed by cron once under the
+        # soft limit again, after which the connection processes input and
+        # the PING queued behind the backlog of messages gets answered.
+        $rd1 ping
+        while 1 {
+            set msg [$rd1 read]
+            if {[string match -nocase "*pong*" $msg]} break
+        }
+        $rd1 close
+
+        r config set client-output-buffer-backpressure no
+        r config set client-output-buffer-limit {pubsub 33554432 8388608 60}
+    }
 }
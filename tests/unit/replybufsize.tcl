@@ -40,7 +40,37 @@ start_server {tags {"replybufsize"}} {
    
         # Restore the peak reset time to default
         r debug replybuffer peak-reset-time reset
-        
+
+        $tc close
+    } {0} {needs:debug}
+
+    test {verify deep-idle clients drop to a dormant reply buffer} {
+        r debug replybuffer peak-reset-time 100
+
+        variable tc [valkey_client]
+        $tc client setname dormant_client
+
+        # After more than 2 seconds without interaction the reply buffer is
+        # reclaimed below the regular minimum.
+        wait_for_condition 50 100 {
+            [get_reply_buffer_size dormant_client] < 1024
+        } else {
+            set rbs [get_reply_buffer_size dormant_client]
+            fail "reply buffer of deep-idle client is $rbs"
+        }
+
+        # Activity grows the buffer back through the usual doubling.
+        r debug replybuffer peak-reset-time never
+        wait_for_condition 20 100 {
+            [$tc get bigval ; get_reply_buffer_size dormant_client] >= 1024
+        } else {
+            set rbs [get_reply_buffer_size dormant_client]
+            fail "reply buffer of reactivated client is $rbs"
+        }
+
+        # Restore the peak reset time to default
+        r debug replybuffer peak-reset-time reset
+
         $tc close
     } {0} {needs:debug}
 }
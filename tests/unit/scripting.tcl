@@ -653,6 +653,33 @@ start_server {tags {"scripting"}} {
         assert_error {NOSCRIPT*} {r script show 4f5a49d7b18244a3b100d159b78b51474e23e081}
     }
 
+    test {SCRIPT PROFILE - samples the hot lines of a script} {
+        r script profile start 100
+        r eval {
+            local x = 0
+            for i = 1, 100000 do
+                x = x + i
+            end
+            return x
+        } 0
+        r script profile stop
+        set samples [r script profile dump]
+        assert {[llength $samples] > 0}
+        # The busy loop must dominate the samples.
+        set top [lindex $samples 0]
+        assert_match {user_script:*} [lindex $top 0]
+        assert {[lindex $top 1] > 0}
+        r script profile reset
+        assert_equal {} [r script profile dump]
+    }
+
+    test {SCRIPT PROFILE - argument errors} {
+        assert_error {*sample-interval*} {r script profile start 0}
+        # Intervals above INT_MAX would truncate in lua_sethook.
+        assert_error {*sample-interval*} {r script profile start 4294967296}
+        assert_error {*Use SCRIPT PROFILE*} {r script profile frequency}
+    }
+
     test "SORT is normally not alpha re-ordered for the scripting engine" {
         r del myset
         r sadd myset 1 2 3 4 10
@@ -9,6 +9,29 @@ start_server {tags {"string"}} {
         r get x
     } {}
 
+    test {GET with read-reply-coalescing} {
+        r config set read-reply-coalescing yes
+        r set hotkey value1
+        # Repeated and pipelined reads return the current value.
+        set rd [valkey_deferring_client]
+        for {set i 0} {$i < 10} {incr i} {$rd get hotkey}
+        for {set i 0} {$i < 10} {incr i} {assert_equal {value1} [$rd read]}
+        # A write in between the reads is always observed.
+        $rd get hotkey
+        $rd set hotkey value2
+        $rd get hotkey
+        assert_equal {value1} [$rd read]
+        assert_equal {OK} [$rd read]
+        assert_equal {value2} [$rd read]
+        $rd close
+        # Integer encoded values and missing keys work as usual.
+        r set hotnum 1234
+        assert_equal {1234 1234} [list [r get hotnum] [r get hotnum]]
+        r del hotkey
+        assert_equal {} [r get hotkey]
+        r config set read-reply-coalescing no
+    }
+
     test {Very big payload in GET/SET} {
         set buf [string repeat "abcd" 1000000]
         r set foo $buf
@@ -741,6 +764,39 @@ if {[string match {*jemalloc*} [s mem_allocator]]} {
         }
     }
 
+    test {SETRANGE full overwrite replaces the value and keeps the TTL} {
+        r del mykey
+        r set mykey "short" ex 100
+        # Offset zero and a value at least as long as the current one takes
+        # the replacement path instead of copying in place.
+        assert_equal 12 [r setrange mykey 0 "longer-value"]
+        assert_equal "longer-value" [r get mykey]
+        assert_range [r ttl mykey] 90 100
+        # Same length exactly.
+        assert_equal 12 [r setrange mykey 0 "LONGER-VALUE"]
+        assert_equal "LONGER-VALUE" [r get mykey]
+        # Missing key at offset zero.
+        r del mykey
+        assert_equal 12 [r setrange mykey 0 "created-here"]
+        assert_equal "created-here" [r get mykey]
+    }
+
+    test {APPEND and SETRANGE growth on a multi-megabyte string} {
+        # Exercise the proportional preallocation path taken once the
+        # string grows past the fixed sds preallocation limit.
+        r del bigstr
+        set chunk [string repeat a 65536]
+        for {set i 0} {$i < 48} {incr i} {
+            r append bigstr $chunk
+        }
+        assert_equal [expr {48 * 65536}] [r strlen bigstr]
+        r setrange bigstr [r strlen bigstr] $chunk
+        assert_equal [expr {49 * 65536}] [r strlen bigstr]
+        assert_equal $chunk [r getrange bigstr -65536 -1]
+        assert_equal "aaaa" [r getrange bigstr 0 3]
+        r del bigstr
+    }
+
     test {APPEND modifies the encoding from int to raw} {
         r del foo
         r set foo 1